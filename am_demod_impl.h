@@ -0,0 +1,187 @@
+/**
+ * @file am_demod_impl.h
+ * @brief AM 解调器的精度无关实现 (由 main-am.c 分别以 double 和 float 包含)
+ *
+ * 包含前需要定义：
+ *   AM_REAL        样本类型 (double 或 float)
+ *   AM_ID(x)       函数名: x 或 x_f
+ *   AM_MATH(fn)    对应精度的数学函数: fn 或 fn##f (fabs / fabsf)
+ *   AM_VERBOSE     是否输出过程信息 (单精度版本用于对比，不输出)
+ *
+ * 单精度版本的样本以 float 存储和运算，内存带宽减半；
+ * 本地载波和直流均值仍以 double 计算，误差只来自滤波和检波本身的舍入。
+ */
+
+/**
+ * 中心移动平均 (边界处只对窗口内实际存在的样本求平均)
+ */
+static void AM_ID(am_moving_average)(AM_REAL *input, AM_REAL *output, int n, int window_size) {
+    int half_window = window_size / 2;
+
+    for (int i = 0; i < n; i++) {
+        AM_REAL sum = 0;
+        int count = 0;
+
+        for (int j = -half_window; j <= half_window; j++) {
+            int idx = i + j;
+            if (idx >= 0 && idx < n) {
+                sum += input[idx];
+                count++;
+            }
+        }
+
+        output[i] = sum / count;
+    }
+}
+
+/**
+ * 减去全信号的均值 (均值以 double 累加，长信号在单精度下也不会累积舍入误差)
+ */
+static void AM_ID(am_remove_dc)(AM_REAL *signal, int n) {
+    double dc = 0.0;
+    for (int i = 0; i < n; i++) dc += signal[i];
+    dc /= n;
+    for (int i = 0; i < n; i++) signal[i] -= (AM_REAL)dc;
+}
+
+/**
+ * @brief AM包络检波解调
+ *
+ * 使用包络检波器提取AM信号的调制信号
+ * 原理：通过整流 + 低通滤波提取包络
+ *
+ * @param am_signal 输入的AM信号
+ * @param demod_signal 输出的解调信号
+ * @param n 采样点数
+ * @param fs 采样频率
+ */
+void AM_ID(am_demodulate_envelope)(AM_REAL *am_signal, AM_REAL *demod_signal, int n, AM_REAL fs) {
+    // 方法1：简单的包络检波（全波整流 + 低通滤波）
+
+    // 步骤1：全波整流
+    AM_REAL *rectified = (AM_REAL *)malloc(n * sizeof(AM_REAL));
+    if (!rectified) {
+        fprintf(stderr, "内存分配失败\n");
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        rectified[i] = AM_MATH(fabs)(am_signal[i]);
+    }
+
+    // 步骤2：低通滤波器（简单移动平均滤波器）
+    // 滤波器窗口大小应该足够去除载波频率，但保留调制信号
+    int window_size = (int)(fs / (AM_REAL)1000);  // 根据采样率自适应
+    if (window_size < 3) window_size = 3;
+    if (window_size % 2 == 0) window_size++;  // 确保为奇数
+    AM_ID(am_moving_average)(rectified, demod_signal, n, window_size);
+
+    // 步骤3：去除直流分量（减去平均值）
+    AM_ID(am_remove_dc)(demod_signal, n);
+
+    free(rectified);
+    if (AM_VERBOSE) {
+        printf("包络检波解调完成（窗口大小=%d）\n", window_size);
+    }
+}
+
+/**
+ * @brief AM包络检波解调（改进版 - 使用Hilbert变换近似）
+ *
+ * @param am_signal 输入的AM信号
+ * @param demod_signal 输出的解调信号
+ * @param n 采样点数
+ * @param fs 采样频率
+ */
+void AM_ID(am_demodulate_envelope_hilbert)(AM_REAL *am_signal, AM_REAL *demod_signal,
+                                           int n, AM_REAL fs) {
+    (void)fs;
+    // 使用解析信号方法计算包络
+    // 包络 = sqrt(I^2 + Q^2)
+    // 其中 I 是原信号，Q 是 Hilbert 变换
+
+    // 简化方法：使用局部最大值插值
+    for (int i = 1; i < n - 1; i++) {
+        // 计算包络（使用相邻样本的平方和的平方根近似）
+        AM_REAL val = am_signal[i] * am_signal[i];
+        AM_REAL deriv = (am_signal[i+1] - am_signal[i-1]) / (AM_REAL)2;
+        demod_signal[i] = AM_MATH(sqrt)(val + deriv * deriv);
+    }
+
+    demod_signal[0] = demod_signal[1];
+    demod_signal[n-1] = demod_signal[n-2];
+
+    // 低通滤波平滑
+    int window = 5;
+    AM_REAL *temp = (AM_REAL *)malloc(n * sizeof(AM_REAL));
+    if (!temp) {
+        fprintf(stderr, "内存分配失败\n");
+        return;
+    }
+    memcpy(temp, demod_signal, n * sizeof(AM_REAL));
+
+    for (int i = window; i < n - window; i++) {
+        AM_REAL sum = 0;
+        for (int j = -window; j <= window; j++) {
+            sum += temp[i + j];
+        }
+        demod_signal[i] = sum / (2 * window + 1);
+    }
+
+    // 去直流
+    AM_ID(am_remove_dc)(demod_signal, n);
+
+    free(temp);
+    if (AM_VERBOSE) {
+        printf("Hilbert变换包络检波解调完成\n");
+    }
+}
+
+/**
+ * @brief AM相干解调（同步检波）
+ *
+ * 使用本地载波与接收信号相乘，然后低通滤波
+ * 需要载波同步（频率和相位）
+ *
+ * @param am_signal 输入的AM信号
+ * @param demod_signal 输出的解调信号
+ * @param n 采样点数
+ * @param fc 载波频率
+ * @param fs 采样频率
+ * @param phase_offset 相位偏移（用于模拟相位误差）
+ */
+void AM_ID(am_demodulate_coherent)(AM_REAL *am_signal, AM_REAL *demod_signal,
+                                   int n, AM_REAL fc, AM_REAL fs, AM_REAL phase_offset) {
+    // 步骤1：生成本地载波 (旋转振荡器以 double 生成，t 较大时相位也不会失准)
+    double *local_carrier = (double *)malloc(n * sizeof(double));
+    AM_REAL *mixed = (AM_REAL *)malloc(n * sizeof(AM_REAL));
+    if (!local_carrier || !mixed) {
+        fprintf(stderr, "内存分配失败\n");
+        free(local_carrier);
+        free(mixed);
+        return;
+    }
+    osc_rotator osc;
+    osc_rotator_init(&osc, fc, fs, phase_offset);
+    osc_rotator_render(&osc, local_carrier, NULL, n);
+
+    // 步骤2：混频（相乘）
+    for (int i = 0; i < n; i++) {
+        mixed[i] = am_signal[i] * (AM_REAL)(2.0 * local_carrier[i]);
+    }
+
+    // 步骤3：低通滤波（去除2fc成分）
+    int window_size = (int)(fs / (fc / (AM_REAL)10));
+    if (window_size < 5) window_size = 5;
+    if (window_size % 2 == 0) window_size++;
+    AM_ID(am_moving_average)(mixed, demod_signal, n, window_size);
+
+    // 去直流
+    AM_ID(am_remove_dc)(demod_signal, n);
+
+    free(local_carrier);
+    free(mixed);
+    if (AM_VERBOSE) {
+        printf("相干解调完成（相位偏移=%.2f°，窗口大小=%d）\n",
+               phase_offset * 180.0 / M_PI, window_size);
+    }
+}
@@ -0,0 +1,380 @@
+/**
+ * @file audio_sink.c
+ * @brief 常驻的异步音频输出 (见 audio_sink.h)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <pthread.h>
+
+#include "audio_sink.h"
+#include "fft.h"
+
+#define AUDIO_SINK_MASK ((size_t)AUDIO_SINK_CAPACITY - 1)
+
+struct audio_sink {
+    int type;
+    FILE* out;
+    int rate;
+    int16_t* ring;              // AUDIO_SINK_CAPACITY 个 S16_LE 样本
+    size_t head;                // 已写入的样本数 (只由生产者修改)
+    size_t tail;                // 已写出的样本数 (只由输出线程修改)
+    int closing;                // 生产者不再写入
+    int failed;                 // 输出失败
+    unsigned long long bytes;   // 已写出的数据字节数 (输出线程)
+    pthread_t thread;
+    pthread_mutex_t lock;       // 只在等待和唤醒时使用，数据读写不加锁
+    pthread_cond_t wake;
+    int consumer_waiting;       // 输出线程发现缓冲区为空，准备等待
+    int producer_waiting;       // 生产者发现缓冲区已满，准备等待
+    struct sigaction old_sigpipe;   // 管道输出时打开前的 SIGPIPE 处理方式，关闭时恢复
+};
+
+/* ---------------- 样本转换 ---------------- */
+
+/**
+ * 与 double_to_pcm16 相同: 限幅后乘以 32767 向零取整，按小端字节序存放
+ */
+static void convert_scalar(const double* x, int16_t* out, int count) {
+    for (int i = 0; i < count; i++) {
+        double sample = x[i];
+        if (sample > 1.0) sample = 1.0;
+        if (sample < -1.0) sample = -1.0;
+        uint16_t v = (uint16_t)(int16_t)(sample * 32767.0);
+        unsigned char* p = (unsigned char*)(out + i);
+        p[0] = (unsigned char)(v & 0xFF);
+        p[1] = (unsigned char)(v >> 8);
+    }
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define AUDIO_SIMD_X86 1
+#include <immintrin.h>
+
+/*
+ * 向量内核: 每次把 8 个样本限幅、乘以 32767、向零取整 (cvttpd)，再用 packs 压缩为 8 个 int16。
+ * 限幅后的值不超过 32767，packs 的饱和不会起作用；x86 为小端，直接存储即为 S16_LE。
+ * 余下的样本在同一个函数内处理，理由与 image_io.c 的 min/max 内核相同 (避免尾调用前缺少 vzeroupper)
+ */
+#define AUDIO_CONVERT_FN(NAME, PACK8)                                                           \
+    static void NAME(const double* x, int16_t* out, int count) {                                \
+        int i = 0;                                                                              \
+        for (; i + 8 <= count; i += 8) {                                                        \
+            _mm_storeu_si128((__m128i*)(out + i), PACK8(x + i));                                \
+        }                                                                                       \
+        for (; i < count; i++) {                                                                \
+            double sample = x[i];                                                               \
+            if (sample > 1.0) sample = 1.0;                                                     \
+            if (sample < -1.0) sample = -1.0;                                                   \
+            out[i] = (int16_t)(sample * 32767.0);                                               \
+        }                                                                                       \
+    }
+
+#pragma GCC push_options
+#pragma GCC target("sse2")
+static inline __m128i pack8_sse2(const double* x) {
+    const __m128d lo = _mm_set1_pd(-1.0), hi = _mm_set1_pd(1.0), scale = _mm_set1_pd(32767.0);
+    __m128i v[4];
+    for (int k = 0; k < 4; k++) {
+        __m128d s = _mm_max_pd(_mm_min_pd(_mm_loadu_pd(x + 2 * k), hi), lo);
+        v[k] = _mm_cvttpd_epi32(_mm_mul_pd(s, scale));
+    }
+    return _mm_packs_epi32(_mm_unpacklo_epi64(v[0], v[1]), _mm_unpacklo_epi64(v[2], v[3]));
+}
+AUDIO_CONVERT_FN(convert_sse2, pack8_sse2)
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+static inline __m128i pack8_avx2(const double* x) {
+    const __m256d lo = _mm256_set1_pd(-1.0), hi = _mm256_set1_pd(1.0), scale = _mm256_set1_pd(32767.0);
+    __m256d a = _mm256_max_pd(_mm256_min_pd(_mm256_loadu_pd(x), hi), lo);
+    __m256d b = _mm256_max_pd(_mm256_min_pd(_mm256_loadu_pd(x + 4), hi), lo);
+    return _mm_packs_epi32(_mm256_cvttpd_epi32(_mm256_mul_pd(a, scale)),
+                           _mm256_cvttpd_epi32(_mm256_mul_pd(b, scale)));
+}
+AUDIO_CONVERT_FN(convert_avx2, pack8_avx2)
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+static inline __m128i pack8_avx512(const double* x) {
+    __m512d s = _mm512_max_pd(_mm512_min_pd(_mm512_loadu_pd(x), _mm512_set1_pd(1.0)), _mm512_set1_pd(-1.0));
+    __m256i v = _mm512_cvttpd_epi32(_mm512_mul_pd(s, _mm512_set1_pd(32767.0)));
+    return _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+}
+AUDIO_CONVERT_FN(convert_avx512, pack8_avx512)
+#pragma GCC pop_options
+#endif
+
+void audio_convert_s16(const double* x, int16_t* out, int count) {
+#ifdef AUDIO_SIMD_X86
+    switch (fft_simd_get_level()) {
+        case FFT_SIMD_AVX512: convert_avx512(x, out, count); return;
+        case FFT_SIMD_AVX2:   convert_avx2(x, out, count); return;
+        case FFT_SIMD_SSE2:   convert_sse2(x, out, count); return;
+        default: break;
+    }
+#endif
+    convert_scalar(x, out, count);
+}
+
+/* ---------------- 输出线程 ---------------- */
+
+/*
+ * 等待与唤醒: 一方发现缓冲区空 (或满) 时先置等待标志，再检查一次读写位置，仍然不变才在条件变量上等待；
+ * 另一方更新位置后读取等待标志，只有对方在等待时才加锁唤醒。标志和位置的读写都是顺序一致的，
+ * 因此要么等待方的第二次检查看到新位置，要么更新方看到等待标志，不会丢失唤醒
+ */
+
+/**
+ * 在 *flag 上声明等待，ready(sink) 仍不成立时阻塞到被唤醒
+ */
+static void sink_wait(audio_sink* sink, int* flag, int (*ready)(audio_sink*)) {
+    pthread_mutex_lock(&sink->lock);
+    __atomic_store_n(flag, 1, __ATOMIC_SEQ_CST);
+    while (!ready(sink)) {
+        pthread_cond_wait(&sink->wake, &sink->lock);
+    }
+    __atomic_store_n(flag, 0, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&sink->lock);
+}
+
+/**
+ * 对方正在等待 (*flag 已置位) 时唤醒它
+ */
+static void sink_notify(audio_sink* sink, int* flag) {
+    if (__atomic_load_n(flag, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&sink->lock);
+        pthread_cond_broadcast(&sink->wake);
+        pthread_mutex_unlock(&sink->lock);
+    }
+}
+
+/** 输出线程可以继续: 有未写出的数据或生产者已关闭 */
+static int consumer_ready(audio_sink* sink) {
+    return __atomic_load_n(&sink->head, __ATOMIC_SEQ_CST) != sink->tail ||
+           __atomic_load_n(&sink->closing, __ATOMIC_SEQ_CST);
+}
+
+/** 生产者可以继续: 缓冲区有空间或输出已失败 */
+static int producer_ready(audio_sink* sink) {
+    return sink->head - __atomic_load_n(&sink->tail, __ATOMIC_SEQ_CST) < AUDIO_SINK_CAPACITY ||
+           __atomic_load_n(&sink->failed, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * 以小端字节序写入 n 字节的整数
+ */
+static int write_le(FILE* out, unsigned long value, int n) {
+    unsigned char bytes[4];
+    for (int i = 0; i < n; i++) {
+        bytes[i] = (unsigned char)((value >> (8 * i)) & 0xFF);
+    }
+    return fwrite(bytes, 1, n, out) == (size_t)n ? 0 : -1;
+}
+
+/**
+ * 写入 WAV 文件头 (PCM 16 位单声道)
+ * @param data_bytes 数据字节数 (打开时先写最大值，关闭时回写实际长度)
+ */
+static int write_wav_header(FILE* out, int rate, unsigned long data_bytes) {
+    unsigned long riff_bytes = data_bytes > 0xFFFFFFFFul - 36 ? 0xFFFFFFFFul : data_bytes + 36;
+    int status = 0;
+    status |= fwrite("RIFF", 1, 4, out) == 4 ? 0 : -1;
+    status |= write_le(out, riff_bytes, 4);
+    status |= fwrite("WAVEfmt ", 1, 8, out) == 8 ? 0 : -1;
+    status |= write_le(out, 16, 4);                 // fmt 块长度
+    status |= write_le(out, 1, 2);                  // PCM
+    status |= write_le(out, 1, 2);                  // 声道数
+    status |= write_le(out, (unsigned long)rate, 4);
+    status |= write_le(out, (unsigned long)rate * 2, 4);  // 每秒字节数
+    status |= write_le(out, 2, 2);                  // 每帧字节数
+    status |= write_le(out, 16, 2);                 // 位深
+    status |= fwrite("data", 1, 4, out) == 4 ? 0 : -1;
+    status |= write_le(out, data_bytes > 0xFFFFFFFFul ? 0xFFFFFFFFul : data_bytes, 4);
+    return status;
+}
+
+/**
+ * 消费者: 把环形缓冲区中已写入的样本整段写出，直到生产者关闭且缓冲区为空
+ * 输出失败后继续推进读位置 (丢弃数据)，生产者不会因缓冲区满而一直等待
+ */
+static void* audio_sink_thread(void* arg) {
+    audio_sink* sink = (audio_sink*)arg;
+    size_t tail = sink->tail;
+    for (;;) {
+        size_t head = __atomic_load_n(&sink->head, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            // 关闭标志在最后一次写入之后设置，看到它时再读一次写位置即可确定是否还有数据
+            if (__atomic_load_n(&sink->closing, __ATOMIC_ACQUIRE) &&
+                __atomic_load_n(&sink->head, __ATOMIC_ACQUIRE) == tail) {
+                break;
+            }
+            sink_wait(sink, &sink->consumer_waiting, consumer_ready);
+            continue;
+        }
+
+        size_t start = tail & AUDIO_SINK_MASK;
+        size_t n = head - tail;
+        if (n > AUDIO_SINK_CAPACITY - start) n = AUDIO_SINK_CAPACITY - start;
+        if (!__atomic_load_n(&sink->failed, __ATOMIC_RELAXED)) {
+            if (fwrite(sink->ring + start, sizeof(int16_t), n, sink->out) != n) {
+                __atomic_store_n(&sink->failed, 1, __ATOMIC_SEQ_CST);
+            } else {
+                sink->bytes += n * sizeof(int16_t);
+            }
+        }
+        tail += n;
+        __atomic_store_n(&sink->tail, tail, __ATOMIC_SEQ_CST);
+        sink_notify(sink, &sink->producer_waiting);
+    }
+    if (fflush(sink->out) != 0) {
+        __atomic_store_n(&sink->failed, 1, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+/* ---------------- 生产者接口 ---------------- */
+
+audio_sink* audio_sink_open(int type, const char* target, int rate) {
+    if (type < AUDIO_SINK_PIPE || type > AUDIO_SINK_WAV || rate <= 0) {
+        printf("错误: 无效的音频输出参数\n");
+        return NULL;
+    }
+    audio_sink* sink = (audio_sink*)calloc(1, sizeof(audio_sink));
+    int16_t* ring = (int16_t*)malloc(AUDIO_SINK_CAPACITY * sizeof(int16_t));
+    if (!sink || !ring) {
+        printf("内存分配失败\n");
+        free(sink);
+        free(ring);
+        return NULL;
+    }
+    sink->type = type;
+    sink->rate = rate;
+    sink->ring = ring;
+
+    if (type == AUDIO_SINK_PIPE) {
+        char cmd[256];
+        if (target != NULL) {
+            snprintf(cmd, sizeof(cmd), "aplay -D %s -f S16_LE -r %d -c 1 2>/dev/null", target, rate);
+        } else {
+            snprintf(cmd, sizeof(cmd), "aplay -f S16_LE -r %d -c 1 2>/dev/null", rate);
+        }
+        // aplay 退出后写管道应当返回错误，而不是让 SIGPIPE 结束整个进程；原来的处理方式在关闭时恢复
+        struct sigaction ignore;
+        memset(&ignore, 0, sizeof(ignore));
+        ignore.sa_handler = SIG_IGN;
+        sigemptyset(&ignore.sa_mask);
+        sigaction(SIGPIPE, &ignore, &sink->old_sigpipe);
+        sink->out = popen(cmd, "w");
+        if (!sink->out) {
+            printf("错误: 无法打开音频设备。请确保安装了 alsa-utils (aplay命令)\n");
+            sigaction(SIGPIPE, &sink->old_sigpipe, NULL);
+        } else {
+            setvbuf(sink->out, NULL, _IONBF, 0);    // 数据整段写出，不再经过 stdio 缓冲，减少播放延迟
+        }
+    } else {
+        sink->out = fopen(target, "wb");
+        if (!sink->out) {
+            printf("错误: 无法创建文件 %s\n", target);
+        }
+    }
+    if (!sink->out) {
+        free(ring);
+        free(sink);
+        return NULL;
+    }
+
+    pthread_mutex_init(&sink->lock, NULL);
+    pthread_cond_init(&sink->wake, NULL);
+    if ((type == AUDIO_SINK_WAV && write_wav_header(sink->out, rate, 0xFFFFFFFFul) != 0) ||
+        pthread_create(&sink->thread, NULL, audio_sink_thread, sink) != 0) {
+        printf("错误: 无法启动音频输出\n");
+        if (type == AUDIO_SINK_PIPE) {
+            pclose(sink->out);
+            sigaction(SIGPIPE, &sink->old_sigpipe, NULL);
+        } else {
+            fclose(sink->out);
+        }
+        pthread_cond_destroy(&sink->wake);
+        pthread_mutex_destroy(&sink->lock);
+        free(ring);
+        free(sink);
+        return NULL;
+    }
+    return sink;
+}
+
+/**
+ * 生产者: 把 count 个样本 (x 为 NULL 时为静音) 写入环形缓冲区，空间不足时等待输出线程
+ */
+static int audio_sink_push(audio_sink* sink, const double* x, int count) {
+    size_t head = sink->head;
+    while (count > 0) {
+        if (__atomic_load_n(&sink->failed, __ATOMIC_ACQUIRE)) {
+            return -1;
+        }
+        size_t tail = __atomic_load_n(&sink->tail, __ATOMIC_ACQUIRE);
+        size_t space = AUDIO_SINK_CAPACITY - (head - tail);
+        if (space == 0) {
+            sink_wait(sink, &sink->producer_waiting, producer_ready);
+            continue;
+        }
+
+        size_t start = head & AUDIO_SINK_MASK;
+        size_t n = (size_t)count;
+        if (n > space) n = space;
+        if (n > AUDIO_SINK_CAPACITY - start) n = AUDIO_SINK_CAPACITY - start;
+        if (x) {
+            audio_convert_s16(x, sink->ring + start, (int)n);
+            x += n;
+        } else {
+            memset(sink->ring + start, 0, n * sizeof(int16_t));
+        }
+        head += n;
+        count -= (int)n;
+        __atomic_store_n(&sink->head, head, __ATOMIC_SEQ_CST);
+        sink_notify(sink, &sink->consumer_waiting);
+    }
+    return __atomic_load_n(&sink->failed, __ATOMIC_ACQUIRE) ? -1 : 0;
+}
+
+int audio_sink_write(audio_sink* sink, const double* x, int count) {
+    return audio_sink_push(sink, x, count);
+}
+
+int audio_sink_silence(audio_sink* sink, int count) {
+    return audio_sink_push(sink, NULL, count);
+}
+
+int audio_sink_close(audio_sink* sink) {
+    if (!sink) return -1;
+    __atomic_store_n(&sink->closing, 1, __ATOMIC_SEQ_CST);
+    sink_notify(sink, &sink->consumer_waiting);
+    pthread_join(sink->thread, NULL);
+
+    int status = sink->failed ? -1 : 0;
+    if (sink->type == AUDIO_SINK_WAV && status == 0) {
+        // 回写实际的数据长度
+        if (fseek(sink->out, 0, SEEK_SET) != 0 ||
+            write_wav_header(sink->out, sink->rate, (unsigned long)sink->bytes) != 0) {
+            status = -1;
+        }
+    }
+    if (sink->type == AUDIO_SINK_PIPE) {
+        if (pclose(sink->out) != 0) status = -1;
+        sigaction(SIGPIPE, &sink->old_sigpipe, NULL);
+    } else {
+        if (fclose(sink->out) != 0) status = -1;
+    }
+    pthread_cond_destroy(&sink->wake);
+    pthread_mutex_destroy(&sink->lock);
+    free(sink->ring);
+    free(sink);
+    return status;
+}
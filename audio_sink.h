@@ -0,0 +1,64 @@
+/**
+ * @file audio_sink.h
+ * @brief 常驻的异步音频输出: 环形缓冲区 + 输出线程
+ *
+ * 整个按键序列只打开一次输出 (一个 aplay 管道、一个 PCM 文件或一个 WAV 文件)。
+ * 调用线程 (生产者) 把 double 样本按块转换为 S16_LE 后写入单生产者/单消费者的无锁环形缓冲区，
+ * 输出线程 (消费者) 把缓冲区中的数据整块写出。两侧只通过各自的读写位置同步 (原子读写，
+ * 写位置用 release 发布、读位置用 acquire 读取)，不加锁；缓冲区满或空时在条件变量上等待，
+ * 另一方只在对方等待时才加锁唤醒 (空 → 非空、满 → 不满)，平时的数据读写不涉及锁。
+ *
+ * 按键音和按键之间的静音都作为样本写入同一条数据流，播放时没有进程启动的间隙，
+ * 按键间隔精确到一个样本，与写入文件的结果完全相同。
+ * 样本转换 (限幅到 [-1, 1]、乘以 32767、向零取整) 按 fft_simd_get_level 使用 SSE2 / AVX2 / AVX-512，
+ * 与 main-dtmf.c 的 double_to_pcm16 逐样本相同。
+ */
+
+#ifndef AUDIO_SINK_H
+#define AUDIO_SINK_H
+
+#include <stdint.h>
+
+#define AUDIO_SINK_PIPE 0           // 通过管道送给 aplay 播放
+#define AUDIO_SINK_RAW  1           // 写入 S16_LE 单声道 PCM 文件
+#define AUDIO_SINK_WAV  2           // 写入 WAV 文件 (PCM 16 位单声道)
+
+#define AUDIO_SINK_CAPACITY (1 << 16)   // 环形缓冲区的样本数 (2 的幂)
+
+typedef struct audio_sink audio_sink;
+
+/**
+ * 打开输出并启动输出线程
+ * 管道输出期间忽略 SIGPIPE (aplay 提前退出时写入返回错误而不是结束进程)，audio_sink_close 时恢复原来的处理方式；
+ * 同时打开多个管道输出时应按打开的相反顺序关闭
+ * @param type AUDIO_SINK_PIPE / AUDIO_SINK_RAW / AUDIO_SINK_WAV
+ * @param target 管道为音频设备 (例如 "plughw:1,0"，NULL 使用默认设备)，文件为文件名
+ * @param rate 采样率 (Hz)
+ * @return 输出句柄，失败返回 NULL (已打印错误信息)
+ */
+audio_sink* audio_sink_open(int type, const char* target, int rate);
+
+/**
+ * 写入 count 个样本 (-1.0 到 1.0)，缓冲区满时等待输出线程
+ * @return 0表示成功，-1表示输出已经失败 (例如 aplay 退出或磁盘已满)
+ */
+int audio_sink_write(audio_sink* sink, const double* x, int count);
+
+/**
+ * 写入 count 个样本的静音
+ * @return 0表示成功，-1表示输出已经失败
+ */
+int audio_sink_silence(audio_sink* sink, int count);
+
+/**
+ * 等待缓冲区中的数据全部写出，结束输出线程并关闭输出 (WAV 文件补写数据长度)
+ * @return 0表示全部写出，-1表示输出失败
+ */
+int audio_sink_close(audio_sink* sink);
+
+/**
+ * 按块把样本转换为 S16_LE (限幅、乘以 32767、向零取整)
+ */
+void audio_convert_s16(const double* x, int16_t* out, int count);
+
+#endif /* AUDIO_SINK_H */
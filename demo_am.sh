@@ -9,7 +9,7 @@ echo ""
 # 检查程序是否存在
 if [ ! -f "./am_signal" ]; then
     echo "程序不存在，正在编译..."
-    gcc -o am_signal main-am.c -lm
+    gcc -o am_signal main-am.c text_io.c fft_thread.c oscillator.c fft_simd.c -lm -pthread
     if [ $? -ne 0 ]; then
         echo "编译失败！"
         exit 1
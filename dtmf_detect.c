@@ -0,0 +1,411 @@
+/**
+ * @file dtmf_detect.c
+ * @brief DTMF 按键检测的 Goertzel 滤波器组 (见 dtmf_detect.h)
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dtmf_detect.h"
+
+#define DTMF_GOERTZEL_LANES 8   // 七个频点补齐到 8 个通道
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+const double dtmf_low_freqs[DTMF_LOW_TONES] = {697, 770, 852, 941};
+const double dtmf_high_freqs[DTMF_HIGH_TONES] = {1209, 1336, 1477};
+const char dtmf_key_table[DTMF_LOW_TONES][DTMF_HIGH_TONES] = {
+    {'1', '2', '3'},
+    {'4', '5', '6'},
+    {'7', '8', '9'},
+    {'*', '0', '#'}
+};
+
+/**
+ * 第 i 个音调的频率 (0..3 为低频组，4..6 为高频组)
+ */
+static double dtmf_tone_freq(int i) {
+    return i < DTMF_LOW_TONES ? dtmf_low_freqs[i] : dtmf_high_freqs[i - DTMF_LOW_TONES];
+}
+
+int dtmf_bank_init(dtmf_bank* bank, int N, double fs, int harmonics) {
+    if (!bank || N < 2 || !(fs > 0)) return -1;
+
+    bank->N = N;
+    bank->fs = fs;
+    bank->nbins = harmonics ? DTMF_MAX_BINS : DTMF_TONES;
+    bank->threshold = DTMF_THRESHOLD;
+    bank->harmonic_ratio = DTMF_HARMONIC_RATIO;
+
+    // 下标的取法与 detect_dtmf 相同: 频率除以分辨率后四舍五入
+    double freq_resolution = fs / N;
+    for (int b = 0; b < bank->nbins; b++) {
+        double f = dtmf_tone_freq(b % DTMF_TONES) * (b < DTMF_TONES ? 1 : 2);
+        int k = (int)(f / freq_resolution + 0.5);
+        bank->bin[b] = (k <= N / 2) ? k : -1;
+        bank->coeff[b] = 2.0 * cos(2.0 * M_PI * k / N);
+    }
+    return 0;
+}
+
+/**
+ * 对 DTMF_GOERTZEL_LANES 个频点同时递推
+ * 频点数是编译期常量，状态留在寄存器中，内层循环可以整体向量化；多出的通道系数为 0，结果丢弃
+ */
+static void goertzel_lanes(const double* coeff, const double* x, int N, double* power) {
+    double s1[DTMF_GOERTZEL_LANES] = {0}, s2[DTMF_GOERTZEL_LANES] = {0};
+    for (int n = 0; n < N; n++) {
+        double xn = x[n];
+#pragma GCC unroll 8
+        for (int b = 0; b < DTMF_GOERTZEL_LANES; b++) {
+            double s0 = (xn - s2[b]) + coeff[b] * s1[b];   // xn - s2 不依赖上一步，关键路径只有一次乘加
+            s2[b] = s1[b];
+            s1[b] = s0;
+        }
+    }
+    for (int b = 0; b < DTMF_GOERTZEL_LANES; b++) {
+        power[b] = s1[b] * s1[b] + s2[b] * s2[b] - coeff[b] * s1[b] * s2[b];
+    }
+}
+
+void dtmf_goertzel(const dtmf_bank* bank, const double* x, double* magnitude) {
+    double coeff[DTMF_GOERTZEL_LANES];
+    double power[DTMF_GOERTZEL_LANES];
+
+    // 七个基波一组、七个谐波一组，各占 DTMF_GOERTZEL_LANES 个通道
+    for (int first = 0; first < bank->nbins; first += DTMF_TONES) {
+        for (int b = 0; b < DTMF_GOERTZEL_LANES; b++) {
+            coeff[b] = b < DTMF_TONES ? bank->coeff[first + b] : 0.0;
+        }
+        goertzel_lanes(coeff, x, bank->N, power);
+        for (int b = 0; b < DTMF_TONES; b++) {
+            magnitude[first + b] = (bank->bin[first + b] >= 0 && power[b] > 0) ? sqrt(power[b]) : 0.0;
+        }
+    }
+}
+
+char dtmf_decide(const double* magnitude, double threshold, int* low, int* high) {
+    int low_idx = -1, high_idx = -1;
+    double max_low_mag = 0, max_high_mag = 0;
+    for (int i = 0; i < DTMF_LOW_TONES; i++) {
+        if (magnitude[i] > threshold && magnitude[i] > max_low_mag) {
+            max_low_mag = magnitude[i];
+            low_idx = i;
+        }
+    }
+    for (int i = 0; i < DTMF_HIGH_TONES; i++) {
+        double mag = magnitude[DTMF_LOW_TONES + i];
+        if (mag > threshold && mag > max_high_mag) {
+            max_high_mag = mag;
+            high_idx = i;
+        }
+    }
+    if (low) *low = low_idx;
+    if (high) *high = high_idx;
+    return (low_idx >= 0 && high_idx >= 0) ? dtmf_key_table[low_idx][high_idx] : '?';
+}
+
+char dtmf_bank_detect(const dtmf_bank* bank, const double* x) {
+    double magnitude[DTMF_MAX_BINS];
+    int low, high;
+    dtmf_goertzel(bank, x, magnitude);
+    char key = dtmf_decide(magnitude, bank->threshold, &low, &high);
+    if (key == '?' || bank->nbins < DTMF_MAX_BINS) {
+        return key;
+    }
+
+    // 两个音调的二次谐波都必须足够弱
+    int tones[2] = {low, DTMF_LOW_TONES + high};
+    for (int t = 0; t < 2; t++) {
+        if (magnitude[DTMF_TONES + tones[t]] > bank->harmonic_ratio * magnitude[tones[t]]) {
+            return '?';
+        }
+    }
+    return key;
+}
+
+int dtmf_key_frequencies(char key, double* f_low, double* f_high) {
+    for (int i = 0; i < DTMF_LOW_TONES; i++) {
+        for (int j = 0; j < DTMF_HIGH_TONES; j++) {
+            if (dtmf_key_table[i][j] == key) {
+                *f_low = dtmf_low_freqs[i];
+                *f_high = dtmf_high_freqs[j];
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------
+ * 滑动 DFT
+ * ------------------------------------------------------------------------- */
+
+/**
+ * 按定义重新计算窗口的累加器和能量，消除逐样本累加的舍入误差
+ * 窗口的位置 j 存放的样本下标与 j 模 N 同余，旋转因子下标为 k*j mod N
+ */
+static void sdft_reanchor(dtmf_sdft* sdft) {
+    int N = sdft->N;
+    for (int b = 0; b < sdft->nbins; b++) {
+        int k = sdft->bin[b];
+        double re = 0, im = 0;
+        if (k >= 0) {
+            int phase = 0;
+            for (int j = 0; j < N; j++) {
+                re += sdft->window[j] * sdft->tw_real[phase];
+                im += sdft->window[j] * sdft->tw_imag[phase];
+                phase += k;
+                if (phase >= N) phase -= N;
+            }
+        }
+        sdft->y_real[b] = re;
+        sdft->y_imag[b] = im;
+    }
+    double energy = 0;
+    for (int j = 0; j < N; j++) {
+        energy += sdft->window[j] * sdft->window[j];
+    }
+    sdft->energy = energy;
+}
+
+int dtmf_sdft_init(dtmf_sdft* sdft, int N, const int* bins, int nbins) {
+    if (!sdft || N < 2 || nbins < 1 || nbins > DTMF_MAX_BINS) return -1;
+    memset(sdft, 0, sizeof(*sdft));
+    sdft->N = N;
+    sdft->nbins = nbins;
+    for (int b = 0; b < nbins; b++) {
+        if (bins[b] > N / 2) {
+            return -1;
+        }
+        sdft->bin[b] = bins[b];
+    }
+
+    sdft->window = (double*)calloc(N, sizeof(double));
+    sdft->tw_real = (double*)malloc(N * sizeof(double));
+    sdft->tw_imag = (double*)malloc(N * sizeof(double));
+    if (!sdft->window || !sdft->tw_real || !sdft->tw_imag) {
+        dtmf_sdft_free(sdft);
+        return -1;
+    }
+    for (int j = 0; j < N; j++) {
+        sdft->tw_real[j] = cos(2.0 * M_PI * j / N);
+        sdft->tw_imag[j] = -sin(2.0 * M_PI * j / N);
+    }
+    return 0;
+}
+
+void dtmf_sdft_free(dtmf_sdft* sdft) {
+    if (sdft) {
+        free(sdft->window);
+        free(sdft->tw_real);
+        free(sdft->tw_imag);
+        sdft->window = sdft->tw_real = sdft->tw_imag = NULL;
+    }
+}
+
+void dtmf_sdft_push(dtmf_sdft* sdft, double x) {
+    int N = sdft->N;
+    const double* tw_real = sdft->tw_real;
+    const double* tw_imag = sdft->tw_imag;
+    double old = sdft->window[sdft->pos];
+    double d = x - old;
+    sdft->window[sdft->pos] = x;
+    sdft->energy += x * x - old * old;
+
+    for (int b = 0; b < sdft->nbins; b++) {
+        int k = sdft->bin[b];
+        if (k < 0) continue;
+        int phase = sdft->phase[b];
+        sdft->y_real[b] += d * tw_real[phase];
+        sdft->y_imag[b] += d * tw_imag[phase];
+        phase += k;
+        sdft->phase[b] = phase >= N ? phase - N : phase;
+    }
+
+    sdft->count++;
+    if (++sdft->pos == N) {
+        // 窗口滑过一整圈: 位置和所有旋转因子下标回到 0，每 DTMF_SDFT_REANCHOR 圈重新求和一次
+        sdft->pos = 0;
+        if (++sdft->laps == DTMF_SDFT_REANCHOR) {
+            sdft->laps = 0;
+            sdft_reanchor(sdft);
+        }
+    }
+}
+
+void dtmf_sdft_magnitude(const dtmf_sdft* sdft, double* magnitude) {
+    for (int b = 0; b < sdft->nbins; b++) {
+        magnitude[b] = sdft->bin[b] >= 0 ?
+            sqrt(sdft->y_real[b] * sdft->y_real[b] + sdft->y_imag[b] * sdft->y_imag[b]) : 0.0;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * 流式解码
+ * ------------------------------------------------------------------------- */
+
+int dtmf_stream_init(dtmf_stream* stream, double fs) {
+    if (!stream || !(fs > 0)) return -1;
+    memset(stream, 0, sizeof(*stream));
+
+    int N = (int)(fs * DTMF_STREAM_FRAME_MS / 1000.0 + 0.5);
+    if (dtmf_bank_init(&stream->bank, N, fs, 0) != 0 ||
+        dtmf_sdft_init(&stream->sdft, N, stream->bank.bin, DTMF_TONES) != 0) {
+        return -1;
+    }
+    stream->hop = DTMF_STREAM_HOP;
+    stream->countdown = 1;
+
+    stream->min_level = DTMF_STREAM_MIN_LEVEL;
+    stream->max_twist = DTMF_STREAM_MAX_TWIST;
+    stream->tone_ratio = DTMF_STREAM_TONE_RATIO;
+
+    // 时刻取窗口中心，连续 n 次判决跨越 (n-1)*hop 个样本
+    int min_on = (int)(fs * DTMF_STREAM_MIN_ON_MS / 1000.0 + 0.5);
+    int min_off = (int)(fs * DTMF_STREAM_MIN_OFF_MS / 1000.0 + 0.5);
+    stream->min_on_count = 1 + (min_on + stream->hop - 1) / stream->hop;
+    stream->min_off_count = 1 + (min_off + stream->hop - 1) / stream->hop;
+    return 0;
+}
+
+void dtmf_stream_free(dtmf_stream* stream) {
+    if (stream) {
+        dtmf_sdft_free(&stream->sdft);
+    }
+}
+
+/**
+ * 对当前窗口判决: 在 dtmf_decide 的基础上检查电平、扭曲和能量比例
+ * @return 按键字符，没有有效的 DTMF 信号时返回 0
+ */
+static char stream_window_key(const dtmf_stream* stream) {
+    int N = stream->bank.N;
+    double magnitude[DTMF_TONES];
+    int low, high;
+
+    const dtmf_sdft* sdft = &stream->sdft;
+
+    // 正弦幅度 A 在对应频点的 DFT 幅度约为 A*N/2
+    double level = stream->min_level * N / 2;
+
+    // 逐样本判决时大多数窗口没有按键音: 先用功率做必要条件检查，不开方
+    // (两组中各有一个功率超过电平阈值，且七个频点的总功率满足能量比例)
+    double low_max = 0, high_max = 0, total = 0;
+    for (int b = 0; b < DTMF_TONES; b++) {
+        double power = sdft->y_real[b] * sdft->y_real[b] + sdft->y_imag[b] * sdft->y_imag[b];
+        total += power;
+        if (b < DTMF_LOW_TONES) {
+            if (power > low_max) low_max = power;
+        } else if (power > high_max) {
+            high_max = power;
+        }
+    }
+    if (low_max <= level * level || high_max <= level * level ||
+        2.0 * total / N < stream->tone_ratio * sdft->energy) {
+        return 0;
+    }
+
+    dtmf_sdft_magnitude(sdft, magnitude);
+    if (dtmf_decide(magnitude, level, &low, &high) == '?') {
+        return 0;
+    }
+    double m_low = magnitude[low], m_high = magnitude[DTMF_LOW_TONES + high];
+    if (m_low > stream->max_twist * m_high || m_high > stream->max_twist * m_low) {
+        return 0;
+    }
+
+    // 幅度为 A 的正弦在窗口中的能量为 A²N/2 = 2|X|²/N
+    double tone_energy = 2.0 * (m_low * m_low + m_high * m_high) / N;
+    if (tone_energy < stream->tone_ratio * sdft->energy) {
+        return 0;
+    }
+    return dtmf_key_table[low][high];
+}
+
+/**
+ * 添加一个事件 (超出容量时丢弃)
+ */
+static void stream_emit(const dtmf_stream* stream, dtmf_event* events, int max_events, int* count,
+                        char key, int released, long long start, long long end) {
+    if (*count < max_events) {
+        events[*count].key = key;
+        events[*count].released = released;
+        events[*count].time = start / stream->bank.fs;
+        events[*count].duration = released ? (end - start) / stream->bank.fs : 0.0;
+    }
+    (*count)++;
+}
+
+/**
+ * 按判决推进按下/松开状态机
+ * @param center 当前窗口中心 (样本)
+ */
+static void stream_update(dtmf_stream* stream, char key, long long center,
+                          dtmf_event* events, int max_events, int* count) {
+    if (key == stream->candidate) {
+        stream->run++;
+    } else {
+        stream->candidate = key;
+        stream->run = 1;
+        stream->run_start = center;
+    }
+
+    if (stream->active) {
+        if (key == stream->active) {
+            stream->off_run = 0;
+            stream->active_end = center;
+            return;
+        }
+        if (++stream->off_run < stream->min_off_count) {
+            return;
+        }
+        stream_emit(stream, events, max_events, count, stream->active, 1,
+                    stream->active_start, stream->active_end);
+        stream->active = 0;
+    }
+
+    // 松开后的第一次判决也可以确认新的按键 (两个按键之间已有 min_off 的间隔)
+    if (stream->candidate && stream->run >= stream->min_on_count) {
+        stream->active = stream->candidate;
+        stream->active_start = stream->run_start;
+        stream->active_end = center;
+        stream->off_run = 0;
+        stream_emit(stream, events, max_events, count, stream->active, 0, stream->active_start, 0);
+    }
+}
+
+int dtmf_stream_feed(dtmf_stream* stream, const int16_t* pcm, int count, dtmf_event* events, int max_events) {
+    int N = stream->bank.N;
+    int nevents = 0;
+
+    for (int i = 0; i < count; i++) {
+        dtmf_sdft_push(&stream->sdft, pcm[i] * (1.0 / 32768.0));
+        stream->consumed++;
+
+        // 窗口填满之后每 hop 个样本判决一次
+        if (stream->consumed < N || --stream->countdown > 0) {
+            continue;
+        }
+        stream->countdown = stream->hop;
+        char key = stream_window_key(stream);
+        stream_update(stream, key, stream->consumed - N / 2 - 1, events, max_events, &nevents);
+    }
+    return nevents < max_events ? nevents : max_events;
+}
+
+int dtmf_stream_flush(dtmf_stream* stream, dtmf_event* events, int max_events) {
+    int nevents = 0;
+    if (stream->active) {
+        stream_emit(stream, events, max_events, &nevents, stream->active, 1,
+                    stream->active_start, stream->active_end);
+        stream->active = 0;
+    }
+    stream->candidate = 0;
+    stream->run = 0;
+    return nevents < max_events ? nevents : max_events;
+}
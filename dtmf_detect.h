@@ -0,0 +1,222 @@
+/**
+ * @file dtmf_detect.h
+ * @brief DTMF 按键检测: 只计算七个音调频点的 Goertzel 滤波器组
+ *
+ * 判决只用到 697/770/852/941 Hz 和 1209/1336/1477 Hz 七个频点的幅度，
+ * 不需要对整帧做 FFT 再计算全部频点的幅度和相位。Goertzel 算法对每个频点做二阶递推
+ *   s[n] = x[n] + c * s[n-1] - s[n-2],  c = 2cos(2πk/N)
+ * N 个样本后 |X[k]|² = s1² + s2² - c * s1 * s2，每个频点每个样本一次乘法、两次加减，
+ * 系数在初始化时计算，循环中没有三角函数，整帧的代价为 O(7N)。
+ * 频点取与 N 点 DFT 相同的整数下标，幅度与 FFT 的结果一致 (只差舍入)，判决规则与 detect_dtmf 相同。
+ *
+ * 可选的二次谐波频点用于抑制语音误触发 (talk-off): 纯 DTMF 音几乎没有二次谐波，
+ * 语音和音乐的谐波较强，检出音调的二次谐波幅度超过基波的 DTMF_HARMONIC_RATIO 倍时拒绝。
+ */
+
+#ifndef DTMF_DETECT_H
+#define DTMF_DETECT_H
+
+#include <stdint.h>
+
+#define DTMF_LOW_TONES  4
+#define DTMF_HIGH_TONES 3
+#define DTMF_TONES      7       // 低频组 4 个 + 高频组 3 个
+#define DTMF_MAX_BINS   14      // 七个基波频点 + 七个二次谐波频点
+
+#define DTMF_THRESHOLD      5.0     // 幅度阈值 (未归一化的 DFT 幅度，与 detect_dtmf 相同)
+#define DTMF_HARMONIC_RATIO 0.1     // 二次谐波与基波的幅度比上限 (-20 dB)
+
+/** DTMF 标准频率和按键表 (低频组选行，高频组选列) */
+extern const double dtmf_low_freqs[DTMF_LOW_TONES];
+extern const double dtmf_high_freqs[DTMF_HIGH_TONES];
+extern const char dtmf_key_table[DTMF_LOW_TONES][DTMF_HIGH_TONES];
+
+/**
+ * Goertzel 滤波器组: 帧长 N、采样率 fs 下各频点的下标和递推系数
+ * 第 0..3 个频点为低频组，4..6 为高频组，启用谐波时 7..13 依次为它们的二次谐波
+ */
+typedef struct {
+    int N;                          // 帧长 (样本数)
+    double fs;                      // 采样率
+    int nbins;                      // 频点数: 7，或启用谐波时 14
+    int bin[DTMF_MAX_BINS];         // DFT 下标 k，-1 表示超出 N/2 (幅度按 0 处理)
+    double coeff[DTMF_MAX_BINS];    // 2cos(2πk/N)
+    double threshold;               // 幅度阈值
+    double harmonic_ratio;          // 二次谐波幅度比上限 (nbins 为 14 时使用)
+} dtmf_bank;
+
+/**
+ * 初始化滤波器组
+ * @param N 帧长
+ * @param fs 采样率
+ * @param harmonics 1 表示同时计算二次谐波频点 (抑制语音误触发)
+ * @return 0表示成功，-1表示参数无效
+ */
+int dtmf_bank_init(dtmf_bank* bank, int N, double fs, int harmonics);
+
+/**
+ * 对一帧 (bank->N 个样本) 计算各频点的 DFT 幅度 |X[k]|
+ * @param magnitude 输出，bank->nbins 个值
+ */
+void dtmf_goertzel(const dtmf_bank* bank, const double* x, double* magnitude);
+
+/**
+ * 由七个音调的幅度判决按键: 两组中各取超过阈值且最大的一个 (幅度相同时取频率较低的)
+ * @param magnitude 低频组 4 个 + 高频组 3 个幅度
+ * @param low 输出低频组的序号 (可以为 NULL)，-1 表示没有超过阈值的音调
+ * @param high 输出高频组的序号 (可以为 NULL)
+ * @return 按键字符，两组中有一组没有音调时返回 '?'
+ */
+char dtmf_decide(const double* magnitude, double threshold, int* low, int* high);
+
+/**
+ * 检测一帧中的按键 (Goertzel + 判决，启用谐波时再做二次谐波检查)
+ * @return 按键字符，无法识别时返回 '?'
+ */
+char dtmf_bank_detect(const dtmf_bank* bank, const double* x);
+
+/**
+ * 按键对应的两个频率
+ * @return 1表示成功，0表示无效按键
+ */
+int dtmf_key_frequencies(char key, double* f_low, double* f_high);
+
+/* ---------------------------------------------------------------------------
+ * 滑动 DFT: 每读入一个样本，更新最近 N 个样本的若干个 DFT 频点
+ *
+ * 采用调制滑动 DFT (mSDFT): 窗口内第 m 个样本对频点 k 的贡献为 x[m] W^{-km}，
+ * 新样本进入、最老的样本离开时两者的旋转因子相同 (相差 N 的整数倍)，
+ *   y_k += (x[n] - x[n-N]) * W^{-kn mod N}
+ * 旋转因子查表得到，累加器不做递推乘法，不会像经典 SDFT 那样因 |W| 的舍入误差而发散。
+ * |y_k| 即最近 N 个样本的 |X[k]|，每个样本的代价为 O(频点数)。
+ * 逐样本累加的舍入误差随样本数缓慢增长，为使连续运行数小时后误差仍然有界，
+ * 窗口每滑过 DTMF_SDFT_REANCHOR 圈按定义重新求和一次 (O(N × 频点数)，均摊到每个样本不到一次乘加)。
+ * ------------------------------------------------------------------------- */
+
+#define DTMF_SDFT_REANCHOR 64   // 每滑过这么多个窗口重新求和一次
+
+/** 滑动 DFT 状态 */
+typedef struct {
+    int N;                          // 窗口长度
+    int nbins;                      // 频点数 (不超过 DTMF_MAX_BINS)
+    int bin[DTMF_MAX_BINS];         // 频点下标，-1 表示不计算 (幅度为 0)
+    double* window;                 // 最近 N 个样本，第 n 个样本存放在 n mod N
+    double* tw_real;                // 旋转因子表 W^{-j} = e^{-2πij/N}，j = 0..N-1
+    double* tw_imag;
+    double y_real[DTMF_MAX_BINS];   // 各频点的累加器
+    double y_imag[DTMF_MAX_BINS];
+    int phase[DTMF_MAX_BINS];       // 当前样本的旋转因子下标 k*n mod N
+    int pos;                        // 当前样本在窗口中的位置 n mod N
+    int laps;                       // 上次重新求和之后窗口滑过的圈数
+    double energy;                  // 窗口内样本的平方和
+    long long count;                // 已读入的样本数
+} dtmf_sdft;
+
+/**
+ * 初始化滑动 DFT，窗口初始为全零
+ * @param N 窗口长度
+ * @param bins 频点下标 (0..N/2，-1 表示跳过)
+ * @param nbins 频点数
+ * @return 0表示成功，-1表示参数无效或内存分配失败
+ */
+int dtmf_sdft_init(dtmf_sdft* sdft, int N, const int* bins, int nbins);
+
+/**
+ * 释放滑动 DFT 的缓冲区
+ */
+void dtmf_sdft_free(dtmf_sdft* sdft);
+
+/**
+ * 读入一个样本
+ */
+void dtmf_sdft_push(dtmf_sdft* sdft, double x);
+
+/**
+ * 最近 N 个样本的 DFT 幅度 |X[k]| (与对这 N 个样本做 Goertzel 或 FFT 的结果相同，只差舍入)
+ * @param magnitude 输出，nbins 个值
+ */
+void dtmf_sdft_magnitude(const dtmf_sdft* sdft, double* magnitude);
+
+/* ---------------------------------------------------------------------------
+ * 流式解码: 连续的 S16_LE PCM 逐样本检测，按键的开始和结束精确到样本
+ *
+ * 窗口长 25.6 ms (8 kHz 下 205 点，七个频点都离 DFT 频点较近)，用滑动 DFT 跟踪七个频点，
+ * 每 hop 个样本 (默认每个样本) 对最近一个窗口判决一次，判决延迟不超过窗口长度。
+ * 判决在 dtmf_decide 的基础上还要求:
+ *   两个音调的幅度都不低于 min_level (满量程为 1)，
+ *   两音调的幅度比不超过 max_twist，
+ *   两音调的能量占窗口能量的比例不低于 tone_ratio (抑制语音和宽带噪声)。
+ * 按键音占窗口的比例达到 tone_ratio (默认一半) 时开始检出，因此以窗口中心作为时刻:
+ * 第一次检出的窗口中心为按键开始，最后一次检出的窗口中心为按键结束。
+ * 判决再经过状态机: 同一按键持续不少于 min_on 才确认按下，
+ * 之后持续 min_off 没有该按键才确认松开，短暂的误检和信号中的短暂跌落都会被滤除。
+ * ------------------------------------------------------------------------- */
+
+#define DTMF_STREAM_FRAME_MS    25.6    // 窗口长度 (毫秒)
+#define DTMF_STREAM_HOP         1       // 判决间隔 (样本数)
+#define DTMF_STREAM_MIN_ON_MS   40.0    // 最短按键时长 (毫秒)
+#define DTMF_STREAM_MIN_OFF_MS  40.0    // 最短按键间隔 (毫秒)
+#define DTMF_STREAM_MIN_LEVEL   0.01    // 单个音调的最低幅度 (-40 dBFS)
+#define DTMF_STREAM_MAX_TWIST   2.5     // 两音调的幅度比上限 (8 dB)
+#define DTMF_STREAM_TONE_RATIO  0.5     // 两音调能量占窗口能量的最低比例
+
+/** 流式解码事件: 按键确认按下时报告一次，松开时再报告一次并给出时长 */
+typedef struct {
+    char key;           // 按键字符
+    int released;       // 0 表示按下，1 表示松开
+    double time;        // 按键开始的时刻 (秒，从流的第一个样本算起)
+    double duration;    // 按键时长 (秒)，按下事件为 0
+} dtmf_event;
+
+/** 流式解码器状态 */
+typedef struct {
+    dtmf_bank bank;         // 窗口长度 bank.N 下的七个频点
+    dtmf_sdft sdft;         // 跟踪七个频点的滑动 DFT
+    int hop;                // 判决间隔 (样本数)
+    int countdown;          // 距下一次判决的样本数
+    long long consumed;     // 已读入的样本总数
+
+    double min_level;       // 参见 DTMF_STREAM_MIN_LEVEL 等
+    double max_twist;
+    double tone_ratio;
+    int min_on_count;       // 确认按下所需的连续判决次数
+    int min_off_count;      // 确认松开所需的连续判决次数
+
+    char candidate;         // 最近连续出现的判决 (0 表示无按键)
+    int run;                // candidate 连续出现的次数
+    long long run_start;    // candidate 第一次出现时的窗口中心 (样本)
+    char active;            // 已确认按下的按键 (0 表示无)
+    long long active_start; // 按下的时刻 (样本)
+    long long active_end;   // 最后一次检出该按键时的窗口中心 (样本)
+    int off_run;            // 按下后连续未检出的次数
+} dtmf_stream;
+
+/**
+ * 初始化流式解码器
+ * @param fs 采样率
+ * @return 0表示成功，-1表示参数无效或内存分配失败
+ */
+int dtmf_stream_init(dtmf_stream* stream, double fs);
+
+/**
+ * 释放流式解码器的缓冲区
+ */
+void dtmf_stream_free(dtmf_stream* stream);
+
+/**
+ * 读入一段 S16_LE 单声道样本，逐样本更新并判决
+ * @param pcm 样本
+ * @param count 样本数
+ * @param events 输出事件
+ * @param max_events events 的容量，超出的事件被丢弃
+ * @return 产生的事件数
+ */
+int dtmf_stream_feed(dtmf_stream* stream, const int16_t* pcm, int count, dtmf_event* events, int max_events);
+
+/**
+ * 流结束: 仍处于按下状态的按键报告松开
+ * @return 产生的事件数 (0 或 1)
+ */
+int dtmf_stream_flush(dtmf_stream* stream, dtmf_event* events, int max_events);
+
+#endif /* DTMF_DETECT_H */
@@ -0,0 +1,258 @@
+/**
+ * @file dtmf_multi.c
+ * @brief 多通道 DTMF 检测 (见 dtmf_multi.h)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "dtmf_multi.h"
+#include "fft.h"
+#include "fft_thread.h"
+
+#define DTMF_MULTI_BLOCK 64             // 线程每次领取的通道数
+#define DTMF_MULTI_PARALLEL_MIN (1 << 16)   // 一次读入少于这么多 (通道 × 样本) 时只用调用线程
+
+/*
+ * 递推内核: 通道 [c0, c1) 读入 count 个样本
+ * 每个向量的七个频点状态在整段样本中都留在寄存器里，只在开始和结束时读写状态数组。
+ * 样本按原始整数值递推，帧结束时幅度再除以 32768: 缩放 2 的幂次不改变舍入，
+ * 结果与先把样本换算为 [-1, 1) 再递推逐位相同。
+ */
+static void dtmf_multi_scalar(const double* coeff, double* s1, double* s2, int stride,
+                              const int16_t* pcm, int channels, int c0, int c1, int count) {
+    for (int c = c0; c < c1; c++) {
+        double a[DTMF_TONES], b[DTMF_TONES];
+        for (int k = 0; k < DTMF_TONES; k++) {
+            a[k] = s1[k * stride + c];
+            b[k] = s2[k * stride + c];
+        }
+        for (int t = 0; t < count; t++) {
+            double x = pcm[(size_t)t * channels + c];
+            for (int k = 0; k < DTMF_TONES; k++) {
+                double s0 = (x - b[k]) + coeff[k] * a[k];
+                b[k] = a[k];
+                a[k] = s0;
+            }
+        }
+        for (int k = 0; k < DTMF_TONES; k++) {
+            s1[k * stride + c] = a[k];
+            s2[k * stride + c] = b[k];
+        }
+    }
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define DTMF_MULTI_SIMD_X86 1
+#include <immintrin.h>
+
+/*
+ * 向量内核: 每次处理 VW 个相邻通道，运算顺序与标量内核相同 (先减后乘加，不使用 FMA)
+ * LOAD16 读入 VW 个 int16 样本并转换为 double。不足一个向量的通道在同一个函数内按标量处理，
+ * 理由与 image_io.c 的 min/max 内核相同 (避免尾调用前缺少 vzeroupper)
+ */
+#define DTMF_MULTI_FN(NAME, VT, VW, LOADD, STORED, SET1, ADD, SUB, MUL, LOAD16)                  \
+    static void NAME(const double* coeff, double* s1, double* s2, int stride,                   \
+                     const int16_t* pcm, int channels, int c0, int c1, int count) {              \
+        VT cv[DTMF_TONES];                                                                      \
+        for (int k = 0; k < DTMF_TONES; k++) cv[k] = SET1(coeff[k]);                            \
+        int c = c0;                                                                             \
+        for (; c + VW <= c1; c += VW) {                                                         \
+            VT a[DTMF_TONES], b[DTMF_TONES];                                                    \
+            for (int k = 0; k < DTMF_TONES; k++) {                                              \
+                a[k] = LOADD(s1 + k * stride + c);                                              \
+                b[k] = LOADD(s2 + k * stride + c);                                              \
+            }                                                                                   \
+            const int16_t* p = pcm + c;                                                         \
+            for (int t = 0; t < count; t++, p += channels) {                                    \
+                VT x = LOAD16(p);                                                               \
+                _Pragma("GCC unroll 7")                                                         \
+                for (int k = 0; k < DTMF_TONES; k++) {                                          \
+                    VT s0 = ADD(SUB(x, b[k]), MUL(cv[k], a[k]));                                \
+                    b[k] = a[k];                                                                \
+                    a[k] = s0;                                                                  \
+                }                                                                               \
+            }                                                                                   \
+            for (int k = 0; k < DTMF_TONES; k++) {                                              \
+                STORED(s1 + k * stride + c, a[k]);                                              \
+                STORED(s2 + k * stride + c, b[k]);                                              \
+            }                                                                                   \
+        }                                                                                       \
+        for (; c < c1; c++) {                                                                   \
+            double a[DTMF_TONES], b[DTMF_TONES];                                                \
+            for (int k = 0; k < DTMF_TONES; k++) {                                              \
+                a[k] = s1[k * stride + c];                                                      \
+                b[k] = s2[k * stride + c];                                                      \
+            }                                                                                   \
+            for (int t = 0; t < count; t++) {                                                   \
+                double x = pcm[(size_t)t * channels + c];                                       \
+                for (int k = 0; k < DTMF_TONES; k++) {                                          \
+                    double s0 = (x - b[k]) + coeff[k] * a[k];                                   \
+                    b[k] = a[k];                                                                \
+                    a[k] = s0;                                                                  \
+                }                                                                               \
+            }                                                                                   \
+            for (int k = 0; k < DTMF_TONES; k++) {                                              \
+                s1[k * stride + c] = a[k];                                                      \
+                s2[k * stride + c] = b[k];                                                      \
+            }                                                                                   \
+        }                                                                                       \
+    }
+
+#pragma GCC push_options
+#pragma GCC target("sse2")
+static inline __m128d dtmf_load16_sse2(const int16_t* p) {
+    return _mm_cvtepi32_pd(_mm_set_epi32(0, 0, p[1], p[0]));
+}
+DTMF_MULTI_FN(dtmf_multi_sse2, __m128d, 2, _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd,
+              _mm_add_pd, _mm_sub_pd, _mm_mul_pd, dtmf_load16_sse2)
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+static inline __m256d dtmf_load16_avx2(const int16_t* p) {
+    return _mm256_cvtepi32_pd(_mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*)p)));
+}
+DTMF_MULTI_FN(dtmf_multi_avx2, __m256d, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd,
+              _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd, dtmf_load16_avx2)
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+static inline __m512d dtmf_load16_avx512(const int16_t* p) {
+    return _mm512_cvtepi32_pd(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)p)));
+}
+DTMF_MULTI_FN(dtmf_multi_avx512, __m512d, 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd,
+              _mm512_add_pd, _mm512_sub_pd, _mm512_mul_pd, dtmf_load16_avx512)
+#pragma GCC pop_options
+#endif
+
+typedef void (*dtmf_multi_kernel)(const double* coeff, double* s1, double* s2, int stride,
+                                  const int16_t* pcm, int channels, int c0, int c1, int count);
+
+/**
+ * 按 fft_simd_get_level 选择向量宽度
+ */
+static dtmf_multi_kernel dtmf_multi_select(void) {
+#ifdef DTMF_MULTI_SIMD_X86
+    switch (fft_simd_get_level()) {
+        case FFT_SIMD_AVX512: return dtmf_multi_avx512;
+        case FFT_SIMD_AVX2:   return dtmf_multi_avx2;
+        case FFT_SIMD_SSE2:   return dtmf_multi_sse2;
+        default: break;
+    }
+#endif
+    return dtmf_multi_scalar;
+}
+
+int dtmf_multi_init(dtmf_multi* detector, int channels, int N, double fs) {
+    if (!detector || channels < 1) return -1;
+    memset(detector, 0, sizeof(*detector));
+    if (dtmf_bank_init(&detector->bank, N, fs, 0) != 0) return -1;
+
+    detector->channels = channels;
+    detector->stride = (channels + DTMF_MULTI_ALIGN - 1) / DTMF_MULTI_ALIGN * DTMF_MULTI_ALIGN;
+    size_t size = (size_t)DTMF_TONES * detector->stride;
+    detector->s1 = (double*)calloc(size, sizeof(double));
+    detector->s2 = (double*)calloc(size, sizeof(double));
+    if (!detector->s1 || !detector->s2) {
+        dtmf_multi_free(detector);
+        return -1;
+    }
+    return 0;
+}
+
+void dtmf_multi_free(dtmf_multi* detector) {
+    if (detector) {
+        free(detector->s1);
+        free(detector->s2);
+        detector->s1 = detector->s2 = NULL;
+    }
+}
+
+/**
+ * 通道 [c0, c1) 的一帧结束: 计算幅度、判决并清零状态
+ * 与 dtmf_goertzel + dtmf_decide 的计算相同
+ */
+static void dtmf_multi_finish(dtmf_multi* detector, int c0, int c1, char* keys) {
+    const dtmf_bank* bank = &detector->bank;
+    int stride = detector->stride;
+    for (int c = c0; c < c1; c++) {
+        double magnitude[DTMF_TONES];
+        for (int k = 0; k < DTMF_TONES; k++) {
+            double a = detector->s1[k * stride + c], b = detector->s2[k * stride + c];
+            double power = a * a + b * b - bank->coeff[k] * a * b;
+            magnitude[k] = (bank->bin[k] >= 0 && power > 0) ? sqrt(power) / 32768.0 : 0.0;
+            detector->s1[k * stride + c] = 0.0;
+            detector->s2[k * stride + c] = 0.0;
+        }
+        keys[c] = dtmf_decide(magnitude, bank->threshold, NULL, NULL);
+    }
+}
+
+typedef struct {
+    dtmf_multi* detector;
+    dtmf_multi_kernel kernel;
+    const int16_t* pcm;     // 本段的第一个样本
+    int count;              // 本段每个通道的样本数
+    char* keys;             // 本段结束时恰好完成一帧则不为 NULL
+    int blocks;
+    int next;
+} dtmf_multi_task;
+
+static void dtmf_multi_worker(fft_team* team, void* arg, int member) {
+    dtmf_multi_task* task = (dtmf_multi_task*)arg;
+    dtmf_multi* detector = task->detector;
+    int begin, n;
+    (void)member;
+    while ((n = fft_team_claim(team, &task->next, task->blocks, 1, &begin)) > 0) {
+        int c0 = begin * DTMF_MULTI_BLOCK;
+        int c1 = c0 + DTMF_MULTI_BLOCK < detector->channels ? c0 + DTMF_MULTI_BLOCK : detector->channels;
+        task->kernel(detector->bank.coeff, detector->s1, detector->s2, detector->stride,
+                     task->pcm, detector->channels, c0, c1, task->count);
+        if (task->keys) {
+            dtmf_multi_finish(detector, c0, c1, task->keys);
+        }
+    }
+}
+
+int dtmf_multi_feed(dtmf_multi* detector, const int16_t* pcm, int count, char* keys, int max_frames) {
+    int N = detector->bank.N;
+    if (count < 0 || (detector->position + (long long)count) / N > max_frames) {
+        return -1;
+    }
+
+    dtmf_multi_task task;
+    task.detector = detector;
+    task.kernel = dtmf_multi_select();
+    task.blocks = (detector->channels + DTMF_MULTI_BLOCK - 1) / DTMF_MULTI_BLOCK;
+
+    int frames = 0;
+    detector->threads = 1;
+    while (count > 0) {
+        // 每段不跨越帧边界，段末恰好结束一帧时顺便完成判决
+        int take = N - detector->position;
+        if (take > count) take = count;
+        task.pcm = pcm;
+        task.count = take;
+        task.keys = (detector->position + take == N) ? keys + (size_t)frames * detector->channels : NULL;
+        task.next = 0;
+
+        int nthreads = fft_get_threads();
+        if ((long long)take * detector->channels < DTMF_MULTI_PARALLEL_MIN) nthreads = 1;
+        if (nthreads > task.blocks) nthreads = task.blocks;
+        if (nthreads > detector->threads) detector->threads = nthreads;
+        fft_team_run(dtmf_multi_worker, &task, nthreads);
+
+        pcm += (size_t)take * detector->channels;
+        count -= take;
+        detector->position += take;
+        if (detector->position == N) {
+            detector->position = 0;
+            detector->frames++;
+            frames++;
+        }
+    }
+    return frames;
+}
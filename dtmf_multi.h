@@ -0,0 +1,63 @@
+/**
+ * @file dtmf_multi.h
+ * @brief 多通道 DTMF 检测: 成千上万路电话信道共用一组 Goertzel 递推
+ *
+ * 所有通道的帧长、采样率和七个频点都相同，只有输入样本不同，
+ * 因此把每个频点的递推状态按通道连续存放 (结构数组，SoA):
+ *   s1[bin][channel], s2[bin][channel]
+ * 同一条向量指令对相邻的 8 个通道 (AVX-512，AVX2 为 4 个) 做同一步递推，
+ * 与单通道的 dtmf_goertzel 运算顺序相同，不使用 FMA，幅度逐位相同。
+ * 通道按块分给线程组，每个线程处理自己的通道块，帧结束时直接完成这些通道的判决。
+ * 工作线程取自常驻线程池 (fft_thread.c)，在多次 dtmf_multi_feed 之间保留，每包只是唤醒它们。
+ *
+ * 输入为通道交错的 S16 样本 pcm[t * channels + c] (TDM 中继的常见格式)，
+ * 每满 N 个样本 (不重叠的帧) 对每个通道给出一次判决，规则与 detect_dtmf 相同。
+ */
+
+#ifndef DTMF_MULTI_H
+#define DTMF_MULTI_H
+
+#include <stdint.h>
+
+#include "dtmf_detect.h"
+
+#define DTMF_MULTI_ALIGN 8      // 通道数补齐到的倍数 (最宽向量的通道数)
+
+/** 多通道检测器 */
+typedef struct {
+    dtmf_bank bank;         // 帧长、采样率和七个频点 (所有通道共用)
+    int channels;           // 通道数
+    int stride;             // 每个频点的状态行长度 (通道数补齐到 DTMF_MULTI_ALIGN)
+    double* s1;             // 递推状态 s[n-1]，DTMF_TONES 行 × stride
+    double* s2;             // 递推状态 s[n-2]
+    int position;           // 当前帧已读入的样本数 (所有通道相同)
+    long long frames;       // 已完成的帧数
+    int threads;            // 最近一次 dtmf_multi_feed 请求的最多线程数 (少量数据时为 1)
+} dtmf_multi;
+
+/**
+ * 初始化多通道检测器
+ * @param channels 通道数
+ * @param N 帧长 (每个通道每次判决的样本数)
+ * @param fs 采样率
+ * @return 0表示成功，-1表示参数无效或内存分配失败
+ */
+int dtmf_multi_init(dtmf_multi* detector, int channels, int N, double fs);
+
+/**
+ * 释放检测器的状态数组
+ */
+void dtmf_multi_free(dtmf_multi* detector);
+
+/**
+ * 读入每个通道 count 个样本 (通道交错)
+ * 每完成一帧，向 keys 写入 channels 个判决 (按键字符或 '?')，第 f 帧写在 keys[f * channels]
+ * @param pcm 样本，pcm[t * channels + c]
+ * @param count 每个通道的样本数
+ * @param keys 输出判决
+ * @param max_frames keys 能容纳的帧数，count 中完成的帧数不能超过它
+ * @return 本次完成的帧数，-1 表示 keys 容量不足 (此时不读入任何样本)
+ */
+int dtmf_multi_feed(dtmf_multi* detector, const int16_t* pcm, int count, char* keys, int max_frames);
+
+#endif /* DTMF_MULTI_H */
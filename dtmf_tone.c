@@ -0,0 +1,64 @@
+/**
+ * @file dtmf_tone.c
+ * @brief 预先合成的 DTMF 按键音缓存 (见 dtmf_tone.h)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "dtmf_tone.h"
+#include "oscillator.h"
+
+int dtmf_tone_cache_init(dtmf_tone_cache* cache, int N, double fs, double amplitude) {
+    if (!cache || N < 1 || fs <= 0) return -1;
+    memset(cache, 0, sizeof(*cache));
+
+    // 七个音调先各生成一次，再两两相加
+    double* tones = (double*)malloc((size_t)DTMF_TONES * N * sizeof(double));
+    cache->samples = (double*)malloc((size_t)DTMF_KEYS * N * sizeof(double));
+    if (!tones || !cache->samples) {
+        free(tones);
+        dtmf_tone_cache_free(cache);
+        return -1;
+    }
+    for (int k = 0; k < DTMF_TONES; k++) {
+        double freq = k < DTMF_LOW_TONES ? dtmf_low_freqs[k] : dtmf_high_freqs[k - DTMF_LOW_TONES];
+        osc_rotator osc;
+        osc_rotator_init(&osc, freq, fs, 0.0);
+        osc_rotator_render(&osc, NULL, tones + (size_t)k * N, N);
+    }
+    for (int i = 0; i < DTMF_LOW_TONES; i++) {
+        const double* low = tones + (size_t)i * N;
+        for (int j = 0; j < DTMF_HIGH_TONES; j++) {
+            const double* high = tones + (size_t)(DTMF_LOW_TONES + j) * N;
+            double* x = cache->samples + (size_t)(i * DTMF_HIGH_TONES + j) * N;
+            for (int n = 0; n < N; n++) {
+                x[n] = amplitude * low[n] + amplitude * high[n];
+            }
+        }
+    }
+    free(tones);
+
+    cache->N = N;
+    cache->fs = fs;
+    cache->amplitude = amplitude;
+    return 0;
+}
+
+void dtmf_tone_cache_free(dtmf_tone_cache* cache) {
+    if (cache) {
+        free(cache->samples);
+        cache->samples = NULL;
+    }
+}
+
+const double* dtmf_tone_cache_get(const dtmf_tone_cache* cache, char key) {
+    for (int i = 0; i < DTMF_LOW_TONES; i++) {
+        for (int j = 0; j < DTMF_HIGH_TONES; j++) {
+            if (dtmf_key_table[i][j] == key) {
+                return cache->samples + (size_t)(i * DTMF_HIGH_TONES + j) * cache->N;
+            }
+        }
+    }
+    return NULL;
+}
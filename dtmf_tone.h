@@ -0,0 +1,47 @@
+/**
+ * @file dtmf_tone.h
+ * @brief 预先合成的 DTMF 按键音缓存
+ *
+ * 十二个按键只由七个音调两两相加组成。缓存初始化时用旋转振荡器 (oscillator.h)
+ * 各生成一次七个音调的 N 个样本，再相加得到十二个按键音；之后每次发送按键
+ * 只需取出 (或复制) 对应的数组，生成过程中不再调用三角函数。
+ * 各按键音都从相位 0 开始，与 x[n] = A sin(2π f_low n / fs) + A sin(2π f_high n / fs) 的差别在 1e-13 量级。
+ */
+
+#ifndef DTMF_TONE_H
+#define DTMF_TONE_H
+
+#include "dtmf_detect.h"
+
+#define DTMF_KEYS (DTMF_LOW_TONES * DTMF_HIGH_TONES)
+
+/** 按键音缓存 */
+typedef struct {
+    int N;                      // 每个按键音的样本数
+    double fs;                  // 采样率
+    double amplitude;           // 每个音调的幅度
+    double* samples;            // DTMF_KEYS 个按键音依次存放，按 dtmf_key_table 的行列顺序
+} dtmf_tone_cache;
+
+/**
+ * 合成全部按键音
+ * @param N 每个按键音的样本数
+ * @param fs 采样率
+ * @param amplitude 每个音调的幅度 (按键音的峰值约为它的两倍)
+ * @return 0表示成功，-1表示参数无效或内存分配失败
+ */
+int dtmf_tone_cache_init(dtmf_tone_cache* cache, int N, double fs, double amplitude);
+
+/**
+ * 释放缓存
+ */
+void dtmf_tone_cache_free(dtmf_tone_cache* cache);
+
+/**
+ * 取出按键音
+ * @param key 按键字符 (0-9, *, #)
+ * @return N 个样本，无效按键返回 NULL
+ */
+const double* dtmf_tone_cache_get(const dtmf_tone_cache* cache, char key);
+
+#endif /* DTMF_TONE_H */
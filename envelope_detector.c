@@ -21,6 +21,9 @@
 #include <math.h>
 #include <string.h>
 
+#include "text_io.h"
+#include "oscillator.h"
+
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
@@ -112,38 +115,6 @@ void rc_lowpass_filter(double *v_in, double *v_out, int n,
     printf("  滤波系数 α = %.6f\n", alpha);
 }
 
-/**
- * @brief 改进的 RC 滤波器（使用梯形积分法，更精确）
- * 
- * 使用梯形法离散化：
- * V_out[n] - V_out[n-1] = (dt/(2RC)) * (V_in[n] + V_in[n-1] - V_out[n] - V_out[n-1])
- * 
- * 整理得：
- * V_out[n] = (a*V_in[n] + a*V_in[n-1] + b*V_out[n-1]) / (1 + a)
- * 其中 a = dt/(2RC), b = 1 - a
- * 
- * @param v_in 输入电压数组
- * @param v_out 输出电压数组
- * @param n 采样点数
- * @param R 电阻值 (Ω)
- * @param C 电容值 (F)
- * @param fs 采样频率 (Hz)
- */
-void rc_lowpass_filter_trapezoidal(double *v_in, double *v_out, int n, 
-                                    double R, double C, double fs) {
-    double dt = 1.0 / fs;
-    double tau = R * C;
-    double a = dt / (2.0 * tau);
-    
-    // 初始条件
-    v_out[0] = v_in[0];
-    
-    // 梯形法递推
-    for (int i = 1; i < n; i++) {
-        v_out[i] = (a * v_in[i] + a * v_in[i-1] + (1.0 - a) * v_out[i-1]) / (1.0 + a);
-    }
-}
-
 /**
  * @brief 包络检波器（二极管 + RC 滤波器）
  * 
@@ -191,39 +162,22 @@ void envelope_detector(double *am_signal, double *demod_signal, int n,
     printf("=========================\n\n");
 }
 
-/**
- * @brief 包络检波器（改进版，使用梯形法）
- */
-void envelope_detector_improved(double *am_signal, double *demod_signal, int n,
-                                double fs, double R, double C, double Vd) {
-    printf("\n=== 包络检波器电路模拟（改进版）===\n");
-    
-    // 步骤 1: 二极管整流
-    double *rectified = (double *)malloc(n * sizeof(double));
-    for (int i = 0; i < n; i++) {
-        rectified[i] = diode_rectifier(am_signal[i], Vd);
-    }
-    printf("✓ 二极管整流完成（Vd = %.2f V）\n", Vd);
-    
-    // 步骤 2: RC 低通滤波（梯形法）
-    rc_lowpass_filter_trapezoidal(rectified, demod_signal, n, R, C, fs);
-    printf("✓ RC 低通滤波完成（梯形积分法）\n");
-    
-    // 步骤 3: 去除直流分量
-    double dc_offset = 0.0;
-    for (int i = 0; i < n; i++) {
-        dc_offset += demod_signal[i];
-    }
-    dc_offset /= n;
-    
-    for (int i = 0; i < n; i++) {
-        demod_signal[i] -= dc_offset;
-    }
-    printf("✓ 直流分量去除完成（DC = %.4f V）\n", dc_offset);
-    
-    free(rectified);
-    printf("===================================\n\n");
-}
+// 改进包络检波器及其梯形法 RC 滤波器的双精度与单精度 (*_f) 版本由同一份实现生成
+#define ENV_REAL        double
+#define ENV_ID(x)       x
+#define ENV_VERBOSE     1
+#include "envelope_impl.h"
+#undef ENV_REAL
+#undef ENV_ID
+#undef ENV_VERBOSE
+
+#define ENV_REAL        float
+#define ENV_ID(x)       x##_f
+#define ENV_VERBOSE     0
+#include "envelope_impl.h"
+#undef ENV_REAL
+#undef ENV_ID
+#undef ENV_VERBOSE
 
 /**
  * @brief 自动计算最佳 RC 参数
@@ -300,11 +254,20 @@ void calculate_optimal_rc(double fc_carrier, double fm_modulating,
  */
 void generate_test_am_signal(double *t, double *am_signal, int n,
                              double fc, double fm, double fs, double mod_index) {
-    for (int i = 0; i < n; i++) {
-        t[i] = i / fs;
-        double modulating = cos(2.0 * M_PI * fm * t[i]);
-        double carrier = cos(2.0 * M_PI * fc * t[i]);
-        am_signal[i] = (1.0 + mod_index * modulating) * carrier;
+    // 调制信号和载波由旋转振荡器分段生成
+    osc_rotator mod_osc, carrier_osc;
+    double modulating[OSC_RESEED], carrier[OSC_RESEED];
+    osc_rotator_init(&mod_osc, fm, fs, 0.0);
+    osc_rotator_init(&carrier_osc, fc, fs, 0.0);
+    for (int start = 0; start < n; start += OSC_RESEED) {
+        int count = n - start < OSC_RESEED ? n - start : OSC_RESEED;
+        osc_rotator_render(&mod_osc, modulating, NULL, count);
+        osc_rotator_render(&carrier_osc, carrier, NULL, count);
+        for (int k = 0; k < count; k++) {
+            int i = start + k;
+            t[i] = i / fs;
+            am_signal[i] = (1.0 + mod_index * modulating[k]) * carrier[k];
+        }
     }
 }
 
@@ -319,10 +282,10 @@ void save_to_csv(const char *filename, double *t, double *signal1,
         return;
     }
     
+    static const text_column column = {TEXT_FIXED, 0, 8};
+    const double *columns[3] = {t, signal1, signal2};
     fprintf(fp, "time,%s,%s\n", name1, name2);
-    for (int i = 0; i < n; i++) {
-        fprintf(fp, "%.8f,%.8f,%.8f\n", t[i], signal1[i], signal2[i]);
-    }
+    text_write_columns(fp, columns, 3, &column, ',', (size_t)n);
     
     fclose(fp);
     printf("数据已保存到 %s\n", filename);
@@ -332,6 +295,13 @@ void save_to_csv(const char *filename, double *t, double *signal1,
  * @brief 主函数 - 包络检波器演示
  */
 int main(int argc, char *argv[]) {
+    int use_float = 0;  // 同时运行单精度检波器并与双精度对比
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-float") == 0) {
+            use_float = 1;
+        }
+    }
+    
     printf("========================================\n");
     printf("  包络检波电路模拟器\n");
     printf("  二极管 + RC 低通滤波器\n");
@@ -379,6 +349,30 @@ int main(int argc, char *argv[]) {
     printf("--- 方法 2: 改进包络检波器 ---\n");
     envelope_detector_improved(am_signal, demod_improved, n, fs, R_opt, C_opt, Vd);
     
+    // 单精度检波器，与双精度结果对比
+    if (use_float) {
+        float *am_f = (float *)malloc(n * sizeof(float));
+        float *demod_f = (float *)malloc(n * sizeof(float));
+        if (am_f && demod_f) {
+            for (int i = 0; i < n; i++) {
+                am_f[i] = (float)am_signal[i];
+            }
+            envelope_detector_improved_f(am_f, demod_f, n, fs, R_opt, C_opt, Vd);
+            
+            double max_diff = 0.0, max_ref = 0.0;
+            for (int i = 0; i < n; i++) {
+                double diff = fabs((double)demod_f[i] - demod_improved[i]);
+                if (diff > max_diff) max_diff = diff;
+                if (fabs(demod_improved[i]) > max_ref) max_ref = fabs(demod_improved[i]);
+            }
+            printf("--- 单精度 (float) 改进包络检波器 ---\n");
+            printf("与双精度结果的最大偏差: %.3e V (相对峰值 %.3e)\n\n",
+                   max_diff, max_ref > 0 ? max_diff / max_ref : 0.0);
+        }
+        free(am_f);
+        free(demod_f);
+    }
+    
     // 保存结果
     save_to_csv("envelope_detector_result.csv", t, am_signal, demod_basic, 
                 n, "AM_Signal", "Demodulated");
@@ -388,9 +382,9 @@ int main(int argc, char *argv[]) {
     
     // 计算原始调制信号
     double *original_mod = (double *)malloc(n * sizeof(double));
-    for (int i = 0; i < n; i++) {
-        original_mod[i] = cos(2.0 * M_PI * fm * t[i]);
-    }
+    osc_rotator mod_osc;
+    osc_rotator_init(&mod_osc, fm, fs, 0.0);
+    osc_rotator_render(&mod_osc, original_mod, NULL, n);
     
     // 归一化解调信号
     double max_demod = 0.0;
@@ -0,0 +1,92 @@
+/**
+ * @file envelope_impl.h
+ * @brief 改进包络检波器 (梯形法 RC 滤波) 的精度无关实现 (由 envelope_detector.c 分别以 double 和 float 包含)
+ *
+ * 包含前需要定义：
+ *   ENV_REAL       样本类型 (double 或 float)
+ *   ENV_ID(x)      函数名: x 或 x_f
+ *   ENV_VERBOSE    是否输出过程信息 (单精度版本用于对比，不输出)
+ *
+ * 电路参数 (R、C、fs、Vd) 和滤波系数以 double 给出后再转换，递推本身使用 ENV_REAL。
+ */
+
+/**
+ * @brief 改进的 RC 滤波器（使用梯形积分法，更精确）
+ *
+ * 使用梯形法离散化：
+ * V_out[n] - V_out[n-1] = (dt/(2RC)) * (V_in[n] + V_in[n-1] - V_out[n] - V_out[n-1])
+ *
+ * 整理得：
+ * V_out[n] = (a*V_in[n] + a*V_in[n-1] + b*V_out[n-1]) / (1 + a)
+ * 其中 a = dt/(2RC), b = 1 - a
+ *
+ * @param v_in 输入电压数组
+ * @param v_out 输出电压数组
+ * @param n 采样点数
+ * @param R 电阻值 (Ω)
+ * @param C 电容值 (F)
+ * @param fs 采样频率 (Hz)
+ */
+void ENV_ID(rc_lowpass_filter_trapezoidal)(ENV_REAL *v_in, ENV_REAL *v_out, int n,
+                                           double R, double C, double fs) {
+    double dt = 1.0 / fs;
+    double tau = R * C;
+    const ENV_REAL a = (ENV_REAL)(dt / (2.0 * tau));
+
+    // 初始条件
+    v_out[0] = v_in[0];
+
+    // 梯形法递推
+    for (int i = 1; i < n; i++) {
+        v_out[i] = (a * v_in[i] + a * v_in[i-1] + (1 - a) * v_out[i-1]) / (1 + a);
+    }
+}
+
+/**
+ * @brief 包络检波器（改进版，使用梯形法）
+ */
+void ENV_ID(envelope_detector_improved)(ENV_REAL *am_signal, ENV_REAL *demod_signal, int n,
+                                        double fs, double R, double C, double Vd) {
+    if (ENV_VERBOSE) {
+        printf("\n=== 包络检波器电路模拟（改进版）===\n");
+    }
+
+    // 步骤 1: 二极管整流 (与 diode_rectifier 相同的分段线性模型)
+    ENV_REAL *rectified = (ENV_REAL *)malloc(n * sizeof(ENV_REAL));
+    if (!rectified) {
+        printf("内存分配失败\n");
+        return;
+    }
+    const ENV_REAL vd = (ENV_REAL)Vd;
+    for (int i = 0; i < n; i++) {
+        rectified[i] = (am_signal[i] > vd) ? am_signal[i] - vd : 0;
+    }
+    if (ENV_VERBOSE) {
+        printf("✓ 二极管整流完成（Vd = %.2f V）\n", Vd);
+    }
+
+    // 步骤 2: RC 低通滤波（梯形法）
+    ENV_ID(rc_lowpass_filter_trapezoidal)(rectified, demod_signal, n, R, C, fs);
+    if (ENV_VERBOSE) {
+        printf("✓ RC 低通滤波完成（梯形积分法）\n");
+    }
+
+    // 步骤 3: 去除直流分量 (均值以 double 累加)
+    double dc_offset = 0.0;
+    for (int i = 0; i < n; i++) {
+        dc_offset += demod_signal[i];
+    }
+    dc_offset /= n;
+
+    for (int i = 0; i < n; i++) {
+        demod_signal[i] -= (ENV_REAL)dc_offset;
+    }
+    if (ENV_VERBOSE) {
+        printf("✓ 直流分量去除完成（DC = %.4f V）\n", dc_offset);
+    }
+
+    free(rectified);
+    if (ENV_VERBOSE) {
+        printf("===================================\n\n");
+    }
+}
@@ -0,0 +1,149 @@
+/**
+ * @file fft.c
+ * @brief 任意长度的 Cooley-Tukey 快速傅里叶变换
+ *
+ * 采用按时间抽取 (DIT) 的迭代混合基实现：
+ * 1. 把 N 分解为 4、2、3、5、7 以及不超过 FFT_MAX_RADIX 的小素数之积
+ * 2. 按基数逆序 (位逆序的推广) 重排输入
+ * 3. 自底向上逐级做蝶形运算，旋转因子预先计算成表，内层循环不再调用 cos/sin
+ * 4. 基-2/3/4/5 的蝶形按 CPU 支持的指令集使用 SSE2/AVX2/AVX-512 内核 (fft_simd.c)
+ * 5. 二维变换的行、列阶段分别由多个线程分担 (fft_thread.c)
+ * 6. 同长度的多个信号可以批量变换，短信号每 8 个 (float 16 个) 交错成一组跨信号向量化
+ * 7. 超出缓存的长信号 (N >= FFT_LARGE_MIN) 使用四步法：N = n1 * n2 拆成两批缓存大小的短变换，
+ *    中间乘旋转因子并分块转置，两批短变换都由多个线程分担
+ *
+ * 含有更大素因子的长度使用 Bluestein (chirp-z) 算法，把长度为 N 的 DFT
+ * 转化为长度为 2 的幂的循环卷积，因此任意 N 都是 O(N log N)，
+ * 也不需要补零 (补零会改变频率分辨率 fs/N)。
+ *
+ * 引擎本体在 fft_impl.h 中，这里分别以 double (fft_*) 和 float (fftf_*) 实例化。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "fft.h"
+#include "fft_simd.h"
+#include "fft_thread.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define FFT_MAX_FACTORS    32
+#define FFT_MAX_RADIX      13   // 超过该值的素因子改用 Bluestein 算法
+#define FFT_TRANSPOSE_TILE 32   // 转置递归到该边长后直接逐元素拷贝 (32x32 double = 8KB)
+#define FFT_ROW_CHUNK      16   // 二维变换行阶段每次领取的行数
+#define FFT_COLUMN_STRIP   16   // 二维变换列阶段每次转置、变换的列数
+#define FFT_PARALLEL_MIN   65536   // 元素数少于该值的二维/批量变换只用一个线程
+#define FFT_BATCH_LANE_BYTES 64     // 批量变换每组交错的信号占一个 AVX-512 向量 (8 个 double / 16 个 float)
+#define FFT_BATCH_LANE_MAX 128      // 不超过该长度的连续信号跨信号交错执行
+#define FFT_BATCH_STRIDED_LANE_MAX 1024 // 样本不相邻 (stride > 1) 时交错执行的最大长度
+#define FFT_LARGE_MIN      (1 << 19)    // 不小于该长度的一维复数变换使用四步法 (double 时 8MB，远超 L2)
+#define FFT_LARGE_SPLIT_MIN 64          // 四步法两个子变换长度的下限
+
+/**
+ * 计算旋转因子 exp(sign * 2πi * k / n)
+ * 先对 k 取模，避免大角度带来的精度损失
+ */
+static void fft_twiddle(long long k, long long n, int sign, double* re, double* im) {
+    double angle = 2.0 * M_PI * (double)(k % n) / (double)n;
+    *re = cos(angle);
+    *im = sign * sin(angle);
+}
+
+/**
+ * 某一级需要的旋转因子个数
+ * 奇数基的通用蝶形额外保存 p 个 W_p^j
+ */
+static int fft_stage_twiddles(int p, int m) {
+    int count = (p - 1) * m;
+    if (p != 2 && p != 3 && p != 4 && p != 5) {
+        count += p;
+    }
+    return count;
+}
+
+/**
+ * 分解变换长度，得到各级基数
+ *
+ * 基-4/2 放在最内层 (最先执行)，之后各级的 m 都是 4 的倍数，
+ * 奇数基的级也能整段使用向量内核。
+ * @return 因子个数；含有大于 FFT_MAX_RADIX 的素因子时返回 -1
+ */
+static int fft_factorize(int n, int* factors) {
+    static const int radices[] = {4, 2, 3, 5, 7};
+    int found[FFT_MAX_FACTORS];
+    int count = 0;
+
+    for (int r = 0; r < (int)(sizeof(radices) / sizeof(radices[0])); r++) {
+        while (n % radices[r] == 0) {
+            found[count++] = radices[r];
+            n /= radices[r];
+        }
+    }
+    for (int p = 11; p <= FFT_MAX_RADIX && n > 1; p += 2) {
+        while (n % p == 0) {
+            found[count++] = p;
+            n /= p;
+        }
+    }
+    if (n != 1) {
+        return -1;
+    }
+
+    // factors[0] 为最外层，因此逆序存放
+    for (int i = 0; i < count; i++) {
+        factors[i] = found[count - 1 - i];
+    }
+    return count;
+}
+
+/**
+ * 为四步法选择分解 n = n1 * n2
+ *
+ * n2 为跨度 n1 的列变换长度，取不超过 √n 且不超过 FFT_BATCH_STRIDED_LANE_MAX 的最大因子，
+ * 这样列变换能跨列交错执行；n1 为连续的行变换长度。
+ * @return n1；长度含有大素因子 (Bluestein) 或找不到合适的因子时返回 0
+ */
+static int fft_large_split(int n) {
+    int factors[FFT_MAX_FACTORS];
+    if (n < FFT_LARGE_MIN || fft_factorize(n, factors) < 0) {
+        return 0;
+    }
+    int n2 = (int)sqrt((double)n);
+    if (n2 > FFT_BATCH_STRIDED_LANE_MAX) n2 = FFT_BATCH_STRIDED_LANE_MAX;
+    while (n % n2 != 0) {
+        n2--;
+    }
+    return n2 >= FFT_LARGE_SPLIT_MIN ? n / n2 : 0;
+}
+
+/* 双精度: fft_* */
+#define FFT_REAL            double
+#define FFT_ID(x)           fft_##x
+#define IFFT_ID(x)          ifft_##x
+#define FFT_KERNELS         fft_kernels
+#define FFT_SIMD_KERNELS    fft_simd_kernels
+#include "fft_impl.h"
+#undef FFT_REAL
+#undef FFT_ID
+#undef IFFT_ID
+#undef FFT_KERNELS
+#undef FFT_SIMD_KERNELS
+
+/* 单精度: fftf_* */
+#define FFT_REAL            float
+#define FFT_ID(x)           fftf_##x
+#define IFFT_ID(x)          ifftf_##x
+#define FFT_KERNELS         fftf_kernels
+#define FFT_SIMD_KERNELS    fftf_simd_kernels
+#include "fft_impl.h"
+#undef FFT_REAL
+#undef FFT_ID
+#undef IFFT_ID
+#undef FFT_KERNELS
+#undef FFT_SIMD_KERNELS
@@ -0,0 +1,512 @@
+/**
+ * @file fft.h
+ * @brief 共享的快速傅里叶变换 (FFT) 模块
+ *
+ * 提供 O(N log N) 的一维正/逆变换，接口与原来的 calculate_1d_dft /
+ * calculate_1d_idft 保持一致：实部、虚部分别存放在两个 double 数组中。
+ * 每个 double 接口都有对应的单精度版本 (fftf_* / ifftf_*)。
+ *
+ * 约定：
+ * - 正变换: X[k] = Σ x[n] * exp(-2πi*k*n/N)
+ * - 逆变换: x[n] = (1/N) * Σ X[k] * exp(+2πi*k*n/N)
+ * - 输入与输出数组可以是同一块内存 (原地变换)
+ */
+
+#ifndef FFT_H
+#define FFT_H
+
+#define FFT_FORWARD (-1)    // 正变换 (指数符号为负)
+#define FFT_INVERSE (+1)    // 逆变换 (指数符号为正)
+
+/**
+ * 变换计划 (不透明类型)
+ *
+ * 计划保存某个 (长度, 方向) 所需的全部预计算表：基数逆序表、各级旋转因子、
+ * Bluestein 卷积核以及执行时的工作区。创建一次后可反复执行，不再有任何初始化开销。
+ * 由于工作区属于计划本身，同一个计划不能被多个线程同时执行。
+ *
+ * 长度不小于 2^19 且不含大素因子时，计划使用四步法 (N = n1 * n2，先做列变换、
+ * 乘旋转因子，再做行变换并转置写出)，每一步只接触缓存大小的数据，并由多个线程分担。
+ */
+typedef struct fft_plan fft_plan;
+
+/**
+ * 创建变换计划
+ * @param n 变换长度 (任意正整数)
+ * @param direction FFT_FORWARD 或 FFT_INVERSE
+ * @return 计划指针，失败返回 NULL；使用完毕后调用 fft_plan_destroy 释放
+ */
+fft_plan* fft_plan_create(int n, int direction);
+
+/**
+ * 释放由 fft_plan_create 创建的计划
+ */
+void fft_plan_destroy(fft_plan* plan);
+
+/**
+ * 获取计划对应的变换长度
+ */
+int fft_plan_size(const fft_plan* plan);
+
+/**
+ * 从进程级缓存中获取计划，不存在时自动创建
+ * 返回的计划归缓存所有，调用者不能释放；在 fft_plan_cache_clear 之前一直有效
+ * (线程数增加后再次获取可能得到另建的新计划，之前取得的计划仍可继续使用)
+ *
+ * 缓存的查找和插入有锁保护，可以在多个线程中调用。但同一长度、方向得到的是同一个计划，
+ * 与其他计划一样不能被多个线程同时执行；需要在多个线程中并行执行时，各线程用 fft_plan_create
+ * 创建自己的计划，或者改用 fft_1d 等简单接口
+ * @return 计划指针，失败返回 NULL
+ */
+fft_plan* fft_plan_get(int n, int direction);
+
+/**
+ * 释放缓存中的全部计划 (此前取得的计划全部失效，不能与其他线程中的 FFT 调用同时进行)
+ */
+void fft_plan_cache_clear(void);
+
+/**
+ * 执行变换计划 (逆变换不做 1/N 归一化)
+ * @param plan 变换计划
+ * @param x_real 输入实部数组
+ * @param x_imag 输入虚部数组 (NULL 表示纯实数输入)
+ * @param X_real 输出实部数组 (可以与输入相同)
+ * @param X_imag 输出虚部数组 (可以与输入相同)
+ * @return 0表示成功，-1表示失败
+ */
+int fft_execute(const fft_plan* plan, const double* x_real, const double* x_imag,
+                double* X_real, double* X_imag);
+
+/**
+ * 实数变换计划 (不透明类型)
+ *
+ * 实数输入的频谱满足共轭对称 X[N-k] = conj(X[k])，只有 N/2+1 个非冗余频点。
+ * r2c 只输出这 N/2+1 个频点，c2r 从它们还原实数序列；
+ * N 为偶数时内部只做一次长度 N/2 的复数 FFT，计算量和输出内存都约为复数变换的一半。
+ */
+typedef struct fft_rplan fft_rplan;
+
+/**
+ * 创建实数变换计划
+ * @param n 实数序列长度
+ * @param direction FFT_FORWARD (r2c) 或 FFT_INVERSE (c2r)
+ * @return 计划指针，失败返回 NULL
+ */
+fft_rplan* fft_rplan_create(int n, int direction);
+
+/**
+ * 释放由 fft_rplan_create 创建的计划
+ */
+void fft_rplan_destroy(fft_rplan* rplan);
+
+/**
+ * 从进程级缓存中获取实数变换计划 (归缓存所有，调用者不能释放，有效期同 fft_plan_get)
+ */
+fft_rplan* fft_rplan_get(int n, int direction);
+
+/**
+ * 执行 r2c 变换
+ * @param x 实数输入 (长度 n)
+ * @param X_real 输出实部 (长度 n/2+1)
+ * @param X_imag 输出虚部 (长度 n/2+1)
+ * @return 0表示成功，-1表示失败
+ */
+int fft_execute_r2c(const fft_rplan* rplan, const double* x, double* X_real, double* X_imag);
+
+/**
+ * 执行 c2r 变换 (不归一化，结果为 n 倍的原信号)
+ * @param X_real 输入实部 (长度 n/2+1)
+ * @param X_imag 输入虚部 (长度 n/2+1)
+ * @param x 实数输出 (长度 n)
+ * @return 0表示成功，-1表示失败
+ */
+int fft_execute_c2r(const fft_rplan* rplan, const double* X_real, const double* X_imag, double* x);
+
+/*
+ * 简单接口 (fft_1d、fft_r2c_1d、fft_1d_many、fft_2d、fft_3d、fft_2d_pruned 等及其逆变换)
+ * 可以在多个线程中同时调用: 每次调用从缓存借用计划，计划正被另一个线程的简单接口使用时
+ * 临时创建一个计划，用完释放 (并发调用同一尺寸时多一次计划创建的开销)。
+ * 通过 fft_*_get 取得的计划与简单接口共享: 在一个线程中执行这样的计划时，
+ * 不要在其他线程中对同一尺寸、方向调用简单接口。
+ */
+
+/**
+ * 一维快速傅里叶变换 (正变换，使用缓存的计划)
+ * @param x_real 输入信号的实部数组
+ * @param x_imag 输入信号的虚部数组 (NULL 表示纯实数输入)
+ * @param N 信号长度
+ * @param X_real 输出信号频域的实部数组
+ * @param X_imag 输出信号频域的虚部数组
+ * @return 0表示成功，-1表示失败
+ */
+int fft_1d(const double* x_real, const double* x_imag, int N, double* X_real, double* X_imag);
+
+/**
+ * 一维快速傅里叶逆变换 (含 1/N 归一化，使用缓存的计划)
+ * @param X_real 输入频域信号的实部数组
+ * @param X_imag 输入频域信号的虚部数组 (NULL 表示虚部全为0)
+ * @param N 信号长度
+ * @param x_real 输出时域信号的实部数组
+ * @param x_imag 输出时域信号的虚部数组
+ * @return 0表示成功，-1表示失败
+ */
+int ifft_1d(const double* X_real, const double* X_imag, int N, double* x_real, double* x_imag);
+
+/**
+ * 实数信号的一维 FFT，只输出 N/2+1 个非冗余频点
+ * @param x 输入实数信号 (长度 N)
+ * @param N 信号长度
+ * @param X_real 输出实部 (长度 N/2+1)
+ * @param X_imag 输出虚部 (长度 N/2+1)
+ * @return 0表示成功，-1表示失败
+ */
+int fft_r2c_1d(const double* x, int N, double* X_real, double* X_imag);
+
+/**
+ * 从 N/2+1 个频点还原实数信号 (含 1/N 归一化)
+ * @param X_real 输入实部 (长度 N/2+1)
+ * @param X_imag 输入虚部 (长度 N/2+1)
+ * @param N 信号长度
+ * @param x 输出实数信号 (长度 N)
+ * @return 0表示成功，-1表示失败
+ */
+int fft_c2r_1d(const double* X_real, const double* X_imag, int N, double* x);
+
+/**
+ * 批量变换计划 (不透明类型)
+ *
+ * 一次变换 howmany 个长度相同的信号，第 j 个信号的第 k 个样本位于 j * dist + k * stride：
+ * - 连续存放的多帧:  stride = 1, dist = n
+ * - 多通道交错采样:  stride = 通道数, dist = 1
+ * - 矩阵的各列:      stride = 列数, dist = 1
+ * 输入输出使用相同的布局，可以原地变换；各信号之间不能重叠。
+ * 长度不超过 1024 时每 8 个 (float 为 16 个) 信号交错成一组，蝶形运算以向量宽度跨信号执行；
+ * 信号较多时由多个线程分担 (线程数见 fft_set_threads)。
+ */
+typedef struct fft_plan_many fft_plan_many;
+
+/**
+ * 创建批量变换计划
+ * @param n 每个信号的长度
+ * @param howmany 信号个数
+ * @param stride 同一信号相邻样本的间隔 (元素个数)
+ * @param dist 相邻信号第一个样本的间隔 (元素个数)
+ * @param direction FFT_FORWARD 或 FFT_INVERSE
+ * @return 计划指针，失败返回 NULL；使用完毕后调用 fft_plan_many_destroy 释放
+ */
+fft_plan_many* fft_plan_many_create(int n, int howmany, int stride, int dist, int direction);
+
+/**
+ * 释放由 fft_plan_many_create 创建的计划
+ */
+void fft_plan_many_destroy(fft_plan_many* plan);
+
+/**
+ * 从进程级缓存中获取批量变换计划 (归缓存所有，调用者不能释放，fft_plan_cache_clear 一并释放；
+ * 在此之前一直有效，线程数增加后再次获取得到的是另建的新计划)
+ */
+fft_plan_many* fft_plan_many_get(int n, int howmany, int stride, int dist, int direction);
+
+/**
+ * 执行批量变换 (逆变换不做 1/n 归一化)
+ * @param x_imag 输入虚部 (NULL 表示纯实数输入)
+ * @param X_real 输出实部 (可以与输入相同)
+ * @param X_imag 输出虚部 (可以与输入相同)
+ * @return 0表示成功，-1表示失败
+ */
+int fft_execute_many(const fft_plan_many* plan, const double* x_real, const double* x_imag,
+                     double* X_real, double* X_imag);
+
+/**
+ * 批量一维 FFT (使用缓存的计划)，布局参数同 fft_plan_many_create
+ * @return 0表示成功，-1表示失败
+ */
+int fft_1d_many(const double* x_real, const double* x_imag, int N, int howmany, int stride, int dist,
+                double* X_real, double* X_imag);
+
+/**
+ * 批量一维逆 FFT (含 1/N 归一化，使用缓存的计划)
+ * @return 0表示成功，-1表示失败
+ */
+int ifft_1d_many(const double* X_real, const double* X_imag, int N, int howmany, int stride, int dist,
+                 double* x_real, double* x_imag);
+
+/**
+ * 实数图像的二维 FFT，只输出 M x (N/2+1) 个非冗余频点 (行优先)
+ * @param x 输入实数图像 (M x N)
+ * @param M 行数
+ * @param N 列数
+ * @param X_real 输出实部 (M x (N/2+1))
+ * @param X_imag 输出虚部 (M x (N/2+1))
+ * @return 0表示成功，-1表示失败
+ */
+int fft_r2c_2d(const double* x, int M, int N, double* X_real, double* X_imag);
+
+/**
+ * 从 M x (N/2+1) 个频点还原实数图像 (含 1/(MN) 归一化)
+ * @param X_real 输入实部 (M x (N/2+1))
+ * @param X_imag 输入虚部 (M x (N/2+1))
+ * @param M 行数
+ * @param N 列数
+ * @param x 输出实数图像 (M x N)
+ * @return 0表示成功，-1表示失败
+ */
+int fft_c2r_2d(const double* X_real, const double* X_imag, int M, int N, double* x);
+
+/**
+ * 复数图像的二维 FFT (行优先 M x N，先逐行再逐列)
+ * @param x_imag 输入虚部 (NULL 表示纯实数输入)
+ * @return 0表示成功，-1表示失败
+ */
+int fft_2d(const double* x_real, const double* x_imag, int M, int N,
+           double* X_real, double* X_imag);
+
+/**
+ * 复数图像的二维逆 FFT (含 1/(MN) 归一化)
+ * @return 0表示成功，-1表示失败
+ */
+int ifft_2d(const double* X_real, const double* X_imag, int M, int N,
+            double* x_real, double* x_imag);
+
+/**
+ * 二维变换计划 (不透明类型)
+ *
+ * 保存行、列两个一维计划以及每个线程的工作区 (列条带、计划执行缓冲)。
+ * 建立后执行时不再分配任何堆内存，可以直接在调用者的缓冲区上原地变换，
+ * 8192x8192 的复数图像只需要图像本身的 1 GB 内存 (另加每线程约 2 MB 工作区)。
+ * 与一维计划一样，同一个计划不能被多个线程同时执行。
+ */
+typedef struct fft_plan2d fft_plan2d;
+
+/**
+ * 创建二维变换计划
+ * 工作区按当前的 fft_get_threads() 分配，执行时最多使用这么多线程
+ * @param M 行数
+ * @param N 列数
+ * @param direction FFT_FORWARD 或 FFT_INVERSE
+ * @return 计划指针，失败返回 NULL；使用完毕后调用 fft_plan2d_destroy 释放
+ */
+fft_plan2d* fft_plan2d_create(int M, int N, int direction);
+
+/**
+ * 释放由 fft_plan2d_create 创建的计划
+ */
+void fft_plan2d_destroy(fft_plan2d* plan);
+
+/**
+ * 从进程级缓存中获取二维计划 (归缓存所有，调用者不能释放，fft_plan_cache_clear 一并释放；
+ * 在此之前一直有效，线程数增加后再次获取得到的是另建的新计划)
+ */
+fft_plan2d* fft_plan2d_get(int M, int N, int direction);
+
+/**
+ * 原地执行二维变换，实部/虚部分离存放 (逆变换不做 1/(MN) 归一化)
+ * @param re 实部 (M x N，行优先)，变换结果写回原处
+ * @param im 虚部 (M x N，行优先)，变换结果写回原处
+ * @return 0表示成功，-1表示失败
+ */
+int fft_execute_2d(const fft_plan2d* plan, double* re, double* im);
+
+/**
+ * 原地执行二维变换，复数交错存放 [re, im, re, im, ...] (与 C99 double complex 数组布局相同)
+ * @param data M x N 个复数 (2*M*N 个 double)
+ * @return 0表示成功，-1表示失败
+ */
+int fft_execute_2d_interleaved(const fft_plan2d* plan, double* data);
+
+/**
+ * 原地执行 howmany 个二维变换 (多层图像: 第 k 层的 M x N 矩阵从 re + k * M * N 开始，不归一化)
+ * 层数不少于线程数 (或每层很小) 时各线程整层领取，每层的行、列阶段都在同一个线程中完成；
+ * 否则逐层执行，层内由多个线程分担。每一层的结果与单独执行 fft_execute_2d 逐位一致
+ * @return 0表示成功，-1表示失败
+ */
+int fft_execute_2d_many(const fft_plan2d* plan, double* re, double* im, int howmany);
+
+/**
+ * 多层图像逐层的二维 FFT (howmany 个连续存放的 M x N 矩阵，使用缓存的计划)
+ * @param x_imag 输入虚部 (NULL 表示纯实数输入)
+ * @return 0表示成功，-1表示失败
+ */
+int fft_2d_many(const double* x_real, const double* x_imag, int M, int N, int howmany,
+                double* X_real, double* X_imag);
+
+/**
+ * 多层图像逐层的二维逆 FFT (每层含 1/(MN) 归一化)
+ * @return 0表示成功，-1表示失败
+ */
+int ifft_2d_many(const double* X_real, const double* X_imag, int M, int N, int howmany,
+                 double* x_real, double* x_imag);
+
+/**
+ * 三维 FFT (D x M x N，按层、行、列优先存放): 先逐层做二维变换，再沿深度方向做批量一维变换
+ * @param x_imag 输入虚部 (NULL 表示纯实数输入)
+ * @return 0表示成功，-1表示失败
+ */
+int fft_3d(const double* x_real, const double* x_imag, int D, int M, int N,
+           double* X_real, double* X_imag);
+
+/**
+ * 三维逆 FFT (含 1/(DMN) 归一化)
+ * @return 0表示成功，-1表示失败
+ */
+int ifft_3d(const double* X_real, const double* X_imag, int D, int M, int N,
+            double* x_real, double* x_imag);
+
+/**
+ * 标记非零行: 行中有任一元素不为 0 时 mask[i] = 1，否则为 0
+ * @param im 虚部 (NULL 表示纯实数)
+ * @return 非零行数，参数无效时返回 -1
+ */
+int fft_row_mask(const double* re, const double* im, int M, int N, unsigned char* mask);
+
+/**
+ * 只有部分行非零的二维 FFT (欠采样K空间): 只变换非零行，
+ * 列变换按非零行的分布 (等间隔、集中在一个窗口内) 分解为较短的变换
+ * @param row_mask 长度 M，非 0 表示该行有数据 (其余行按 0 处理)；NULL 表示自动检测全零行
+ * @return 0表示成功，-1表示失败
+ */
+int fft_2d_pruned(const double* x_real, const double* x_imag, int M, int N,
+                  const unsigned char* row_mask, double* X_real, double* X_imag);
+
+/**
+ * 只有部分行非零的二维逆 FFT (含 1/(MN) 归一化)，补零重建的结果与 ifft_2d 相同
+ * @return 0表示成功，-1表示失败
+ */
+int ifft_2d_pruned(const double* X_real, const double* X_imag, int M, int N,
+                   const unsigned char* row_mask, double* x_real, double* x_imag);
+
+/**
+ * 矩阵转置 (缓存无关的分块实现)
+ * dst[j * rows + i] = src[i * cols + j]
+ * @param src 输入矩阵 (rows x cols，行优先)
+ * @param rows 行数
+ * @param cols 列数
+ * @param dst 输出矩阵 (cols x rows)，不能与 src 相同
+ * @return 0表示成功，-1表示失败
+ */
+int fft_transpose(const double* src, int rows, int cols, double* dst);
+
+/*
+ * 多线程
+ *
+ * 二维变换 (fft_2d、fft_r2c_2d 等及其 float 版本) 的行阶段和列阶段分别由多个线程分担，
+ * 两个阶段之间有一道屏障；每个线程使用自己的工作区，计划只读共享。
+ * 长度不小于 2^19 的一维变换 (四步法) 的列变换、行变换阶段同样如此。
+ * 默认使用全部在线 CPU 核，也可以通过环境变量 FFT_THREADS=<n> 或 fft_set_threads() 指定。
+ * 图像较小 (少于 256x256 个元素) 时只使用调用线程。
+ */
+
+/**
+ * 设置二维变换使用的线程数 (含调用线程)
+ * @param threads 线程数，0 表示使用全部 CPU 核
+ * @return 0表示成功，-1表示参数无效
+ */
+int fft_set_threads(int threads);
+
+/**
+ * 获取二维变换使用的线程数
+ */
+int fft_get_threads(void);
+
+/*
+ * 单精度 (float) 接口
+ *
+ * 与上面的 double 接口一一对应，名字以 fftf_ / ifftf_ 开头，语义完全相同。
+ * 数据量减半，SIMD 内核每条指令处理的元素加倍；旋转因子仍以 double 计算后再转换。
+ * 相对 double 结果的误差约为 1e-7 * log2(N)，见 README-FFT.md 的精度一节。
+ */
+typedef struct fftf_plan fftf_plan;
+typedef struct fftf_rplan fftf_rplan;
+
+fftf_plan* fftf_plan_create(int n, int direction);
+void fftf_plan_destroy(fftf_plan* plan);
+int fftf_plan_size(const fftf_plan* plan);
+fftf_plan* fftf_plan_get(int n, int direction);
+void fftf_plan_cache_clear(void);
+int fftf_execute(const fftf_plan* plan, const float* x_real, const float* x_imag,
+                 float* X_real, float* X_imag);
+
+fftf_rplan* fftf_rplan_create(int n, int direction);
+void fftf_rplan_destroy(fftf_rplan* rplan);
+fftf_rplan* fftf_rplan_get(int n, int direction);
+int fftf_execute_r2c(const fftf_rplan* rplan, const float* x, float* X_real, float* X_imag);
+int fftf_execute_c2r(const fftf_rplan* rplan, const float* X_real, const float* X_imag, float* x);
+
+int fftf_1d(const float* x_real, const float* x_imag, int N, float* X_real, float* X_imag);
+int ifftf_1d(const float* X_real, const float* X_imag, int N, float* x_real, float* x_imag);
+int fftf_r2c_1d(const float* x, int N, float* X_real, float* X_imag);
+int fftf_c2r_1d(const float* X_real, const float* X_imag, int N, float* x);
+int fftf_r2c_2d(const float* x, int M, int N, float* X_real, float* X_imag);
+int fftf_c2r_2d(const float* X_real, const float* X_imag, int M, int N, float* x);
+int fftf_2d(const float* x_real, const float* x_imag, int M, int N, float* X_real, float* X_imag);
+int ifftf_2d(const float* X_real, const float* X_imag, int M, int N, float* x_real, float* x_imag);
+int fftf_transpose(const float* src, int rows, int cols, float* dst);
+
+typedef struct fftf_plan_many fftf_plan_many;
+
+fftf_plan_many* fftf_plan_many_create(int n, int howmany, int stride, int dist, int direction);
+void fftf_plan_many_destroy(fftf_plan_many* plan);
+fftf_plan_many* fftf_plan_many_get(int n, int howmany, int stride, int dist, int direction);
+int fftf_execute_many(const fftf_plan_many* plan, const float* x_real, const float* x_imag,
+                      float* X_real, float* X_imag);
+int fftf_1d_many(const float* x_real, const float* x_imag, int N, int howmany, int stride, int dist,
+                 float* X_real, float* X_imag);
+int ifftf_1d_many(const float* X_real, const float* X_imag, int N, int howmany, int stride, int dist,
+                  float* x_real, float* x_imag);
+
+typedef struct fftf_plan2d fftf_plan2d;
+
+fftf_plan2d* fftf_plan2d_create(int M, int N, int direction);
+void fftf_plan2d_destroy(fftf_plan2d* plan);
+fftf_plan2d* fftf_plan2d_get(int M, int N, int direction);
+int fftf_execute_2d(const fftf_plan2d* plan, float* re, float* im);
+int fftf_execute_2d_interleaved(const fftf_plan2d* plan, float* data);
+int fftf_execute_2d_many(const fftf_plan2d* plan, float* re, float* im, int howmany);
+int fftf_2d_many(const float* x_real, const float* x_imag, int M, int N, int howmany,
+                 float* X_real, float* X_imag);
+int ifftf_2d_many(const float* X_real, const float* X_imag, int M, int N, int howmany,
+                  float* x_real, float* x_imag);
+int fftf_3d(const float* x_real, const float* x_imag, int D, int M, int N, float* X_real, float* X_imag);
+int ifftf_3d(const float* X_real, const float* X_imag, int D, int M, int N, float* x_real, float* x_imag);
+int fftf_row_mask(const float* re, const float* im, int M, int N, unsigned char* mask);
+int fftf_2d_pruned(const float* x_real, const float* x_imag, int M, int N,
+                   const unsigned char* row_mask, float* X_real, float* X_imag);
+int ifftf_2d_pruned(const float* X_real, const float* X_imag, int M, int N,
+                    const unsigned char* row_mask, float* x_real, float* x_imag);
+
+/*
+ * SIMD 内核选择
+ *
+ * 蝶形运算在运行时根据 cpuid 选择最宽的向量指令集，同一个可执行文件
+ * 在 AVX2 和 AVX-512 机器上都能全速运行。测试时可以通过环境变量
+ * FFT_SIMD=scalar|sse2|avx2|avx512 或 fft_simd_set_level() 强制使用某一级内核。
+ */
+#define FFT_SIMD_AUTO   (-1)    // 自动选择 CPU 支持的最高级别
+#define FFT_SIMD_SCALAR 0       // 标量实现
+#define FFT_SIMD_SSE2   1       // 2 x double
+#define FFT_SIMD_AVX2   2       // 4 x double, 含 FMA
+#define FFT_SIMD_AVX512 3       // 8 x double
+
+/**
+ * 强制使用某一级内核
+ * @param level FFT_SIMD_AUTO 或 FFT_SIMD_SCALAR .. FFT_SIMD_AVX512
+ * @return 0表示成功，-1表示当前 CPU 不支持该级别
+ */
+int fft_simd_set_level(int level);
+
+/**
+ * 获取当前使用的内核级别
+ */
+int fft_simd_get_level(void);
+
+/**
+ * 获取 CPU 支持的最高内核级别
+ */
+int fft_simd_best_level(void);
+
+/**
+ * 内核级别的名称 ("scalar", "sse2", "avx2", "avx512")
+ */
+const char* fft_simd_level_name(int level);
+
+#endif /* FFT_H */
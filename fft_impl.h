@@ -0,0 +1,2596 @@
+/**
+ * @file fft_impl.h
+ * @brief FFT 引擎的精度无关实现 (由 fft.c 分别以 double 和 float 包含)
+ *
+ * 包含前需要定义：
+ *   FFT_REAL           元素类型 (double 或 float)
+ *   FFT_ID(x)          生成公开/内部名字: fft_x 或 fftf_x
+ *   IFFT_ID(x)         逆变换简单接口的名字: ifft_x 或 ifftf_x
+ *   FFT_KERNELS        对应精度的 SIMD 内核表类型
+ *   FFT_SIMD_KERNELS   获取内核表的函数
+ *
+ * 旋转因子和 Bluestein 的 chirp 始终以 double 计算后再转换，
+ * 单精度版本的误差只来自蝶形运算本身的舍入。
+ */
+
+/**
+ * Bluestein (chirp-z) 算法所需的预计算数据
+ */
+typedef struct {
+    int m;                  // 卷积长度 (2 的幂, m >= 2N-1)
+    FFT_REAL *chirp_real;     // w[k] = exp(sign * πi * k² / N)
+    FFT_REAL *chirp_imag;
+    FFT_REAL *filter_real;    // FFT(conj(w)) / m，已包含逆变换的归一化
+    FFT_REAL *filter_imag;
+    FFT_ID(plan) *sub_fwd;      // 长度 m 的正变换
+    FFT_ID(plan) *sub_inv;      // 长度 m 的逆变换 (不归一化)
+} FFT_ID(bluestein);
+
+/**
+ * 变换计划：保存某个长度、某个方向所需的全部预计算表
+ */
+struct FFT_ID(plan) {
+    int n;                          // 变换长度
+    int sign;                       // 指数符号: -1 正变换, +1 逆变换
+    int nfactors;                   // 因子个数
+    int factors[FFT_MAX_FACTORS];   // factors[0] 为最外层 (最后执行) 的基数
+    int *perm;                      // 输入重排表: out[i] = in[perm[i]]
+    FFT_REAL *tw_real;                // 旋转因子实部 (各级连续存放)
+    FFT_REAL *tw_imag;                // 旋转因子虚部
+    FFT_ID(bluestein) *bluestein;       // 非 NULL 表示使用 Bluestein 算法
+    struct FFT_ID(large) *large;        // 非 NULL 表示使用四步法 (没有 perm 和旋转因子表)
+    FFT_REAL *scratch;                // 执行时的工作区 (原地变换的输入副本、Bluestein 卷积缓冲或四步法的中间矩阵)
+    int busy;                         // 缓存中的计划正被某个简单接口 (fft_1d 等) 使用 (受 cache_lock 保护)
+};
+
+/**
+ * 进程级计划缓存：按 (长度, 方向) 复用计划
+ */
+typedef struct FFT_ID(plan_cache_entry) {
+    FFT_ID(plan) *plan;
+    struct FFT_ID(plan_cache_entry) *next;
+} FFT_ID(plan_cache_entry);
+
+static FFT_ID(plan_cache_entry) *FFT_ID(plan_cache) = NULL;
+
+/**
+ * 保护全部计划缓存 (链表本身和计划的 busy 标记)，每种精度各一把
+ * 缓存中没有的计划在持锁期间创建，同一个计划不会被两个线程重复创建
+ */
+static pthread_mutex_t FFT_ID(cache_lock) = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * 实数变换计划 (r2c / c2r)
+ *
+ * N 为偶数时把实数序列看作长度 N/2 的复数序列 z[n] = x[2n] + i*x[2n+1]，
+ * 只做一次半长复数 FFT，再利用共轭对称性拆分出 N/2+1 个非冗余频点。
+ * N 为奇数时直接使用长度 N 的复数计划。
+ */
+struct FFT_ID(rplan) {
+    int n;                  // 实数序列长度
+    int direction;          // FFT_FORWARD 为 r2c, FFT_INVERSE 为 c2r
+    FFT_ID(plan) *plan;         // N 为偶数时长度 N/2，否则长度 N
+    FFT_REAL *tw_real;        // W_N^k = exp(-2πi*k/N), k = 0..N/2 (仅 N 为偶数)
+    FFT_REAL *tw_imag;
+    FFT_REAL *scratch;        // 4 * plan->n 个 FFT_REAL
+    int busy;                 // 同 plan->busy
+};
+
+typedef struct FFT_ID(rplan_cache_entry) {
+    FFT_ID(rplan) *plan;
+    struct FFT_ID(rplan_cache_entry) *next;
+} FFT_ID(rplan_cache_entry);
+
+static FFT_ID(rplan_cache_entry) *FFT_ID(rplan_cache) = NULL;
+
+/**
+ * 计算旋转因子并转换为本精度 (始终以 double 计算 cos/sin)
+ */
+static void FFT_ID(set_twiddle)(long long k, long long n, int sign, FFT_REAL* re, FFT_REAL* im) {
+    double wr, wi;
+    fft_twiddle(k, n, sign, &wr, &wi);
+    *re = (FFT_REAL)wr;
+    *im = (FFT_REAL)wi;
+}
+
+static void FFT_ID(plan_destroy_internal)(FFT_ID(plan)* plan);
+static FFT_ID(plan)* FFT_ID(plan_create_internal)(int n, int sign);
+static void FFT_ID(plan_execute_passes)(const FFT_ID(plan)* plan, FFT_REAL* re, FFT_REAL* im);
+static void FFT_ID(plan_many_cache_release)(void);
+static void FFT_ID(plan2d_cache_release)(void);
+static FFT_ID(plan)* FFT_ID(large_create)(int n, int n1, int sign);
+static void FFT_ID(large_destroy)(struct FFT_ID(large)* large);
+static int FFT_ID(execute_large)(const FFT_ID(plan)* plan, const FFT_REAL* x_real, const FFT_REAL* x_imag,
+                                 FFT_REAL* X_real, FFT_REAL* X_imag);
+static int FFT_ID(large_outgrown)(const FFT_ID(plan)* plan);
+
+static void FFT_ID(bluestein_destroy)(FFT_ID(bluestein)* b) {
+    if (!b) return;
+    free(b->chirp_real);
+    free(b->chirp_imag);
+    free(b->filter_real);
+    free(b->filter_imag);
+    FFT_ID(plan_destroy_internal)(b->sub_fwd);
+    FFT_ID(plan_destroy_internal)(b->sub_inv);
+    free(b);
+}
+
+/**
+ * 为长度 n 建立 Bluestein 数据
+ */
+static FFT_ID(bluestein)* FFT_ID(bluestein_create)(int n, int sign) {
+    FFT_ID(bluestein) *b = (FFT_ID(bluestein) *)calloc(1, sizeof(FFT_ID(bluestein)));
+    if (!b) return NULL;
+
+    b->m = 1;
+    while (b->m < 2 * n - 1) b->m *= 2;
+    int m = b->m;
+
+    b->chirp_real = (FFT_REAL *)malloc(n * sizeof(FFT_REAL));
+    b->chirp_imag = (FFT_REAL *)malloc(n * sizeof(FFT_REAL));
+    b->filter_real = (FFT_REAL *)calloc(m, sizeof(FFT_REAL));
+    b->filter_imag = (FFT_REAL *)calloc(m, sizeof(FFT_REAL));
+    b->sub_fwd = FFT_ID(plan_create_internal)(m, -1);
+    b->sub_inv = FFT_ID(plan_create_internal)(m, +1);
+    if (!b->chirp_real || !b->chirp_imag || !b->filter_real || !b->filter_imag ||
+        !b->sub_fwd || !b->sub_inv) {
+        FFT_ID(bluestein_destroy)(b);
+        return NULL;
+    }
+
+    // w[k] = exp(sign * πi * k² / n) = exp(sign * 2πi * (k² mod 2n) / 2n)
+    for (int k = 0; k < n; k++) {
+        FFT_ID(set_twiddle)((long long)k * k, 2LL * n, sign, &b->chirp_real[k], &b->chirp_imag[k]);
+    }
+
+    // 卷积核 conj(w)，按循环卷积的方式放在两端，然后变换到频域
+    FFT_REAL *tmp_real = (FFT_REAL *)calloc(m, sizeof(FFT_REAL));
+    FFT_REAL *tmp_imag = (FFT_REAL *)calloc(m, sizeof(FFT_REAL));
+    if (!tmp_real || !tmp_imag) {
+        free(tmp_real);
+        free(tmp_imag);
+        FFT_ID(bluestein_destroy)(b);
+        return NULL;
+    }
+    tmp_real[0] = b->chirp_real[0];
+    tmp_imag[0] = -b->chirp_imag[0];
+    for (int k = 1; k < n; k++) {
+        tmp_real[k] = tmp_real[m - k] = b->chirp_real[k];
+        tmp_imag[k] = tmp_imag[m - k] = -b->chirp_imag[k];
+    }
+    for (int i = 0; i < m; i++) {
+        b->filter_real[i] = tmp_real[b->sub_fwd->perm[i]];
+        b->filter_imag[i] = tmp_imag[b->sub_fwd->perm[i]];
+    }
+    FFT_ID(plan_execute_passes)(b->sub_fwd, b->filter_real, b->filter_imag);
+    for (int i = 0; i < m; i++) {
+        b->filter_real[i] /= m;
+        b->filter_imag[i] /= m;
+    }
+
+    free(tmp_real);
+    free(tmp_imag);
+    return b;
+}
+
+/**
+ * 按 lanes 路交错执行时旋转因子表的长度 (lanes 为 1 即普通计划)
+ */
+static size_t FFT_ID(twiddle_count)(const FFT_ID(plan)* plan, int lanes) {
+    size_t total = 0;
+    for (int s = plan->nfactors - 1, m = lanes; s >= 0; s--) {
+        total += fft_stage_twiddles(plan->factors[s], m);
+        m *= plan->factors[s];
+    }
+    return total;
+}
+
+/**
+ * 按执行顺序 (从最内层到最外层) 依次存放每一级的旋转因子
+ *
+ * lanes 路交错执行时，第 k 个蝶形的旋转因子连续重复 lanes 次，
+ * 各级的长度正好是 fft_stage_twiddles(p, m * lanes)，蝶形内核不需要任何改动；
+ * 通用奇数基的 W_p^j 与 lanes 无关，只存一份。
+ */
+static void FFT_ID(fill_twiddles)(const FFT_ID(plan)* plan, int lanes, FFT_REAL* tw_real, FFT_REAL* tw_imag) {
+    size_t offset = 0;
+    for (int s = plan->nfactors - 1, m = 1; s >= 0; s--) {
+        int p = plan->factors[s];
+        for (int j = 1; j < p; j++) {
+            for (int k = 0; k < m; k++) {
+                FFT_ID(set_twiddle)((long long)j * k, (long long)p * m, plan->sign,
+                            &tw_real[offset], &tw_imag[offset]);
+                for (int l = 1; l < lanes; l++) {
+                    tw_real[offset + l] = tw_real[offset];
+                    tw_imag[offset + l] = tw_imag[offset];
+                }
+                offset += lanes;
+            }
+        }
+        if (fft_stage_twiddles(p, m) > (p - 1) * m) {
+            // 通用奇数基蝶形使用的 W_p^j
+            for (int j = 0; j < p; j++) {
+                FFT_ID(set_twiddle)(j, p, plan->sign, &tw_real[offset], &tw_imag[offset]);
+                offset++;
+            }
+        }
+        m *= p;
+    }
+}
+
+static void FFT_ID(plan_destroy_internal)(FFT_ID(plan)* plan) {
+    if (!plan) return;
+    free(plan->scratch);
+    free(plan->perm);
+    free(plan->tw_real);
+    free(plan->tw_imag);
+    FFT_ID(bluestein_destroy)(plan->bluestein);
+    FFT_ID(large_destroy)(plan->large);
+    free(plan);
+}
+
+/**
+ * 创建变换计划：生成基数逆序表和每一级的旋转因子表
+ * @return 计划指针，内存分配失败时返回 NULL
+ */
+static FFT_ID(plan)* FFT_ID(plan_create_internal)(int n, int sign) {
+    FFT_ID(plan) *plan = (FFT_ID(plan) *)calloc(1, sizeof(FFT_ID(plan)));
+    if (!plan) return NULL;
+    plan->n = n;
+    plan->sign = sign;
+    plan->nfactors = fft_factorize(n, plan->factors);
+
+    if (plan->nfactors < 0) {
+        plan->nfactors = 0;
+        plan->bluestein = FFT_ID(bluestein_create)(n, sign);
+        if (!plan->bluestein) {
+            FFT_ID(plan_destroy_internal)(plan);
+            return NULL;
+        }
+        return plan;
+    }
+
+    // 旋转因子总数
+    size_t total = FFT_ID(twiddle_count)(plan, 1);
+
+    plan->perm = (int *)malloc(n * sizeof(int));
+    plan->tw_real = (FFT_REAL *)malloc((total > 0 ? total : 1) * sizeof(FFT_REAL));
+    plan->tw_imag = (FFT_REAL *)malloc((total > 0 ? total : 1) * sizeof(FFT_REAL));
+    if (!plan->perm || !plan->tw_real || !plan->tw_imag) {
+        FFT_ID(plan_destroy_internal)(plan);
+        return NULL;
+    }
+
+    // 基数逆序: 下标的各位数字 (按 factors[0], factors[1], ... 进制) 反向排列
+    for (int i = 0; i < n; i++) {
+        int rem = i, pos = 0, stride = n;
+        for (int s = 0; s < plan->nfactors; s++) {
+            stride /= plan->factors[s];
+            pos += (rem % plan->factors[s]) * stride;
+            rem /= plan->factors[s];
+        }
+        plan->perm[pos] = i;
+    }
+
+    FFT_ID(fill_twiddles)(plan, 1, plan->tw_real, plan->tw_imag);
+    return plan;
+}
+
+/**
+ * 基-2 蝶形级
+ */
+static void FFT_ID(pass_radix2)(FFT_REAL* re, FFT_REAL* im, int n, int m,
+                            const FFT_REAL* tw_real, const FFT_REAL* tw_imag) {
+    for (int base = 0; base < n; base += 2 * m) {
+        FFT_REAL *r0 = re + base, *i0 = im + base;
+        FFT_REAL *r1 = r0 + m, *i1 = i0 + m;
+        for (int k = 0; k < m; k++) {
+            FFT_REAL wr = tw_real[k], wi = tw_imag[k];
+            FFT_REAL tr = r1[k] * wr - i1[k] * wi;
+            FFT_REAL ti = r1[k] * wi + i1[k] * wr;
+            r1[k] = r0[k] - tr;
+            i1[k] = i0[k] - ti;
+            r0[k] += tr;
+            i0[k] += ti;
+        }
+    }
+}
+
+/**
+ * 基-3 蝶形级
+ */
+static void FFT_ID(pass_radix3)(FFT_REAL* re, FFT_REAL* im, int n, int m, int sign,
+                            const FFT_REAL* tw_real, const FFT_REAL* tw_imag) {
+    const FFT_REAL s60 = sign * 0.86602540378443864676;  // sign * sin(2π/3)
+    const FFT_REAL half = 0.5;
+    const FFT_REAL *w1r = tw_real, *w1i = tw_imag;
+    const FFT_REAL *w2r = tw_real + m, *w2i = tw_imag + m;
+
+    for (int base = 0; base < n; base += 3 * m) {
+        FFT_REAL *r0 = re + base, *i0 = im + base;
+        FFT_REAL *r1 = r0 + m, *i1 = i0 + m;
+        FFT_REAL *r2 = r1 + m, *i2 = i1 + m;
+        for (int k = 0; k < m; k++) {
+            FFT_REAL t1r = r1[k] * w1r[k] - i1[k] * w1i[k];
+            FFT_REAL t1i = r1[k] * w1i[k] + i1[k] * w1r[k];
+            FFT_REAL t2r = r2[k] * w2r[k] - i2[k] * w2i[k];
+            FFT_REAL t2i = r2[k] * w2i[k] + i2[k] * w2r[k];
+
+            FFT_REAL sr = t1r + t2r, si = t1i + t2i;
+            FFT_REAL dr = t1r - t2r, di = t1i - t2i;
+            FFT_REAL mr = r0[k] - half * sr, mi = i0[k] - half * si;
+
+            r0[k] += sr;
+            i0[k] += si;
+            r1[k] = mr - s60 * di;
+            i1[k] = mi + s60 * dr;
+            r2[k] = mr + s60 * di;
+            i2[k] = mi - s60 * dr;
+        }
+    }
+}
+
+/**
+ * 基-4 蝶形级
+ */
+static void FFT_ID(pass_radix4)(FFT_REAL* re, FFT_REAL* im, int n, int m, int sign,
+                            const FFT_REAL* tw_real, const FFT_REAL* tw_imag) {
+    const FFT_REAL *w1r = tw_real, *w1i = tw_imag;
+    const FFT_REAL *w2r = tw_real + m, *w2i = tw_imag + m;
+    const FFT_REAL *w3r = tw_real + 2 * m, *w3i = tw_imag + 2 * m;
+
+    for (int base = 0; base < n; base += 4 * m) {
+        FFT_REAL *r0 = re + base, *i0 = im + base;
+        FFT_REAL *r1 = r0 + m, *i1 = i0 + m;
+        FFT_REAL *r2 = r1 + m, *i2 = i1 + m;
+        FFT_REAL *r3 = r2 + m, *i3 = i2 + m;
+        for (int k = 0; k < m; k++) {
+            // 乘旋转因子
+            FFT_REAL t1r = r1[k] * w1r[k] - i1[k] * w1i[k];
+            FFT_REAL t1i = r1[k] * w1i[k] + i1[k] * w1r[k];
+            FFT_REAL t2r = r2[k] * w2r[k] - i2[k] * w2i[k];
+            FFT_REAL t2i = r2[k] * w2i[k] + i2[k] * w2r[k];
+            FFT_REAL t3r = r3[k] * w3r[k] - i3[k] * w3i[k];
+            FFT_REAL t3i = r3[k] * w3i[k] + i3[k] * w3r[k];
+
+            // 4 点 DFT
+            FFT_REAL ar = r0[k] + t2r, ai = i0[k] + t2i;
+            FFT_REAL br = r0[k] - t2r, bi = i0[k] - t2i;
+            FFT_REAL cr = t1r + t3r, ci = t1i + t3i;
+            FFT_REAL dr = t1r - t3r, di = t1i - t3i;
+
+            r0[k] = ar + cr;
+            i0[k] = ai + ci;
+            r2[k] = ar - cr;
+            i2[k] = ai - ci;
+            // (sign * i) * d
+            r1[k] = br - sign * di;
+            i1[k] = bi + sign * dr;
+            r3[k] = br + sign * di;
+            i3[k] = bi - sign * dr;
+        }
+    }
+}
+
+/**
+ * 基-5 蝶形级
+ */
+static void FFT_ID(pass_radix5)(FFT_REAL* re, FFT_REAL* im, int n, int m, int sign,
+                            const FFT_REAL* tw_real, const FFT_REAL* tw_imag) {
+    const FFT_REAL c1 = 0.30901699437494742410;          // cos(2π/5)
+    const FFT_REAL c2 = -0.80901699437494742410;         // cos(4π/5)
+    const FFT_REAL s1 = sign * 0.95105651629515357212;   // sign * sin(2π/5)
+    const FFT_REAL s2 = sign * 0.58778525229247312917;   // sign * sin(4π/5)
+
+    for (int base = 0; base < n; base += 5 * m) {
+        FFT_REAL *r[5], *i[5];
+        for (int j = 0; j < 5; j++) {
+            r[j] = re + base + j * m;
+            i[j] = im + base + j * m;
+        }
+        for (int k = 0; k < m; k++) {
+            FFT_REAL tr[5], ti[5];
+            tr[0] = r[0][k];
+            ti[0] = i[0][k];
+            for (int j = 1; j < 5; j++) {
+                FFT_REAL wr = tw_real[(j - 1) * m + k], wi = tw_imag[(j - 1) * m + k];
+                tr[j] = r[j][k] * wr - i[j][k] * wi;
+                ti[j] = r[j][k] * wi + i[j][k] * wr;
+            }
+
+            FFT_REAL a1r = tr[1] + tr[4], a1i = ti[1] + ti[4];
+            FFT_REAL b1r = tr[1] - tr[4], b1i = ti[1] - ti[4];
+            FFT_REAL a2r = tr[2] + tr[3], a2i = ti[2] + ti[3];
+            FFT_REAL b2r = tr[2] - tr[3], b2i = ti[2] - ti[3];
+
+            FFT_REAL m1r = tr[0] + c1 * a1r + c2 * a2r, m1i = ti[0] + c1 * a1i + c2 * a2i;
+            FFT_REAL m2r = tr[0] + c2 * a1r + c1 * a2r, m2i = ti[0] + c2 * a1i + c1 * a2i;
+            FFT_REAL n1r = s1 * b1r + s2 * b2r, n1i = s1 * b1i + s2 * b2i;
+            FFT_REAL n2r = s2 * b1r - s1 * b2r, n2i = s2 * b1i - s1 * b2i;
+
+            r[0][k] = tr[0] + a1r + a2r;
+            i[0][k] = ti[0] + a1i + a2i;
+            // ± i * n
+            r[1][k] = m1r - n1i;  i[1][k] = m1i + n1r;
+            r[4][k] = m1r + n1i;  i[4][k] = m1i - n1r;
+            r[2][k] = m2r - n2i;  i[2][k] = m2i + n2r;
+            r[3][k] = m2r + n2i;  i[3][k] = m2i - n2r;
+        }
+    }
+}
+
+/**
+ * 通用奇数基蝶形级 (基-7、基-11、基-13)
+ * 利用 W_p^j 与 W_p^(p-j) 共轭的对称性，乘法次数约为直接计算的一半
+ * @param rot_real W_p^j 的实部 (j = 0..p-1)
+ * @param rot_imag W_p^j 的虚部
+ */
+static void FFT_ID(pass_generic)(FFT_REAL* re, FFT_REAL* im, int n, int m, int p,
+                             const FFT_REAL* tw_real, const FFT_REAL* tw_imag,
+                             const FFT_REAL* rot_real, const FFT_REAL* rot_imag) {
+    int half = p / 2;
+
+    for (int base = 0; base < n; base += p * m) {
+        for (int k = 0; k < m; k++) {
+            FFT_REAL tr[FFT_MAX_RADIX], ti[FFT_MAX_RADIX];
+            FFT_REAL ar[FFT_MAX_RADIX / 2], ai[FFT_MAX_RADIX / 2];
+            FFT_REAL br[FFT_MAX_RADIX / 2], bi[FFT_MAX_RADIX / 2];
+
+            tr[0] = re[base + k];
+            ti[0] = im[base + k];
+            for (int j = 1; j < p; j++) {
+                FFT_REAL xr = re[base + j * m + k], xi = im[base + j * m + k];
+                FFT_REAL wr = tw_real[(j - 1) * m + k], wi = tw_imag[(j - 1) * m + k];
+                tr[j] = xr * wr - xi * wi;
+                ti[j] = xr * wi + xi * wr;
+            }
+
+            FFT_REAL sum_r = tr[0], sum_i = ti[0];
+            for (int j = 1; j <= half; j++) {
+                ar[j - 1] = tr[j] + tr[p - j];
+                ai[j - 1] = ti[j] + ti[p - j];
+                br[j - 1] = tr[j] - tr[p - j];
+                bi[j - 1] = ti[j] - ti[p - j];
+                sum_r += ar[j - 1];
+                sum_i += ai[j - 1];
+            }
+            re[base + k] = sum_r;
+            im[base + k] = sum_i;
+
+            for (int q = 1; q <= half; q++) {
+                FFT_REAL mr = tr[0], mi = ti[0];
+                FFT_REAL nr = 0.0, ni = 0.0;
+                int idx = 0;  // (q * j) mod p
+                for (int j = 1; j <= half; j++) {
+                    idx += q;
+                    if (idx >= p) idx -= p;
+                    mr += rot_real[idx] * ar[j - 1];
+                    mi += rot_real[idx] * ai[j - 1];
+                    nr += rot_imag[idx] * br[j - 1];
+                    ni += rot_imag[idx] * bi[j - 1];
+                }
+                // X[q] = m + i*n, X[p-q] = m - i*n
+                re[base + q * m + k] = mr - ni;
+                im[base + q * m + k] = mi + nr;
+                re[base + (p - q) * m + k] = mr + ni;
+                im[base + (p - q) * m + k] = mi - nr;
+            }
+        }
+    }
+}
+
+/**
+ * 对已经按基数逆序排好的数据，原地执行全部蝶形级
+ *
+ * lanes 路交错时第 i 个元素的第 l 路位于 re[i * lanes + l]，
+ * 把长度看作 n * lanes、m 从 lanes 开始，每一级就是普通的蝶形级 (旋转因子见 fill_twiddles)。
+ * lanes 为向量宽度的倍数时所有级都使用向量内核。
+ */
+static void FFT_ID(execute_passes)(const FFT_ID(plan)* plan, int lanes,
+                                   const FFT_REAL* tw_real, const FFT_REAL* tw_imag,
+                                   FFT_REAL* re, FFT_REAL* im) {
+    int n = plan->n * lanes;
+    const FFT_KERNELS *simd = FFT_SIMD_KERNELS();
+
+    for (int s = plan->nfactors - 1, m = lanes; s >= 0; s--) {
+        int p = plan->factors[s];
+        // 向量内核要求 m 是向量宽度的整数倍，前几级 m 较小时使用标量实现
+        int vec = simd && p <= 5 && m % simd->width == 0;
+        switch (p) {
+            case 2:
+                if (vec) simd->radix2(re, im, n, m, tw_real, tw_imag);
+                else FFT_ID(pass_radix2)(re, im, n, m, tw_real, tw_imag);
+                break;
+            case 3:
+                if (vec) simd->radix3(re, im, n, m, plan->sign, tw_real, tw_imag);
+                else FFT_ID(pass_radix3)(re, im, n, m, plan->sign, tw_real, tw_imag);
+                break;
+            case 4:
+                if (vec) simd->radix4(re, im, n, m, plan->sign, tw_real, tw_imag);
+                else FFT_ID(pass_radix4)(re, im, n, m, plan->sign, tw_real, tw_imag);
+                break;
+            case 5:
+                if (vec) simd->radix5(re, im, n, m, plan->sign, tw_real, tw_imag);
+                else FFT_ID(pass_radix5)(re, im, n, m, plan->sign, tw_real, tw_imag);
+                break;
+            default:
+                FFT_ID(pass_generic)(re, im, n, m, p, tw_real, tw_imag,
+                                 tw_real + (p - 1) * m, tw_imag + (p - 1) * m);
+                break;
+        }
+        tw_real += fft_stage_twiddles(p, m);
+        tw_imag += fft_stage_twiddles(p, m);
+        m *= p;
+    }
+}
+
+static void FFT_ID(plan_execute_passes)(const FFT_ID(plan)* plan, FFT_REAL* re, FFT_REAL* im) {
+    FFT_ID(execute_passes)(plan, 1, plan->tw_real, plan->tw_imag, re, im);
+}
+
+/**
+ * Bluestein 算法: X[k] = w[k] * Σ (x[j] w[j]) conj(w[k-j])
+ * 输入在第一步就被完整读取，因此输出可以与输入重叠
+ */
+static int FFT_ID(execute_bluestein)(const FFT_ID(plan)* plan, const FFT_REAL* x_real, const FFT_REAL* x_imag,
+                                 FFT_REAL* X_real, FFT_REAL* X_imag, FFT_REAL* work) {
+    const FFT_ID(bluestein) *b = plan->bluestein;
+    int n = plan->n, m = b->m;
+
+    FFT_REAL *a_real = work, *a_imag = work + m;
+    FFT_REAL *c_real = work + 2 * m, *c_imag = work + 3 * m;
+
+    // 1. a[j] = x[j] * w[j]，补零到 m，直接写入基数逆序位置
+    const int *perm = b->sub_fwd->perm;
+    for (int i = 0; i < m; i++) {
+        int j = perm[i];
+        if (j < n) {
+            FFT_REAL xr = x_real[j], xi = x_imag ? x_imag[j] : 0.0;
+            a_real[i] = xr * b->chirp_real[j] - xi * b->chirp_imag[j];
+            a_imag[i] = xr * b->chirp_imag[j] + xi * b->chirp_real[j];
+        } else {
+            a_real[i] = 0.0;
+            a_imag[i] = 0.0;
+        }
+    }
+    FFT_ID(plan_execute_passes)(b->sub_fwd, a_real, a_imag);
+
+    // 2. 频域相乘，同样写入逆变换的基数逆序位置
+    perm = b->sub_inv->perm;
+    for (int i = 0; i < m; i++) {
+        int j = perm[i];
+        c_real[i] = a_real[j] * b->filter_real[j] - a_imag[j] * b->filter_imag[j];
+        c_imag[i] = a_real[j] * b->filter_imag[j] + a_imag[j] * b->filter_real[j];
+    }
+    FFT_ID(plan_execute_passes)(b->sub_inv, c_real, c_imag);
+
+    // 3. X[k] = w[k] * c[k]
+    for (int k = 0; k < n; k++) {
+        FFT_REAL cr = c_real[k], ci = c_imag[k];
+        X_real[k] = cr * b->chirp_real[k] - ci * b->chirp_imag[k];
+        X_imag[k] = cr * b->chirp_imag[k] + ci * b->chirp_real[k];
+    }
+
+    return 0;
+}
+
+/**
+ * 计划执行时需要的工作区大小 (FFT_REAL 个数)
+ * Bluestein 需要两组长度 m 的复数缓冲，其余情况只需一份输入副本
+ */
+static size_t FFT_ID(plan_scratch_len)(const FFT_ID(plan)* plan) {
+    return plan->bluestein ? 4 * (size_t)plan->bluestein->m : 2 * (size_t)plan->n;
+}
+
+/**
+ * 使用调用者提供的工作区执行变换 (多线程时每个线程各用一份工作区)
+ */
+static int FFT_ID(execute_with)(const FFT_ID(plan)* plan, const FFT_REAL* x_real, const FFT_REAL* x_imag,
+                                FFT_REAL* X_real, FFT_REAL* X_imag, FFT_REAL* scratch) {
+    int n;
+
+    if (!plan || !x_real || !X_real || !X_imag) {
+        return -1;
+    }
+    n = plan->n;
+
+    if (plan->bluestein) {
+        return FFT_ID(execute_bluestein)(plan, x_real, x_imag, X_real, X_imag, scratch);
+    }
+
+    // 1. 基数逆序重排 (原地调用时先把输入复制到工作区)
+    const FFT_REAL *src_real = x_real, *src_imag = x_imag;
+    if (x_real == X_real || x_real == X_imag || (x_imag && (x_imag == X_real || x_imag == X_imag))) {
+        FFT_REAL *copy = scratch;
+        memcpy(copy, x_real, n * sizeof(FFT_REAL));
+        src_real = copy;
+        if (x_imag) {
+            memcpy(copy + n, x_imag, n * sizeof(FFT_REAL));
+            src_imag = copy + n;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        X_real[i] = src_real[plan->perm[i]];
+        X_imag[i] = src_imag ? src_imag[plan->perm[i]] : 0.0;
+    }
+
+    // 2. 自底向上逐级蝶形运算
+    FFT_ID(plan_execute_passes)(plan, X_real, X_imag);
+    return 0;
+}
+
+/**
+ * 执行变换计划 (不归一化)
+ * 输入与输出可以是同一块内存；x_imag 为 NULL 表示虚部全为0
+ */
+int FFT_ID(execute)(const FFT_ID(plan)* plan, const FFT_REAL* x_real, const FFT_REAL* x_imag,
+                FFT_REAL* X_real, FFT_REAL* X_imag) {
+    if (!plan) return -1;
+    if (plan->large) {
+        return FFT_ID(execute_large)(plan, x_real, x_imag, X_real, X_imag);
+    }
+    return FFT_ID(execute_with)(plan, x_real, x_imag, X_real, X_imag, plan->scratch);
+}
+
+/**
+ * 创建直接执行 (不使用四步法) 的计划，可以用 execute_with 配合线程私有的工作区执行
+ */
+static FFT_ID(plan)* FFT_ID(plan_create_direct)(int n, int direction) {
+    if (n < 1 || (direction != FFT_FORWARD && direction != FFT_INVERSE)) {
+        return NULL;
+    }
+
+    FFT_ID(plan) *plan = FFT_ID(plan_create_internal)(n, direction);
+    if (!plan) return NULL;
+
+    plan->scratch = (FFT_REAL *)malloc(FFT_ID(plan_scratch_len)(plan) * sizeof(FFT_REAL));
+    if (!plan->scratch) {
+        FFT_ID(plan_destroy_internal)(plan);
+        return NULL;
+    }
+    return plan;
+}
+
+FFT_ID(plan)* FFT_ID(plan_create)(int n, int direction) {
+    if (n < 1 || (direction != FFT_FORWARD && direction != FFT_INVERSE)) {
+        return NULL;
+    }
+    int n1 = fft_large_split(n);
+    if (n1 > 0) {
+        return FFT_ID(large_create)(n, n1, direction);
+    }
+    return FFT_ID(plan_create_direct)(n, direction);
+}
+
+void FFT_ID(plan_destroy)(FFT_ID(plan)* plan) {
+    FFT_ID(plan_destroy_internal)(plan);
+}
+
+int FFT_ID(plan_size)(const FFT_ID(plan)* plan) {
+    return plan ? plan->n : 0;
+}
+
+/**
+ * 在缓存中查找计划，不存在时创建 (调用者持有 cache_lock)
+ */
+static FFT_ID(plan)* FFT_ID(plan_lookup)(int n, int direction) {
+    for (FFT_ID(plan_cache_entry) *e = FFT_ID(plan_cache); e; e = e->next) {
+        if (e->plan->n == n && e->plan->sign == direction) {
+            // 四步法的线程工作区按创建时的线程数分配，线程数增加后另建计划插在缓存最前面；
+            // 旧计划可能仍被调用者持有 (执行时线程数不超过它自己的工作区)，留到 fft_plan_cache_clear 再释放
+            if (!FFT_ID(large_outgrown)(e->plan)) return e->plan;
+            break;
+        }
+    }
+
+    FFT_ID(plan_cache_entry) *entry = (FFT_ID(plan_cache_entry) *)malloc(sizeof(FFT_ID(plan_cache_entry)));
+    FFT_ID(plan) *plan = FFT_ID(plan_create)(n, direction);
+    if (!entry || !plan) {
+        free(entry);
+        FFT_ID(plan_destroy)(plan);
+        return NULL;
+    }
+    entry->plan = plan;
+    entry->next = FFT_ID(plan_cache);
+    FFT_ID(plan_cache) = entry;
+    return plan;
+}
+
+FFT_ID(plan)* FFT_ID(plan_get)(int n, int direction) {
+    pthread_mutex_lock(&FFT_ID(cache_lock));
+    FFT_ID(plan) *plan = FFT_ID(plan_lookup)(n, direction);
+    pthread_mutex_unlock(&FFT_ID(cache_lock));
+    return plan;
+}
+
+/**
+ * 简单接口借用缓存中的计划: 空闲时标记为使用中；正被其他线程的简单接口使用时
+ * 临时创建一个计划 (用完由 plan_return 释放)，因此多个线程可以同时调用 fft_1d 等接口
+ */
+static FFT_ID(plan)* FFT_ID(plan_borrow)(int n, int direction) {
+    pthread_mutex_lock(&FFT_ID(cache_lock));
+    FFT_ID(plan) *plan = FFT_ID(plan_lookup)(n, direction);
+    int shared = plan && !plan->busy;
+    if (shared) plan->busy = 1;
+    pthread_mutex_unlock(&FFT_ID(cache_lock));
+    return shared ? plan : FFT_ID(plan_create)(n, direction);
+}
+
+/**
+ * 归还 plan_borrow 得到的计划 (临时计划直接释放)
+ */
+static void FFT_ID(plan_return)(FFT_ID(plan)* plan) {
+    pthread_mutex_lock(&FFT_ID(cache_lock));
+    int shared = plan->busy;
+    plan->busy = 0;
+    pthread_mutex_unlock(&FFT_ID(cache_lock));
+    if (!shared) FFT_ID(plan_destroy)(plan);
+}
+
+FFT_ID(rplan)* FFT_ID(rplan_create)(int n, int direction) {
+    if (n < 1 || (direction != FFT_FORWARD && direction != FFT_INVERSE)) {
+        return NULL;
+    }
+
+    FFT_ID(rplan) *rplan = (FFT_ID(rplan) *)calloc(1, sizeof(FFT_ID(rplan)));
+    if (!rplan) return NULL;
+    rplan->n = n;
+    rplan->direction = direction;
+
+    int len = (n % 2 == 0) ? n / 2 : n;
+    rplan->plan = FFT_ID(plan_create)(len, direction);
+    rplan->scratch = (FFT_REAL *)malloc(4 * (size_t)len * sizeof(FFT_REAL));
+    if (!rplan->plan || !rplan->scratch) {
+        FFT_ID(rplan_destroy)(rplan);
+        return NULL;
+    }
+
+    if (n % 2 == 0) {
+        int half = n / 2;
+        rplan->tw_real = (FFT_REAL *)malloc((half + 1) * sizeof(FFT_REAL));
+        rplan->tw_imag = (FFT_REAL *)malloc((half + 1) * sizeof(FFT_REAL));
+        if (!rplan->tw_real || !rplan->tw_imag) {
+            FFT_ID(rplan_destroy)(rplan);
+            return NULL;
+        }
+        for (int k = 0; k <= half; k++) {
+            FFT_ID(set_twiddle)(k, n, FFT_FORWARD, &rplan->tw_real[k], &rplan->tw_imag[k]);
+        }
+    }
+    return rplan;
+}
+
+void FFT_ID(rplan_destroy)(FFT_ID(rplan)* rplan) {
+    if (!rplan) return;
+    FFT_ID(plan_destroy)(rplan->plan);
+    free(rplan->tw_real);
+    free(rplan->tw_imag);
+    free(rplan->scratch);
+    free(rplan);
+}
+
+/**
+ * 在缓存中查找实数变换计划，不存在时创建 (调用者持有 cache_lock)
+ */
+static FFT_ID(rplan)* FFT_ID(rplan_lookup)(int n, int direction) {
+    for (FFT_ID(rplan_cache_entry) *e = FFT_ID(rplan_cache); e; e = e->next) {
+        if (e->plan->n == n && e->plan->direction == direction) {
+            // 同 plan_get: 线程数增加后另建计划，旧计划保留到缓存清空
+            if (!FFT_ID(large_outgrown)(e->plan->plan)) return e->plan;
+            break;
+        }
+    }
+
+    FFT_ID(rplan_cache_entry) *entry = (FFT_ID(rplan_cache_entry) *)malloc(sizeof(FFT_ID(rplan_cache_entry)));
+    FFT_ID(rplan) *rplan = FFT_ID(rplan_create)(n, direction);
+    if (!entry || !rplan) {
+        free(entry);
+        FFT_ID(rplan_destroy)(rplan);
+        return NULL;
+    }
+    entry->plan = rplan;
+    entry->next = FFT_ID(rplan_cache);
+    FFT_ID(rplan_cache) = entry;
+    return rplan;
+}
+
+FFT_ID(rplan)* FFT_ID(rplan_get)(int n, int direction) {
+    pthread_mutex_lock(&FFT_ID(cache_lock));
+    FFT_ID(rplan) *rplan = FFT_ID(rplan_lookup)(n, direction);
+    pthread_mutex_unlock(&FFT_ID(cache_lock));
+    return rplan;
+}
+
+/**
+ * 借用/归还缓存中的实数变换计划 (同 plan_borrow / plan_return)
+ */
+static FFT_ID(rplan)* FFT_ID(rplan_borrow)(int n, int direction) {
+    pthread_mutex_lock(&FFT_ID(cache_lock));
+    FFT_ID(rplan) *rplan = FFT_ID(rplan_lookup)(n, direction);
+    int shared = rplan && !rplan->busy;
+    if (shared) rplan->busy = 1;
+    pthread_mutex_unlock(&FFT_ID(cache_lock));
+    return shared ? rplan : FFT_ID(rplan_create)(n, direction);
+}
+
+static void FFT_ID(rplan_return)(FFT_ID(rplan)* rplan) {
+    pthread_mutex_lock(&FFT_ID(cache_lock));
+    int shared = rplan->busy;
+    rplan->busy = 0;
+    pthread_mutex_unlock(&FFT_ID(cache_lock));
+    if (!shared) FFT_ID(rplan_destroy)(rplan);
+}
+
+/**
+ * 把长度 N/2 的复数序列 z[n] = x[2n] + i*x[2n+1] 变换到 Z (写入 Z_real/Z_imag)
+ */
+static void FFT_ID(rplan_pack_forward)(const FFT_ID(rplan)* rplan, const FFT_REAL* x,
+                                   FFT_REAL* Z_real, FFT_REAL* Z_imag) {
+    const FFT_ID(plan) *plan = rplan->plan;
+    int half = plan->n;
+
+    if (plan->bluestein || plan->large) {
+        FFT_REAL *z_real = rplan->scratch + 2 * half, *z_imag = rplan->scratch + 3 * half;
+        for (int i = 0; i < half; i++) {
+            z_real[i] = x[2 * i];
+            z_imag[i] = x[2 * i + 1];
+        }
+        FFT_ID(execute)(plan, z_real, z_imag, Z_real, Z_imag);
+        return;
+    }
+
+    // 拆分奇偶样本时直接写入基数逆序位置，省去一次复制
+    for (int i = 0; i < half; i++) {
+        int j = plan->perm[i];
+        Z_real[i] = x[2 * j];
+        Z_imag[i] = x[2 * j + 1];
+    }
+    FFT_ID(plan_execute_passes)(plan, Z_real, Z_imag);
+}
+
+int FFT_ID(execute_r2c)(const FFT_ID(rplan)* rplan, const FFT_REAL* x, FFT_REAL* X_real, FFT_REAL* X_imag) {
+    if (!rplan || !x || !X_real || !X_imag || rplan->direction != FFT_FORWARD) {
+        return -1;
+    }
+    int n = rplan->n;
+
+    if (n % 2 != 0) {
+        FFT_REAL *full_real = rplan->scratch, *full_imag = rplan->scratch + n;
+        if (FFT_ID(execute)(rplan->plan, x, NULL, full_real, full_imag) != 0) return -1;
+        memcpy(X_real, full_real, (n / 2 + 1) * sizeof(FFT_REAL));
+        memcpy(X_imag, full_imag, (n / 2 + 1) * sizeof(FFT_REAL));
+        return 0;
+    }
+
+    int half = n / 2;
+    FFT_REAL *Z_real = rplan->scratch, *Z_imag = rplan->scratch + half;
+    FFT_ID(rplan_pack_forward)(rplan, x, Z_real, Z_imag);
+
+    const FFT_REAL h = 0.5;
+
+    // E[k] = (Z[k] + conj(Z[M-k])) / 2        偶数样本的频谱
+    // O[k] = (Z[k] - conj(Z[M-k])) / (2i)     奇数样本的频谱
+    // X[k] = E[k] + W_N^k * O[k]
+    for (int k = 0; k <= half; k++) {
+        int a = (k == half) ? 0 : k;
+        int b = (k == 0) ? 0 : half - k;
+        FFT_REAL zr = Z_real[a], zi = Z_imag[a];
+        FFT_REAL cr = Z_real[b], ci = -Z_imag[b];
+
+        FFT_REAL er = h * (zr + cr), ei = h * (zi + ci);
+        FFT_REAL or_ = h * (zi - ci), oi = -h * (zr - cr);
+        FFT_REAL wr = rplan->tw_real[k], wi = rplan->tw_imag[k];
+
+        X_real[k] = er + wr * or_ - wi * oi;
+        X_imag[k] = ei + wr * oi + wi * or_;
+    }
+    return 0;
+}
+
+int FFT_ID(execute_c2r)(const FFT_ID(rplan)* rplan, const FFT_REAL* X_real, const FFT_REAL* X_imag, FFT_REAL* x) {
+    if (!rplan || !X_real || !X_imag || !x || rplan->direction != FFT_INVERSE) {
+        return -1;
+    }
+    int n = rplan->n;
+
+    if (n % 2 != 0) {
+        // 按共轭对称补全整个频谱后做复数逆变换，只保留实部
+        FFT_REAL *full_real = rplan->scratch, *full_imag = rplan->scratch + n;
+        FFT_REAL *out_real = rplan->scratch + 2 * n, *out_imag = rplan->scratch + 3 * n;
+        for (int k = 0; k <= n / 2; k++) {
+            full_real[k] = X_real[k];
+            full_imag[k] = X_imag[k];
+        }
+        for (int k = n / 2 + 1; k < n; k++) {
+            full_real[k] = X_real[n - k];
+            full_imag[k] = -X_imag[n - k];
+        }
+        full_imag[0] = 0.0;
+        if (FFT_ID(execute)(rplan->plan, full_real, full_imag, out_real, out_imag) != 0) return -1;
+        memcpy(x, out_real, n * sizeof(FFT_REAL));
+        return 0;
+    }
+
+    const FFT_ID(plan) *plan = rplan->plan;
+    int half = n / 2;
+    FFT_REAL *Z_real = rplan->scratch, *Z_imag = rplan->scratch + half;
+    FFT_REAL *z_real = rplan->scratch + 2 * half, *z_imag = rplan->scratch + 3 * half;
+
+    // 还原 Z[k] = E[k] + i*O[k]，其中 E = X[k] + conj(X[M-k])，O = (X[k] - conj(X[M-k])) * W_N^-k
+    for (int k = 0; k < half; k++) {
+        FFT_REAL xr = X_real[k], xi = X_imag[k];
+        FFT_REAL cr = X_real[half - k], ci = -X_imag[half - k];
+        FFT_REAL er = xr + cr, ei = xi + ci;
+        FFT_REAL dr = xr - cr, di = xi - ci;
+        FFT_REAL wr = rplan->tw_real[k], wi = -rplan->tw_imag[k];
+        FFT_REAL or_ = dr * wr - di * wi, oi = dr * wi + di * wr;
+        Z_real[k] = er - oi;
+        Z_imag[k] = ei + or_;
+    }
+
+    if (plan->bluestein || plan->large) {
+        if (FFT_ID(execute)(plan, Z_real, Z_imag, z_real, z_imag) != 0) return -1;
+    } else {
+        for (int i = 0; i < half; i++) {
+            z_real[i] = Z_real[plan->perm[i]];
+            z_imag[i] = Z_imag[plan->perm[i]];
+        }
+        FFT_ID(plan_execute_passes)(plan, z_real, z_imag);
+    }
+
+    for (int i = 0; i < half; i++) {
+        x[2 * i] = z_real[i];
+        x[2 * i + 1] = z_imag[i];
+    }
+    return 0;
+}
+
+void FFT_ID(plan_cache_clear)(void) {
+    pthread_mutex_lock(&FFT_ID(cache_lock));
+    while (FFT_ID(plan_cache)) {
+        FFT_ID(plan_cache_entry) *next = FFT_ID(plan_cache)->next;
+        FFT_ID(plan_destroy)(FFT_ID(plan_cache)->plan);
+        free(FFT_ID(plan_cache));
+        FFT_ID(plan_cache) = next;
+    }
+    while (FFT_ID(rplan_cache)) {
+        FFT_ID(rplan_cache_entry) *next = FFT_ID(rplan_cache)->next;
+        FFT_ID(rplan_destroy)(FFT_ID(rplan_cache)->plan);
+        free(FFT_ID(rplan_cache));
+        FFT_ID(rplan_cache) = next;
+    }
+    FFT_ID(plan_many_cache_release)();
+    FFT_ID(plan2d_cache_release)();
+    pthread_mutex_unlock(&FFT_ID(cache_lock));
+}
+
+/**
+ * 按方向执行一维变换的公共部分 (使用缓存的计划)
+ */
+static int FFT_ID(1d_run)(const FFT_REAL* in_real, const FFT_REAL* in_imag, int N,
+                      FFT_REAL* out_real, FFT_REAL* out_imag, int direction) {
+    if (N < 1 || !in_real || !out_real || !out_imag) {
+        return -1;
+    }
+
+    FFT_ID(plan) *plan = FFT_ID(plan_borrow)(N, direction);
+    if (!plan) {
+        printf("内存分配失败\n");
+        return -1;
+    }
+    int result = FFT_ID(execute)(plan, in_real, in_imag, out_real, out_imag);
+    FFT_ID(plan_return)(plan);
+    return result;
+}
+
+int FFT_ID(1d)(const FFT_REAL* x_real, const FFT_REAL* x_imag, int N, FFT_REAL* X_real, FFT_REAL* X_imag) {
+    return FFT_ID(1d_run)(x_real, x_imag, N, X_real, X_imag, FFT_FORWARD);
+}
+
+int IFFT_ID(1d)(const FFT_REAL* X_real, const FFT_REAL* X_imag, int N, FFT_REAL* x_real, FFT_REAL* x_imag) {
+    if (FFT_ID(1d_run)(X_real, X_imag, N, x_real, x_imag, FFT_INVERSE) != 0) {
+        return -1;
+    }
+    // 归一化
+    FFT_REAL scale = 1.0 / N;
+    for (int n = 0; n < N; n++) {
+        x_real[n] *= scale;
+        x_imag[n] *= scale;
+    }
+    return 0;
+}
+
+int FFT_ID(r2c_1d)(const FFT_REAL* x, int N, FFT_REAL* X_real, FFT_REAL* X_imag) {
+    if (N < 1) return -1;
+    FFT_ID(rplan) *rplan = FFT_ID(rplan_borrow)(N, FFT_FORWARD);
+    if (!rplan) {
+        printf("内存分配失败\n");
+        return -1;
+    }
+    int result = FFT_ID(execute_r2c)(rplan, x, X_real, X_imag);
+    FFT_ID(rplan_return)(rplan);
+    return result;
+}
+
+int FFT_ID(c2r_1d)(const FFT_REAL* X_real, const FFT_REAL* X_imag, int N, FFT_REAL* x) {
+    if (N < 1) return -1;
+    FFT_ID(rplan) *rplan = FFT_ID(rplan_borrow)(N, FFT_INVERSE);
+    if (!rplan) {
+        printf("内存分配失败\n");
+        return -1;
+    }
+    int result = FFT_ID(execute_c2r)(rplan, X_real, X_imag, x);
+    FFT_ID(rplan_return)(rplan);
+    if (result != 0) {
+        return -1;
+    }
+    FFT_REAL scale = 1.0 / N;
+    for (int n = 0; n < N; n++) {
+        x[n] *= scale;
+    }
+    return 0;
+}
+
+/**
+ * 缓存无关 (cache-oblivious) 转置:
+ * dst[j * dst_stride + i * dst_step] = src[i * src_stride + j * src_step]
+ *
+ * 递归地把较长的一边对半切分，直到子块不超过 FFT_TRANSPOSE_TILE 见方。
+ * 无论缓存多大，总有某一层的子块读写两侧都能留在缓存中，不需要针对机器调节块大小。
+ * step 为 2 时可以直接读写实部/虚部交错存放的复数数组。
+ */
+static void FFT_ID(transpose_block)(const FFT_REAL* src, size_t src_stride, size_t src_step,
+                                    FFT_REAL* dst, size_t dst_stride, size_t dst_step,
+                                    int rows, int cols) {
+    while (rows > FFT_TRANSPOSE_TILE || cols > FFT_TRANSPOSE_TILE) {
+        if (rows >= cols) {
+            int half = rows / 2;
+            FFT_ID(transpose_block)(src, src_stride, src_step, dst, dst_stride, dst_step, half, cols);
+            src += (size_t)half * src_stride;
+            dst += (size_t)half * dst_step;
+            rows -= half;
+        } else {
+            int half = cols / 2;
+            FFT_ID(transpose_block)(src, src_stride, src_step, dst, dst_stride, dst_step, rows, half);
+            src += (size_t)half * src_step;
+            dst += (size_t)half * dst_stride;
+            cols -= half;
+        }
+    }
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            dst[j * dst_stride + i * dst_step] = src[i * src_stride + j * src_step];
+        }
+    }
+}
+
+int FFT_ID(transpose)(const FFT_REAL* src, int rows, int cols, FFT_REAL* dst) {
+    if (rows < 1 || cols < 1 || !src || !dst || src == dst) return -1;
+    FFT_ID(transpose_block)(src, cols, 1, dst, rows, 1, rows, cols);
+    return 0;
+}
+
+/**
+ * 批量变换的执行数据: 同一长度的多个信号共用一个计划
+ *
+ * 短信号每 lanes 个交错成一组 (第 i 个样本的各路相邻存放)，
+ * 所有蝶形级都以向量宽度跨信号执行，包括逐个变换时 m 小于向量宽度、只能用标量的前几级。
+ * 较长的信号 (见 FFT_BATCH_LANE_MAX) 和 Bluestein 长度逐个变换。
+ */
+typedef struct {
+    const FFT_ID(plan) *plan;
+    int lanes;                  // 每组交错的信号数，0 表示逐个变换
+    FFT_REAL *tw_real;          // lanes 路交错的旋转因子表 (见 fill_twiddles)
+    FFT_REAL *tw_imag;
+    size_t work_len;            // 每个线程需要的工作区长度
+} FFT_ID(batch);
+
+/**
+ * 为计划建立批量执行数据
+ * @param howmany 信号个数，只有一个信号时不交错
+ * @param stride 同一信号相邻样本的间隔，不为 1 时逐个变换需要转置条带
+ * @return 0表示成功，-1表示内存分配失败
+ */
+static int FFT_ID(batch_init)(FFT_ID(batch)* b, const FFT_ID(plan)* plan, int howmany, int stride) {
+    b->plan = plan;
+    b->lanes = 0;
+    b->tw_real = NULL;
+    b->tw_imag = NULL;
+    b->work_len = FFT_ID(plan_scratch_len)(plan);
+    if (stride != 1) {
+        b->work_len += 2 * (size_t)FFT_COLUMN_STRIP * plan->n;
+    }
+
+    // 连续信号逐个变换时前几级之后就能整段使用向量内核，交错的收益只在很短的长度上；
+    // 样本不相邻时交错省去了转置，较长的信号也划算
+    int lane_max = (stride == 1) ? FFT_BATCH_LANE_MAX : FFT_BATCH_STRIDED_LANE_MAX;
+    if (howmany < 2 || plan->bluestein || plan->n > lane_max) {
+        return 0;
+    }
+    int lanes = FFT_BATCH_LANE_BYTES / (int)sizeof(FFT_REAL);
+    size_t total = FFT_ID(twiddle_count)(plan, lanes);
+    b->tw_real = (FFT_REAL *)malloc((total > 0 ? total : 1) * sizeof(FFT_REAL));
+    b->tw_imag = (FFT_REAL *)malloc((total > 0 ? total : 1) * sizeof(FFT_REAL));
+    if (!b->tw_real || !b->tw_imag) {
+        free(b->tw_real);
+        free(b->tw_imag);
+        b->tw_real = NULL;
+        b->tw_imag = NULL;
+        return -1;
+    }
+    FFT_ID(fill_twiddles)(plan, lanes, b->tw_real, b->tw_imag);
+    b->lanes = lanes;
+    b->work_len = 2 * (size_t)plan->n * lanes;
+    return 0;
+}
+
+static void FFT_ID(batch_release)(FFT_ID(batch)* b) {
+    free(b->tw_real);
+    free(b->tw_imag);
+    b->tw_real = NULL;
+    b->tw_imag = NULL;
+}
+
+/**
+ * 变换第 first .. first+count-1 个信号
+ * 第 j 个信号的第 k 个样本位于 j * dist + k * stride (输入输出布局相同，可以原地)
+ * @param in_imag NULL 表示纯实数输入
+ * @param work 至少 b->work_len 个 FFT_REAL
+ */
+static void FFT_ID(batch_run)(const FFT_ID(batch)* b, const FFT_REAL* in_real, const FFT_REAL* in_imag,
+                              FFT_REAL* out_real, FFT_REAL* out_imag, size_t stride, size_t dist,
+                              int first, int count, FFT_REAL* work) {
+    const FFT_ID(plan) *plan = b->plan;
+    int n = plan->n, end = first + count;
+
+    if (!b->lanes) {
+        if (stride == 1) {
+            for (int j = first; j < end; j++) {
+                size_t offset = (size_t)j * dist;
+                FFT_ID(execute_with)(plan, in_real + offset, in_imag ? in_imag + offset : NULL,
+                                     out_real + offset, out_imag + offset, work);
+            }
+            return;
+        }
+        // 样本不相邻时每次把 FFT_COLUMN_STRIP 个信号分块转置成连续的行，变换后再转置回去
+        FFT_REAL *s_real = work + FFT_ID(plan_scratch_len)(plan);
+        FFT_REAL *s_imag = s_real + (size_t)FFT_COLUMN_STRIP * n;
+        for (int j = first; j < end; j += FFT_COLUMN_STRIP) {
+            int strip = (end - j < FFT_COLUMN_STRIP) ? end - j : FFT_COLUMN_STRIP;
+            size_t offset = (size_t)j * dist;
+            FFT_ID(transpose_block)(in_real + offset, stride, dist, s_real, n, 1, n, strip);
+            if (in_imag) {
+                FFT_ID(transpose_block)(in_imag + offset, stride, dist, s_imag, n, 1, n, strip);
+            } else {
+                memset(s_imag, 0, (size_t)strip * n * sizeof(FFT_REAL));
+            }
+            for (int l = 0; l < strip; l++) {
+                size_t row = (size_t)l * n;
+                FFT_ID(execute_with)(plan, s_real + row, s_imag + row, s_real + row, s_imag + row, work);
+            }
+            FFT_ID(transpose_block)(s_real, n, 1, out_real + offset, stride, dist, strip, n);
+            FFT_ID(transpose_block)(s_imag, n, 1, out_imag + offset, stride, dist, strip, n);
+        }
+        return;
+    }
+
+    int lanes = b->lanes;
+    FFT_REAL *g_real = work, *g_imag = work + (size_t)n * lanes;
+    const FFT_REAL *src_real[FFT_BATCH_LANE_BYTES / sizeof(FFT_REAL)];
+    const FFT_REAL *src_imag[FFT_BATCH_LANE_BYTES / sizeof(FFT_REAL)];
+    for (int g = first; g < end; g += lanes) {
+        int width = (end - g < lanes) ? end - g : lanes;
+
+        // 不足 lanes 路时重复最后一个信号，多算的几路不写回
+        for (int l = 0; l < lanes; l++) {
+            size_t offset = (size_t)(g + (l < width ? l : width - 1)) * dist;
+            src_real[l] = in_real + offset;
+            src_imag[l] = in_imag ? in_imag + offset : NULL;
+        }
+
+        // 1. 按基数逆序读入一组信号 (dist 为 1 时各路相邻，整段复制)
+        int adjacent = (dist == 1 && width == lanes);
+        for (int i = 0; i < n; i++) {
+            size_t offset = (size_t)plan->perm[i] * stride;
+            FFT_REAL *dst = g_real + (size_t)i * lanes;
+            if (adjacent) {
+                memcpy(dst, src_real[0] + offset, lanes * sizeof(FFT_REAL));
+                continue;
+            }
+            for (int l = 0; l < lanes; l++) {
+                dst[l] = src_real[l][offset];
+            }
+        }
+        if (in_imag) {
+            for (int i = 0; i < n; i++) {
+                size_t offset = (size_t)plan->perm[i] * stride;
+                FFT_REAL *dst = g_imag + (size_t)i * lanes;
+                if (adjacent) {
+                    memcpy(dst, src_imag[0] + offset, lanes * sizeof(FFT_REAL));
+                    continue;
+                }
+                for (int l = 0; l < lanes; l++) {
+                    dst[l] = src_imag[l][offset];
+                }
+            }
+        } else {
+            memset(g_imag, 0, (size_t)n * lanes * sizeof(FFT_REAL));
+        }
+
+        // 2. 跨信号的向量化蝶形
+        FFT_ID(execute_passes)(plan, lanes, b->tw_real, b->tw_imag, g_real, g_imag);
+
+        // 3. 写回: 按输出中相邻的方向走内层循环
+        FFT_REAL *dst_real = out_real + (size_t)g * dist, *dst_imag = out_imag + (size_t)g * dist;
+        if (dist < stride) {
+            for (int k = 0; k < n; k++) {
+                const FFT_REAL *row_real = g_real + (size_t)k * lanes, *row_imag = g_imag + (size_t)k * lanes;
+                size_t offset = (size_t)k * stride;
+                for (int l = 0; l < width; l++) {
+                    dst_real[offset + l * dist] = row_real[l];
+                    dst_imag[offset + l * dist] = row_imag[l];
+                }
+            }
+        } else {
+            for (int l = 0; l < width; l++) {
+                size_t offset = (size_t)l * dist;
+                for (int k = 0; k < n; k++) {
+                    dst_real[offset + (size_t)k * stride] = g_real[(size_t)k * lanes + l];
+                    dst_imag[offset + (size_t)k * stride] = g_imag[(size_t)k * lanes + l];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * 四步法 (four-step) 执行数据
+ *
+ * n = n1 * n2，把输入看作 n2 行 n1 列的矩阵 x[j + n1 * k]，输出下标为 k + n2 * r：
+ * 1. 对 n1 列各做一次长度 n2 的变换 (跨度 n1，见 batch_run)，结果写入中间矩阵 Y
+ * 2. Y[j + n1 * k] 乘以旋转因子 W_n^(j*k)
+ * 3. 对 n2 行各做一次长度 n1 的连续变换
+ * 4. 转置写出: X[k + n2 * r] = Y[r + n1 * k]
+ * 六步法的三次整体转置分别并入了列变换的条带和行变换后的分块写出，
+ * 每一步只接触缓存大小的一组列或行，各组由线程组动态领取。
+ */
+struct FFT_ID(large) {
+    int n1, n2;
+    FFT_ID(plan) *row_plan;         // 长度 n1 的直接执行计划
+    FFT_ID(plan) *col_plan;         // 长度 n2 的直接执行计划 (n1 == n2 时与 row_plan 相同)
+    FFT_ID(batch) columns;          // n1 个跨度为 n1 的列变换
+    FFT_REAL *lo_real, *lo_imag;    // W_n^e, e < n1
+    FFT_REAL *hi_real, *hi_imag;    // W_n^(e * n1), e < n2
+    int nthreads;                   // 工作区份数 (创建时的 fft_get_threads())
+    size_t work_len;                // 每个线程的工作区长度
+    FFT_REAL *work;
+};
+
+static void FFT_ID(large_destroy)(struct FFT_ID(large)* large) {
+    if (!large) return;
+    FFT_ID(batch_release)(&large->columns);
+    if (large->col_plan != large->row_plan) {
+        FFT_ID(plan_destroy)(large->col_plan);
+    }
+    FFT_ID(plan_destroy)(large->row_plan);
+    free(large->lo_real);
+    free(large->lo_imag);
+    free(large->hi_real);
+    free(large->hi_imag);
+    free(large->work);
+    free(large);
+}
+
+/**
+ * 创建四步法计划 (n1 由 fft_large_split 选择)
+ * 计划本身的工作区存放中间矩阵 Y，不分配长度 n 的基数逆序表和旋转因子表
+ */
+static FFT_ID(plan)* FFT_ID(large_create)(int n, int n1, int sign) {
+    FFT_ID(plan) *plan = (FFT_ID(plan) *)calloc(1, sizeof(FFT_ID(plan)));
+    struct FFT_ID(large) *large = (struct FFT_ID(large) *)calloc(1, sizeof(struct FFT_ID(large)));
+    if (!plan || !large) {
+        free(plan);
+        free(large);
+        return NULL;
+    }
+    plan->n = n;
+    plan->sign = sign;
+    plan->large = large;
+
+    int n2 = n / n1;
+    large->n1 = n1;
+    large->n2 = n2;
+    large->row_plan = FFT_ID(plan_create_direct)(n1, sign);
+    large->col_plan = (n2 == n1) ? large->row_plan : FFT_ID(plan_create_direct)(n2, sign);
+    large->lo_real = (FFT_REAL *)malloc(n1 * sizeof(FFT_REAL));
+    large->lo_imag = (FFT_REAL *)malloc(n1 * sizeof(FFT_REAL));
+    large->hi_real = (FFT_REAL *)malloc(n2 * sizeof(FFT_REAL));
+    large->hi_imag = (FFT_REAL *)malloc(n2 * sizeof(FFT_REAL));
+    plan->scratch = (FFT_REAL *)malloc(2 * (size_t)n * sizeof(FFT_REAL));
+    if (!large->row_plan || !large->col_plan || !large->lo_real || !large->lo_imag ||
+        !large->hi_real || !large->hi_imag || !plan->scratch ||
+        FFT_ID(batch_init)(&large->columns, large->col_plan, n1, n1) != 0) {
+        FFT_ID(plan_destroy_internal)(plan);
+        return NULL;
+    }
+
+    // W_n^(j*k) 按 j*k = hi * n1 + lo 拆成两张短表之积，表长只有 n1 + n2
+    for (int e = 0; e < n1; e++) {
+        FFT_ID(set_twiddle)(e, n, sign, &large->lo_real[e], &large->lo_imag[e]);
+    }
+    for (int e = 0; e < n2; e++) {
+        FFT_ID(set_twiddle)((long long)e * n1, n, sign, &large->hi_real[e], &large->hi_imag[e]);
+    }
+
+    // 行阶段需要乘过旋转因子的一行 (2 * n1) 和行计划的工作区
+    large->work_len = 2 * (size_t)n1 + FFT_ID(plan_scratch_len)(large->row_plan);
+    if (large->work_len < large->columns.work_len) {
+        large->work_len = large->columns.work_len;
+    }
+    large->nthreads = fft_get_threads();
+    large->work = (FFT_REAL *)malloc((size_t)large->nthreads * large->work_len * sizeof(FFT_REAL));
+    if (!large->work) {
+        FFT_ID(plan_destroy_internal)(plan);
+        return NULL;
+    }
+    return plan;
+}
+
+/**
+ * 四步法计划的线程工作区少于当前线程数 (缓存需要为当前线程数另建计划)
+ */
+static int FFT_ID(large_outgrown)(const FFT_ID(plan)* plan) {
+    return plan->large && plan->large->nthreads < fft_get_threads();
+}
+
+/**
+ * 四步法的一次并行执行
+ */
+typedef struct {
+    const struct FFT_ID(large) *large;
+    const FFT_REAL *in_real, *in_imag;
+    FFT_REAL *y_real, *y_imag;          // 中间矩阵 (计划的工作区)
+    FFT_REAL *out_real, *out_imag;
+    int next_col, next_row;             // 下一个待领取的列/行
+} FFT_ID(large_task);
+
+static void FFT_ID(large_worker)(fft_team* team, void* arg, int member) {
+    FFT_ID(large_task) *task = (FFT_ID(large_task) *)arg;
+    const struct FFT_ID(large) *large = task->large;
+    int n1 = large->n1, n2 = large->n2;
+    FFT_REAL *work = large->work + (size_t)member * large->work_len;
+    int begin, count;
+
+    // 1. 列变换: 输入读完之后才写输出，因此可以原地执行
+    int chunk = large->columns.lanes ? large->columns.lanes : FFT_COLUMN_STRIP;
+    while ((count = fft_team_claim(team, &task->next_col, n1, chunk, &begin)) > 0) {
+        FFT_ID(batch_run)(&large->columns, task->in_real, task->in_imag, task->y_real, task->y_imag,
+                          n1, 1, begin, count, work);
+    }
+    fft_team_barrier(team);
+
+    // 2~4. 每次领取 FFT_COLUMN_STRIP 行: 乘旋转因子、行变换，趁还在缓存中转置到输出
+    FFT_REAL *t_real = work, *t_imag = work + n1, *scratch = work + 2 * n1;
+    while ((count = fft_team_claim(team, &task->next_row, n2, FFT_COLUMN_STRIP, &begin)) > 0) {
+        for (int k = begin; k < begin + count; k++) {
+            FFT_REAL *row_real = task->y_real + (size_t)k * n1, *row_imag = task->y_imag + (size_t)k * n1;
+            // j*k 逐项加 k，按 hi * n1 + lo 进位，不需要除法
+            int step_hi = k / n1, step_lo = k % n1;
+            int hi = 0, lo = 0;
+            for (int j = 0; j < n1; j++) {
+                FFT_REAL wr = large->hi_real[hi] * large->lo_real[lo] - large->hi_imag[hi] * large->lo_imag[lo];
+                FFT_REAL wi = large->hi_real[hi] * large->lo_imag[lo] + large->hi_imag[hi] * large->lo_real[lo];
+                t_real[j] = row_real[j] * wr - row_imag[j] * wi;
+                t_imag[j] = row_real[j] * wi + row_imag[j] * wr;
+                hi += step_hi;
+                lo += step_lo;
+                if (lo >= n1) {
+                    lo -= n1;
+                    hi++;
+                }
+            }
+            FFT_ID(execute_with)(large->row_plan, t_real, t_imag, row_real, row_imag, scratch);
+        }
+        size_t offset = (size_t)begin * n1;
+        FFT_ID(transpose_block)(task->y_real + offset, n1, 1, task->out_real + begin, n2, 1, count, n1);
+        FFT_ID(transpose_block)(task->y_imag + offset, n1, 1, task->out_imag + begin, n2, 1, count, n1);
+    }
+}
+
+static int FFT_ID(execute_large)(const FFT_ID(plan)* plan, const FFT_REAL* x_real, const FFT_REAL* x_imag,
+                                 FFT_REAL* X_real, FFT_REAL* X_imag) {
+    if (!x_real || !X_real || !X_imag) return -1;
+
+    FFT_ID(large_task) task;
+    task.large = plan->large;
+    task.in_real = x_real;
+    task.in_imag = x_imag;
+    task.y_real = plan->scratch;
+    task.y_imag = plan->scratch + plan->n;
+    task.out_real = X_real;
+    task.out_imag = X_imag;
+    task.next_col = 0;
+    task.next_row = 0;
+
+    FFT_SIMD_KERNELS();
+
+    int nthreads = fft_get_threads();
+    if (nthreads > plan->large->nthreads) nthreads = plan->large->nthreads;
+    fft_team_run(FFT_ID(large_worker), &task, nthreads);
+    return 0;
+}
+
+/**
+ * 批量变换计划
+ */
+struct FFT_ID(plan_many) {
+    int n, howmany;
+    int stride, dist;
+    int direction;
+    FFT_ID(plan) *plan;
+    FFT_ID(batch) batch;
+    int nthreads;               // 工作区份数 (创建时的 fft_get_threads())
+    FFT_REAL *work;             // nthreads * batch.work_len
+    int busy;                   // 同 plan->busy
+};
+
+typedef struct FFT_ID(plan_many_cache_entry) {
+    FFT_ID(plan_many) *plan;
+    struct FFT_ID(plan_many_cache_entry) *next;
+} FFT_ID(plan_many_cache_entry);
+
+static FFT_ID(plan_many_cache_entry) *FFT_ID(plan_many_cache) = NULL;
+
+void FFT_ID(plan_many_destroy)(FFT_ID(plan_many)* plan) {
+    if (!plan) return;
+    FFT_ID(batch_release)(&plan->batch);
+    FFT_ID(plan_destroy)(plan->plan);
+    free(plan->work);
+    free(plan);
+}
+
+FFT_ID(plan_many)* FFT_ID(plan_many_create)(int n, int howmany, int stride, int dist, int direction) {
+    if (n < 1 || howmany < 1 || stride < 1 || dist < 1 ||
+        (direction != FFT_FORWARD && direction != FFT_INVERSE)) {
+        return NULL;
+    }
+
+    FFT_ID(plan_many) *plan = (FFT_ID(plan_many) *)calloc(1, sizeof(FFT_ID(plan_many)));
+    if (!plan) return NULL;
+    plan->n = n;
+    plan->howmany = howmany;
+    plan->stride = stride;
+    plan->dist = dist;
+    plan->direction = direction;
+    plan->plan = FFT_ID(plan_create_direct)(n, direction);
+    if (!plan->plan || FFT_ID(batch_init)(&plan->batch, plan->plan, howmany, stride) != 0) {
+        FFT_ID(plan_many_destroy)(plan);
+        return NULL;
+    }
+
+    plan->nthreads = fft_get_threads();
+    plan->work = (FFT_REAL *)malloc((size_t)plan->nthreads * plan->batch.work_len * sizeof(FFT_REAL));
+    if (!plan->work) {
+        FFT_ID(plan_many_destroy)(plan);
+        return NULL;
+    }
+    return plan;
+}
+
+/**
+ * 在缓存中查找批量变换计划，不存在时创建 (调用者持有 cache_lock)
+ */
+static FFT_ID(plan_many)* FFT_ID(plan_many_lookup)(int n, int howmany, int stride, int dist, int direction) {
+    int threads = fft_get_threads();
+    for (FFT_ID(plan_many_cache_entry) *e = FFT_ID(plan_many_cache); e; e = e->next) {
+        FFT_ID(plan_many) *plan = e->plan;
+        if (plan->n != n || plan->howmany != howmany || plan->stride != stride ||
+            plan->dist != dist || plan->direction != direction) {
+            continue;
+        }
+        // 线程工作区不够时另建计划插在缓存最前面，旧计划可能仍被调用者持有，留到缓存清空
+        if (plan->nthreads >= threads) return plan;
+        break;
+    }
+
+    FFT_ID(plan_many_cache_entry) *entry = (FFT_ID(plan_many_cache_entry) *)malloc(sizeof(FFT_ID(plan_many_cache_entry)));
+    if (!entry) return NULL;
+    entry->plan = FFT_ID(plan_many_create)(n, howmany, stride, dist, direction);
+    if (!entry->plan) {
+        free(entry);
+        return NULL;
+    }
+    entry->next = FFT_ID(plan_many_cache);
+    FFT_ID(plan_many_cache) = entry;
+    return entry->plan;
+}
+
+FFT_ID(plan_many)* FFT_ID(plan_many_get)(int n, int howmany, int stride, int dist, int direction) {
+    pthread_mutex_lock(&FFT_ID(cache_lock));
+    FFT_ID(plan_many) *plan = FFT_ID(plan_many_lookup)(n, howmany, stride, dist, direction);
+    pthread_mutex_unlock(&FFT_ID(cache_lock));
+    return plan;
+}
+
+/**
+ * 借用/归还缓存中的批量变换计划 (同 plan_borrow / plan_return)
+ */
+static FFT_ID(plan_many)* FFT_ID(plan_many_borrow)(int n, int howmany, int stride, int dist, int direction) {
+    pthread_mutex_lock(&FFT_ID(cache_lock));
+    FFT_ID(plan_many) *plan = FFT_ID(plan_many_lookup)(n, howmany, stride, dist, direction);
+    int shared = plan && !plan->busy;
+    if (shared) plan->busy = 1;
+    pthread_mutex_unlock(&FFT_ID(cache_lock));
+    return shared ? plan : FFT_ID(plan_many_create)(n, howmany, stride, dist, direction);
+}
+
+static void FFT_ID(plan_many_return)(FFT_ID(plan_many)* plan) {
+    pthread_mutex_lock(&FFT_ID(cache_lock));
+    int shared = plan->busy;
+    plan->busy = 0;
+    pthread_mutex_unlock(&FFT_ID(cache_lock));
+    if (!shared) FFT_ID(plan_many_destroy)(plan);
+}
+
+static void FFT_ID(plan_many_cache_release)(void) {
+    while (FFT_ID(plan_many_cache)) {
+        FFT_ID(plan_many_cache_entry) *next = FFT_ID(plan_many_cache)->next;
+        FFT_ID(plan_many_destroy)(FFT_ID(plan_many_cache)->plan);
+        free(FFT_ID(plan_many_cache));
+        FFT_ID(plan_many_cache) = next;
+    }
+}
+
+/**
+ * 批量变换的一次并行执行: 各线程按组领取信号
+ */
+typedef struct {
+    const FFT_ID(plan_many) *plan;
+    const FFT_REAL *in_real, *in_imag;
+    FFT_REAL *out_real, *out_imag;
+    int chunk;                  // 每次领取的信号数
+    int next;                   // 下一个待领取的信号
+} FFT_ID(many_task);
+
+static void FFT_ID(many_worker)(fft_team* team, void* arg, int member) {
+    FFT_ID(many_task) *task = (FFT_ID(many_task) *)arg;
+    const FFT_ID(plan_many) *plan = task->plan;
+    FFT_REAL *work = plan->work + (size_t)member * plan->batch.work_len;
+    int begin, count;
+
+    while ((count = fft_team_claim(team, &task->next, plan->howmany, task->chunk, &begin)) > 0) {
+        FFT_ID(batch_run)(&plan->batch, task->in_real, task->in_imag, task->out_real, task->out_imag,
+                          plan->stride, plan->dist, begin, count, work);
+    }
+}
+
+int FFT_ID(execute_many)(const FFT_ID(plan_many)* plan, const FFT_REAL* x_real, const FFT_REAL* x_imag,
+                         FFT_REAL* X_real, FFT_REAL* X_imag) {
+    if (!plan || !x_real || !X_real || !X_imag) return -1;
+
+    FFT_ID(many_task) task;
+    task.plan = plan;
+    task.in_real = x_real;
+    task.in_imag = x_imag;
+    task.out_real = X_real;
+    task.out_imag = X_imag;
+    task.chunk = plan->batch.lanes ? plan->batch.lanes : FFT_ROW_CHUNK;
+    task.next = 0;
+
+    FFT_SIMD_KERNELS();
+
+    int nthreads = plan->nthreads;
+    int max_chunks = (plan->howmany + task.chunk - 1) / task.chunk;
+    if ((size_t)plan->n * plan->howmany < FFT_PARALLEL_MIN) nthreads = 1;
+    if (nthreads > max_chunks) nthreads = max_chunks;
+    fft_team_run(FFT_ID(many_worker), &task, nthreads);
+    return 0;
+}
+
+/**
+ * 按方向执行批量变换的公共部分 (使用缓存的计划)
+ */
+static int FFT_ID(1d_many_run)(const FFT_REAL* in_real, const FFT_REAL* in_imag, int N,
+                               int howmany, int stride, int dist,
+                               FFT_REAL* out_real, FFT_REAL* out_imag, int direction) {
+    if (N < 1 || howmany < 1 || stride < 1 || dist < 1 || !in_real || !out_real || !out_imag) {
+        return -1;
+    }
+
+    FFT_ID(plan_many) *plan = FFT_ID(plan_many_borrow)(N, howmany, stride, dist, direction);
+    if (!plan) {
+        printf("内存分配失败\n");
+        return -1;
+    }
+    int result = FFT_ID(execute_many)(plan, in_real, in_imag, out_real, out_imag);
+    FFT_ID(plan_many_return)(plan);
+    return result;
+}
+
+int FFT_ID(1d_many)(const FFT_REAL* x_real, const FFT_REAL* x_imag, int N, int howmany, int stride, int dist,
+                    FFT_REAL* X_real, FFT_REAL* X_imag) {
+    return FFT_ID(1d_many_run)(x_real, x_imag, N, howmany, stride, dist, X_real, X_imag, FFT_FORWARD);
+}
+
+int IFFT_ID(1d_many)(const FFT_REAL* X_real, const FFT_REAL* X_imag, int N, int howmany, int stride, int dist,
+                     FFT_REAL* x_real, FFT_REAL* x_imag) {
+    if (FFT_ID(1d_many_run)(X_real, X_imag, N, howmany, stride, dist, x_real, x_imag, FFT_INVERSE) != 0) {
+        return -1;
+    }
+    FFT_REAL scale = 1.0 / N;
+    for (int j = 0; j < howmany; j++) {
+        for (int k = 0; k < N; k++) {
+            size_t i = (size_t)j * dist + (size_t)k * stride;
+            x_real[i] *= scale;
+            x_imag[i] *= scale;
+        }
+    }
+    return 0;
+}
+
+/**
+ * 二维变换的一次并行执行
+ *
+ * 行阶段把每一行 (输入跨度 N，输出跨度 stride) 变换到输出矩阵；
+ * 屏障之后的列阶段每次领取 FFT_COLUMN_STRIP 列，作为一批跨度为 stride 的信号变换 (见 batch_run)：
+ * 列较短时各列交错成组直接做向量化蝶形，否则分块转置到线程私有的条带中逐行变换后再转置回去。
+ * 交错格式 (re 指向 [re, im, re, im, ...]，im 为 NULL) 只支持原地变换。
+ */
+typedef struct {
+    const FFT_REAL *in_real, *in_imag;  // 行阶段输入，in_imag 可以为 NULL
+    FFT_REAL *re, *im;                  // 输出矩阵，列阶段原地进行
+    int interleaved;                    // re 为交错存放的复数数组
+    int M, N, cols, stride;
+    const FFT_ID(batch) *rows;          // 长度 N 的行变换，NULL 表示只做列阶段
+    const FFT_ID(batch) *columns;       // 长度 M 的列变换
+    FFT_REAL *work;                     // 各线程的工作区 (NULL 表示由线程自行分配)
+    size_t work_len;                    // 每个线程工作区的 FFT_REAL 个数
+    int next_row, next_col;             // 下一个待领取的行/列
+} FFT_ID(2d_task);
+
+/**
+ * 计算每个线程需要的工作区: 行、列批量变换中较大的一个 (交错格式的行阶段还需要一行的拆分缓冲)
+ */
+static void FFT_ID(2d_work_layout)(FFT_ID(2d_task)* task) {
+    size_t work_len = task->columns->work_len;
+    if (task->rows) {
+        size_t row_len = task->rows->work_len;
+        if (task->interleaved) {
+            size_t split_len = FFT_ID(plan_scratch_len)(task->rows->plan) + 2 * (size_t)task->N;
+            if (split_len > row_len) row_len = split_len;
+        }
+        if (row_len > work_len) work_len = row_len;
+    }
+    task->work_len = work_len;
+}
+
+static void FFT_ID(2d_worker)(fft_team* team, void* arg, int member) {
+    FFT_ID(2d_task) *task = (FFT_ID(2d_task) *)arg;
+    int M = task->M, N = task->N, begin, count;
+    int step = task->interleaved ? 2 : 1;
+
+    FFT_REAL *work = task->work ? task->work + (size_t)member * task->work_len
+                                : (FFT_REAL *)malloc(task->work_len * sizeof(FFT_REAL));
+
+    // 分配失败的线程不领取工作，但仍参与屏障，剩余的工作由其他线程完成
+    if (task->rows) {
+        const FFT_ID(plan) *row_plan = task->rows->plan;
+        FFT_REAL *r_real = work + FFT_ID(plan_scratch_len)(row_plan), *r_imag = r_real + N;
+        while (work && (count = fft_team_claim(team, &task->next_row, M, FFT_ROW_CHUNK, &begin)) > 0) {
+            if (!task->interleaved) {
+                // 输入输出的行跨度相同 (stride == N)
+                FFT_ID(batch_run)(task->rows, task->in_real, task->in_imag, task->re, task->im,
+                                  1, task->stride, begin, count, work);
+                continue;
+            }
+            if (task->rows->lanes) {
+                // 交错成组时读写本来就是逐个样本，直接按跨度 2 访问，结果与分离格式逐位一致
+                FFT_ID(batch_run)(task->rows, task->re, task->re + 1, task->re, task->re + 1,
+                                  2, 2 * (size_t)task->stride, begin, count, work);
+                continue;
+            }
+            for (int i = begin; i < begin + count; i++) {
+                FFT_REAL *row = task->re + 2 * (size_t)i * task->stride;
+                for (int j = 0; j < N; j++) {
+                    r_real[j] = row[2 * j];
+                    r_imag[j] = row[2 * j + 1];
+                }
+                FFT_ID(execute_with)(row_plan, r_real, r_imag, r_real, r_imag, work);
+                for (int j = 0; j < N; j++) {
+                    row[2 * j] = r_real[j];
+                    row[2 * j + 1] = r_imag[j];
+                }
+            }
+        }
+        fft_team_barrier(team);
+    }
+
+    FFT_REAL *c_real = task->re;
+    FFT_REAL *c_imag = task->interleaved ? task->re + 1 : task->im;
+    size_t c_stride = (size_t)task->stride * step;
+    while (work && (count = fft_team_claim(team, &task->next_col, task->cols, FFT_COLUMN_STRIP, &begin)) > 0) {
+        FFT_ID(batch_run)(task->columns, c_real, c_imag, c_real, c_imag, c_stride, step, begin, count, work);
+    }
+
+    if (!task->work) {
+        free(work);
+    }
+}
+
+/**
+ * 执行二维任务: 选定线程数后运行线程组，并检查是否所有工作都已完成
+ * @param max_threads 工作区预先分配时为分配的份数，否则为 0
+ */
+static int FFT_ID(2d_dispatch)(FFT_ID(2d_task)* task, int max_threads) {
+    task->next_row = 0;
+    task->next_col = 0;
+
+    // 计划缓存和 SIMD 内核选择都在调用线程中完成，工作线程只读
+    FFT_SIMD_KERNELS();
+
+    int nthreads = fft_get_threads();
+    int max_chunks = (task->cols + FFT_COLUMN_STRIP - 1) / FFT_COLUMN_STRIP;
+    if ((size_t)task->M * task->cols < FFT_PARALLEL_MIN) nthreads = 1;
+    if (nthreads > max_chunks) nthreads = max_chunks;
+    if (max_threads > 0 && nthreads > max_threads) nthreads = max_threads;
+    fft_team_run(FFT_ID(2d_worker), task, nthreads);
+
+    // 没有任何线程拿到工作区时计数器不会前进
+    if ((task->rows && task->next_row < task->M) || task->next_col < task->cols) {
+        printf("内存分配失败\n");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * 对 M x cols 复数矩阵 (行优先，行跨度 stride) 的每一列做长度 M 的变换
+ * 工作区由各线程临时分配 (实数二维变换使用)；缓存中的列计划只读取其旋转因子等表，
+ * 不使用它的工作区，因此不需要借用
+ */
+static int FFT_ID(columns)(FFT_REAL* re, FFT_REAL* im, int M, int cols, int stride, int direction) {
+    FFT_ID(plan) *col_plan = FFT_ID(plan_get)(M, direction), *direct = NULL;
+    FFT_ID(batch) batch;
+    if (col_plan && col_plan->large) {
+        // 缓存中的四步法计划不能按条带执行，临时创建直接执行的计划
+        col_plan = direct = FFT_ID(plan_create_direct)(M, direction);
+    }
+    if (!col_plan || FFT_ID(batch_init)(&batch, col_plan, cols, stride) != 0) {
+        FFT_ID(plan_destroy)(direct);
+        printf("内存分配失败\n");
+        return -1;
+    }
+
+    FFT_ID(2d_task) task;
+    memset(&task, 0, sizeof(task));
+    task.re = re;
+    task.im = im;
+    task.M = M;
+    task.cols = cols;
+    task.stride = stride;
+    task.columns = &batch;
+    FFT_ID(2d_work_layout)(&task);
+    int result = FFT_ID(2d_dispatch)(&task, 0);
+    FFT_ID(batch_release)(&batch);
+    FFT_ID(plan_destroy)(direct);
+    return result;
+}
+
+int FFT_ID(r2c_2d)(const FFT_REAL* x, int M, int N, FFT_REAL* X_real, FFT_REAL* X_imag) {
+    if (M < 1 || N < 1 || !x || !X_real || !X_imag) return -1;
+
+    int cols = N / 2 + 1;
+    FFT_ID(rplan) *rplan = FFT_ID(rplan_borrow)(N, FFT_FORWARD);
+    if (!rplan) {
+        printf("内存分配失败\n");
+        return -1;
+    }
+
+    // 第一步: 每一行做 r2c，得到 N/2+1 个频点
+    for (int i = 0; i < M; i++) {
+        FFT_ID(execute_r2c)(rplan, x + (size_t)i * N,
+                        X_real + (size_t)i * cols, X_imag + (size_t)i * cols);
+    }
+    FFT_ID(rplan_return)(rplan);
+
+    // 第二步: 对这 N/2+1 列做复数变换
+    return FFT_ID(columns)(X_real, X_imag, M, cols, cols, FFT_FORWARD);
+}
+
+int FFT_ID(c2r_2d)(const FFT_REAL* X_real, const FFT_REAL* X_imag, int M, int N, FFT_REAL* x) {
+    if (M < 1 || N < 1 || !X_real || !X_imag || !x) return -1;
+
+    int cols = N / 2 + 1;
+    size_t count = (size_t)M * cols;
+    FFT_REAL *tmp = (FFT_REAL *)malloc(2 * count * sizeof(FFT_REAL));
+    if (!tmp) {
+        printf("内存分配失败\n");
+        return -1;
+    }
+    FFT_REAL *tmp_real = tmp, *tmp_imag = tmp + count;
+    memcpy(tmp_real, X_real, count * sizeof(FFT_REAL));
+    memcpy(tmp_imag, X_imag, count * sizeof(FFT_REAL));
+
+    // 第一步: 对 N/2+1 列做复数逆变换
+    if (FFT_ID(columns)(tmp_real, tmp_imag, M, cols, cols, FFT_INVERSE) != 0) {
+        free(tmp);
+        return -1;
+    }
+
+    // 第二步: 每一行做 c2r，并归一化
+    FFT_ID(rplan) *rplan = FFT_ID(rplan_borrow)(N, FFT_INVERSE);
+    if (!rplan) {
+        free(tmp);
+        printf("内存分配失败\n");
+        return -1;
+    }
+    FFT_REAL scale = 1.0 / ((double)M * N);
+    for (int i = 0; i < M; i++) {
+        FFT_REAL *row = x + (size_t)i * N;
+        FFT_ID(execute_c2r)(rplan, tmp_real + (size_t)i * cols, tmp_imag + (size_t)i * cols, row);
+        for (int j = 0; j < N; j++) {
+            row[j] *= scale;
+        }
+    }
+    FFT_ID(rplan_return)(rplan);
+
+    free(tmp);
+    return 0;
+}
+
+/**
+ * 二维变换计划: 行/列计划与每个线程的工作区，执行时不再分配任何内存
+ */
+struct FFT_ID(plan2d) {
+    int M, N;                   // 行数、列数
+    int direction;
+    FFT_ID(plan) *row_plan;     // 长度 N
+    FFT_ID(plan) *col_plan;     // 长度 M (M == N 时与 row_plan 是同一个计划)
+    FFT_ID(batch) rows;         // M 行的批量变换
+    FFT_ID(batch) columns;      // N 列的批量变换
+    int nthreads;               // 工作区份数 (创建时的 fft_get_threads())
+    size_t work_len;            // 每份工作区的长度 (同时满足分离和交错两种格式)
+    FFT_REAL *work;             // nthreads * work_len
+    int busy;                   // 同 plan->busy
+};
+
+typedef struct FFT_ID(plan2d_cache_entry) {
+    FFT_ID(plan2d) *plan;
+    struct FFT_ID(plan2d_cache_entry) *next;
+} FFT_ID(plan2d_cache_entry);
+
+static FFT_ID(plan2d_cache_entry) *FFT_ID(plan2d_cache) = NULL;
+
+void FFT_ID(plan2d_destroy)(FFT_ID(plan2d)* plan) {
+    if (!plan) return;
+    FFT_ID(batch_release)(&plan->rows);
+    FFT_ID(batch_release)(&plan->columns);
+    if (plan->col_plan != plan->row_plan) {
+        FFT_ID(plan_destroy)(plan->col_plan);
+    }
+    FFT_ID(plan_destroy)(plan->row_plan);
+    free(plan->work);
+    free(plan);
+}
+
+FFT_ID(plan2d)* FFT_ID(plan2d_create)(int M, int N, int direction) {
+    if (M < 1 || N < 1 || (direction != FFT_FORWARD && direction != FFT_INVERSE)) {
+        return NULL;
+    }
+
+    FFT_ID(plan2d) *plan = (FFT_ID(plan2d) *)calloc(1, sizeof(FFT_ID(plan2d)));
+    if (!plan) return NULL;
+    plan->M = M;
+    plan->N = N;
+    plan->direction = direction;
+    plan->row_plan = FFT_ID(plan_create_direct)(N, direction);
+    plan->col_plan = (M == N) ? plan->row_plan : FFT_ID(plan_create_direct)(M, direction);
+    if (!plan->row_plan || !plan->col_plan ||
+        FFT_ID(batch_init)(&plan->rows, plan->row_plan, M, 1) != 0 ||
+        FFT_ID(batch_init)(&plan->columns, plan->col_plan, N, 2 * N) != 0) {  // 交错格式的列跨度为 2N
+        FFT_ID(plan2d_destroy)(plan);
+        return NULL;
+    }
+
+    // 按交错格式计算工作区，分离格式需要的更少
+    FFT_ID(2d_task) layout;
+    memset(&layout, 0, sizeof(layout));
+    layout.M = M;
+    layout.N = N;
+    layout.interleaved = 1;
+    layout.rows = &plan->rows;
+    layout.columns = &plan->columns;
+    FFT_ID(2d_work_layout)(&layout);
+
+    plan->work_len = layout.work_len;
+    plan->nthreads = fft_get_threads();
+    plan->work = (FFT_REAL *)malloc((size_t)plan->nthreads * plan->work_len * sizeof(FFT_REAL));
+    if (!plan->work) {
+        FFT_ID(plan2d_destroy)(plan);
+        return NULL;
+    }
+    return plan;
+}
+
+/**
+ * 在缓存中查找二维计划，不存在时创建 (调用者持有 cache_lock)
+ */
+static FFT_ID(plan2d)* FFT_ID(plan2d_lookup)(int M, int N, int direction) {
+    int threads = fft_get_threads();
+    for (FFT_ID(plan2d_cache_entry) *e = FFT_ID(plan2d_cache); e; e = e->next) {
+        FFT_ID(plan2d) *plan = e->plan;
+        if (plan->M != M || plan->N != N || plan->direction != direction) {
+            continue;
+        }
+        // 线程数调大后工作区份数不够，另建计划插在缓存最前面；
+        // 旧计划可能仍被调用者持有 (执行时线程数不超过它自己的工作区份数)，留到缓存清空
+        if (plan->nthreads >= threads) return plan;
+        break;
+    }
+
+    FFT_ID(plan2d_cache_entry) *entry = (FFT_ID(plan2d_cache_entry) *)malloc(sizeof(FFT_ID(plan2d_cache_entry)));
+    if (!entry) return NULL;
+    entry->plan = FFT_ID(plan2d_create)(M, N, direction);
+    if (!entry->plan) {
+        free(entry);
+        return NULL;
+    }
+    entry->next = FFT_ID(plan2d_cache);
+    FFT_ID(plan2d_cache) = entry;
+    return entry->plan;
+}
+
+FFT_ID(plan2d)* FFT_ID(plan2d_get)(int M, int N, int direction) {
+    pthread_mutex_lock(&FFT_ID(cache_lock));
+    FFT_ID(plan2d) *plan = FFT_ID(plan2d_lookup)(M, N, direction);
+    pthread_mutex_unlock(&FFT_ID(cache_lock));
+    return plan;
+}
+
+/**
+ * 借用/归还缓存中的二维计划 (同 plan_borrow / plan_return)
+ */
+static FFT_ID(plan2d)* FFT_ID(plan2d_borrow)(int M, int N, int direction) {
+    pthread_mutex_lock(&FFT_ID(cache_lock));
+    FFT_ID(plan2d) *plan = FFT_ID(plan2d_lookup)(M, N, direction);
+    int shared = plan && !plan->busy;
+    if (shared) plan->busy = 1;
+    pthread_mutex_unlock(&FFT_ID(cache_lock));
+    return shared ? plan : FFT_ID(plan2d_create)(M, N, direction);
+}
+
+static void FFT_ID(plan2d_return)(FFT_ID(plan2d)* plan) {
+    pthread_mutex_lock(&FFT_ID(cache_lock));
+    int shared = plan->busy;
+    plan->busy = 0;
+    pthread_mutex_unlock(&FFT_ID(cache_lock));
+    if (!shared) FFT_ID(plan2d_destroy)(plan);
+}
+
+static void FFT_ID(plan2d_cache_release)(void) {
+    while (FFT_ID(plan2d_cache)) {
+        FFT_ID(plan2d_cache_entry) *next = FFT_ID(plan2d_cache)->next;
+        FFT_ID(plan2d_destroy)(FFT_ID(plan2d_cache)->plan);
+        free(FFT_ID(plan2d_cache));
+        FFT_ID(plan2d_cache) = next;
+    }
+}
+
+/**
+ * 用计划中的工作区执行二维变换 (不归一化)
+ * interleaved 为 1 时 re 指向交错存放的复数数组，只能原地变换
+ */
+static void FFT_ID(plan2d_task)(const FFT_ID(plan2d)* plan, FFT_ID(2d_task)* task,
+                                const FFT_REAL* in_real, const FFT_REAL* in_imag,
+                                FFT_REAL* re, FFT_REAL* im, int interleaved) {
+    task->in_real = in_real;
+    task->in_imag = in_imag;
+    task->re = re;
+    task->im = im;
+    task->interleaved = interleaved;
+    task->M = plan->M;
+    task->N = plan->N;
+    task->cols = plan->N;
+    task->stride = plan->N;
+    task->rows = &plan->rows;
+    task->columns = &plan->columns;
+    task->work = plan->work;
+    task->work_len = plan->work_len;
+}
+
+static int FFT_ID(plan2d_run)(const FFT_ID(plan2d)* plan, const FFT_REAL* in_real, const FFT_REAL* in_imag,
+                              FFT_REAL* re, FFT_REAL* im, int interleaved) {
+    FFT_ID(2d_task) task;
+    FFT_ID(plan2d_task)(plan, &task, in_real, in_imag, re, im, interleaved);
+    return FFT_ID(2d_dispatch)(&task, plan->nthreads);
+}
+
+int FFT_ID(execute_2d)(const FFT_ID(plan2d)* plan, FFT_REAL* re, FFT_REAL* im) {
+    if (!plan || !re || !im) return -1;
+    return FFT_ID(plan2d_run)(plan, re, im, re, im, 0);
+}
+
+int FFT_ID(execute_2d_interleaved)(const FFT_ID(plan2d)* plan, FFT_REAL* data) {
+    if (!plan || !data) return -1;
+    return FFT_ID(plan2d_run)(plan, NULL, NULL, data, NULL, 1);
+}
+
+/**
+ * 多层二维变换的一次并行执行: 各线程整层领取，每层在线程自己的工作区中完成行、列两个阶段
+ * (以单成员线程组运行 2d_worker，层内没有屏障和共享计数器的竞争)
+ */
+typedef struct {
+    const FFT_ID(plan2d) *plan;
+    const FFT_REAL *in_real, *in_imag;
+    FFT_REAL *re, *im;
+    int howmany;
+    int next;                   // 下一个待领取的层
+} FFT_ID(2d_many_task);
+
+static void FFT_ID(2d_many_worker)(fft_team* team, void* arg, int member) {
+    FFT_ID(2d_many_task) *task = (FFT_ID(2d_many_task) *)arg;
+    const FFT_ID(plan2d) *plan = task->plan;
+    size_t plane = (size_t)plan->M * plan->N;
+    int begin;
+
+    while (fft_team_claim(team, &task->next, task->howmany, 1, &begin) > 0) {
+        size_t offset = (size_t)begin * plane;
+        FFT_ID(2d_task) slice;
+        FFT_ID(plan2d_task)(plan, &slice, task->in_real + offset,
+                            task->in_imag ? task->in_imag + offset : NULL,
+                            task->re + offset, task->im + offset, 0);
+        slice.work = plan->work + (size_t)member * plan->work_len;
+        slice.next_row = 0;
+        slice.next_col = 0;
+        fft_team_run(FFT_ID(2d_worker), &slice, 1);
+    }
+}
+
+/**
+ * howmany 层的二维变换 (第 k 层从 k * M * N 开始): 层数不少于线程数或每层很小时按层并行，
+ * 否则逐层执行、层内并行。两种方式的每一层都与单独的二维变换逐位一致
+ */
+static int FFT_ID(2d_many_run)(const FFT_ID(plan2d)* plan, const FFT_REAL* in_real, const FFT_REAL* in_imag,
+                               FFT_REAL* re, FFT_REAL* im, int howmany) {
+    size_t plane = (size_t)plan->M * plan->N;
+    int nthreads = plan->nthreads;
+    if (howmany < nthreads && plane >= FFT_PARALLEL_MIN) {
+        for (int k = 0; k < howmany; k++) {
+            size_t offset = (size_t)k * plane;
+            if (FFT_ID(plan2d_run)(plan, in_real + offset, in_imag ? in_imag + offset : NULL,
+                                   re + offset, im + offset, 0) != 0) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    FFT_ID(2d_many_task) task;
+    task.plan = plan;
+    task.in_real = in_real;
+    task.in_imag = in_imag;
+    task.re = re;
+    task.im = im;
+    task.howmany = howmany;
+    task.next = 0;
+
+    FFT_SIMD_KERNELS();
+
+    if (plane * howmany < FFT_PARALLEL_MIN) nthreads = 1;
+    if (nthreads > howmany) nthreads = howmany;
+    fft_team_run(FFT_ID(2d_many_worker), &task, nthreads);
+    return 0;
+}
+
+int FFT_ID(execute_2d_many)(const FFT_ID(plan2d)* plan, FFT_REAL* re, FFT_REAL* im, int howmany) {
+    if (!plan || !re || !im || howmany < 1) return -1;
+    return FFT_ID(2d_many_run)(plan, re, im, re, im, howmany);
+}
+
+/**
+ * 多层二维变换或三维变换的公共部分: 先对各层做二维变换，depth_pass 时再对深度方向做批量一维变换
+ * (M*N 个长度为 D 的信号，样本跨度 M*N)；逆变换最后除以参与变换的总点数
+ */
+static int FFT_ID(volume_run)(const FFT_REAL* in_real, const FFT_REAL* in_imag, int D, int M, int N,
+                              FFT_REAL* out_real, FFT_REAL* out_imag, int direction, int depth_pass) {
+    if (D < 1 || M < 1 || N < 1 || !in_real || !out_real || !out_imag ||
+        (size_t)M * N > 0x7fffffff) {
+        return -1;
+    }
+    FFT_ID(plan2d) *plan = FFT_ID(plan2d_borrow)(M, N, direction);
+    if (!plan) {
+        printf("内存分配失败\n");
+        return -1;
+    }
+    int result = FFT_ID(2d_many_run)(plan, in_real, in_imag, out_real, out_imag, D);
+    FFT_ID(plan2d_return)(plan);
+    if (result != 0) {
+        return -1;
+    }
+    if (depth_pass && D > 1) {
+        int plane = M * N;
+        FFT_ID(plan_many) *depth = FFT_ID(plan_many_borrow)(D, plane, plane, 1, direction);
+        if (!depth) {
+            printf("内存分配失败\n");
+            return -1;
+        }
+        result = FFT_ID(execute_many)(depth, out_real, out_imag, out_real, out_imag);
+        FFT_ID(plan_many_return)(depth);
+        if (result != 0) {
+            return -1;
+        }
+    }
+    if (direction == FFT_INVERSE) {
+        FFT_REAL scale = 1.0 / ((double)(depth_pass ? D : 1) * M * N);
+        size_t count = (size_t)D * M * N;
+        for (size_t i = 0; i < count; i++) {
+            out_real[i] *= scale;
+            out_imag[i] *= scale;
+        }
+    }
+    return 0;
+}
+
+int FFT_ID(2d_many)(const FFT_REAL* x_real, const FFT_REAL* x_imag, int M, int N, int howmany,
+                    FFT_REAL* X_real, FFT_REAL* X_imag) {
+    return FFT_ID(volume_run)(x_real, x_imag, howmany, M, N, X_real, X_imag, FFT_FORWARD, 0);
+}
+
+int IFFT_ID(2d_many)(const FFT_REAL* X_real, const FFT_REAL* X_imag, int M, int N, int howmany,
+                     FFT_REAL* x_real, FFT_REAL* x_imag) {
+    return FFT_ID(volume_run)(X_real, X_imag, howmany, M, N, x_real, x_imag, FFT_INVERSE, 0);
+}
+
+int FFT_ID(3d)(const FFT_REAL* x_real, const FFT_REAL* x_imag, int D, int M, int N,
+               FFT_REAL* X_real, FFT_REAL* X_imag) {
+    return FFT_ID(volume_run)(x_real, x_imag, D, M, N, X_real, X_imag, FFT_FORWARD, 1);
+}
+
+int IFFT_ID(3d)(const FFT_REAL* X_real, const FFT_REAL* X_imag, int D, int M, int N,
+                FFT_REAL* x_real, FFT_REAL* x_imag) {
+    return FFT_ID(volume_run)(X_real, X_imag, D, M, N, x_real, x_imag, FFT_INVERSE, 1);
+}
+
+int FFT_ID(2d)(const FFT_REAL* x_real, const FFT_REAL* x_imag, int M, int N,
+               FFT_REAL* X_real, FFT_REAL* X_imag) {
+    if (M < 1 || N < 1 || !x_real || !X_real || !X_imag) return -1;
+    FFT_ID(plan2d) *plan = FFT_ID(plan2d_borrow)(M, N, FFT_FORWARD);
+    if (!plan) {
+        printf("内存分配失败\n");
+        return -1;
+    }
+    int result = FFT_ID(plan2d_run)(plan, x_real, x_imag, X_real, X_imag, 0);
+    FFT_ID(plan2d_return)(plan);
+    return result;
+}
+
+int IFFT_ID(2d)(const FFT_REAL* X_real, const FFT_REAL* X_imag, int M, int N,
+                FFT_REAL* x_real, FFT_REAL* x_imag) {
+    if (M < 1 || N < 1 || !X_real || !x_real || !x_imag) return -1;
+    FFT_ID(plan2d) *plan = FFT_ID(plan2d_borrow)(M, N, FFT_INVERSE);
+    if (!plan) {
+        printf("内存分配失败\n");
+        return -1;
+    }
+    int result = FFT_ID(plan2d_run)(plan, X_real, X_imag, x_real, x_imag, 0);
+    FFT_ID(plan2d_return)(plan);
+    if (result != 0) {
+        return -1;
+    }
+    FFT_REAL scale = 1.0 / ((double)M * N);
+    size_t count = (size_t)M * N;
+    for (size_t i = 0; i < count; i++) {
+        x_real[i] *= scale;
+        x_imag[i] *= scale;
+    }
+    return 0;
+}
+
+/*
+ * 已知行支撑的二维变换 (欠采样K空间的补零重建)
+ *
+ * 未采样的行全为 0: 行阶段只变换采样行，其余输出行直接置 0。
+ * 列变换的输入只在采样行上非零，按采样行的结构选择代价最小的列阶段 (M = R * Q = P * Q，W = W_M)：
+ * - 剩余类: 采样行只落在 A 个模 R 的剩余类上 (等间隔欠采样时 A = 1)
+ *   X[m] = Σ_r W^(r*m) Y_r[m mod Q]，Y_r 是第 r, r+R, r+2R, ... 行组成的长度 Q 的变换
+ * - 窗口: 采样行都在从 a 开始、长度为 Q 的循环窗口内 (低分辨率、中心采样)
+ *   X[p + P*m2] = W^(a*(p+P*m2)) Σ_k W^(k*p) W_Q^(k*m2) x[a+k]，即 P 组长度 Q 的变换
+ * - 完整: 两者都不划算时做全部 M 点列变换 (行阶段仍然跳过零行)
+ * 长度 Q 的变换都在连续的 Q x N 块上进行 (列跨度为 N，与普通二维变换的列阶段相同)。
+ */
+#define FFT_PRUNE_FULL    0
+#define FFT_PRUNE_RESIDUE 1
+#define FFT_PRUNE_WINDOW  2
+
+typedef struct {
+    const FFT_ID(plan2d) *plan;         // 行变换计划与各线程工作区
+    const FFT_REAL *in_real, *in_imag;  // in_imag 可以为 NULL
+    FFT_REAL *re, *im;                  // M x N 输出
+    int M, N, sign;
+    FFT_REAL scale;                     // 合成输出时乘上的归一化系数
+    const unsigned char *mask;          // 采样掩码
+    const int *rows;                    // 采样行 (递增)
+    int nrows;
+    int kind;                           // FFT_PRUNE_*
+    int Q, R;                           // 列变换长度，剩余类的模 (窗口分解时 R 为相位数 P)
+    int a, p;                           // 窗口起点，当前处理的相位
+    int *residues;                      // 采样行所在的剩余类
+    int blocks;                         // 剩余类分解的块数 A (窗口分解为 1)
+    FFT_REAL *u_real, *u_imag;          // blocks 个 Q x N 块
+    FFT_REAL *t_real, *t_imag;          // 窗口分解: 窗口内各行的副本 (Q x N)
+    int next;
+} FFT_ID(prune_task);
+
+/**
+ * 行阶段: 领取一段采样行，其中等间隔的连续几行作为一批变换 (间隔 step 行)
+ */
+static void FFT_ID(prune_rows_worker)(fft_team* team, void* arg, int member) {
+    FFT_ID(prune_task) *task = (FFT_ID(prune_task) *)arg;
+    const FFT_ID(plan2d) *plan = task->plan;
+    const FFT_ID(batch) *b = &plan->rows;
+    FFT_REAL *work = plan->work + (size_t)member * plan->work_len;
+    size_t N = (size_t)task->N;
+    int begin, count;
+
+    while ((count = fft_team_claim(team, &task->next, task->nrows, FFT_ROW_CHUNK, &begin)) > 0) {
+        int end = begin + count;
+        for (int k = begin; k < end; ) {
+            int step = (k + 1 < end) ? task->rows[k + 1] - task->rows[k] : 1;
+            int len = 1;
+            while (k + len < end && task->rows[k + len] - task->rows[k + len - 1] == step) len++;
+            size_t offset = (size_t)task->rows[k] * N;
+            const FFT_REAL *in_imag = task->in_imag ? task->in_imag + offset : NULL;
+            if (b->lanes && len < b->lanes) {
+                // 凑不满一组交错时逐行变换，不做多余的几路
+                len = 1;
+                FFT_ID(execute_with)(b->plan, task->in_real + offset, in_imag,
+                                     task->re + offset, task->im + offset, work);
+            } else {
+                FFT_ID(batch_run)(b, task->in_real + offset, in_imag, task->re + offset, task->im + offset,
+                                  1, (size_t)step * N, 0, len, work);
+            }
+            k += len;
+        }
+    }
+}
+
+/**
+ * 准备长度 Q 的列变换的输入块 (第 t 行):
+ * 剩余类分解的第 b 块取第 residues[b] + t*R 行 (未采样的行没有写过，按 0 填充)，
+ * 窗口分解取窗口内第 t 行的副本乘以 W^(t*p)
+ */
+static void FFT_ID(prune_gather_worker)(fft_team* team, void* arg, int member) {
+    FFT_ID(prune_task) *task = (FFT_ID(prune_task) *)arg;
+    size_t N = (size_t)task->N, block = (size_t)task->Q * N;
+    int begin, count;
+    (void)member;
+
+    while ((count = fft_team_claim(team, &task->next, task->Q, FFT_ROW_CHUNK, &begin)) > 0) {
+        for (int t = begin; t < begin + count; t++) {
+            FFT_REAL *u_real = task->u_real + (size_t)t * N, *u_imag = task->u_imag + (size_t)t * N;
+            if (task->kind == FFT_PRUNE_WINDOW) {
+                const FFT_REAL *x_real = task->t_real + (size_t)t * N, *x_imag = task->t_imag + (size_t)t * N;
+                FFT_REAL wr, wi;
+                FFT_ID(set_twiddle)((long long)t * task->p, task->M, task->sign, &wr, &wi);
+                for (size_t j = 0; j < N; j++) {
+                    u_real[j] = x_real[j] * wr - x_imag[j] * wi;
+                    u_imag[j] = x_real[j] * wi + x_imag[j] * wr;
+                }
+                continue;
+            }
+            for (int b = 0; b < task->blocks; b++) {
+                int row = task->residues[b] + t * task->R;
+                if (task->mask[row]) {
+                    memcpy(u_real + b * block, task->re + (size_t)row * N, N * sizeof(FFT_REAL));
+                    memcpy(u_imag + b * block, task->im + (size_t)row * N, N * sizeof(FFT_REAL));
+                } else {
+                    memset(u_real + b * block, 0, N * sizeof(FFT_REAL));
+                    memset(u_imag + b * block, 0, N * sizeof(FFT_REAL));
+                }
+            }
+        }
+    }
+}
+
+/**
+ * 由列变换的结果合成输出行 (见上面的两个公式)，同时乘上归一化系数
+ * 剩余类分解领取全部 M 行；窗口分解领取 Q 行，第 m2 行写到输出的第 p + P*m2 行
+ */
+static void FFT_ID(prune_scatter_worker)(fft_team* team, void* arg, int member) {
+    FFT_ID(prune_task) *task = (FFT_ID(prune_task) *)arg;
+    size_t N = (size_t)task->N, block = (size_t)task->Q * N;
+    int items = task->kind == FFT_PRUNE_WINDOW ? task->Q : task->M;
+    int begin, count;
+    (void)member;
+
+    while ((count = fft_team_claim(team, &task->next, items, FFT_ROW_CHUNK, &begin)) > 0) {
+        for (int k = begin; k < begin + count; k++) {
+            FFT_REAL wr, wi;
+            if (task->kind == FFT_PRUNE_WINDOW) {
+                int m = task->p + task->R * k;
+                FFT_REAL *x_real = task->re + (size_t)m * N, *x_imag = task->im + (size_t)m * N;
+                const FFT_REAL *u_real = task->u_real + (size_t)k * N, *u_imag = task->u_imag + (size_t)k * N;
+                FFT_ID(set_twiddle)((long long)task->a * m, task->M, task->sign, &wr, &wi);
+                wr *= task->scale;
+                wi *= task->scale;
+                for (size_t j = 0; j < N; j++) {
+                    x_real[j] = u_real[j] * wr - u_imag[j] * wi;
+                    x_imag[j] = u_real[j] * wi + u_imag[j] * wr;
+                }
+                continue;
+            }
+            FFT_REAL *x_real = task->re + (size_t)k * N, *x_imag = task->im + (size_t)k * N;
+            size_t offset = (size_t)(k % task->Q) * N;
+            for (int b = 0; b < task->blocks; b++) {
+                const FFT_REAL *y_real = task->u_real + b * block + offset;
+                const FFT_REAL *y_imag = task->u_imag + b * block + offset;
+                FFT_ID(set_twiddle)((long long)task->residues[b] * k, task->M, task->sign, &wr, &wi);
+                wr *= task->scale;
+                wi *= task->scale;
+                if (b == 0) {
+                    for (size_t j = 0; j < N; j++) {
+                        x_real[j] = y_real[j] * wr - y_imag[j] * wi;
+                        x_imag[j] = y_real[j] * wi + y_imag[j] * wr;
+                    }
+                } else {
+                    for (size_t j = 0; j < N; j++) {
+                        x_real[j] += y_real[j] * wr - y_imag[j] * wi;
+                        x_imag[j] += y_real[j] * wi + y_imag[j] * wr;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * 运行剪枝变换的一个阶段
+ * @param items 可领取的行数
+ * @param max_threads 大于 0 时限制线程数 (行阶段使用计划中的工作区)
+ */
+static void FFT_ID(prune_dispatch)(FFT_ID(prune_task)* task, void (*worker)(fft_team*, void*, int),
+                                   int items, int max_threads) {
+    int nthreads = fft_get_threads();
+    int max_chunks = (items + FFT_ROW_CHUNK - 1) / FFT_ROW_CHUNK;
+    if ((size_t)items * task->N < FFT_PARALLEL_MIN) nthreads = 1;
+    if (nthreads > max_chunks) nthreads = max_chunks;
+    if (max_threads > 0 && nthreads > max_threads) nthreads = max_threads;
+    task->next = 0;
+    fft_team_run(worker, task, nthreads);
+}
+
+static double FFT_ID(prune_log2)(int n) {
+    return n > 1 ? log((double)n) / log(2.0) : 0.0;
+}
+
+/**
+ * 按采样行选择列阶段: 以每列的复数乘加次数估计代价，不比完整列变换省时则返回 FFT_PRUNE_FULL
+ * 剩余类分解时 task->residues 由本函数分配
+ */
+static int FFT_ID(prune_choose)(FFT_ID(prune_task)* task) {
+    int M = task->M, K = task->nrows;
+    double best = (double)M * FFT_ID(prune_log2)(M);
+    int kind = FFT_PRUNE_FULL, best_R = 1;
+
+    // 剩余类: 每个剩余类一次 Q 点变换，合成时每个输出行累加 A 项
+    unsigned char *seen = (unsigned char *)malloc((size_t)M);
+    if (!seen) return FFT_PRUNE_FULL;
+    for (int R = 2; R <= M; R++) {
+        if (M % R != 0) continue;
+        int Q = M / R, A = 0;
+        memset(seen, 0, (size_t)R);
+        for (int k = 0; k < K; k++) {
+            int r = task->rows[k] % R;
+            A += !seen[r];
+            seen[r] = 1;
+        }
+        double cost = (double)A * Q * (FFT_ID(prune_log2)(Q) + 1.0) + (double)M * A;
+        if (cost < best) {
+            best = cost;
+            kind = FFT_PRUNE_RESIDUE;
+            best_R = R;
+        }
+    }
+
+    // 窗口: 最长的循环零行间隔之外就是包含全部采样行的最短窗口
+    int gap = 0, gap_end = task->rows[0];
+    for (int k = 0; k < K; k++) {
+        int g = (K == 1) ? M - 1 : (task->rows[k] - task->rows[(k + K - 1) % K] - 1 + M) % M;
+        if (g > gap) {
+            gap = g;
+            gap_end = task->rows[k];
+        }
+    }
+    int window_Q = 0;
+    for (int Q = M - gap; Q < M && !window_Q; Q++) {
+        if (M % Q == 0) window_Q = Q;
+    }
+    if (window_Q > 0 && (double)M * (FFT_ID(prune_log2)(window_Q) + 2.0) < best) {
+        kind = FFT_PRUNE_WINDOW;
+    }
+
+    if (kind == FFT_PRUNE_WINDOW) {
+        task->Q = window_Q;
+        task->R = M / window_Q;
+        task->a = gap_end;
+        task->blocks = 1;
+    } else if (kind == FFT_PRUNE_RESIDUE) {
+        task->R = best_R;
+        task->Q = M / best_R;
+        task->residues = (int *)malloc((size_t)best_R * sizeof(int));
+        if (!task->residues) kind = FFT_PRUNE_FULL;
+        task->blocks = 0;
+        memset(seen, 0, (size_t)best_R);
+        for (int k = 0; kind != FFT_PRUNE_FULL && k < K; k++) {
+            int r = task->rows[k] % best_R;
+            if (!seen[r]) task->residues[task->blocks++] = r;
+            seen[r] = 1;
+        }
+    }
+    free(seen);
+    return kind;
+}
+
+int FFT_ID(row_mask)(const FFT_REAL* re, const FFT_REAL* im, int M, int N, unsigned char* mask) {
+    if (M < 1 || N < 1 || !re || !mask) return -1;
+    int count = 0;
+    for (int i = 0; i < M; i++) {
+        const FFT_REAL *row_real = re + (size_t)i * N, *row_imag = im ? im + (size_t)i * N : NULL;
+        int j = 0;
+        // 采样行通常在开头几个元素就能确定
+        while (j < N && row_real[j] == 0 && (!row_imag || row_imag[j] == 0)) j++;
+        mask[i] = j < N;
+        count += mask[i];
+    }
+    return count;
+}
+
+/**
+ * 输出乘以归一化系数 (scale 为 1 时不做)
+ */
+static void FFT_ID(prune_scale)(FFT_REAL* re, FFT_REAL* im, size_t count, FFT_REAL scale) {
+    if (scale == 1) return;
+    for (size_t i = 0; i < count; i++) {
+        re[i] *= scale;
+        im[i] *= scale;
+    }
+}
+
+/**
+ * 剪枝的二维变换 (结果乘以 scale)，输入与输出可以是同一组数组
+ * @param row_mask NULL 表示检测全零行
+ */
+static int FFT_ID(2d_pruned_run)(const FFT_REAL* in_real, const FFT_REAL* in_imag, int M, int N,
+                                 const unsigned char* row_mask, FFT_REAL* re, FFT_REAL* im,
+                                 int direction, FFT_REAL scale) {
+    FFT_ID(plan2d) *plan = FFT_ID(plan2d_borrow)(M, N, direction);
+    int *rows = (int *)malloc((size_t)M * sizeof(int));
+    unsigned char *detected = row_mask ? NULL : (unsigned char *)malloc((size_t)M);
+    if (!plan || !rows || (!row_mask && !detected)) {
+        if (plan) FFT_ID(plan2d_return)(plan);
+        free(rows);
+        free(detected);
+        printf("内存分配失败\n");
+        return -1;
+    }
+    if (!row_mask) {
+        FFT_ID(row_mask)(in_real, in_imag, M, N, detected);
+    }
+
+    FFT_ID(prune_task) task;
+    memset(&task, 0, sizeof(task));
+    task.plan = plan;
+    task.in_real = in_real;
+    task.in_imag = in_imag;
+    task.re = re;
+    task.im = im;
+    task.M = M;
+    task.N = N;
+    task.sign = direction;
+    task.scale = scale;
+    task.mask = row_mask ? row_mask : detected;
+    task.rows = rows;
+    for (int i = 0; i < M; i++) {
+        if (task.mask[i]) {
+            rows[task.nrows++] = i;
+        }
+    }
+
+    int result = 0;
+    size_t count = (size_t)M * N;
+    if (task.nrows == M) {
+        // 全采样时就是普通的二维变换
+        result = FFT_ID(plan2d_run)(plan, in_real, in_imag, re, im, 0);
+        if (result == 0) FFT_ID(prune_scale)(re, im, count, scale);
+    } else if (task.nrows == 0) {
+        memset(re, 0, count * sizeof(FFT_REAL));
+        memset(im, 0, count * sizeof(FFT_REAL));
+    } else {
+        task.kind = FFT_ID(prune_choose)(&task);
+        if (task.kind != FFT_PRUNE_FULL) {
+            size_t u_len = (size_t)task.Q * task.blocks * N;
+            task.u_real = (FFT_REAL *)malloc(u_len * sizeof(FFT_REAL));
+            task.u_imag = (FFT_REAL *)malloc(u_len * sizeof(FFT_REAL));
+            if (task.kind == FFT_PRUNE_WINDOW) {
+                task.t_real = (FFT_REAL *)malloc(u_len * sizeof(FFT_REAL));
+                task.t_imag = (FFT_REAL *)malloc(u_len * sizeof(FFT_REAL));
+            }
+            if (!task.u_real || !task.u_imag || (task.kind == FFT_PRUNE_WINDOW && (!task.t_real || !task.t_imag))) {
+                // 中间矩阵分配失败时退回完整的列变换
+                task.kind = FFT_PRUNE_FULL;
+            }
+        }
+
+        FFT_SIMD_KERNELS();
+        FFT_ID(prune_dispatch)(&task, FFT_ID(prune_rows_worker), task.nrows, plan->nthreads);
+
+        if (task.kind == FFT_PRUNE_FULL) {
+            // 未采样的行按 0 处理 (掩码为 0 的行即使有数据也忽略)
+            for (int i = 0; i < M; i++) {
+                if (!task.mask[i]) {
+                    memset(re + (size_t)i * N, 0, (size_t)N * sizeof(FFT_REAL));
+                    memset(im + (size_t)i * N, 0, (size_t)N * sizeof(FFT_REAL));
+                }
+            }
+            FFT_ID(2d_task) columns;
+            FFT_ID(plan2d_task)(plan, &columns, NULL, NULL, re, im, 0);
+            columns.rows = NULL;
+            result = FFT_ID(2d_dispatch)(&columns, plan->nthreads);
+            if (result == 0) FFT_ID(prune_scale)(re, im, count, scale);
+        } else if (task.kind == FFT_PRUNE_RESIDUE) {
+            size_t block = (size_t)task.Q * N;
+            FFT_ID(prune_dispatch)(&task, FFT_ID(prune_gather_worker), task.Q, 0);
+            for (int b = 0; b < task.blocks && result == 0 && task.Q > 1; b++) {
+                result = FFT_ID(columns)(task.u_real + b * block, task.u_imag + b * block, task.Q, N, N, direction);
+            }
+            if (result == 0) {
+                FFT_ID(prune_dispatch)(&task, FFT_ID(prune_scatter_worker), M, 0);
+            }
+        } else {
+            // 输出行会被依次覆盖，先复制窗口内的行，再逐个相位完成 Q 点变换
+            for (int t = 0; t < task.Q; t++) {
+                int row = (task.a + t) % M;
+                FFT_REAL *t_real = task.t_real + (size_t)t * N, *t_imag = task.t_imag + (size_t)t * N;
+                if (task.mask[row]) {
+                    memcpy(t_real, re + (size_t)row * N, (size_t)N * sizeof(FFT_REAL));
+                    memcpy(t_imag, im + (size_t)row * N, (size_t)N * sizeof(FFT_REAL));
+                } else {
+                    memset(t_real, 0, (size_t)N * sizeof(FFT_REAL));
+                    memset(t_imag, 0, (size_t)N * sizeof(FFT_REAL));
+                }
+            }
+            for (task.p = 0; task.p < task.R && result == 0; task.p++) {
+                FFT_ID(prune_dispatch)(&task, FFT_ID(prune_gather_worker), task.Q, 0);
+                if (task.Q > 1) {
+                    result = FFT_ID(columns)(task.u_real, task.u_imag, task.Q, N, N, direction);
+                }
+                if (result == 0) {
+                    FFT_ID(prune_dispatch)(&task, FFT_ID(prune_scatter_worker), task.Q, 0);
+                }
+            }
+        }
+    }
+
+    free(task.u_real);
+    free(task.u_imag);
+    free(task.t_real);
+    free(task.t_imag);
+    free(task.residues);
+    free(detected);
+    free(rows);
+    FFT_ID(plan2d_return)(plan);
+    return result;
+}
+
+int FFT_ID(2d_pruned)(const FFT_REAL* x_real, const FFT_REAL* x_imag, int M, int N,
+                      const unsigned char* row_mask, FFT_REAL* X_real, FFT_REAL* X_imag) {
+    if (M < 1 || N < 1 || !x_real || !X_real || !X_imag) return -1;
+    return FFT_ID(2d_pruned_run)(x_real, x_imag, M, N, row_mask, X_real, X_imag, FFT_FORWARD, 1);
+}
+
+int IFFT_ID(2d_pruned)(const FFT_REAL* X_real, const FFT_REAL* X_imag, int M, int N,
+                       const unsigned char* row_mask, FFT_REAL* x_real, FFT_REAL* x_imag) {
+    if (M < 1 || N < 1 || !X_real || !x_real || !x_imag) return -1;
+    return FFT_ID(2d_pruned_run)(X_real, X_imag, M, N, row_mask, x_real, x_imag, FFT_INVERSE,
+                                 (FFT_REAL)(1.0 / ((double)M * N)));
+}
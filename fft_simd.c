@@ -0,0 +1,222 @@
+/**
+ * @file fft_simd.c
+ * @brief 蝶形运算的 SSE2 / AVX2 / AVX-512 内核与运行时分派
+ *
+ * 各指令集、各精度的内核由同一个模板 fft_simd_kernels.h 生成，
+ * 通过 GCC 的 target 属性编译，不需要额外的编译选项：
+ * Makefile 仍然使用 -O2，生成的可执行文件在只支持 SSE2 的机器上也能运行。
+ *
+ * 选择顺序:
+ * 1. fft_simd_set_level() 显式指定
+ * 2. 环境变量 FFT_SIMD=scalar|sse2|avx2|avx512
+ * 3. cpuid 检测到的最宽指令集
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fft.h"
+#include "fft_simd.h"
+
+static const char *fft_simd_names[] = {"scalar", "sse2", "avx2", "avx512"};
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define FFT_SIMD_X86 1
+#include <immintrin.h>
+
+/* ---------------- SSE2: 2 x double / 4 x float ---------------- */
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#define VS              double
+#define VT              __m128d
+#define VW              2
+#define VLOAD(p)        _mm_loadu_pd(p)
+#define VSTORE(p, v)    _mm_storeu_pd((p), (v))
+#define VADD(a, b)      _mm_add_pd((a), (b))
+#define VSUB(a, b)      _mm_sub_pd((a), (b))
+#define VMUL(a, b)      _mm_mul_pd((a), (b))
+#define VFMA(a, b, c)   _mm_add_pd(_mm_mul_pd((a), (b)), (c))
+#define VFMS(a, b, c)   _mm_sub_pd(_mm_mul_pd((a), (b)), (c))
+#define VSET1(x)        _mm_set1_pd(x)
+#define FFT_SIMD_FN(x)  fft_##x##_sse2
+#include "fft_simd_kernels.h"
+
+#define VS              float
+#define VT              __m128
+#define VW              4
+#define VLOAD(p)        _mm_loadu_ps(p)
+#define VSTORE(p, v)    _mm_storeu_ps((p), (v))
+#define VADD(a, b)      _mm_add_ps((a), (b))
+#define VSUB(a, b)      _mm_sub_ps((a), (b))
+#define VMUL(a, b)      _mm_mul_ps((a), (b))
+#define VFMA(a, b, c)   _mm_add_ps(_mm_mul_ps((a), (b)), (c))
+#define VFMS(a, b, c)   _mm_sub_ps(_mm_mul_ps((a), (b)), (c))
+#define VSET1(x)        _mm_set1_ps(x)
+#define FFT_SIMD_FN(x)  fftf_##x##_sse2
+#include "fft_simd_kernels.h"
+#pragma GCC pop_options
+
+/* ---------------- AVX2 + FMA: 4 x double / 8 x float ---------------- */
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#define VS              double
+#define VT              __m256d
+#define VW              4
+#define VLOAD(p)        _mm256_loadu_pd(p)
+#define VSTORE(p, v)    _mm256_storeu_pd((p), (v))
+#define VADD(a, b)      _mm256_add_pd((a), (b))
+#define VSUB(a, b)      _mm256_sub_pd((a), (b))
+#define VMUL(a, b)      _mm256_mul_pd((a), (b))
+#define VFMA(a, b, c)   _mm256_fmadd_pd((a), (b), (c))
+#define VFMS(a, b, c)   _mm256_fmsub_pd((a), (b), (c))
+#define VSET1(x)        _mm256_set1_pd(x)
+#define FFT_SIMD_FN(x)  fft_##x##_avx2
+#include "fft_simd_kernels.h"
+
+#define VS              float
+#define VT              __m256
+#define VW              8
+#define VLOAD(p)        _mm256_loadu_ps(p)
+#define VSTORE(p, v)    _mm256_storeu_ps((p), (v))
+#define VADD(a, b)      _mm256_add_ps((a), (b))
+#define VSUB(a, b)      _mm256_sub_ps((a), (b))
+#define VMUL(a, b)      _mm256_mul_ps((a), (b))
+#define VFMA(a, b, c)   _mm256_fmadd_ps((a), (b), (c))
+#define VFMS(a, b, c)   _mm256_fmsub_ps((a), (b), (c))
+#define VSET1(x)        _mm256_set1_ps(x)
+#define FFT_SIMD_FN(x)  fftf_##x##_avx2
+#include "fft_simd_kernels.h"
+#pragma GCC pop_options
+
+/* ---------------- AVX-512F: 8 x double / 16 x float ---------------- */
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#define VS              double
+#define VT              __m512d
+#define VW              8
+#define VLOAD(p)        _mm512_loadu_pd(p)
+#define VSTORE(p, v)    _mm512_storeu_pd((p), (v))
+#define VADD(a, b)      _mm512_add_pd((a), (b))
+#define VSUB(a, b)      _mm512_sub_pd((a), (b))
+#define VMUL(a, b)      _mm512_mul_pd((a), (b))
+#define VFMA(a, b, c)   _mm512_fmadd_pd((a), (b), (c))
+#define VFMS(a, b, c)   _mm512_fmsub_pd((a), (b), (c))
+#define VSET1(x)        _mm512_set1_pd(x)
+#define FFT_SIMD_FN(x)  fft_##x##_avx512
+#include "fft_simd_kernels.h"
+
+#define VS              float
+#define VT              __m512
+#define VW              16
+#define VLOAD(p)        _mm512_loadu_ps(p)
+#define VSTORE(p, v)    _mm512_storeu_ps((p), (v))
+#define VADD(a, b)      _mm512_add_ps((a), (b))
+#define VSUB(a, b)      _mm512_sub_ps((a), (b))
+#define VMUL(a, b)      _mm512_mul_ps((a), (b))
+#define VFMA(a, b, c)   _mm512_fmadd_ps((a), (b), (c))
+#define VFMS(a, b, c)   _mm512_fmsub_ps((a), (b), (c))
+#define VSET1(x)        _mm512_set1_ps(x)
+#define FFT_SIMD_FN(x)  fftf_##x##_avx512
+#include "fft_simd_kernels.h"
+#pragma GCC pop_options
+
+static const fft_kernels fft_kernel_table[] = {
+    {"sse2",   2, fft_radix2_sse2,   fft_radix3_sse2,   fft_radix4_sse2,   fft_radix5_sse2},
+    {"avx2",   4, fft_radix2_avx2,   fft_radix3_avx2,   fft_radix4_avx2,   fft_radix5_avx2},
+    {"avx512", 8, fft_radix2_avx512, fft_radix3_avx512, fft_radix4_avx512, fft_radix5_avx512},
+};
+
+static const fftf_kernels fftf_kernel_table[] = {
+    {"sse2",   4,  fftf_radix2_sse2,   fftf_radix3_sse2,   fftf_radix4_sse2,   fftf_radix5_sse2},
+    {"avx2",   8,  fftf_radix2_avx2,   fftf_radix3_avx2,   fftf_radix4_avx2,   fftf_radix5_avx2},
+    {"avx512", 16, fftf_radix2_avx512, fftf_radix3_avx512, fftf_radix4_avx512, fftf_radix5_avx512},
+};
+#endif
+
+static int fft_simd_level = -1;     // -1 表示尚未选择
+
+/**
+ * 检测 CPU 支持的最高级别
+ */
+static int fft_simd_detect(void) {
+#ifdef FFT_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return FFT_SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return FFT_SIMD_AVX2;
+    if (__builtin_cpu_supports("sse2")) return FFT_SIMD_SSE2;
+#endif
+    return FFT_SIMD_SCALAR;
+}
+
+int fft_simd_best_level(void) {
+    static int best = -1;
+    if (best < 0) {
+        best = fft_simd_detect();
+    }
+    return best;
+}
+
+int fft_simd_set_level(int level) {
+    if (level == FFT_SIMD_AUTO) {
+        fft_simd_level = fft_simd_best_level();
+        return 0;
+    }
+    if (level < FFT_SIMD_SCALAR || level > FFT_SIMD_AVX512 || level > fft_simd_best_level()) {
+        return -1;
+    }
+    fft_simd_level = level;
+    return 0;
+}
+
+int fft_simd_get_level(void) {
+    if (fft_simd_level < 0) {
+        // 第一次使用: 环境变量优先，其次自动检测
+        const char *env = getenv("FFT_SIMD");
+        int level = FFT_SIMD_AUTO;
+        if (env && *env) {
+            for (int i = FFT_SIMD_SCALAR; i <= FFT_SIMD_AVX512; i++) {
+                if (strcmp(env, fft_simd_names[i]) == 0) {
+                    level = i;
+                }
+            }
+            if (level == FFT_SIMD_AUTO && strcmp(env, "auto") != 0) {
+                fprintf(stderr, "警告: 未知的 FFT_SIMD=%s，使用自动检测\n", env);
+            }
+        }
+        if (fft_simd_set_level(level) != 0) {
+            fprintf(stderr, "警告: 当前 CPU 不支持 FFT_SIMD=%s，使用自动检测\n", env);
+            fft_simd_set_level(FFT_SIMD_AUTO);
+        }
+    }
+    return fft_simd_level;
+}
+
+const char* fft_simd_level_name(int level) {
+    if (level < FFT_SIMD_SCALAR || level > FFT_SIMD_AVX512) {
+        return "unknown";
+    }
+    return fft_simd_names[level];
+}
+
+const fft_kernels* fft_simd_kernels(void) {
+    int level = fft_simd_get_level();
+#ifdef FFT_SIMD_X86
+    if (level > FFT_SIMD_SCALAR) {
+        return &fft_kernel_table[level - 1];
+    }
+#endif
+    (void)level;
+    return NULL;
+}
+
+const fftf_kernels* fftf_simd_kernels(void) {
+    int level = fft_simd_get_level();
+#ifdef FFT_SIMD_X86
+    if (level > FFT_SIMD_SCALAR) {
+        return &fftf_kernel_table[level - 1];
+    }
+#endif
+    (void)level;
+    return NULL;
+}
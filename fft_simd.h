@@ -0,0 +1,54 @@
+/**
+ * @file fft_simd.h
+ * @brief FFT 蝶形运算的 SIMD 内核与运行时分派 (模块内部接口)
+ *
+ * 每一级蝶形都是对 k = 0..m-1 的独立循环，实部/虚部分离存放使得
+ * 相邻的 k 可以直接装入同一个向量寄存器，不需要任何重排 (shuffle)。
+ * 启动时根据 cpuid 选择 AVX-512 / AVX2+FMA / SSE2 / 标量内核，
+ * 同一个可执行文件在不同的机器上都能使用最宽的向量指令。
+ */
+
+#ifndef FFT_SIMD_H
+#define FFT_SIMD_H
+
+/**
+ * 一组蝶形内核 (与 fft.c 中标量实现的参数完全一致)
+ */
+typedef struct {
+    const char *name;   // 内核名称
+    int width;          // 每个向量包含的 double 个数 (标量为 1)
+    void (*radix2)(double* re, double* im, int n, int m,
+                   const double* tw_real, const double* tw_imag);
+    void (*radix3)(double* re, double* im, int n, int m, int sign,
+                   const double* tw_real, const double* tw_imag);
+    void (*radix4)(double* re, double* im, int n, int m, int sign,
+                   const double* tw_real, const double* tw_imag);
+    void (*radix5)(double* re, double* im, int n, int m, int sign,
+                   const double* tw_real, const double* tw_imag);
+} fft_kernels;
+
+/**
+ * 单精度蝶形内核 (向量宽度是双精度的两倍)
+ */
+typedef struct {
+    const char *name;
+    int width;          // 每个向量包含的 float 个数
+    void (*radix2)(float* re, float* im, int n, int m,
+                   const float* tw_real, const float* tw_imag);
+    void (*radix3)(float* re, float* im, int n, int m, int sign,
+                   const float* tw_real, const float* tw_imag);
+    void (*radix4)(float* re, float* im, int n, int m, int sign,
+                   const float* tw_real, const float* tw_imag);
+    void (*radix5)(float* re, float* im, int n, int m, int sign,
+                   const float* tw_real, const float* tw_imag);
+} fftf_kernels;
+
+/**
+ * 获取当前使用的向量内核
+ * 第一次调用时根据 CPU 特性 (以及环境变量 FFT_SIMD) 选择；
+ * 返回 NULL 表示使用 fft.c 中的标量实现
+ */
+const fft_kernels* fft_simd_kernels(void);
+const fftf_kernels* fftf_simd_kernels(void);
+
+#endif /* FFT_SIMD_H */
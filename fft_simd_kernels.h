@@ -0,0 +1,180 @@
+/**
+ * @file fft_simd_kernels.h
+ * @brief 向量化蝶形内核模板
+ *
+ * 本文件由 fft_simd.c 针对每种指令集各包含一次，包含前需要定义：
+ *   VS               标量类型 (double 或 float)
+ *   VT               向量类型
+ *   VW               每个向量包含的元素个数
+ *   VLOAD/VSTORE     非对齐装载/存储
+ *   VADD/VSUB/VMUL   逐元素运算
+ *   VFMA(a, b, c)    a*b + c
+ *   VFMS(a, b, c)    a*b - c
+ *   VSET1(x)         广播标量
+ *   FFT_SIMD_FN(x)   生成带指令集后缀的函数名
+ *
+ * 这些宏在本文件末尾被取消定义，可以直接为下一种指令集重新定义。
+ *
+ * 调用者保证 m 是 VW 的整数倍，因此循环没有尾部处理。
+ * 运算顺序与 fft.c 中的标量实现一一对应。
+ */
+
+/* 复数乘法 t = x * w */
+#define CMUL(tr, ti, xr, xi, wr, wi)          \
+    VT tr = VFMS(xr, wr, VMUL(xi, wi));       \
+    VT ti = VFMA(xr, wi, VMUL(xi, wr))
+
+static void FFT_SIMD_FN(radix2)(VS* re, VS* im, int n, int m,
+                                const VS* tw_real, const VS* tw_imag) {
+    for (int base = 0; base < n; base += 2 * m) {
+        VS *r0 = re + base, *i0 = im + base;
+        VS *r1 = r0 + m, *i1 = i0 + m;
+        for (int k = 0; k < m; k += VW) {
+            VT wr = VLOAD(tw_real + k), wi = VLOAD(tw_imag + k);
+            VT xr = VLOAD(r1 + k), xi = VLOAD(i1 + k);
+            CMUL(tr, ti, xr, xi, wr, wi);
+            VT ar = VLOAD(r0 + k), ai = VLOAD(i0 + k);
+            VSTORE(r1 + k, VSUB(ar, tr));
+            VSTORE(i1 + k, VSUB(ai, ti));
+            VSTORE(r0 + k, VADD(ar, tr));
+            VSTORE(i0 + k, VADD(ai, ti));
+        }
+    }
+}
+
+static void FFT_SIMD_FN(radix3)(VS* re, VS* im, int n, int m, int sign,
+                                const VS* tw_real, const VS* tw_imag) {
+    const VT s60 = VSET1(sign * 0.86602540378443864676);
+    const VT half = VSET1(0.5);
+
+    for (int base = 0; base < n; base += 3 * m) {
+        VS *r0 = re + base, *i0 = im + base;
+        VS *r1 = r0 + m, *i1 = i0 + m;
+        VS *r2 = r1 + m, *i2 = i1 + m;
+        for (int k = 0; k < m; k += VW) {
+            VT x1r = VLOAD(r1 + k), x1i = VLOAD(i1 + k);
+            VT x2r = VLOAD(r2 + k), x2i = VLOAD(i2 + k);
+            VT w1r = VLOAD(tw_real + k), w1i = VLOAD(tw_imag + k);
+            VT w2r = VLOAD(tw_real + m + k), w2i = VLOAD(tw_imag + m + k);
+            CMUL(t1r, t1i, x1r, x1i, w1r, w1i);
+            CMUL(t2r, t2i, x2r, x2i, w2r, w2i);
+
+            VT x0r = VLOAD(r0 + k), x0i = VLOAD(i0 + k);
+            VT sr = VADD(t1r, t2r), si = VADD(t1i, t2i);
+            VT dr = VSUB(t1r, t2r), di = VSUB(t1i, t2i);
+            VT mr = VSUB(x0r, VMUL(half, sr)), mi = VSUB(x0i, VMUL(half, si));
+            VT ndr = VMUL(s60, dr), ndi = VMUL(s60, di);
+
+            VSTORE(r0 + k, VADD(x0r, sr));
+            VSTORE(i0 + k, VADD(x0i, si));
+            VSTORE(r1 + k, VSUB(mr, ndi));
+            VSTORE(i1 + k, VADD(mi, ndr));
+            VSTORE(r2 + k, VADD(mr, ndi));
+            VSTORE(i2 + k, VSUB(mi, ndr));
+        }
+    }
+}
+
+static void FFT_SIMD_FN(radix4)(VS* re, VS* im, int n, int m, int sign,
+                                const VS* tw_real, const VS* tw_imag) {
+    const VT vs = VSET1((VS)sign);
+
+    for (int base = 0; base < n; base += 4 * m) {
+        VS *r0 = re + base, *i0 = im + base;
+        VS *r1 = r0 + m, *i1 = i0 + m;
+        VS *r2 = r1 + m, *i2 = i1 + m;
+        VS *r3 = r2 + m, *i3 = i2 + m;
+        for (int k = 0; k < m; k += VW) {
+            // 乘旋转因子
+            VT x1r = VLOAD(r1 + k), x1i = VLOAD(i1 + k);
+            VT x2r = VLOAD(r2 + k), x2i = VLOAD(i2 + k);
+            VT x3r = VLOAD(r3 + k), x3i = VLOAD(i3 + k);
+            VT w1r = VLOAD(tw_real + k), w1i = VLOAD(tw_imag + k);
+            VT w2r = VLOAD(tw_real + m + k), w2i = VLOAD(tw_imag + m + k);
+            VT w3r = VLOAD(tw_real + 2 * m + k), w3i = VLOAD(tw_imag + 2 * m + k);
+            CMUL(t1r, t1i, x1r, x1i, w1r, w1i);
+            CMUL(t2r, t2i, x2r, x2i, w2r, w2i);
+            CMUL(t3r, t3i, x3r, x3i, w3r, w3i);
+
+            // 4 点 DFT
+            VT x0r = VLOAD(r0 + k), x0i = VLOAD(i0 + k);
+            VT ar = VADD(x0r, t2r), ai = VADD(x0i, t2i);
+            VT br = VSUB(x0r, t2r), bi = VSUB(x0i, t2i);
+            VT cr = VADD(t1r, t3r), ci = VADD(t1i, t3i);
+            VT dr = VMUL(vs, VSUB(t1r, t3r)), di = VMUL(vs, VSUB(t1i, t3i));
+
+            VSTORE(r0 + k, VADD(ar, cr));
+            VSTORE(i0 + k, VADD(ai, ci));
+            VSTORE(r2 + k, VSUB(ar, cr));
+            VSTORE(i2 + k, VSUB(ai, ci));
+            // (sign * i) * d
+            VSTORE(r1 + k, VSUB(br, di));
+            VSTORE(i1 + k, VADD(bi, dr));
+            VSTORE(r3 + k, VADD(br, di));
+            VSTORE(i3 + k, VSUB(bi, dr));
+        }
+    }
+}
+
+static void FFT_SIMD_FN(radix5)(VS* re, VS* im, int n, int m, int sign,
+                                const VS* tw_real, const VS* tw_imag) {
+    const VT c1 = VSET1(0.30901699437494742410);           // cos(2π/5)
+    const VT c2 = VSET1(-0.80901699437494742410);          // cos(4π/5)
+    const VT s1 = VSET1(sign * 0.95105651629515357212);    // sign * sin(2π/5)
+    const VT s2 = VSET1(sign * 0.58778525229247312917);    // sign * sin(4π/5)
+
+    for (int base = 0; base < n; base += 5 * m) {
+        VS *r0 = re + base, *i0 = im + base;
+        VS *r1 = r0 + m, *i1 = i0 + m;
+        VS *r2 = r1 + m, *i2 = i1 + m;
+        VS *r3 = r2 + m, *i3 = i2 + m;
+        VS *r4 = r3 + m, *i4 = i3 + m;
+        for (int k = 0; k < m; k += VW) {
+            VT x1r = VLOAD(r1 + k), x1i = VLOAD(i1 + k);
+            VT x2r = VLOAD(r2 + k), x2i = VLOAD(i2 + k);
+            VT x3r = VLOAD(r3 + k), x3i = VLOAD(i3 + k);
+            VT x4r = VLOAD(r4 + k), x4i = VLOAD(i4 + k);
+            VT w1r = VLOAD(tw_real + k), w1i = VLOAD(tw_imag + k);
+            VT w2r = VLOAD(tw_real + m + k), w2i = VLOAD(tw_imag + m + k);
+            VT w3r = VLOAD(tw_real + 2 * m + k), w3i = VLOAD(tw_imag + 2 * m + k);
+            VT w4r = VLOAD(tw_real + 3 * m + k), w4i = VLOAD(tw_imag + 3 * m + k);
+            CMUL(t1r, t1i, x1r, x1i, w1r, w1i);
+            CMUL(t2r, t2i, x2r, x2i, w2r, w2i);
+            CMUL(t3r, t3i, x3r, x3i, w3r, w3i);
+            CMUL(t4r, t4i, x4r, x4i, w4r, w4i);
+
+            VT x0r = VLOAD(r0 + k), x0i = VLOAD(i0 + k);
+            VT a1r = VADD(t1r, t4r), a1i = VADD(t1i, t4i);
+            VT b1r = VSUB(t1r, t4r), b1i = VSUB(t1i, t4i);
+            VT a2r = VADD(t2r, t3r), a2i = VADD(t2i, t3i);
+            VT b2r = VSUB(t2r, t3r), b2i = VSUB(t2i, t3i);
+
+            VT m1r = VFMA(c2, a2r, VFMA(c1, a1r, x0r)), m1i = VFMA(c2, a2i, VFMA(c1, a1i, x0i));
+            VT m2r = VFMA(c1, a2r, VFMA(c2, a1r, x0r)), m2i = VFMA(c1, a2i, VFMA(c2, a1i, x0i));
+            VT n1r = VFMA(s2, b2r, VMUL(s1, b1r)), n1i = VFMA(s2, b2i, VMUL(s1, b1i));
+            VT n2r = VFMS(s2, b1r, VMUL(s1, b2r)), n2i = VFMS(s2, b1i, VMUL(s1, b2i));
+
+            VSTORE(r0 + k, VADD(x0r, VADD(a1r, a2r)));
+            VSTORE(i0 + k, VADD(x0i, VADD(a1i, a2i)));
+            // ± i * n
+            VSTORE(r1 + k, VSUB(m1r, n1i));  VSTORE(i1 + k, VADD(m1i, n1r));
+            VSTORE(r4 + k, VADD(m1r, n1i));  VSTORE(i4 + k, VSUB(m1i, n1r));
+            VSTORE(r2 + k, VSUB(m2r, n2i));  VSTORE(i2 + k, VADD(m2i, n2r));
+            VSTORE(r3 + k, VADD(m2r, n2i));  VSTORE(i3 + k, VSUB(m2i, n2r));
+        }
+    }
+}
+
+#undef CMUL
+#undef VS
+#undef VT
+#undef VW
+#undef VLOAD
+#undef VSTORE
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef VFMA
+#undef VFMS
+#undef VSET1
+#undef FFT_SIMD_FN
@@ -0,0 +1,228 @@
+/**
+ * @file fft_thread.c
+ * @brief 线程组、屏障与线程数设置
+ *
+ * 线程数的选择顺序:
+ * 1. fft_set_threads() 显式指定
+ * 2. 环境变量 FFT_THREADS=<n>
+ * 3. 在线 CPU 核数
+ *
+ * 工作线程来自常驻线程池，只在第一次需要时创建，每次执行只是唤醒它们，不再创建和回收线程。
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "fft.h"
+#include "fft_thread.h"
+
+#define FFT_MAX_THREADS 256
+
+struct fft_team {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int threaded;               // 是否有工作线程参与 (为 0 时不使用锁)
+    int size;                   // 参与屏障的成员数
+    int waiting;                // 已到达屏障的成员数
+    unsigned generation;        // 每放行一次屏障加 1
+    fft_team_fn fn;
+    void *arg;
+};
+
+/**
+ * 线程池中每个工作线程的状态
+ */
+typedef struct {
+    int member;                 // 在线程组中的成员编号 (1 起)
+    unsigned seen;              // 已处理过的最后一轮
+} fft_pool_worker;
+
+/**
+ * 常驻线程池: 第一次需要时才创建线程，之后一直保留，空闲时在 wake 上等待。
+ * 每次 fft_team_run 把 generation 加 1 并唤醒工作线程，成员编号不超过 members 的线程参与这一轮
+ */
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;        // 有新一轮工作
+    pthread_cond_t done;        // 这一轮的工作线程全部返回
+    int started;                // 已创建的工作线程数
+    int busy;                   // 是否正在服务某个线程组
+    int members;                // 本轮参与的工作线程数
+    int remaining;              // 本轮尚未返回的工作线程数
+    unsigned generation;        // 每派发一轮加 1
+    fft_team *team;
+    fft_pool_worker workers[FFT_MAX_THREADS - 1];
+} fft_pool = { .lock = PTHREAD_MUTEX_INITIALIZER, .wake = PTHREAD_COND_INITIALIZER, .done = PTHREAD_COND_INITIALIZER };
+
+static int fft_threads = 0;     // 0 表示尚未确定
+
+/**
+ * 在线 CPU 核数
+ */
+static int fft_cpu_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1) return 1;
+    return n > FFT_MAX_THREADS ? FFT_MAX_THREADS : (int)n;
+}
+
+int fft_set_threads(int threads) {
+    if (threads < 0) {
+        return -1;
+    }
+    if (threads == 0) {
+        threads = fft_cpu_count();
+    }
+    fft_threads = threads > FFT_MAX_THREADS ? FFT_MAX_THREADS : threads;
+    return 0;
+}
+
+int fft_get_threads(void) {
+    if (fft_threads == 0) {
+        // 第一次使用: 环境变量优先，其次使用全部核
+        const char *env = getenv("FFT_THREADS");
+        int threads = 0;
+        if (env && *env) {
+            threads = atoi(env);
+            if (threads < 1) {
+                fprintf(stderr, "警告: 无效的 FFT_THREADS=%s，使用全部 CPU 核\n", env);
+                threads = 0;
+            }
+        }
+        fft_set_threads(threads);
+    }
+    return fft_threads;
+}
+
+void fft_team_barrier(fft_team* team) {
+    if (!team->threaded) return;
+
+    pthread_mutex_lock(&team->lock);
+    unsigned generation = team->generation;
+    if (++team->waiting >= team->size) {
+        team->waiting = 0;
+        team->generation++;
+        pthread_cond_broadcast(&team->cond);
+    } else {
+        while (generation == team->generation) {
+            pthread_cond_wait(&team->cond, &team->lock);
+        }
+    }
+    pthread_mutex_unlock(&team->lock);
+}
+
+int fft_team_claim(fft_team* team, int* counter, int total, int chunk, int* begin) {
+    int start, end;
+    if (team->threaded) pthread_mutex_lock(&team->lock);
+    start = *counter;
+    end = (total - start > chunk) ? start + chunk : total;
+    if (start < total) {
+        *counter = end;
+    }
+    if (team->threaded) pthread_mutex_unlock(&team->lock);
+
+    *begin = start;
+    return start < total ? end - start : 0;
+}
+
+/**
+ * 常驻线程池中的一个工作线程
+ */
+static void* fft_pool_main(void* p) {
+    fft_pool_worker *w = (fft_pool_worker *)p;
+    pthread_mutex_lock(&fft_pool.lock);
+    for (;;) {
+        while (w->seen == fft_pool.generation) {
+            pthread_cond_wait(&fft_pool.wake, &fft_pool.lock);
+        }
+        w->seen = fft_pool.generation;
+        if (w->member > fft_pool.members) {
+            continue;           // 这一轮不需要这么多线程
+        }
+        fft_team *team = fft_pool.team;
+        pthread_mutex_unlock(&fft_pool.lock);
+
+        team->fn(team, team->arg, w->member);
+
+        pthread_mutex_lock(&fft_pool.lock);
+        if (--fft_pool.remaining == 0) {
+            pthread_cond_signal(&fft_pool.done);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * 把线程池扩充到 count 个工作线程 (调用时持有 fft_pool.lock)
+ * @return 实际可用的工作线程数 (创建失败时少于 count)
+ */
+static int fft_pool_grow(int count) {
+    while (fft_pool.started < count) {
+        fft_pool_worker *w = &fft_pool.workers[fft_pool.started];
+        pthread_t thread;
+        w->member = fft_pool.started + 1;
+        w->seen = fft_pool.generation;
+        if (pthread_create(&thread, NULL, fft_pool_main, w) != 0) {
+            break;
+        }
+        pthread_detach(thread);
+        fft_pool.started++;
+    }
+    return fft_pool.started < count ? fft_pool.started : count;
+}
+
+void fft_team_run(fft_team_fn fn, void* arg, int nthreads) {
+    fft_team team;
+    team.threaded = 0;
+    team.size = 1;
+    team.waiting = 0;
+    team.generation = 0;
+    team.fn = fn;
+    team.arg = arg;
+
+    if (nthreads > FFT_MAX_THREADS) nthreads = FFT_MAX_THREADS;
+
+    // 线程池同一时间只服务一个线程组: 并发或嵌套的调用只用调用线程执行
+    int members = 0;
+    if (nthreads > 1) {
+        pthread_mutex_lock(&fft_pool.lock);
+        if (!fft_pool.busy) {
+            members = fft_pool_grow(nthreads - 1);
+            fft_pool.busy = members > 0;
+        }
+        pthread_mutex_unlock(&fft_pool.lock);
+    }
+    if (members == 0) {
+        fn(&team, arg, 0);
+        return;
+    }
+
+    pthread_mutex_init(&team.lock, NULL);
+    pthread_cond_init(&team.cond, NULL);
+    team.threaded = 1;
+    team.size = members + 1;
+
+    pthread_mutex_lock(&fft_pool.lock);
+    fft_pool.team = &team;
+    fft_pool.members = members;
+    fft_pool.remaining = members;
+    fft_pool.generation++;
+    pthread_cond_broadcast(&fft_pool.wake);
+    pthread_mutex_unlock(&fft_pool.lock);
+
+    fn(&team, arg, 0);
+
+    pthread_mutex_lock(&fft_pool.lock);
+    while (fft_pool.remaining > 0) {
+        pthread_cond_wait(&fft_pool.done, &fft_pool.lock);
+    }
+    fft_pool.team = NULL;
+    fft_pool.busy = 0;
+    pthread_mutex_unlock(&fft_pool.lock);
+
+    pthread_cond_destroy(&team.cond);
+    pthread_mutex_destroy(&team.lock);
+}
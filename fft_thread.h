@@ -0,0 +1,43 @@
+/**
+ * @file fft_thread.h
+ * @brief FFT 的多线程执行 (模块内部接口)
+ *
+ * 一次并行执行由若干 POSIX 线程组成一个线程组 (调用线程本身也是成员)。
+ * 工作线程来自常驻线程池: 第一次需要时创建，之后保留到进程结束，每次执行只唤醒所需的数量。
+ * 工作按块从共享计数器动态领取，各阶段之间用 fft_team_barrier 同步，
+ * 因此即使某个线程创建失败或线程池正忙，其余成员也能把全部工作做完。
+ */
+
+#ifndef FFT_THREAD_H
+#define FFT_THREAD_H
+
+typedef struct fft_team fft_team;
+
+/**
+ * 线程组中每个成员执行的函数
+ * member 为成员编号 (调用线程为 0)，小于 fft_team_run 的 nthreads，可用于选择预先分配的工作区
+ */
+typedef void (*fft_team_fn)(fft_team* team, void* arg, int member);
+
+/**
+ * 用最多 nthreads 个线程 (含调用线程) 执行 fn，全部成员返回后才返回
+ * nthreads <= 1 时直接在调用线程中执行；线程池正在服务其他调用 (并发或嵌套调用) 时也只用调用线程执行。
+ * 本函数不分配堆内存
+ */
+void fft_team_run(fft_team_fn fn, void* arg, int nthreads);
+
+/**
+ * 屏障: 等待组内所有成员到达
+ */
+void fft_team_barrier(fft_team* team);
+
+/**
+ * 从共享计数器领取一块工作 [*begin, *begin + 返回值)
+ * @param counter 下一个未领取的位置 (由组内成员共享，调用前置 0)
+ * @param total 工作总数
+ * @param chunk 每次最多领取的个数
+ * @return 领到的个数，0 表示没有剩余工作
+ */
+int fft_team_claim(fft_team* team, int* counter, int total, int chunk, int* begin);
+
+#endif /* FFT_THREAD_H */
@@ -0,0 +1,131 @@
+/**
+ * @file fm_demod_impl.h
+ * @brief FM 解析信号解调与后处理的精度无关实现 (由 main-fm.c 分别以 double 和 float 包含)
+ *
+ * 包含前需要定义：
+ *   FM_REAL        样本类型 (double 或 float)
+ *   FM_ID(x)       函数名: x 或 x_f
+ *   FM_MATH(fn)    对应精度的数学函数: fn 或 fn##f (atan2 / atan2f)
+ *   FM_VERBOSE     是否输出过程信息 (单精度版本用于对比，不输出)
+ *
+ * Hilbert 变换核只有 40 个系数，两种精度都先以 double 计算再转换；直流均值以 double 累加。
+ */
+
+/**
+ * @brief FM解调 - 使用解析信号方法（最准确）
+ *
+ * 通过Hilbert变换构造解析信号，然后计算瞬时频率
+ * 这里使用简化的离散希尔伯特变换
+ *
+ * @param signal 输入的FM信号
+ * @param demod_signal 输出的解调信号（频率偏移）
+ * @param n 采样点数
+ * @param fs 采样频率
+ * @param fc 载波频率
+ */
+void FM_ID(fm_demodulate_analytic)(FM_REAL *signal, FM_REAL *demod_signal,
+                                   int n, FM_REAL fs, FM_REAL fc) {
+    FM_REAL *hilbert = (FM_REAL *)malloc(n * sizeof(FM_REAL));
+    FM_REAL *phase = (FM_REAL *)malloc(n * sizeof(FM_REAL));
+    FM_REAL kernel[41];
+
+    if (!hilbert || !phase) {
+        fprintf(stderr, "内存分配失败!\n");
+        free(hilbert);
+        free(phase);
+        return;
+    }
+
+    // Hilbert变换核: h(n) = 2*sin^2(πn/2) / (πn)
+    for (int k = -20; k <= 20; k++) {
+        kernel[k + 20] = (k == 0) ? 0 :
+            (FM_REAL)((2.0 / (M_PI * k)) * sin(M_PI * k / 2.0) * sin(M_PI * k / 2.0));
+    }
+
+    // 简化的Hilbert变换（90度相移）
+    // 对于余弦信号，Hilbert变换产生正弦信号
+    for (int i = 0; i < n; i++) {
+        FM_REAL acc = 0;
+
+        // 使用有限长度的希尔伯特变换核
+        for (int k = -20; k <= 20; k++) {
+            int idx = i + k;
+            if (k != 0 && idx >= 0 && idx < n) {
+                acc += signal[idx] * kernel[k + 20];
+            }
+        }
+        hilbert[i] = acc;
+    }
+
+    // 计算瞬时相位
+    for (int i = 0; i < n; i++) {
+        phase[i] = FM_MATH(atan2)(hilbert[i], signal[i]);
+    }
+
+    // 计算瞬时频率（相位的导数）
+    const FM_REAL pi = (FM_REAL)M_PI;
+    for (int i = 1; i < n; i++) {
+        FM_REAL dphase = phase[i] - phase[i-1];
+
+        // 相位解包装（unwrapping）
+        while (dphase > pi) dphase -= 2 * pi;
+        while (dphase < -pi) dphase += 2 * pi;
+
+        // 瞬时频率 = (1/2π) * dφ/dt
+        FM_REAL inst_freq = (dphase * fs) / (2 * pi);
+
+        // 减去载波频率得到调制信号
+        demod_signal[i] = inst_freq - fc;
+    }
+
+    demod_signal[0] = demod_signal[1];
+
+    free(hilbert);
+    free(phase);
+}
+
+/**
+ * @brief 简单的低通滤波器（移动平均）
+ *
+ * @param input 输入信号
+ * @param output 输出信号
+ * @param n 信号长度
+ * @param window_size 滤波窗口大小
+ */
+void FM_ID(lowpass_filter)(FM_REAL *input, FM_REAL *output, int n, int window_size) {
+    int half_window = window_size / 2;
+
+    for (int i = 0; i < n; i++) {
+        FM_REAL sum = 0;
+        int count = 0;
+
+        for (int j = -half_window; j <= half_window; j++) {
+            int idx = i + j;
+            if (idx >= 0 && idx < n) {
+                sum += input[idx];
+                count++;
+            }
+        }
+
+        output[i] = sum / count;
+    }
+}
+
+/**
+ * @brief 去除信号的直流分量
+ */
+void FM_ID(remove_dc)(FM_REAL *signal, int n) {
+    double mean = 0.0;
+    for (int i = 0; i < n; i++) {
+        mean += signal[i];
+    }
+    mean /= n;
+
+    for (int i = 0; i < n; i++) {
+        signal[i] -= (FM_REAL)mean;
+    }
+
+    if (FM_VERBOSE) {
+        printf("  去除直流分量: %.2f Hz\n", mean);
+    }
+}
@@ -0,0 +1,112 @@
+/**
+ * @file image_io.h
+ * @brief 灰度图像导出 (BMP / PGM)
+ *
+ * 数据按 [min, max] 线性映射到 0..255 (与以前逐像素写入的结果完全相同)。
+ * 整行归一化后打包到缓冲区，每次写入一块若干行，图像较大时由多个线程分担各行的转换；
+ * min/max 的统计使用与 FFT 内核相同级别的 SIMD 指令 (见 fft_simd_get_level)。
+ *
+ * 格式:
+ * - IMAGE_BMP24: 24 位 BMP，每个像素重复三次灰度值 (默认)
+ * - IMAGE_BMP8:  8 位 BMP + 256 级灰度调色板，像素数据为 24 位的 1/3
+ * - IMAGE_PGM:   二进制 PGM (P5)，文件头之后紧跟 width x height 字节
+ */
+
+#ifndef IMAGE_IO_H
+#define IMAGE_IO_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** 图像格式 */
+#define IMAGE_BMP24 0
+#define IMAGE_BMP8  1
+#define IMAGE_PGM   2
+
+/**
+ * 按名称 ("bmp"、"bmp8"、"pgm") 选择格式
+ * @return 格式，-1 表示未知的名称
+ */
+int image_parse_format(const char* name);
+
+/**
+ * 格式对应的文件扩展名 ("bmp" 或 "pgm"，不含点)
+ */
+const char* image_format_ext(int format);
+
+/**
+ * 统计 count 个元素的最小值和最大值 (count >= 1)
+ */
+void image_minmax(const double* data, size_t count, double* min_val, double* max_val);
+
+/**
+ * 将数值归一化到 [0, 255] 范围 (max_val == min_val 时为 128)
+ */
+uint8_t image_to_byte(double value, double min_val, double max_val);
+
+/**
+ * 按数据自身的范围保存灰度图像
+ * @param data 行优先的 height x width 数组，第 0 行在图像顶部
+ * @return 0表示成功，-1表示失败
+ */
+int image_save(const char* filename, const double* data, int width, int height, int format);
+
+/**
+ * 按给定的范围保存灰度图像 (不再统计 min/max)
+ */
+int image_save_range(const char* filename, const double* data, int width, int height, int format,
+                     double min_val, double max_val);
+
+/** 频谱图像的幅度刻度 */
+#define IMAGE_SPECTRUM_LINEAR 0     // |X|
+#define IMAGE_SPECTRUM_LOG    1     // log(1 + |X|)
+
+/**
+ * 将复数频谱保存为中心化的幅度图像 (零频位于图像中心，与先 fftshift 再保存的结果相同)
+ * 幅度、对数、中心化和量化在写入每一行时一次完成，不生成幅度图、中心化副本等整幅的中间数组；
+ * 之前只需要对功率 re^2 + im^2 做一次只读的 min/max 统计
+ * @param re 频谱实部 (height x width，零频在第 0 行第 0 列)
+ * @param im 频谱虚部 (height x width)
+ * @param scale IMAGE_SPECTRUM_LINEAR 或 IMAGE_SPECTRUM_LOG
+ * @return 0表示成功，-1表示失败
+ */
+int image_save_spectrum(const char* filename, const double* re, const double* im, int width, int height,
+                        int scale, int format);
+
+/**
+ * 逐行写入图像 (数据不在内存中时使用，只需要一行的缓冲区)
+ * 行按文件中的顺序提交: BMP 从最后一行开始，PGM 从第 0 行开始，见 image_writer_next_row
+ */
+typedef struct {
+    FILE *file;
+    int width, height, format;
+    size_t row_size;            // 文件中每行的字节数 (含 BMP 的 4 字节对齐填充)
+    int rows_written;
+    uint8_t *pixels;
+} image_writer;
+
+/**
+ * 创建文件并写入文件头
+ * @return 0表示成功，-1表示失败 (已打印原因)
+ */
+int image_writer_open(image_writer* writer, const char* filename, int width, int height, int format);
+
+/**
+ * 下一次 image_writer_put 应提交的图像行号
+ */
+int image_writer_next_row(const image_writer* writer);
+
+/**
+ * 归一化并写入一行 (width 个元素)
+ * @return 0表示成功，-1表示失败
+ */
+int image_writer_put(image_writer* writer, const double* row, double min_val, double max_val);
+
+/**
+ * 关闭文件并释放缓冲区
+ * @return 0表示全部行都已成功写入，-1表示失败
+ */
+int image_writer_close(image_writer* writer);
+
+#endif /* IMAGE_IO_H */
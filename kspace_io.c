@@ -0,0 +1,734 @@
+/**
+ * @file kspace_io.c
+ * @brief K空间数据文件的读写 (见 kspace_io.h)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "kspace_io.h"
+
+#define KSPACE_MAGIC "KSPC"
+#define KSPACE_BYTE_ORDER 0xFEFF        // 按写入者的字节序存放，读到 0xFFFE 说明需要交换
+#define KSPACE_LEGACY_HEADER_SIZE (2 * sizeof(int))
+#define KSPACE_CHUNK 8192               // 转换和 pread 的缓冲区字节数
+#define KSPACE_HALF_BITS 15             // float16 每行缩放后的最大值小于 2^15
+
+/*
+ * 文件头各字段的偏移 (字节)
+ *  0 魔数 "KSPC"     4 版本 (u16)      6 字节序标记 (u16)
+ *  8 宽 (u32)       12 高 (u32)       16 元素类型 (u8)   17 存放方式 (u8)   18 标志 (u8)   19 保留
+ * 20 层数 (u32，版本 3；更早的版本为 0，表示单层)
+ * 24 实部偏移 (u64) 32 虚部偏移 (u64) 40 文件大小 (u64)  48 缩放系数表偏移 (u64)  56 保留至 64 字节
+ */
+
+int kspace_dtype_size(int dtype) {
+    switch (dtype) {
+        case KSPACE_F64: return 8;
+        case KSPACE_F32: return 4;
+        case KSPACE_F16: return 2;
+        default: return 0;
+    }
+}
+
+const char* kspace_dtype_name(int dtype) {
+    switch (dtype) {
+        case KSPACE_F64: return "float64";
+        case KSPACE_F32: return "float32";
+        case KSPACE_F16: return "float16 (每行缩放)";
+        default: return "unknown";
+    }
+}
+
+static void kspace_swap_bytes(unsigned char* p, int size) {
+    for (int i = 0; i < size / 2; i++) {
+        unsigned char t = p[i];
+        p[i] = p[size - 1 - i];
+        p[size - 1 - i] = t;
+    }
+}
+
+/**
+ * 读取文件头中的一个无符号整数字段 (size 为 2、4 或 8)
+ */
+static uint64_t kspace_field(const unsigned char* header, int offset, int size, int swapped) {
+    unsigned char bytes[8];
+    memcpy(bytes, header + offset, size);
+    if (swapped) kspace_swap_bytes(bytes, size);
+    switch (size) {
+        case 2: { uint16_t v; memcpy(&v, bytes, 2); return v; }
+        case 4: { uint32_t v; memcpy(&v, bytes, 4); return v; }
+        default: { uint64_t v; memcpy(&v, bytes, 8); return v; }
+    }
+}
+
+static void kspace_put_field(unsigned char* header, int offset, int size, uint64_t value) {
+    switch (size) {
+        case 2: { uint16_t v = (uint16_t)value; memcpy(header + offset, &v, 2); break; }
+        case 4: { uint32_t v = (uint32_t)value; memcpy(header + offset, &v, 4); break; }
+        default: memcpy(header + offset, &value, 8); break;
+    }
+}
+
+static uint64_t kspace_align(uint64_t offset) {
+    return (offset + KSPACE_ALIGN - 1) / KSPACE_ALIGN * KSPACE_ALIGN;
+}
+
+int kspace_info_init(kspace_info* info, int width, int height, int depth, int dtype, int layout, int flags) {
+    int elem = kspace_dtype_size(dtype);
+    if (width < 1 || height < 1 || depth < 1 || (uint64_t)height * depth > 0x7fffffff || elem == 0 ||
+        (flags & ~(KSPACE_HERMITIAN | KSPACE_VOLUME)) != 0 ||
+        (layout != KSPACE_SPLIT && layout != KSPACE_INTERLEAVED)) {
+        return -1;
+    }
+    if (depth == 1) flags &= ~KSPACE_VOLUME;
+    memset(info, 0, sizeof(*info));
+    info->version = depth > 1 ? 3 : ((dtype == KSPACE_F16 || flags != 0) ? 2 : 1);
+    info->width = width;
+    info->height = height;
+    info->depth = depth;
+    info->dtype = dtype;
+    info->layout = layout;
+    info->flags = flags;
+    info->stored_width = (flags & KSPACE_HERMITIAN) ? width / 2 + 1 : width;
+
+    uint64_t rows = (uint64_t)height * depth;
+    uint64_t plane = (uint64_t)info->stored_width * rows * elem;
+    uint64_t offset = KSPACE_HEADER_SIZE;
+    if (dtype == KSPACE_F16) {
+        info->scale_offset = offset;
+        offset = kspace_align(offset + rows * sizeof(double));
+    }
+    info->real_offset = offset;
+    if (layout == KSPACE_SPLIT) {
+        info->imag_offset = kspace_align(info->real_offset + plane);
+        info->file_size = info->imag_offset + plane;
+    } else {
+        info->imag_offset = info->real_offset + elem;
+        info->file_size = info->real_offset + 2 * plane;
+    }
+    return 0;
+}
+
+int kspace_total_rows(const kspace_info* info) {
+    return info->height * info->depth;
+}
+
+void kspace_encode_header(const kspace_info* info, unsigned char* header) {
+    memset(header, 0, KSPACE_HEADER_SIZE);
+    memcpy(header, KSPACE_MAGIC, 4);
+    kspace_put_field(header, 4, 2, (uint64_t)info->version);
+    kspace_put_field(header, 6, 2, KSPACE_BYTE_ORDER);
+    kspace_put_field(header, 8, 4, (uint64_t)info->width);
+    kspace_put_field(header, 12, 4, (uint64_t)info->height);
+    if (info->version >= 3) {
+        kspace_put_field(header, 20, 4, (uint64_t)info->depth);
+    }
+    header[16] = (unsigned char)info->dtype;
+    header[17] = (unsigned char)info->layout;
+    header[18] = (unsigned char)info->flags;
+    kspace_put_field(header, 24, 8, info->real_offset);
+    kspace_put_field(header, 32, 8, info->imag_offset);
+    kspace_put_field(header, 40, 8, info->file_size);
+    kspace_put_field(header, 48, 8, info->scale_offset);
+}
+
+/**
+ * 完整读取 bytes 个字节 (pread 可能只返回一部分)
+ */
+static int kspace_pread(int fd, void* buf, size_t bytes, uint64_t offset) {
+    char *p = (char *)buf;
+    while (bytes > 0) {
+        ssize_t n = pread(fd, p, bytes, (off_t)offset);
+        if (n <= 0) return -1;
+        p += n;
+        bytes -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return 0;
+}
+
+/**
+ * [offset, offset + size) 是否完整地位于 file_size 字节之内 (不会因加法溢出而误判)
+ */
+static int kspace_fits(uint64_t offset, uint64_t size, uint64_t file_size) {
+    return offset <= file_size && size <= file_size - offset;
+}
+
+/**
+ * 旧格式: 宽、高之后紧跟实部平面和虚部平面，元素类型由文件大小推断
+ */
+static int kspace_read_legacy(const unsigned char* header, uint64_t file_size, kspace_info* info) {
+    int dims[2];
+    memcpy(dims, header, sizeof(dims));
+    if (dims[0] < 1 || dims[1] < 1) {
+        printf("无法识别的K空间文件 (尺寸无效)\n");
+        return -1;
+    }
+    uint64_t count = (uint64_t)dims[0] * dims[1];
+    if (count > (UINT64_MAX - KSPACE_LEGACY_HEADER_SIZE) / (2 * sizeof(double))) {
+        printf("文件大小与尺寸不符\n");
+        return -1;
+    }
+    int dtype = 0;
+    if (file_size == KSPACE_LEGACY_HEADER_SIZE + 2 * count * sizeof(double)) dtype = KSPACE_F64;
+    if (file_size == KSPACE_LEGACY_HEADER_SIZE + 2 * count * sizeof(float)) dtype = KSPACE_F32;
+    if (dtype == 0) {
+        printf("文件大小与尺寸不符\n");
+        return -1;
+    }
+    memset(info, 0, sizeof(*info));
+    info->width = dims[0];
+    info->height = dims[1];
+    info->depth = 1;
+    info->stored_width = dims[0];
+    info->dtype = dtype;
+    info->layout = KSPACE_SPLIT;
+    info->real_offset = KSPACE_LEGACY_HEADER_SIZE;
+    info->imag_offset = KSPACE_LEGACY_HEADER_SIZE + count * kspace_dtype_size(dtype);
+    info->file_size = file_size;
+    return 0;
+}
+
+int kspace_read_info(int fd, kspace_info* info) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        printf("无法读取文件信息\n");
+        return -1;
+    }
+    uint64_t file_size = (uint64_t)st.st_size;
+    unsigned char header[KSPACE_HEADER_SIZE];
+    size_t header_bytes = file_size < KSPACE_HEADER_SIZE ? (size_t)file_size : KSPACE_HEADER_SIZE;
+    if (header_bytes < KSPACE_LEGACY_HEADER_SIZE || kspace_pread(fd, header, header_bytes, 0) != 0) {
+        printf("读取文件头失败\n");
+        return -1;
+    }
+    if (header_bytes < KSPACE_HEADER_SIZE || memcmp(header, KSPACE_MAGIC, 4) != 0) {
+        return kspace_read_legacy(header, file_size, info);
+    }
+
+    uint64_t order = kspace_field(header, 6, 2, 0);
+    if (order != KSPACE_BYTE_ORDER && order != 0xFFFE) {
+        printf("K空间文件头损坏 (字节序标记 0x%04x)\n", (unsigned)order);
+        return -1;
+    }
+    memset(info, 0, sizeof(*info));
+    info->swapped = (order != KSPACE_BYTE_ORDER);
+    info->version = (int)kspace_field(header, 4, 2, info->swapped);
+    if (info->version < 1 || info->version > KSPACE_VERSION) {
+        printf("不支持的K空间文件版本: %d (最高支持 %d)\n", info->version, KSPACE_VERSION);
+        return -1;
+    }
+    uint64_t width = kspace_field(header, 8, 4, info->swapped);
+    uint64_t height = kspace_field(header, 12, 4, info->swapped);
+    uint64_t depth = info->version >= 3 ? kspace_field(header, 20, 4, info->swapped) : 1;
+    info->dtype = header[16];
+    info->layout = header[17];
+    info->flags = header[18];
+    info->real_offset = kspace_field(header, 24, 8, info->swapped);
+    info->imag_offset = kspace_field(header, 32, 8, info->swapped);
+    info->file_size = kspace_field(header, 40, 8, info->swapped);
+    info->scale_offset = kspace_field(header, 48, 8, info->swapped);
+
+    int elem = kspace_dtype_size(info->dtype);
+    if (width < 1 || width > 0x7fffffff || height < 1 || depth < 1 || height * depth > 0x7fffffff ||
+        elem == 0 || (info->flags & ~(KSPACE_HERMITIAN | KSPACE_VOLUME)) != 0 ||
+        ((info->flags & KSPACE_VOLUME) && depth < 2) ||
+        (info->layout != KSPACE_SPLIT && info->layout != KSPACE_INTERLEAVED)) {
+        printf("K空间文件头损坏 (尺寸 %llux%llux%llu, 类型 %d, 存放方式 %d, 标志 %d)\n",
+               (unsigned long long)width, (unsigned long long)height, (unsigned long long)depth,
+               info->dtype, info->layout, info->flags);
+        return -1;
+    }
+    info->width = (int)width;
+    info->height = (int)height;
+    info->depth = (int)depth;
+    info->stored_width = (info->flags & KSPACE_HERMITIAN) ? info->width / 2 + 1 : info->width;
+
+    // 每个平面 (交错存放时为整个数组) 和缩放系数表都必须完整地位于文件之内
+    // 宽和行数各不超过 2^31，先用除法确认 2 × 平面字节数不会超出 64 位，再做乘法
+    uint64_t rows = height * depth;
+    uint64_t elements = (uint64_t)info->stored_width * rows;
+    if (elements > UINT64_MAX / (2 * (uint64_t)elem)) {
+        printf("K空间文件头损坏 (尺寸过大)\n");
+        return -1;
+    }
+    uint64_t plane = elements * (uint64_t)elem;
+    int valid = info->real_offset >= KSPACE_HEADER_SIZE && info->real_offset % elem == 0;
+    if (info->layout == KSPACE_SPLIT) {
+        valid = valid && info->imag_offset >= KSPACE_HEADER_SIZE && info->imag_offset % elem == 0 &&
+                kspace_fits(info->real_offset, plane, info->file_size) &&
+                kspace_fits(info->imag_offset, plane, info->file_size) &&
+                (info->real_offset + plane <= info->imag_offset || info->imag_offset + plane <= info->real_offset);
+    } else {
+        valid = valid && info->imag_offset == info->real_offset + elem &&
+                kspace_fits(info->real_offset, 2 * plane, info->file_size);
+    }
+    if (info->dtype == KSPACE_F16) {
+        valid = valid && info->scale_offset >= KSPACE_HEADER_SIZE &&
+                kspace_fits(info->scale_offset, rows * sizeof(double), info->file_size);
+    }
+    if (!valid) {
+        printf("K空间文件头损坏 (数据偏移无效)\n");
+        return -1;
+    }
+    if (info->file_size > file_size) {
+        printf("K空间文件不完整: 需要 %llu 字节，实际 %llu 字节\n",
+               (unsigned long long)info->file_size, (unsigned long long)file_size);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * double 转换为 IEEE 754 半精度 (就近舍入到偶数，超出范围为无穷大)
+ */
+static uint16_t kspace_half_from_double(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint16_t sign = (uint16_t)((bits >> 48) & 0x8000);
+    int exponent = (int)((bits >> 52) & 0x7ff);
+    uint64_t mantissa = bits & 0xfffffffffffffULL;
+
+    if (exponent == 0x7ff) {
+        return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+    }
+    int e = exponent - 1023 + 15;
+    if (e >= 31) {
+        return sign | 0x7c00;
+    }
+    if (e <= 0) {
+        // 非正规数: 连同隐含的最高位右移，小于最小非正规数一半的值舍入为 0
+        if (e < -10) return sign;
+        mantissa |= 1ULL << 52;
+        int shift = 43 - e;
+        uint64_t half = mantissa >> shift;
+        uint64_t rest = mantissa & ((1ULL << shift) - 1);
+        uint64_t halfway = 1ULL << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1))) half++;
+        return sign | (uint16_t)half;
+    }
+    // 舍入的进位可能进入指数位，到 0x7c00 时正好是无穷大
+    uint32_t half = ((uint32_t)e << 10) | (uint32_t)(mantissa >> 42);
+    uint64_t rest = mantissa & ((1ULL << 42) - 1);
+    if (rest > (1ULL << 41) || (rest == (1ULL << 41) && (half & 1))) half++;
+    return sign | (uint16_t)half;
+}
+
+/**
+ * IEEE 754 半精度转换为 float (所有半精度值都能用 float 精确表示)
+ */
+static float kspace_half_to_float(uint16_t h) {
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1f;
+    uint32_t mantissa = h & 0x3ff;
+    float value;
+    if (exponent == 0) {
+        value = (float)mantissa * (1.0f / 16777216.0f);     // mantissa * 2^-24
+        return sign ? -value : value;
+    }
+    uint32_t bits = (exponent == 31) ? (sign | 0x7f800000u | (mantissa << 13))
+                                     : (sign | ((exponent + 112) << 23) | (mantissa << 13));
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * 读取一个元素 (必要时交换字节序) 并转换为 double
+ */
+static double kspace_get(const unsigned char* p, int dtype, int swapped) {
+    unsigned char bytes[8];
+    int size = dtype == KSPACE_F16 ? 2 : (dtype == KSPACE_F32 ? 4 : 8);
+    memcpy(bytes, p, size);
+    if (swapped) kspace_swap_bytes(bytes, size);
+    if (dtype == KSPACE_F16) {
+        uint16_t v;
+        memcpy(&v, bytes, sizeof(v));
+        return kspace_half_to_float(v);
+    }
+    if (dtype == KSPACE_F32) {
+        float v;
+        memcpy(&v, bytes, sizeof(v));
+        return v;
+    }
+    double v;
+    memcpy(&v, bytes, sizeof(v));
+    return v;
+}
+
+static void kspace_put(unsigned char* p, int dtype, double value) {
+    if (dtype == KSPACE_F16) {
+        uint16_t v = kspace_half_from_double(value);
+        memcpy(p, &v, sizeof(v));
+    } else if (dtype == KSPACE_F32) {
+        float v = (float)value;
+        memcpy(p, &v, sizeof(v));
+    } else {
+        memcpy(p, &value, sizeof(value));
+    }
+}
+
+/**
+ * 转换 count 个元素并乘以 scale: 源和目标可以各自带元素跨度 (交错存放时为 2)
+ */
+static void kspace_convert(const unsigned char* src, int src_dtype, size_t src_step, int swapped, double scale,
+                           unsigned char* dst, int dst_dtype, size_t dst_step, size_t count) {
+    size_t src_size = (size_t)kspace_dtype_size(src_dtype);
+    size_t dst_size = (size_t)kspace_dtype_size(dst_dtype);
+    if (!swapped && scale == 1.0 && src_dtype == dst_dtype && src_step == 1 && dst_step == 1) {
+        memcpy(dst, src, count * src_size);
+        return;
+    }
+    src_step *= src_size;
+    dst_step *= dst_size;
+    for (size_t i = 0; i < count; i++) {
+        kspace_put(dst + i * dst_step, dst_dtype, kspace_get(src + i * src_step, src_dtype, swapped) * scale);
+    }
+}
+
+/**
+ * float16 一行的缩放系数: 2 的整数次幂 (缩放不引入舍入)，使行内最大绝对值缩放后落在 [2^14, 2^15)，
+ * 远离半精度的上限 65504，较小的值在正规数范围内还有约 29 个二进制数量级
+ */
+static double kspace_row_scale(double max_abs) {
+    if (!(max_abs > 0) || isinf(max_abs)) return 1.0;
+    int e;
+    frexp(max_abs, &e);
+    if (e - KSPACE_HALF_BITS < -1022) e = KSPACE_HALF_BITS - 1022;
+    return ldexp(1.0, e - KSPACE_HALF_BITS);
+}
+
+/**
+ * 写到 offset 之前补零 (平面之间的对齐填充)
+ */
+static int kspace_pad(FILE* file, uint64_t* pos, uint64_t offset) {
+    static const unsigned char zeros[KSPACE_ALIGN];
+    while (*pos < offset) {
+        size_t n = offset - *pos < sizeof(zeros) ? (size_t)(offset - *pos) : sizeof(zeros);
+        if (fwrite(zeros, 1, n, file) != n) return -1;
+        *pos += n;
+    }
+    return 0;
+}
+
+/**
+ * 写入新格式文件: 源数据为 src_dtype 的分离平面 (depth 层完整的 height x width)，
+ * 半谱只写入每行的前 stored_width 列
+ */
+static int kspace_write(const char* filename, const void* real, const void* imag, int src_dtype,
+                        int width, int height, int depth, int dtype, int layout, int flags) {
+    kspace_info info;
+    if (kspace_info_init(&info, width, height, depth, dtype, layout, flags) != 0 || !real || !imag) {
+        printf("无效的K空间数据参数\n");
+        return -1;
+    }
+    height = kspace_total_rows(&info);      // 以下按全部层的行处理
+
+    size_t src_size = (size_t)kspace_dtype_size(src_dtype);
+    size_t elem = (size_t)kspace_dtype_size(dtype);
+    size_t stored = (size_t)info.stored_width;
+    const unsigned char *planes[2] = {(const unsigned char *)real, (const unsigned char *)imag};
+
+    // float16: 先按每行保存的列统计缩放系数
+    double *scales = NULL;
+    if (dtype == KSPACE_F16) {
+        scales = (double *)malloc((size_t)height * sizeof(double));
+        if (!scales) {
+            printf("内存分配失败\n");
+            return -1;
+        }
+        for (int i = 0; i < height; i++) {
+            double max_abs = 0.0;
+            for (int p = 0; p < 2; p++) {
+                const unsigned char *row = planes[p] + (size_t)i * width * src_size;
+                for (size_t j = 0; j < stored; j++) {
+                    double v = fabs(kspace_get(row + j * src_size, src_dtype, 0));
+                    if (v > max_abs) max_abs = v;
+                }
+            }
+            scales[i] = kspace_row_scale(max_abs);
+        }
+    }
+
+    FILE* file = fopen(filename, "wb");
+    if (!file) {
+        printf("无法创建文件: %s\n", filename);
+        free(scales);
+        return -1;
+    }
+
+    unsigned char header[KSPACE_HEADER_SIZE];
+    kspace_encode_header(&info, header);
+    uint64_t pos = sizeof(header);
+    int ok = fwrite(header, 1, sizeof(header), file) == sizeof(header);
+    if (ok && scales) {
+        ok = kspace_pad(file, &pos, info.scale_offset) == 0 &&
+             fwrite(scales, sizeof(double), (size_t)height, file) == (size_t)height;
+        pos += (uint64_t)height * sizeof(double);
+    }
+
+    unsigned char buffer[KSPACE_CHUNK];
+    if (layout == KSPACE_SPLIT) {
+        size_t chunk = sizeof(buffer) / elem;
+        for (int p = 0; p < 2 && ok; p++) {
+            ok = kspace_pad(file, &pos, p == 0 ? info.real_offset : info.imag_offset) == 0;
+            for (int i = 0; i < height && ok; i++) {
+                const unsigned char *row = planes[p] + (size_t)i * width * src_size;
+                double scale = scales ? 1.0 / scales[i] : 1.0;
+                for (size_t done = 0; done < stored && ok; done += chunk) {
+                    size_t n = stored - done < chunk ? stored - done : chunk;
+                    kspace_convert(row + done * src_size, src_dtype, 1, 0, scale, buffer, dtype, 1, n);
+                    ok = fwrite(buffer, elem, n, file) == n;
+                }
+            }
+            pos += (uint64_t)stored * height * elem;
+        }
+    } else {
+        size_t chunk = sizeof(buffer) / (2 * elem);
+        ok = ok && kspace_pad(file, &pos, info.real_offset) == 0;
+        for (int i = 0; i < height && ok; i++) {
+            size_t row = (size_t)i * width * src_size;
+            double scale = scales ? 1.0 / scales[i] : 1.0;
+            for (size_t done = 0; done < stored && ok; done += chunk) {
+                size_t n = stored - done < chunk ? stored - done : chunk;
+                kspace_convert(planes[0] + row + done * src_size, src_dtype, 1, 0, scale, buffer, dtype, 2, n);
+                kspace_convert(planes[1] + row + done * src_size, src_dtype, 1, 0, scale, buffer + elem, dtype, 2, n);
+                ok = fwrite(buffer, 2 * elem, n, file) == n;
+            }
+        }
+    }
+
+    free(scales);
+    if (fclose(file) != 0 || !ok) {
+        printf("写入文件失败: %s\n", filename);
+        return -1;
+    }
+    return 0;
+}
+
+int kspace_save(const char* filename, const double* real, const double* imag,
+                int width, int height, int dtype, int layout, int flags) {
+    return kspace_write(filename, real, imag, KSPACE_F64, width, height, 1, dtype, layout, flags);
+}
+
+int kspace_save_volume(const char* filename, const double* real, const double* imag,
+                       int width, int height, int depth, int dtype, int layout, int flags) {
+    return kspace_write(filename, real, imag, KSPACE_F64, width, height, depth, dtype, layout, flags);
+}
+
+int kspace_save_f32(const char* filename, const float* real, const float* imag,
+                    int width, int height, int layout) {
+    return kspace_write(filename, real, imag, KSPACE_F32, width, height, 1, KSPACE_F32, layout, 0);
+}
+
+int kspace_open(const char* filename, kspace_file* ks) {
+    memset(ks, 0, sizeof(*ks));
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        printf("无法打开文件: %s\n", filename);
+        return -1;
+    }
+    if (kspace_read_info(fd, &ks->info) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    // 映射建立后即可关闭文件描述符
+    ks->map_size = (size_t)ks->info.file_size;
+    void *map = mmap(NULL, ks->map_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        printf("无法映射文件: %s\n", filename);
+        memset(ks, 0, sizeof(*ks));
+        return -1;
+    }
+    ks->map = map;
+    ks->real = (const unsigned char *)map + ks->info.real_offset;
+    ks->imag = (const unsigned char *)map + ks->info.imag_offset;
+    return 0;
+}
+
+void kspace_close(kspace_file* ks) {
+    if (ks->map) {
+        munmap(ks->map, ks->map_size);
+    }
+    memset(ks, 0, sizeof(*ks));
+}
+
+int kspace_is_direct(const kspace_file* ks, int dtype) {
+    return ks->map && !ks->info.swapped && ks->info.layout == KSPACE_SPLIT &&
+           (ks->info.flags & KSPACE_HERMITIAN) == 0 && ks->info.dtype == dtype;
+}
+
+/**
+ * 数据来源: 内存映射 (map 不为 NULL) 或用 pread 读取的文件
+ */
+typedef struct {
+    const unsigned char *map;
+    int fd;
+} kspace_source;
+
+static int kspace_source_read(const kspace_source* src, void* dst, size_t bytes, uint64_t offset) {
+    if (src->map) {
+        memcpy(dst, src->map + offset, bytes);
+        return 0;
+    }
+    return kspace_pread(src->fd, dst, bytes, offset);
+}
+
+/**
+ * 读取第 row 行保存的 stored_width 个元素，乘以行缩放系数后转换为 dtype
+ */
+static int kspace_load_row(const kspace_source* src, const kspace_info* info, int row,
+                           unsigned char* re, unsigned char* im, int dtype) {
+    size_t elem = (size_t)kspace_dtype_size(info->dtype);
+    size_t dsize = (size_t)kspace_dtype_size(dtype);
+    size_t step = info->layout == KSPACE_INTERLEAVED ? 2 : 1;
+    size_t count = (size_t)info->stored_width;
+    uint64_t start = (uint64_t)row * count * step * elem;
+
+    double scale = 1.0;
+    if (info->dtype == KSPACE_F16) {
+        unsigned char bytes[sizeof(double)];
+        if (kspace_source_read(src, bytes, sizeof(bytes), info->scale_offset + (uint64_t)row * sizeof(double)) != 0) {
+            return -1;
+        }
+        scale = kspace_get(bytes, KSPACE_F64, info->swapped);
+    }
+
+    if (src->map) {
+        kspace_convert(src->map + info->real_offset + start, info->dtype, step, info->swapped, scale,
+                       re, dtype, 1, count);
+        kspace_convert(src->map + info->imag_offset + start, info->dtype, step, info->swapped, scale,
+                       im, dtype, 1, count);
+        return 0;
+    }
+
+    unsigned char buffer[KSPACE_CHUNK];
+    if (step == 2) {
+        // 实部、虚部在同一段数据中，一次读入后拆分
+        size_t chunk = sizeof(buffer) / (2 * elem);
+        for (size_t done = 0; done < count; done += chunk) {
+            size_t n = count - done < chunk ? count - done : chunk;
+            if (kspace_pread(src->fd, buffer, 2 * n * elem, info->real_offset + start + 2 * done * elem) != 0) {
+                return -1;
+            }
+            kspace_convert(buffer, info->dtype, 2, info->swapped, scale, re + done * dsize, dtype, 1, n);
+            kspace_convert(buffer + elem, info->dtype, 2, info->swapped, scale, im + done * dsize, dtype, 1, n);
+        }
+        return 0;
+    }
+
+    uint64_t offsets[2] = {info->real_offset + start, info->imag_offset + start};
+    unsigned char *planes[2] = {re, im};
+    for (int p = 0; p < 2; p++) {
+        if (info->dtype == dtype && !info->swapped && scale == 1.0) {
+            if (kspace_pread(src->fd, planes[p], count * elem, offsets[p]) != 0) return -1;
+            continue;
+        }
+        size_t chunk = sizeof(buffer) / elem;
+        for (size_t done = 0; done < count; done += chunk) {
+            size_t n = count - done < chunk ? count - done : chunk;
+            if (kspace_pread(src->fd, buffer, n * elem, offsets[p] + done * elem) != 0) return -1;
+            kspace_convert(buffer, info->dtype, 1, info->swapped, scale, planes[p] + done * dsize, dtype, 1, n);
+        }
+    }
+    return 0;
+}
+
+/**
+ * 由镜像行 m_re/m_im (只用到保存的列) 补全半谱行中 j >= stored 的列: X[i][j] = conj(X[m][N-j])
+ */
+static void kspace_expand_row(unsigned char* re, unsigned char* im, const unsigned char* m_re,
+                              const unsigned char* m_im, int width, int stored, int dtype) {
+    if (dtype == KSPACE_F64) {
+        double *r = (double *)re, *i = (double *)im;
+        const double *mr = (const double *)m_re, *mi = (const double *)m_im;
+        for (int j = stored; j < width; j++) {
+            r[j] = mr[width - j];
+            i[j] = -mi[width - j];
+        }
+    } else {
+        float *r = (float *)re, *i = (float *)im;
+        const float *mr = (const float *)m_re, *mi = (const float *)m_im;
+        for (int j = stored; j < width; j++) {
+            r[j] = mr[width - j];
+            i[j] = -mi[width - j];
+        }
+    }
+}
+
+/**
+ * 半谱中全局行 row 的镜像行: 同一层的第 (M-i)%M 行，三维数据为镜像层 (D-s)%D 中的这一行
+ */
+static int kspace_mirror_row(const kspace_info* info, int row) {
+    int s = row / info->height, i = row % info->height;
+    if (info->flags & KSPACE_VOLUME) {
+        s = (info->depth - s) % info->depth;
+    }
+    return s * info->height + (info->height - i) % info->height;
+}
+
+/**
+ * 读取 [row, row + rows) 行 (全局行号) 并展开为完整的行
+ */
+static int kspace_load_rows(const kspace_source* src, const kspace_info* info, int row, int rows,
+                            void* re, void* im, int dtype) {
+    if (row < 0 || rows < 0 || row + rows > kspace_total_rows(info) ||
+        (dtype != KSPACE_F64 && dtype != KSPACE_F32)) {
+        return -1;
+    }
+    size_t line = (size_t)info->width * kspace_dtype_size(dtype);
+    unsigned char *out_re = (unsigned char *)re, *out_im = (unsigned char *)im;
+    for (int r = 0; r < rows; r++) {
+        if (kspace_load_row(src, info, row + r, out_re + r * line, out_im + r * line, dtype) != 0) return -1;
+    }
+    if (info->stored_width == info->width) {
+        return 0;
+    }
+
+    // 补全时只读取镜像行保存的列 (N-j < stored_width)，镜像行在本块内时即使已经补全也可以直接使用
+    int stored = info->stored_width;
+    size_t stored_bytes = (size_t)stored * kspace_dtype_size(dtype);
+    unsigned char *mirror = NULL;
+    for (int r = 0; r < rows; r++) {
+        int m = kspace_mirror_row(info, row + r);
+        const unsigned char *m_re, *m_im;
+        if (m >= row && m < row + rows) {
+            m_re = out_re + (m - row) * line;
+            m_im = out_im + (m - row) * line;
+        } else {
+            if (!mirror && !(mirror = (unsigned char *)malloc(2 * stored_bytes))) return -1;
+            if (kspace_load_row(src, info, m, mirror, mirror + stored_bytes, dtype) != 0) {
+                free(mirror);
+                return -1;
+            }
+            m_re = mirror;
+            m_im = mirror + stored_bytes;
+        }
+        kspace_expand_row(out_re + r * line, out_im + r * line, m_re, m_im, info->width, stored, dtype);
+    }
+    free(mirror);
+    return 0;
+}
+
+int kspace_read_rows(const kspace_file* ks, int row, int rows, void* re, void* im, int dtype) {
+    if (!ks->map) return -1;
+    kspace_source src = {(const unsigned char *)ks->map, -1};
+    return kspace_load_rows(&src, &ks->info, row, rows, re, im, dtype);
+}
+
+int kspace_pread_rows(int fd, const kspace_info* info, int row, int rows, double* re, double* im) {
+    kspace_source src = {NULL, fd};
+    return kspace_load_rows(&src, info, row, rows, re, im, KSPACE_F64);
+}
@@ -0,0 +1,167 @@
+/**
+ * @file kspace_io.h
+ * @brief K空间数据文件的读写 (带版本的二进制容器，只读内存映射加载)
+ *
+ * 文件格式 (版本 3):
+ * - 64 字节文件头: 魔数 "KSPC"、版本号、字节序标记、宽、高、层数、元素类型 (f64/f32/f16)、
+ *   存放方式 (实部/虚部分离或复数交错)、标志、各数据平面的偏移
+ * - 数据平面从 64 字节对齐的偏移开始，映射到内存后可以直接交给 SIMD 内核
+ * - float16 为每一行保存一个缩放系数 (2 的整数次幂，float64)，元素为 值/缩放系数
+ * - 共轭对称的半谱 (KSPACE_HERMITIAN) 每行只保存前 width/2+1 列，
+ *   其余列读取时由 X[i][j] = conj(X[(M-i)%M][N-j]) 展开，适用于实数图像的频谱
+ * - 多层数据 (depth > 1) 的各层依次存放在同一个平面中，第 s 层第 i 行的全局行号为 s * height + i；
+ *   KSPACE_VOLUME 表示三维K空间 (深度方向也是频率轴，需要三维逆变换)，否则为各自独立的二维层
+ * 不使用 float16 和半谱的单层文件仍写为版本 1，单层文件不会写为版本 3，旧的读取程序可以直接读取。
+ *
+ * 旧格式 (两个 int 的宽、高，紧跟实部平面和虚部平面，元素类型由文件大小推断) 仍然可以加载。
+ * 加载时只建立只读映射并检查文件头，不复制数据，打开多 GB 的文件也几乎不花时间；
+ * 数据在第一次访问时才由系统按页读入。
+ */
+
+#ifndef KSPACE_IO_H
+#define KSPACE_IO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define KSPACE_VERSION 3
+#define KSPACE_HEADER_SIZE 64
+#define KSPACE_ALIGN 64
+
+/** 元素类型 */
+#define KSPACE_F64 1
+#define KSPACE_F32 2
+#define KSPACE_F16 3            // 每行一个缩放系数，只用于存储
+
+/** 标志 */
+#define KSPACE_HERMITIAN 1      // 只保存 width/2+1 列的共轭对称半谱
+#define KSPACE_VOLUME    2      // 三维K空间 (只用于 depth > 1)，半谱的镜像行在镜像层中
+
+/** 存放方式 */
+#define KSPACE_SPLIT 0          // 实部平面 + 虚部平面
+#define KSPACE_INTERLEAVED 1    // [re, im, re, im, ...]
+
+/**
+ * 文件头解析结果
+ */
+typedef struct {
+    int version;                // 0 表示旧格式
+    int width, height;
+    int depth;                  // 层数 (单层文件为 1)
+    int dtype;                  // KSPACE_F64、KSPACE_F32 或 KSPACE_F16
+    int layout;                 // KSPACE_SPLIT 或 KSPACE_INTERLEAVED
+    int flags;                  // KSPACE_HERMITIAN、KSPACE_VOLUME
+    int stored_width;           // 每行实际保存的列数 (半谱为 width/2+1)
+    int swapped;                // 文件字节序与本机不同
+    uint64_t real_offset;       // 第一个实部元素的偏移
+    uint64_t imag_offset;       // 第一个虚部元素的偏移
+    uint64_t scale_offset;      // 每行缩放系数表的偏移 (仅 float16，共 depth * height 个)
+    uint64_t file_size;         // 完整文件的字节数
+} kspace_info;
+
+/**
+ * 只读映射的K空间文件
+ * real/imag 指向映射中的第一个实部/虚部元素；交错存放时两者相差一个元素，元素跨度为 2
+ */
+typedef struct {
+    kspace_info info;
+    const void *real, *imag;
+    void *map;
+    size_t map_size;
+} kspace_file;
+
+/**
+ * 元素类型的字节数，未知类型返回 0
+ */
+int kspace_dtype_size(int dtype);
+
+/**
+ * 元素类型的名称 ("float64" 等)
+ */
+const char* kspace_dtype_name(int dtype);
+
+/**
+ * 按尺寸、类型、存放方式和标志计算新格式文件的布局 (数据平面 64 字节对齐)
+ * @param depth 层数 (单层为 1，此时忽略 KSPACE_VOLUME)
+ * @return 0表示成功，-1表示参数无效
+ */
+int kspace_info_init(kspace_info* info, int width, int height, int depth, int dtype, int layout, int flags);
+
+/**
+ * 全部层的总行数 (depth * height)
+ */
+int kspace_total_rows(const kspace_info* info);
+
+/**
+ * 按本机字节序生成 KSPACE_HEADER_SIZE 字节的文件头
+ */
+void kspace_encode_header(const kspace_info* info, unsigned char* header);
+
+/**
+ * 读取并检查文件头 (新旧格式均可)，文件大小必须与头中的尺寸相符
+ * @return 0表示成功，-1表示失败 (已打印原因)
+ */
+int kspace_read_info(int fd, kspace_info* info);
+
+/**
+ * 保存K空间数据 (新格式)，double 数据按 dtype 存储
+ * @param real 实部 (height x width，总是完整的频谱)
+ * @param imag 虚部 (height x width)
+ * @param dtype KSPACE_F64、KSPACE_F32 或 KSPACE_F16
+ * @param layout KSPACE_SPLIT 或 KSPACE_INTERLEAVED
+ * @param flags 0 或 KSPACE_HERMITIAN (调用者保证频谱共轭对称，只写入前 width/2+1 列)
+ * @return 0表示成功，-1表示失败
+ */
+int kspace_save(const char* filename, const double* real, const double* imag,
+                int width, int height, int dtype, int layout, int flags);
+
+/**
+ * 保存多层K空间数据 (depth 个连续存放的 height x width 层)
+ * @param flags 0、KSPACE_HERMITIAN、KSPACE_VOLUME 的组合；
+ *              三维数据的半谱要求整个体积共轭对称 (实数体积的三维频谱)，多层二维数据要求每层各自共轭对称
+ * @return 0表示成功，-1表示失败
+ */
+int kspace_save_volume(const char* filename, const double* real, const double* imag,
+                       int width, int height, int depth, int dtype, int layout, int flags);
+
+/**
+ * 保存单精度K空间数据 (新格式，float32)
+ */
+int kspace_save_f32(const char* filename, const float* real, const float* imag,
+                    int width, int height, int layout);
+
+/**
+ * 只读映射K空间文件
+ * @return 0表示成功，-1表示失败 (已打印原因)；成功后用 kspace_close 释放
+ */
+int kspace_open(const char* filename, kspace_file* ks);
+
+/**
+ * 解除映射
+ */
+void kspace_close(kspace_file* ks);
+
+/**
+ * 映射中的数据能否不经转换直接作为 dtype 的分离平面使用 (real/imag 即为输入数组)
+ * float16 和半谱文件总是需要经过 kspace_read_rows 展开
+ */
+int kspace_is_direct(const kspace_file* ks, int dtype);
+
+/**
+ * 从映射中读取若干行，转换为 dtype 的分离平面 (float16 乘以行缩放系数，半谱展开为完整的行)
+ * @param row 起始行 (全局行号，多层数据可以一次读取若干层)
+ * @param rows 行数
+ * @param re 输出实部 (rows x width)
+ * @param im 输出虚部 (rows x width)
+ * @param dtype 输出元素类型 KSPACE_F64 或 KSPACE_F32
+ * @return 0表示成功，-1表示参数无效或内存分配失败
+ */
+int kspace_read_rows(const kspace_file* ks, int row, int rows, void* re, void* im, int dtype);
+
+/**
+ * 用 pread 从文件读取若干行，转换为 double 的分离平面 (不映射文件，用于分块处理)
+ * @return 0表示成功，-1表示失败
+ */
+int kspace_pread_rows(int fd, const kspace_info* info, int row, int rows, double* re, double* im);
+
+#endif /* KSPACE_IO_H */
@@ -1,315 +1,643 @@
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 #include <stdint.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+#include "fft.h"
+#include "kspace_io.h"
+#include "image_io.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-// BMP 文件头结构
-#pragma pack(push, 1)
-typedef struct {
-    uint16_t type;
-    uint32_t size;
-    uint16_t reserved1;
-    uint16_t reserved2;
-    uint32_t offset;
-} BMPFileHeader;
-
-typedef struct {
-    uint32_t size;
-    int32_t  width;
-    int32_t  height;
-    uint16_t planes;
-    uint16_t bits;
-    uint32_t compression;
-    uint32_t imagesize;
-    int32_t  xresolution;
-    int32_t  yresolution;
-    uint32_t ncolors;
-    uint32_t importantcolors;
-} BMPInfoHeader;
-#pragma pack(pop)
+// 灰度图像的输出格式 (--image 选项)
+static int image_format = IMAGE_BMP24;
+
+/**
+ * 保存灰度图像 (按数据自身的范围归一化)
+ * @param name 不含扩展名的文件名，扩展名由输出格式决定
+ */
+int save_image(const char* name, const double* data, int width, int height) {
+    char filename[256];
+    snprintf(filename, sizeof(filename), "%s.%s", name, image_format_ext(image_format));
+    return image_save(filename, data, width, height, image_format);
+}
+
+/**
+ * 计算一维离散傅里叶逆变换 (1D IDFT)，内部使用 FFT 实现
+ */
+void calculate_1d_idft(double* X_real, double* X_imag, int N, double* x_real, double* x_imag) {
+    ifft_1d(X_real, X_imag, N, x_real, x_imag);
+}
 
 /**
- * 将数值归一化到 [0, 255] 范围
+ * 显示采样掩码的统计 (欠采样时)
  */
-uint8_t normalize_to_byte(double value, double min_val, double max_val) {
-    if (max_val == min_val) return 128;
-    double normalized = (value - min_val) / (max_val - min_val) * 255.0;
-    if (normalized < 0) return 0;
-    if (normalized > 255) return 255;
-    return (uint8_t)normalized;
+static void print_sampling(const unsigned char* row_mask, int M) {
+    int sampled = 0;
+    for (int i = 0; i < M; i++) {
+        sampled += row_mask[i] != 0;
+    }
+    if (sampled < M) {
+        printf("  欠采样: %d / %d 行有数据 (加速因子 %.2f)，只变换采样行，列变换按采样分布剪枝\n",
+               sampled, M, sampled > 0 ? (double)M / sampled : 0.0);
+    }
+}
+
+/**
+ * 计算二维离散傅里叶逆变换 (2D IDFT)
+ * 先逐行变换，再分块转置后逐行完成列变换 (见 ifft_2d)；
+ * 欠采样的K空间 (补零重建) 跳过未采样的行，列变换按采样行的分布分解为较短的变换 (见 ifft_2d_pruned)
+ * 输入与输出可以是同一组数组 (原地变换)，使用缓存的二维计划，不分配临时图像
+ * @param row_mask 采样掩码 (长度 M，非 0 表示该行已采样)，NULL 表示把全零行视为未采样
+ */
+void calculate_2d_idft(const double* X_real, const double* X_imag, int M, int N,
+                       const unsigned char* row_mask, double* x_real, double* x_imag) {
+    unsigned char *detected = row_mask ? NULL : (unsigned char *)malloc((size_t)M);
+    if (detected) {
+        fft_row_mask(X_real, X_imag, M, N, detected);
+        row_mask = detected;
+    }
+    printf("正在执行 2D IDFT...\n");
+    printf("  步骤1: 对 %d 行进行 1D IDFT...\n", M);
+    printf("  步骤2: 分块转置后对 %d 列进行 1D IDFT...\n", N);
+    if (row_mask) {
+        print_sampling(row_mask, M);
+    }
+    int result = ifft_2d_pruned(X_real, X_imag, M, N, row_mask, x_real, x_imag);
+    free(detected);
+    if (result != 0) {
+        printf("2D IDFT 失败\n");
+        return;
+    }
+    printf("2D IDFT 完成！\n");
+}
+
+/**
+ * 单精度二维离散傅里叶逆变换 (2D IDFT)，含 1/(MN) 归一化
+ * @param row_mask 采样掩码，NULL 表示把全零行视为未采样
+ */
+void calculate_2d_idft_f(const float* X_real, const float* X_imag, int M, int N,
+                         const unsigned char* row_mask, float* x_real, float* x_imag) {
+    unsigned char *detected = row_mask ? NULL : (unsigned char *)malloc((size_t)M);
+    if (detected) {
+        fftf_row_mask(X_real, X_imag, M, N, detected);
+        row_mask = detected;
+    }
+    printf("正在执行 2D IDFT (float)...\n");
+    if (row_mask) {
+        print_sampling(row_mask, M);
+    }
+    int result = ifftf_2d_pruned(X_real, X_imag, M, N, row_mask, x_real, x_imag);
+    free(detected);
+    if (result != 0) {
+        printf("2D IDFT (float) 失败\n");
+        return;
+    }
+    printf("2D IDFT 完成！\n");
 }
 
 /**
- * 将 2D 数据保存为灰度 BMP 图像
+ * 读取采样掩码文件: 文本中依次为每一行的 0 或 1 (空白分隔，# 开头到行尾为注释)
+ * @param mask 输出，长度 M
+ * @return 0表示成功，-1表示失败
  */
-int save_bmp_grayscale(const char* filename, double* data, int width, int height) {
-    FILE* file = fopen(filename, "wb");
+int load_row_mask(const char* filename, int M, unsigned char* mask) {
+    FILE *file = fopen(filename, "r");
     if (!file) {
-        printf("无法创建文件: %s\n", filename);
+        printf("无法打开采样掩码文件: %s\n", filename);
         return -1;
     }
-    
-    // 找出数据的最小值和最大值
-    double min_val = data[0], max_val = data[0];
-    for (int i = 1; i < width * height; i++) {
-        if (data[i] < min_val) min_val = data[i];
-        if (data[i] > max_val) max_val = data[i];
-    }
-    
-    // BMP 要求每行字节数是 4 的倍数
-    int row_size = ((width * 3 + 3) / 4) * 4;
-    int padding = row_size - width * 3;
-    
-    // 填充文件头
-    BMPFileHeader file_header;
-    file_header.type = 0x4D42;
-    file_header.size = sizeof(BMPFileHeader) + sizeof(BMPInfoHeader) + row_size * height;
-    file_header.reserved1 = 0;
-    file_header.reserved2 = 0;
-    file_header.offset = sizeof(BMPFileHeader) + sizeof(BMPInfoHeader);
-    
-    // 填充信息头
-    BMPInfoHeader info_header;
-    info_header.size = sizeof(BMPInfoHeader);
-    info_header.width = width;
-    info_header.height = height;
-    info_header.planes = 1;
-    info_header.bits = 24;
-    info_header.compression = 0;
-    info_header.imagesize = row_size * height;
-    info_header.xresolution = 2835;
-    info_header.yresolution = 2835;
-    info_header.ncolors = 0;
-    info_header.importantcolors = 0;
-    
-    // 写入文件头和信息头
-    fwrite(&file_header, sizeof(BMPFileHeader), 1, file);
-    fwrite(&info_header, sizeof(BMPInfoHeader), 1, file);
-    
-    // 写入像素数据 (BMP 从下到上存储)
-    uint8_t pad[3] = {0, 0, 0};
-    for (int i = height - 1; i >= 0; i--) {
-        for (int j = 0; j < width; j++) {
-            uint8_t pixel = normalize_to_byte(data[i * width + j], min_val, max_val);
-            fwrite(&pixel, 1, 1, file);  // B
-            fwrite(&pixel, 1, 1, file);  // G
-            fwrite(&pixel, 1, 1, file);  // R
-        }
-        if (padding > 0) {
-            fwrite(pad, 1, padding, file);
+    int count = 0, c;
+    while (count < M && (c = fgetc(file)) != EOF) {
+        if (c == '#') {
+            while ((c = fgetc(file)) != EOF && c != '\n') {}
+        } else if (c >= '0' && c <= '9') {
+            ungetc(c, file);
+            int value;
+            if (fscanf(file, "%d", &value) != 1) break;
+            mask[count++] = value != 0;
         }
     }
-    
     fclose(file);
-    printf("已保存图像: %s (尺寸: %dx%d, 范围: [%.3f, %.3f])\n", 
-           filename, width, height, min_val, max_val);
+    if (count < M) {
+        printf("采样掩码文件 %s 只有 %d 个值 (需要 %d 行)\n", filename, count, M);
+        return -1;
+    }
     return 0;
 }
 
 /**
- * 从二进制文件加载K空间数据
+ * 显示K空间文件的格式信息
  */
-int load_kspace_binary(const char* filename, double** real, double** imag, int* width, int* height) {
-    FILE* file = fopen(filename, "rb");
-    if (!file) {
-        printf("无法打开文件: %s\n", filename);
-        return -1;
+static void print_kspace_info(const kspace_info* info) {
+    if (info->depth > 1) {
+        printf("K空间数据尺寸: %d x %d x %d 层 (%s)\n", info->width, info->height, info->depth,
+               (info->flags & KSPACE_VOLUME) ? "三维K空间" : "多层二维");
+    } else {
+        printf("K空间数据尺寸: %d x %d\n", info->width, info->height);
     }
-    
-    // 读取文件头
-    size_t read_count;
-    read_count = fread(width, sizeof(int), 1, file);
-    if (read_count != 1) {
-        printf("读取宽度失败\n");
-        fclose(file);
+    if (info->version == 0) {
+        printf("文件格式: 旧格式 (无文件头)\n");
+    } else {
+        printf("文件格式: 版本 %d, %s%s\n", info->version,
+               info->layout == KSPACE_INTERLEAVED ? "复数交错" : "实部/虚部分离",
+               info->swapped ? ", 字节序与本机不同" : "");
+    }
+    printf("数据类型: %s\n", kspace_dtype_name(info->dtype));
+    if (info->flags & KSPACE_HERMITIAN) {
+        printf("存储方式: 共轭对称半谱 (每行保存 %d 列，读取时展开)\n", info->stored_width);
+    }
+}
+
+/*
+ * 分块 (out-of-core) 重建
+ *
+ * K空间文件大于内存时，按内存预算分块完成与 calculate_2d_idft 相同的计算：
+ * 1. 行阶段: 每次读入若干行做 1D IDFT，转置后写入临时文件 (临时文件按列存放，N x M)
+ * 2. 列阶段: 每次从临时文件连续读入若干列，转置回 M x 列数，做列方向的 1D IDFT 并乘以 1/(MN)，
+ *    按行写入输出文件 (K空间文件格式，float64 分离平面)
+ * 两个阶段使用与二维计划相同的批量内核 (行连续、列跨度不为 1)，结果与整幅变换逐位一致。
+ */
+
+/**
+ * 完整读取 bytes 个字节 (pread 可能只返回一部分)
+ */
+static int pread_full(int fd, void* buf, size_t bytes, off_t offset) {
+    char *p = (char *)buf;
+    while (bytes > 0) {
+        ssize_t n = pread(fd, p, bytes, offset);
+        if (n <= 0) return -1;
+        p += n;
+        bytes -= (size_t)n;
+        offset += n;
+    }
+    return 0;
+}
+
+static int pwrite_full(int fd, const void* buf, size_t bytes, off_t offset) {
+    const char *p = (const char *)buf;
+    while (bytes > 0) {
+        ssize_t n = pwrite(fd, p, bytes, offset);
+        if (n <= 0) return -1;
+        p += n;
+        bytes -= (size_t)n;
+        offset += n;
+    }
+    return 0;
+}
+
+/**
+ * 下一块的大小: 不超过 limit，且不留下只有 1 行/列的最后一块
+ * (批量变换只在不少于 2 个信号时交错执行，与整幅变换保持相同的执行路径)
+ */
+static int ooc_block_count(int total, int start, int limit) {
+    int count = (total - start < limit) ? total - start : limit;
+    if (total - start - count == 1) {
+        count = (count > 2) ? count - 1 : count + 1;
+    }
+    return count;
+}
+
+/**
+ * 分块执行 2D IDFT
+ * @param in_fd K空间文件，in 为其文件头 (新旧格式、任意元素类型和存放方式)
+ * @param tmp_fd 临时文件 (转置的中间结果)
+ * @param out_fd 输出文件，out 为其布局 (float64 分离平面)，写入文件头和图像的实部、虚部平面
+ * @param budget 两个阶段各自缓冲区的字节数上限
+ * @param stats 输出统计: [最小实部, 最大实部, 实部之和, 最大|虚部|, |虚部|之和]
+ * @return 0表示成功，-1表示失败
+ */
+static int ooc_2d_idft(int in_fd, const kspace_info* in, int tmp_fd, int out_fd, const kspace_info* out,
+                       int M, int N, size_t budget, double* stats) {
+    size_t plane = (size_t)M * N;
+
+    // 每块需要读入和转置两份缓冲区，每份实部、虚部各一个平面
+    size_t row_bytes = 4 * (size_t)N * sizeof(double);
+    size_t col_bytes = 4 * (size_t)M * sizeof(double);
+    int rows_per_block = (int)((budget / row_bytes < (size_t)M) ? budget / row_bytes : (size_t)M);
+    int cols_per_block = (int)((budget / col_bytes < (size_t)N) ? budget / col_bytes : (size_t)N);
+    if (rows_per_block < 2) rows_per_block = (M < 2) ? M : 2;
+    if (cols_per_block < 2) cols_per_block = (N < 2) ? N : 2;
+    printf("  行块: %d 行, 列块: %d 列\n", rows_per_block, cols_per_block);
+
+    size_t max_block = (size_t)(rows_per_block + 1) * N;
+    if ((size_t)(cols_per_block + 1) * M > max_block) max_block = (size_t)(cols_per_block + 1) * M;
+    double *buffer = (double *)malloc(4 * max_block * sizeof(double));
+    if (!buffer) {
+        printf("内存分配失败\n");
         return -1;
     }
-    
-    read_count = fread(height, sizeof(int), 1, file);
-    if (read_count != 1) {
-        printf("读取高度失败\n");
-        fclose(file);
+    double *a_real = buffer, *a_imag = buffer + max_block;
+    double *b_real = buffer + 2 * max_block, *b_imag = buffer + 3 * max_block;
+
+    // 1. 行阶段
+    printf("  步骤1: 分块对 %d 行进行 1D IDFT，转置写入临时文件...\n", M);
+    for (int r0 = 0, count; r0 < M; r0 += count) {
+        count = ooc_block_count(M, r0, rows_per_block);
+        if (kspace_pread_rows(in_fd, in, r0, count, a_real, a_imag) != 0) {
+            printf("读取K空间数据失败\n");
+            free(buffer);
+            return -1;
+        }
+        fft_plan_many *rows = fft_plan_many_get(N, count, 1, N, FFT_INVERSE);
+        if (!rows || fft_execute_many(rows, a_real, a_imag, a_real, a_imag) != 0) {
+            printf("行变换失败\n");
+            free(buffer);
+            return -1;
+        }
+
+        // 临时文件中第 j 列占连续的 M 个元素，这一块写入其中的 [r0, r0 + count)
+        fft_transpose(a_real, count, N, b_real);
+        fft_transpose(a_imag, count, N, b_imag);
+        for (int j = 0; j < N; j++) {
+            off_t pos = ((off_t)j * M + r0) * (off_t)sizeof(double);
+            if (pwrite_full(tmp_fd, b_real + (size_t)j * count, count * sizeof(double), pos) != 0 ||
+                pwrite_full(tmp_fd, b_imag + (size_t)j * count, count * sizeof(double),
+                            pos + (off_t)plane * sizeof(double)) != 0) {
+                printf("写入临时文件失败\n");
+                free(buffer);
+                return -1;
+            }
+        }
+    }
+
+    // 2. 列阶段
+    printf("  步骤2: 分块读入 %d 列进行 1D IDFT，按行写入输出文件...\n", N);
+    unsigned char header[KSPACE_HEADER_SIZE];
+    kspace_encode_header(out, header);
+    if (pwrite_full(out_fd, header, sizeof(header), 0) != 0) {
+        printf("写入输出文件失败\n");
+        free(buffer);
         return -1;
     }
-    
-    printf("K空间数据尺寸: %d x %d\n", *width, *height);
-    
-    // 分配内存
-    *real = (double*)malloc((*width) * (*height) * sizeof(double));
-    *imag = (double*)malloc((*width) * (*height) * sizeof(double));
-    
-    if (!*real || !*imag) {
+    double scale = 1.0 / ((double)M * N);
+    stats[0] = INFINITY;
+    stats[1] = -INFINITY;
+    stats[2] = stats[3] = stats[4] = 0.0;
+    for (int c0 = 0, count; c0 < N; c0 += count) {
+        count = ooc_block_count(N, c0, cols_per_block);
+        size_t n = (size_t)count * M;
+        off_t offset = (off_t)c0 * M * (off_t)sizeof(double);
+        if (pread_full(tmp_fd, a_real, n * sizeof(double), offset) != 0 ||
+            pread_full(tmp_fd, a_imag, n * sizeof(double), offset + (off_t)plane * sizeof(double)) != 0) {
+            printf("读取临时文件失败\n");
+            free(buffer);
+            return -1;
+        }
+
+        // 转置回 M 行 count 列，列变换的样本跨度为 count
+        fft_transpose(a_real, count, M, b_real);
+        fft_transpose(a_imag, count, M, b_imag);
+        fft_plan_many *cols = fft_plan_many_get(M, count, count, 1, FFT_INVERSE);
+        if (!cols || fft_execute_many(cols, b_real, b_imag, b_real, b_imag) != 0) {
+            printf("列变换失败\n");
+            free(buffer);
+            return -1;
+        }
+        for (size_t i = 0; i < n; i++) {
+            b_real[i] *= scale;
+            b_imag[i] *= scale;
+            if (b_real[i] < stats[0]) stats[0] = b_real[i];
+            if (b_real[i] > stats[1]) stats[1] = b_real[i];
+            stats[2] += b_real[i];
+            if (fabs(b_imag[i]) > stats[3]) stats[3] = fabs(b_imag[i]);
+            stats[4] += fabs(b_imag[i]);
+        }
+
+        for (int i = 0; i < M; i++) {
+            off_t pos = ((off_t)i * N + c0) * (off_t)sizeof(double);
+            if (pwrite_full(out_fd, b_real + (size_t)i * count, count * sizeof(double),
+                            (off_t)out->real_offset + pos) != 0 ||
+                pwrite_full(out_fd, b_imag + (size_t)i * count, count * sizeof(double),
+                            (off_t)out->imag_offset + pos) != 0) {
+                printf("写入输出文件失败\n");
+                free(buffer);
+                return -1;
+            }
+        }
+    }
+
+    free(buffer);
+    return 0;
+}
+
+/**
+ * 逐行从图像文件 (K空间文件格式，float64 分离平面，布局为 image) 读取实部，保存为灰度图像
+ * 只需要一行的缓冲区；min_val/max_val 由调用者预先统计
+ */
+static int save_image_from_file(const char* name, int fd, const kspace_info* image,
+                                double min_val, double max_val) {
+    int width = image->width, height = image->height;
+    char filename[256];
+    snprintf(filename, sizeof(filename), "%s.%s", name, image_format_ext(image_format));
+    double *row = (double *)malloc((size_t)width * sizeof(double));
+    if (!row) {
         printf("内存分配失败\n");
-        fclose(file);
         return -1;
     }
-    
-    // 读取实部数据
-    read_count = fread(*real, sizeof(double), (*width) * (*height), file);
-    if (read_count != (*width) * (*height)) {
-        printf("读取实部数据失败\n");
-        fclose(file);
-        free(*real);
-        free(*imag);
+    image_writer writer;
+    if (image_writer_open(&writer, filename, width, height, image_format) != 0) {
+        free(row);
         return -1;
     }
-    
-    // 读取虚部数据
-    read_count = fread(*imag, sizeof(double), (*width) * (*height), file);
-    if (read_count != (*width) * (*height)) {
-        printf("读取虚部数据失败\n");
-        fclose(file);
-        free(*real);
-        free(*imag);
+
+    for (int k = 0; k < height; k++) {
+        int i = image_writer_next_row(&writer);
+        off_t pos = (off_t)image->real_offset + (off_t)i * width * (off_t)sizeof(double);
+        if (pread_full(fd, row, (size_t)width * sizeof(double), pos) != 0) {
+            printf("读取图像文件失败\n");
+            break;
+        }
+        if (image_writer_put(&writer, row, min_val, max_val) != 0) {
+            printf("写入图像失败: %s\n", filename);
+            break;
+        }
+    }
+
+    free(row);
+    if (image_writer_close(&writer) != 0) {
         return -1;
     }
-    
-    fclose(file);
-    printf("已加载K空间数据: %s (尺寸: %dx%d)\n", filename, *width, *height);
+    printf("已保存图像: %s (尺寸: %dx%d, 范围: [%.3f, %.3f])\n",
+           filename, width, height, min_val, max_val);
     return 0;
 }
 
+/*
+ * 多层重建
+ *
+ * 一次进程启动重建整个检查的所有层，不再每层运行一次程序：
+ * - 多层二维数据 (层间独立) 用 ifft_2d_many: 层数不少于线程数时各线程整层领取，
+ *   每层的行、列变换都在同一个线程内完成，层与层之间没有同步
+ * - 三维K空间 (KSPACE_VOLUME) 用 ifft_3d: 各层二维逆变换之后再沿深度方向做批量一维逆变换
+ * 所有层使用同一个灰度范围，输出每层一幅图像，或用 --montage 把各层按网格拼成一幅总览图。
+ */
+
 /**
- * 计算一维离散傅里叶逆变换 (1D IDFT)
+ * 把 depth 层 height x width 的图像按 cols 列的网格拼成一幅图像 (逐行写入，空格子填最小值)
  */
-void calculate_1d_idft(double* X_real, double* X_imag, int N, double* x_real, double* x_imag) {
-    for (int n = 0; n < N; n++) {
-        x_real[n] = 0.0;
-        x_imag[n] = 0.0;
-        for (int k = 0; k < N; k++) {
-            double angle = 2.0 * M_PI * k * n / N;
-            double cos_val = cos(angle);
-            double sin_val = sin(angle);
-            // 复数乘法: (a + bi) * (cos + i*sin)
-            x_real[n] += X_real[k] * cos_val - X_imag[k] * sin_val;
-            x_imag[n] += X_imag[k] * cos_val + X_real[k] * sin_val;
+static int save_montage(const char* name, const double* volume, int width, int height, int depth,
+                        double min_val, double max_val) {
+    int cols = (int)ceil(sqrt((double)depth));
+    int rows = (depth + cols - 1) / cols;
+    int montage_width = cols * width, montage_height = rows * height;
+    char filename[256];
+    snprintf(filename, sizeof(filename), "%s.%s", name, image_format_ext(image_format));
+    double *line = (double *)malloc((size_t)montage_width * sizeof(double));
+    if (!line) {
+        printf("内存分配失败\n");
+        return -1;
+    }
+    image_writer writer;
+    if (image_writer_open(&writer, filename, montage_width, montage_height, image_format) != 0) {
+        free(line);
+        return -1;
+    }
+
+    int ok = 1;
+    for (int k = 0; k < montage_height && ok; k++) {
+        int y = image_writer_next_row(&writer);
+        int tile_row = y / height, i = y % height;
+        for (int c = 0; c < cols; c++) {
+            int s = tile_row * cols + c;
+            double *dst = line + (size_t)c * width;
+            if (s < depth) {
+                memcpy(dst, volume + ((size_t)s * height + i) * width, (size_t)width * sizeof(double));
+            } else {
+                for (int j = 0; j < width; j++) dst[j] = min_val;
+            }
         }
-        // 归一化
-        x_real[n] /= N;
-        x_imag[n] /= N;
+        ok = image_writer_put(&writer, line, min_val, max_val) == 0;
     }
+
+    free(line);
+    if (image_writer_close(&writer) != 0 || !ok) {
+        printf("写入图像失败: %s\n", filename);
+        return -1;
+    }
+    printf("已保存总览图: %s (%d x %d 格, 尺寸: %dx%d)\n", filename, cols, rows, montage_width, montage_height);
+    return 0;
 }
 
 /**
- * 计算二维离散傅里叶逆变换 (2D IDFT)
+ * 多层 / 三维K空间的重建
+ * @param montage 为 1 时输出一幅总览图，否则每层一幅图像
+ * @return 进程退出码
  */
-void calculate_2d_idft(double* X_real, double* X_imag, int M, int N, 
-                       double* x_real, double* x_imag) {
-    printf("正在执行 2D IDFT...\n");
-    
-    // 临时存储数组
-    double *temp_real = (double *)malloc(M * N * sizeof(double));
-    double *temp_imag = (double *)malloc(M * N * sizeof(double));
-    double *row_real = (double *)malloc(N * sizeof(double));
-    double *row_imag = (double *)malloc(N * sizeof(double));
-    double *row_out_real = (double *)malloc(N * sizeof(double));
-    double *row_out_imag = (double *)malloc(N * sizeof(double));
-    
-    if (!temp_real || !temp_imag || !row_real || !row_imag || !row_out_real || !row_out_imag) {
+static int reconstruct_slices(const kspace_file* ks, int montage) {
+    int width = ks->info.width, height = ks->info.height, depth = ks->info.depth;
+    int volume = (ks->info.flags & KSPACE_VOLUME) != 0;
+    size_t plane = (size_t)width * height;
+    size_t count = plane * depth;
+
+    double *image_real = (double *)malloc(count * sizeof(double));
+    double *image_imag = (double *)malloc(count * sizeof(double));
+    if (!image_real || !image_imag) {
         printf("内存分配失败\n");
-        return;
+        free(image_real);
+        free(image_imag);
+        return 1;
     }
-    
-    // 第一步: 对每一行进行1D IDFT
-    printf("  步骤1: 对 %d 行进行 1D IDFT...\n", M);
-    for (int i = 0; i < M; i++) {
-        if (i % 50 == 0) printf("    处理第 %d/%d 行...\r", i, M);
-        
-        // 提取第i行
-        for (int j = 0; j < N; j++) {
-            row_real[j] = X_real[i * N + j];
-            row_imag[j] = X_imag[i * N + j];
-        }
-        
-        // 对该行进行1D IDFT
-        calculate_1d_idft(row_real, row_imag, N, row_out_real, row_out_imag);
-        
-        // 存储结果
-        for (int j = 0; j < N; j++) {
-            temp_real[i * N + j] = row_out_real[j];
-            temp_imag[i * N + j] = row_out_imag[j];
-        }
+
+    // float64 分离平面直接以映射为输入，其他存储方式先转换到输出数组再原地变换
+    int direct = kspace_is_direct(ks, KSPACE_F64);
+    if (!direct && kspace_read_rows(ks, 0, kspace_total_rows(&ks->info), image_real, image_imag, KSPACE_F64) != 0) {
+        printf("读取K空间数据失败\n");
+        free(image_real);
+        free(image_imag);
+        return 1;
     }
-    printf("    完成所有行的处理          \n");
-    
-    // 分配列数组
-    double *col_real = (double *)malloc(M * sizeof(double));
-    double *col_imag = (double *)malloc(M * sizeof(double));
-    double *col_out_real = (double *)malloc(M * sizeof(double));
-    double *col_out_imag = (double *)malloc(M * sizeof(double));
-    
-    if (!col_real || !col_imag || !col_out_real || !col_out_imag) {
-        printf("内存分配失败\n");
-        free(temp_real); free(temp_imag);
-        free(row_real); free(row_imag); free(row_out_real); free(row_out_imag);
-        return;
+    const double *in_real = direct ? (const double *)ks->real : image_real;
+    const double *in_imag = direct ? (const double *)ks->imag : image_imag;
+    printf("变换输入: %s\n", direct ? "直接读取文件映射" : "转换为计算精度后原地变换");
+
+    // 可视化一层的K空间: 三维数据取 kz = 0 的一层，多层二维数据取中间一层
+    int spectrum_slice = volume ? 0 : depth / 2;
+    char spectrum_file[256];
+    snprintf(spectrum_file, sizeof(spectrum_file), "kspace_magnitude_spectrum.%s", image_format_ext(image_format));
+    printf("K空间幅度谱: 第 %d 层\n", spectrum_slice);
+    image_save_spectrum(spectrum_file, in_real + spectrum_slice * plane, in_imag + spectrum_slice * plane,
+                        width, height, IMAGE_SPECTRUM_LOG, image_format);
+
+    int result;
+    if (volume) {
+        printf("\n正在执行 3D IDFT (%d 层二维变换 + 深度方向 %d 点变换)...\n", depth, depth);
+        result = ifft_3d(in_real, in_imag, depth, height, width, image_real, image_imag);
+    } else {
+        printf("\n正在执行 %d 层 2D IDFT (按层分配给 %d 个线程)...\n", depth,
+               fft_get_threads() < depth ? fft_get_threads() : depth);
+        result = ifft_2d_many(in_real, in_imag, height, width, depth, image_real, image_imag);
     }
-    
-    // 第二步: 对每一列进行1D IDFT
-    printf("  步骤2: 对 %d 列进行 1D IDFT...\n", N);
-    for (int j = 0; j < N; j++) {
-        if (j % 50 == 0) printf("    处理第 %d/%d 列...\r", j, N);
-        
-        // 提取第j列
-        for (int i = 0; i < M; i++) {
-            col_real[i] = temp_real[i * N + j];
-            col_imag[i] = temp_imag[i * N + j];
+    if (result != 0) {
+        printf("逆变换失败\n");
+        free(image_real);
+        free(image_imag);
+        return 1;
+    }
+    printf("逆变换完成！\n\n");
+
+    // 所有层共用一个灰度范围，层与层之间的亮度可以直接比较
+    double min_real, max_real, sum_real = 0.0, max_imag = 0.0, sum_imag = 0.0;
+    image_minmax(image_real, count, &min_real, &max_real);
+    for (size_t i = 0; i < count; i++) {
+        double abs_imag = fabs(image_imag[i]);
+        if (abs_imag > max_imag) max_imag = abs_imag;
+        sum_imag += abs_imag;
+        sum_real += image_real[i];
+    }
+
+    if (montage) {
+        save_montage("reconstructed_montage", image_real, width, height, depth, min_real, max_real);
+    } else {
+        char filename[256];
+        for (int s = 0; s < depth; s++) {
+            snprintf(filename, sizeof(filename), "reconstructed_slice_%03d.%s", s, image_format_ext(image_format));
+            if (image_save_range(filename, image_real + s * plane, width, height, image_format,
+                                 min_real, max_real) != 0) {
+                break;
+            }
         }
-        
-        // 对该列进行1D IDFT
-        calculate_1d_idft(col_real, col_imag, M, col_out_real, col_out_imag);
-        
-        // 存储结果
-        for (int i = 0; i < M; i++) {
-            x_real[i * N + j] = col_out_real[i];
-            x_imag[i * N + j] = col_out_imag[i];
+        printf("已保存 %d 层图像: reconstructed_slice_000.%s ... (范围: [%.3f, %.3f])\n",
+               depth, image_format_ext(image_format), min_real, max_real);
+    }
+
+    printf("\n=================================================\n");
+    printf("  图像还原统计 (全部 %d 层)\n", depth);
+    printf("=================================================\n");
+    printf("虚部分析 (理论上应接近0):\n");
+    printf("  最大虚部: %.6e\n", max_imag);
+    printf("  平均虚部: %.6e\n", sum_imag / (double)count);
+    printf("\n还原图像统计:\n");
+    printf("  最小值: %.6f\n", min_real);
+    printf("  最大值: %.6f\n", max_real);
+    printf("  平均值: %.6f\n", sum_real / (double)count);
+
+    int middle = depth / 2;
+    printf("\n还原图像 (第 %d 层左上角 8x8 区域):\n", middle);
+    for (int i = 0; i < 8 && i < height; i++) {
+        for (int j = 0; j < 8 && j < width; j++) {
+            printf("%6.2f ", image_real[middle * plane + (size_t)i * width + j]);
         }
+        printf("\n");
     }
-    printf("    完成所有列的处理          \n");
-    
-    // 释放临时内存
-    free(temp_real);
-    free(temp_imag);
-    free(row_real);
-    free(row_imag);
-    free(row_out_real);
-    free(row_out_imag);
-    free(col_real);
-    free(col_imag);
-    free(col_out_real);
-    free(col_out_imag);
-    
-    printf("2D IDFT 完成！\n");
+
+    printf("\n=================================================\n");
+    printf("输出文件:\n");
+    printf("  - kspace_magnitude_spectrum.%s  (第 %d 层的K空间幅度谱)\n", image_format_ext(image_format), spectrum_slice);
+    if (montage) {
+        printf("  - reconstructed_montage.%s      (全部 %d 层的总览图)\n", image_format_ext(image_format), depth);
+    } else {
+        printf("  - reconstructed_slice_NNN.%s    (每层一幅，共 %d 幅)\n", image_format_ext(image_format), depth);
+    }
+    printf("=================================================\n");
+
+    free(image_real);
+    free(image_imag);
+    return 0;
 }
 
 /**
- * FFT频谱中心化 (FFTShift) - 用于可视化幅度谱
+ * 分块重建模式: 峰值内存由 budget_mb 决定，与图像大小无关
+ * 输出 reconstructed_image.bin (图像的实部、虚部平面，格式同K空间文件) 和 reconstructed_image 图像
+ * @return 进程退出码
  */
-void fft_shift(double* data, int width, int height) {
-    double* temp = (double*)malloc(width * height * sizeof(double));
-    if (!temp) return;
-    
-    int half_h = height / 2;
-    int half_w = width / 2;
-    
-    for (int i = 0; i < height; i++) {
-        for (int j = 0; j < width; j++) {
-            int new_i = (i + half_h) % height;
-            int new_j = (j + half_w) % width;
-            temp[new_i * width + new_j] = data[i * width + j];
-        }
+static int reconstruct_out_of_core(const char* input_file, size_t budget_mb, const char* tmp_dir) {
+    int in_fd = open(input_file, O_RDONLY);
+    if (in_fd < 0) {
+        printf("无法打开文件: %s\n", input_file);
+        return 1;
     }
-    
-    for (int i = 0; i < width * height; i++) {
-        data[i] = temp[i];
+    kspace_info in;
+    if (kspace_read_info(in_fd, &in) != 0) {
+        close(in_fd);
+        return 1;
     }
-    
-    free(temp);
+    int width = in.width, height = in.height;
+    print_kspace_info(&in);
+    if (in.depth > 1) {
+        printf("错误: 分块重建只支持单层K空间数据\n");
+        close(in_fd);
+        return 1;
+    }
+    printf("内存预算: %zu MB\n\n", budget_mb);
+
+    // 临时文件创建后立即删除，进程退出时由系统回收
+    char tmp_path[4096];
+    snprintf(tmp_path, sizeof(tmp_path), "%s/kspace_ooc_XXXXXX", tmp_dir);
+    int tmp_fd = mkstemp(tmp_path);
+    if (tmp_fd < 0) {
+        printf("无法创建临时文件: %s\n", tmp_path);
+        close(in_fd);
+        return 1;
+    }
+    unlink(tmp_path);
+
+    const char *image_file = "reconstructed_image.bin";
+    kspace_info image;
+    kspace_info_init(&image, width, height, 1, KSPACE_F64, KSPACE_SPLIT, 0);
+    int out_fd = open(image_file, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0) {
+        printf("无法创建文件: %s\n", image_file);
+        close(tmp_fd);
+        close(in_fd);
+        return 1;
+    }
+
+    printf("正在执行分块 2D IDFT...\n");
+    double stats[5];
+    int result = ooc_2d_idft(in_fd, &in, tmp_fd, out_fd, &image,
+                             height, width, budget_mb << 20, stats);
+    close(tmp_fd);
+    close(in_fd);
+    fft_plan_cache_clear();
+    if (result != 0) {
+        close(out_fd);
+        return 1;
+    }
+    printf("2D IDFT 完成！已保存图像数据: %s\n\n", image_file);
+
+    save_image_from_file("reconstructed_image", out_fd, &image, stats[0], stats[1]);
+
+    double count = (double)width * height;
+    printf("\n=================================================\n");
+    printf("  图像还原统计\n");
+    printf("=================================================\n");
+    printf("虚部分析 (理论上应接近0):\n");
+    printf("  最大虚部: %.6e\n", stats[3]);
+    printf("  平均虚部: %.6e\n", stats[4] / count);
+    printf("\n还原图像统计:\n");
+    printf("  最小值: %.6f\n", stats[0]);
+    printf("  最大值: %.6f\n", stats[1]);
+    printf("  平均值: %.6f\n", stats[2] / count);
+
+    printf("\n还原图像 (左上角 8x8 区域):\n");
+    double corner[8];
+    int corner_width = width < 8 ? width : 8;
+    for (int i = 0; i < 8 && i < height; i++) {
+        off_t pos = (off_t)image.real_offset + (off_t)i * width * (off_t)sizeof(double);
+        if (pread_full(out_fd, corner, corner_width * sizeof(double), pos) != 0) break;
+        for (int j = 0; j < corner_width; j++) {
+            printf("%6.2f ", corner[j]);
+        }
+        printf("\n");
+    }
+    close(out_fd);
+
+    printf("\n=================================================\n");
+    printf("输出文件:\n");
+    printf("  - reconstructed_image.bin        (还原图像数据，实部+虚部)\n");
+    printf("  - reconstructed_image.%s        (还原图像)\n", image_format_ext(image_format));
+    printf("=================================================\n");
+    return 0;
 }
 
 int main(int argc, char *argv[]) {
@@ -317,68 +645,174 @@ int main(int argc, char *argv[]) {
     printf("  K空间数据 → 图像还原程序\n");
     printf("=================================================\n\n");
     
-    // 确定输入文件名
+    // 解析命令行参数: [--float] [--threads N] [--budget MB [--tmp-dir 目录]] [--image bmp|bmp8|pgm]
+    //                 [--montage] [--mask 采样掩码文件] [输入文件]
     const char *input_file = "kspace_data.bin";
-    if (argc > 1) {
-        input_file = argv[1];
+    const char *mask_file = NULL;   // 每行是否采样，不指定时把全零行视为未采样
+    const char *tmp_dir = ".";
+    int use_float = 0;  // 使用单精度重建
+    int montage = 0;    // 多层数据输出一幅总览图
+    long budget_mb = 0; // 大于 0 时使用分块重建
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--float") == 0 || strcmp(argv[i], "-f32") == 0) {
+            use_float = 1;
+        } else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+            budget_mb = atol(argv[++i]);
+            if (budget_mb < 1) {
+                printf("错误: 无效的内存预算 %s (单位 MB)\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--montage") == 0) {
+            montage = 1;
+        } else if (strcmp(argv[i], "--mask") == 0 && i + 1 < argc) {
+            mask_file = argv[++i];
+        } else if (strcmp(argv[i], "--tmp-dir") == 0 && i + 1 < argc) {
+            tmp_dir = argv[++i];
+        } else if (strcmp(argv[i], "--image") == 0 && i + 1 < argc) {
+            image_format = image_parse_format(argv[++i]);
+            if (image_format < 0) {
+                printf("错误: 无效的图像格式 %s (bmp、bmp8 或 pgm)\n", argv[i]);
+                return 1;
+            }
+        } else if ((strcmp(argv[i], "--threads") == 0 || strcmp(argv[i], "-t") == 0) && i + 1 < argc) {
+            if (fft_set_threads(atoi(argv[++i])) != 0) {
+                printf("错误: 无效的线程数 %s\n", argv[i]);
+                return 1;
+            }
+        } else {
+            input_file = argv[i];
+        }
     }
     
-    printf("输入文件: %s\n\n", input_file);
-    
-    // 加载K空间数据
-    double *kspace_real = NULL;
-    double *kspace_imag = NULL;
-    int width = 0, height = 0;
+    printf("输入文件: %s\n", input_file);
+    if (budget_mb > 0) {
+        if (use_float) {
+            printf("提示: 分块重建只支持双精度，忽略 --float\n");
+        }
+        if (mask_file) {
+            printf("提示: 分块重建变换全部行，忽略 --mask\n");
+        }
+        printf("重建方式: 分块 (out-of-core)\n");
+        printf("FFT 线程数: %d\n", fft_get_threads());
+        return reconstruct_out_of_core(input_file, (size_t)budget_mb, tmp_dir);
+    }
+    printf("计算精度: %s\n", use_float ? "float (单精度)" : "double (双精度)");
+    printf("FFT 线程数: %d\n\n", fft_get_threads());
     
-    if (load_kspace_binary(input_file, &kspace_real, &kspace_imag, &width, &height) != 0) {
+    // 只读映射K空间文件: 不复制数据，打开几乎不花时间，数据在变换读取时才按页读入
+    kspace_file ks;
+    if (kspace_open(input_file, &ks) != 0) {
         printf("加载K空间数据失败！\n");
         return 1;
     }
+    int width = ks.info.width, height = ks.info.height;
+    size_t count = (size_t)width * height;
+    print_kspace_info(&ks.info);
+    if (ks.info.depth > 1) {
+        if (use_float) {
+            printf("提示: 多层重建只支持双精度，忽略 --float\n");
+        }
+        if (mask_file) {
+            printf("提示: 多层重建变换全部行，忽略 --mask\n");
+        }
+        printf("\n");
+        int status = reconstruct_slices(&ks, montage);
+        kspace_close(&ks);
+        return status;
+    }
+    printf("已映射K空间数据: %s (尺寸: %dx%d)\n", input_file, width, height);
     
     printf("\n");
     
-    // 计算并保存K空间幅度谱 (用于可视化)
-    double *magnitude = (double *)malloc(width * height * sizeof(double));
-    if (magnitude) {
-        for (int i = 0; i < width * height; i++) {
-            magnitude[i] = sqrt(kspace_real[i] * kspace_real[i] + 
-                               kspace_imag[i] * kspace_imag[i]);
+    unsigned char *row_mask = NULL;
+    if (mask_file) {
+        row_mask = (unsigned char *)malloc((size_t)height);
+        if (!row_mask || load_row_mask(mask_file, height, row_mask) != 0) {
+            free(row_mask);
+            kspace_close(&ks);
+            return 1;
         }
-        
-        // 对幅度谱进行中心化
-        fft_shift(magnitude, width, height);
-        
-        // 保存对数幅度谱
-        double *log_magnitude = (double *)malloc(width * height * sizeof(double));
-        if (log_magnitude) {
-            for (int i = 0; i < width * height; i++) {
-                log_magnitude[i] = log(1.0 + magnitude[i]);
-            }
-            save_bmp_grayscale("kspace_magnitude_spectrum.bmp", log_magnitude, width, height);
-            free(log_magnitude);
-        }
-        
-        free(magnitude);
+        printf("采样掩码: %s\n\n", mask_file);
     }
     
-    // 分配还原图像的内存
-    double *image_real = (double *)malloc(width * height * sizeof(double));
-    double *image_imag = (double *)malloc(width * height * sizeof(double));
-    
-    if (!image_real || !image_imag) {
+    // 还原图像的数组 (非直接输入时先存放转换后的K空间数据)
+    double *image_real = (double *)malloc(count * sizeof(double));
+    double *image_imag = (double *)malloc(count * sizeof(double));
+    float *image_real_f = NULL;
+    float *image_imag_f = NULL;
+    if (use_float) {
+        image_real_f = (float *)malloc(count * sizeof(float));
+        image_imag_f = (float *)malloc(count * sizeof(float));
+    }
+    if (!image_real || !image_imag || (use_float && (!image_real_f || !image_imag_f))) {
         printf("内存分配失败\n");
-        free(kspace_real);
-        free(kspace_imag);
+        free(image_real);
+        free(image_imag);
+        free(image_real_f);
+        free(image_imag_f);
+        free(row_mask);
+        kspace_close(&ks);
+        return 1;
+    }
+    
+    // 保存中心化的K空间对数幅度谱 (用于可视化): 幅度、中心化、对数和量化在写入时一次完成。
+    // float64 分离平面直接使用映射，其他存储方式先转换到输出数组 (双精度还原时随后原地变换)
+    int spectrum_direct = kspace_is_direct(&ks, KSPACE_F64);
+    if (!spectrum_direct && kspace_read_rows(&ks, 0, height, image_real, image_imag, KSPACE_F64) != 0) {
+        printf("读取K空间数据失败: %s\n", input_file);
+        free(image_real);
+        free(image_imag);
+        free(image_real_f);
+        free(image_imag_f);
+        free(row_mask);
+        kspace_close(&ks);
         return 1;
     }
+    char spectrum_file[256];
+    snprintf(spectrum_file, sizeof(spectrum_file), "kspace_magnitude_spectrum.%s", image_format_ext(image_format));
+    image_save_spectrum(spectrum_file, spectrum_direct ? (const double *)ks.real : image_real,
+                        spectrum_direct ? (const double *)ks.imag : image_imag,
+                        width, height, IMAGE_SPECTRUM_LOG, image_format);
     
     // 执行2D逆傅里叶变换
-    calculate_2d_idft(kspace_real, kspace_imag, height, width, image_real, image_imag);
+    // 文件中是所需精度的分离平面时直接以映射为输入；否则先转换 (或拆分交错数据) 到输出数组，再原地变换
+    int dtype = use_float ? KSPACE_F32 : KSPACE_F64;
+    int direct = kspace_is_direct(&ks, dtype);
+    printf("变换输入: %s\n", direct ? "直接读取文件映射" : "转换为计算精度后原地变换");
+    if (use_float) {
+        // 单精度结果再转换为 double 供后续统计和保存
+        if (!direct && kspace_read_rows(&ks, 0, height, image_real_f, image_imag_f, KSPACE_F32) != 0) {
+            printf("读取K空间数据失败: %s\n", input_file);
+            free(image_real);
+            free(image_imag);
+            free(image_real_f);
+            free(image_imag_f);
+            free(row_mask);
+            kspace_close(&ks);
+            return 1;
+        }
+        calculate_2d_idft_f(direct ? (const float *)ks.real : image_real_f,
+                            direct ? (const float *)ks.imag : image_imag_f,
+                            height, width, row_mask, image_real_f, image_imag_f);
+        for (size_t i = 0; i < count; i++) {
+            image_real[i] = image_real_f[i];
+            image_imag[i] = image_imag_f[i];
+        }
+        free(image_real_f);
+        free(image_imag_f);
+    } else {
+        // 非直接输入时 image_real/image_imag 中已经是上面转换好的K空间数据
+        calculate_2d_idft(direct ? (const double *)ks.real : image_real,
+                          direct ? (const double *)ks.imag : image_imag,
+                          height, width, row_mask, image_real, image_imag);
+    }
+    free(row_mask);
+    kspace_close(&ks);
     
     printf("\n");
     
     // 保存还原的图像 (实部)
-    save_bmp_grayscale("reconstructed_image.bmp", image_real, width, height);
+    save_image("reconstructed_image", image_real, width, height);
     
     // 分析虚部 (理论上应该接近0)
     double max_imag = 0.0, avg_imag = 0.0;
@@ -422,13 +856,11 @@ int main(int argc, char *argv[]) {
     
     printf("\n=================================================\n");
     printf("输出文件:\n");
-    printf("  - kspace_magnitude_spectrum.bmp  (K空间幅度谱)\n");
-    printf("  - reconstructed_image.bmp        (还原图像)\n");
+    printf("  - kspace_magnitude_spectrum.%s  (K空间幅度谱)\n", image_format_ext(image_format));
+    printf("  - reconstructed_image.%s        (还原图像)\n", image_format_ext(image_format));
     printf("=================================================\n");
     
     // 释放内存
-    free(kspace_real);
-    free(kspace_imag);
     free(image_real);
     free(image_imag);
     
@@ -16,6 +16,9 @@
 #include <math.h>
 #include <string.h>
 
+#include "text_io.h"
+#include "oscillator.h"
+
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
@@ -41,15 +44,16 @@ void generate_am_signal(double *t, double *modulating, double *carrier,
         printf("警告: 调制指数 %.2f > 1.0，会产生过调制失真\n", modulation_index);
     }
     
+    // 调制信号（可以是任意基带信号，这里使用简单的正弦波）和载波信号由旋转振荡器生成
+    osc_rotator mod_osc, carrier_osc;
+    osc_rotator_init(&mod_osc, fm, fs, 0.0);
+    osc_rotator_init(&carrier_osc, fc, fs, 0.0);
+    osc_rotator_render(&mod_osc, modulating, NULL, n);
+    osc_rotator_render(&carrier_osc, carrier, NULL, n);
+    
     for (int i = 0; i < n; i++) {
         t[i] = i / fs;
         
-        // 调制信号（可以是任意基带信号，这里使用简单的正弦波）
-        modulating[i] = cos(2.0 * M_PI * fm * t[i]);
-        
-        // 载波信号
-        carrier[i] = cos(2.0 * M_PI * fc * t[i]);
-        
         // AM信号：s(t) = [A + m*m(t)] * cos(2π*fc*t)
         // 归一化后：s(t) = [1 + μ*m(t)] * cos(2π*fc*t)
         // 其中 μ 是调制指数
@@ -88,20 +92,30 @@ void generate_am_signal_complex(double *t, double *modulating, double *carrier,
     double freq2 = 500.0;  // 二次谐波
     double freq3 = 800.0;  // 三次谐波
     
+    // 三个频率分量先分别生成，carrier 和 am_signal 暂作第二、三个分量的缓冲区
+    osc_rotator osc;
+    osc_rotator_init(&osc, freq1, fs, 0.0);
+    osc_rotator_render(&osc, modulating, NULL, n);
+    osc_rotator_init(&osc, freq2, fs, 0.0);
+    osc_rotator_render(&osc, carrier, NULL, n);
+    osc_rotator_init(&osc, freq3, fs, 0.0);
+    osc_rotator_render(&osc, am_signal, NULL, n);
+    
     for (int i = 0; i < n; i++) {
         t[i] = i / fs;
         
         // 复杂调制信号（三个频率分量的叠加）
-        modulating[i] = 0.5 * cos(2.0 * M_PI * freq1 * t[i]) +
-                       0.3 * cos(2.0 * M_PI * freq2 * t[i]) +
-                       0.2 * cos(2.0 * M_PI * freq3 * t[i]);
+        modulating[i] = 0.5 * modulating[i] + 0.3 * carrier[i] + 0.2 * am_signal[i];
         
         // 归一化到 [-1, 1]
         modulating[i] = modulating[i] / 1.0;
-        
-        // 载波信号
-        carrier[i] = cos(2.0 * M_PI * fc * t[i]);
-        
+    }
+    
+    // 载波信号
+    osc_rotator_init(&osc, fc, fs, 0.0);
+    osc_rotator_render(&osc, carrier, NULL, n);
+    
+    for (int i = 0; i < n; i++) {
         // AM信号
         am_signal[i] = (1.0 + modulation_index * modulating[i]) * carrier[i];
     }
@@ -113,172 +127,37 @@ void generate_am_signal_complex(double *t, double *modulating, double *carrier,
     printf("  调制指数 μ = %.2f\n", modulation_index);
 }
 
-/**
- * @brief AM包络检波解调
- * 
- * 使用包络检波器提取AM信号的调制信号
- * 原理：通过整流 + 低通滤波提取包络
- * 
- * @param am_signal 输入的AM信号
- * @param demod_signal 输出的解调信号
- * @param n 采样点数
- * @param fs 采样频率
- */
-void am_demodulate_envelope(double *am_signal, double *demod_signal, int n, double fs) {
-    // 方法1：简单的包络检波（全波整流 + 低通滤波）
-    
-    // 步骤1：全波整流
-    double *rectified = (double *)malloc(n * sizeof(double));
-    for (int i = 0; i < n; i++) {
-        rectified[i] = fabs(am_signal[i]);
-    }
-    
-    // 步骤2：低通滤波器（简单移动平均滤波器）
-    // 滤波器窗口大小应该足够去除载波频率，但保留调制信号
-    int window_size = (int)(fs / 1000.0);  // 根据采样率自适应
-    if (window_size < 3) window_size = 3;
-    if (window_size % 2 == 0) window_size++;  // 确保为奇数
-    
-    int half_window = window_size / 2;
-    
-    for (int i = 0; i < n; i++) {
-        double sum = 0.0;
-        int count = 0;
-        
-        for (int j = -half_window; j <= half_window; j++) {
-            int idx = i + j;
-            if (idx >= 0 && idx < n) {
-                sum += rectified[idx];
-                count++;
-            }
-        }
-        
-        demod_signal[i] = sum / count;
-    }
-    
-    // 步骤3：去除直流分量（减去平均值）
-    double dc_offset = 0.0;
-    for (int i = 0; i < n; i++) {
-        dc_offset += demod_signal[i];
-    }
-    dc_offset /= n;
-    
-    for (int i = 0; i < n; i++) {
-        demod_signal[i] -= dc_offset;
-    }
-    
-    free(rectified);
-    printf("包络检波解调完成（窗口大小=%d）\n", window_size);
-}
+// 解调器的双精度 (am_demodulate_*) 与单精度 (am_demodulate_*_f) 版本由同一份实现生成
+#define AM_REAL         double
+#define AM_ID(x)        x
+#define AM_MATH(fn)     fn
+#define AM_VERBOSE      1
+#include "am_demod_impl.h"
+#undef AM_REAL
+#undef AM_ID
+#undef AM_MATH
+#undef AM_VERBOSE
 
-/**
- * @brief AM包络检波解调（改进版 - 使用Hilbert变换近似）
- * 
- * @param am_signal 输入的AM信号
- * @param demod_signal 输出的解调信号
- * @param n 采样点数
- * @param fs 采样频率
- */
-void am_demodulate_envelope_hilbert(double *am_signal, double *demod_signal, 
-                                    int n, double fs) {
-    // 使用解析信号方法计算包络
-    // 包络 = sqrt(I^2 + Q^2)
-    // 其中 I 是原信号，Q 是 Hilbert 变换
-    
-    // 简化方法：使用局部最大值插值
-    for (int i = 1; i < n - 1; i++) {
-        // 计算包络（使用相邻样本的平方和的平方根近似）
-        double val = am_signal[i] * am_signal[i];
-        double deriv = (am_signal[i+1] - am_signal[i-1]) / 2.0;
-        demod_signal[i] = sqrt(val + deriv * deriv);
-    }
-    
-    demod_signal[0] = demod_signal[1];
-    demod_signal[n-1] = demod_signal[n-2];
-    
-    // 低通滤波平滑
-    int window = 5;
-    double *temp = (double *)malloc(n * sizeof(double));
-    memcpy(temp, demod_signal, n * sizeof(double));
-    
-    for (int i = window; i < n - window; i++) {
-        double sum = 0.0;
-        for (int j = -window; j <= window; j++) {
-            sum += temp[i + j];
-        }
-        demod_signal[i] = sum / (2 * window + 1);
-    }
-    
-    // 去直流
-    double dc = 0.0;
-    for (int i = 0; i < n; i++) dc += demod_signal[i];
-    dc /= n;
-    for (int i = 0; i < n; i++) demod_signal[i] -= dc;
-    
-    free(temp);
-    printf("Hilbert变换包络检波解调完成\n");
-}
+#define AM_REAL         float
+#define AM_ID(x)        x##_f
+#define AM_MATH(fn)     fn##f
+#define AM_VERBOSE      0
+#include "am_demod_impl.h"
+#undef AM_REAL
+#undef AM_ID
+#undef AM_MATH
+#undef AM_VERBOSE
 
 /**
- * @brief AM相干解调（同步检波）
- * 
- * 使用本地载波与接收信号相乘，然后低通滤波
- * 需要载波同步（频率和相位）
- * 
- * @param am_signal 输入的AM信号
- * @param demod_signal 输出的解调信号
- * @param n 采样点数
- * @param fc 载波频率
- * @param fs 采样频率
- * @param phase_offset 相位偏移（用于模拟相位误差）
+ * @brief 单精度解调结果与双精度结果的最大绝对偏差
  */
-void am_demodulate_coherent(double *am_signal, double *demod_signal, 
-                           int n, double fc, double fs, double phase_offset) {
-    // 步骤1：生成本地载波
-    double *local_carrier = (double *)malloc(n * sizeof(double));
-    for (int i = 0; i < n; i++) {
-        double t = i / fs;
-        local_carrier[i] = 2.0 * cos(2.0 * M_PI * fc * t + phase_offset);
-    }
-    
-    // 步骤2：混频（相乘）
-    double *mixed = (double *)malloc(n * sizeof(double));
-    for (int i = 0; i < n; i++) {
-        mixed[i] = am_signal[i] * local_carrier[i];
-    }
-    
-    // 步骤3：低通滤波（去除2fc成分）
-    int window_size = (int)(fs / (fc / 10.0));
-    if (window_size < 5) window_size = 5;
-    if (window_size % 2 == 0) window_size++;
-    
-    int half_window = window_size / 2;
-    
+double max_deviation_f(float *single, double *reference, int n) {
+    double max_dev = 0.0;
     for (int i = 0; i < n; i++) {
-        double sum = 0.0;
-        int count = 0;
-        
-        for (int j = -half_window; j <= half_window; j++) {
-            int idx = i + j;
-            if (idx >= 0 && idx < n) {
-                sum += mixed[idx];
-                count++;
-            }
-        }
-        
-        demod_signal[i] = sum / count;
+        double dev = fabs((double)single[i] - reference[i]);
+        if (dev > max_dev) max_dev = dev;
     }
-    
-    // 去直流
-    double dc = 0.0;
-    for (int i = 0; i < n; i++) dc += demod_signal[i];
-    dc /= n;
-    for (int i = 0; i < n; i++) demod_signal[i] -= dc;
-    
-    free(local_carrier);
-    free(mixed);
-    printf("相干解调完成（相位偏移=%.2f°，窗口大小=%d）\n", 
-           phase_offset * 180.0 / M_PI, window_size);
+    return max_dev;
 }
 
 /**
@@ -313,10 +192,10 @@ void save_signal_to_file(const char *filename, double *t, double *signal, int n)
         return;
     }
     
+    static const text_column column = {TEXT_FIXED, 0, 6};
+    const double *columns[2] = {t, signal};
     fprintf(fp, "# Time(s)\tSignal\n");
-    for (int i = 0; i < n; i++) {
-        fprintf(fp, "%.6f\t%.6f\n", t[i], signal[i]);
-    }
+    text_write_columns(fp, columns, 2, &column, '\t', (size_t)n);
     
     fclose(fp);
     printf("信号已保存到: %s\n", filename);
@@ -340,10 +219,9 @@ void save_signals_to_csv(const char *filename, double *t,
     fprintf(fp, "Time,%s,%s,%s,%s\n", name1, name2, name3, name4);
     
     // 写入数据
-    for (int i = 0; i < n; i++) {
-        fprintf(fp, "%.6f,%.6f,%.6f,%.6f,%.6f\n", 
-                t[i], sig1[i], sig2[i], sig3[i], sig4[i]);
-    }
+    static const text_column column = {TEXT_FIXED, 0, 6};
+    const double *columns[5] = {t, sig1, sig2, sig3, sig4};
+    text_write_columns(fp, columns, 5, &column, ',', (size_t)n);
     
     fclose(fp);
     printf("CSV数据已保存到: %s\n", filename);
@@ -361,11 +239,10 @@ void save_demodulated_signals(const char *filename, double *t,
         return;
     }
     
+    static const text_column column = {TEXT_FIXED, 0, 6};
+    const double *columns[5] = {t, original, envelope, hilbert, coherent};
     fprintf(fp, "Time,Original,Envelope,Hilbert,Coherent\n");
-    for (int i = 0; i < n; i++) {
-        fprintf(fp, "%.6f,%.6f,%.6f,%.6f,%.6f\n", 
-                t[i], original[i], envelope[i], hilbert[i], coherent[i]);
-    }
+    text_write_columns(fp, columns, 5, &column, ',', (size_t)n);
     
     fclose(fp);
     printf("解调结果已保存到: %s\n", filename);
@@ -383,6 +260,7 @@ int main(int argc, char *argv[]) {
     double fs = 100000.0;    // 采样频率 100kHz（满足Nyquist定理）
     double duration = 0.01;  // 信号持续时间 10ms
     double modulation_index = 0.8;  // 调制指数 80%
+    int use_float = 0;       // 同时运行单精度解调并与双精度对比
     
     // 解析命令行参数
     for (int i = 1; i < argc; i++) {
@@ -396,6 +274,8 @@ int main(int argc, char *argv[]) {
             duration = atof(argv[++i]);
         } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
             modulation_index = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-float") == 0) {
+            use_float = 1;
         } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             printf("用法: %s [选项]\n", argv[0]);
             printf("选项:\n");
@@ -404,6 +284,7 @@ int main(int argc, char *argv[]) {
             printf("  -fs <Hz>    采样频率 (默认: 100000)\n");
             printf("  -d <秒>     持续时间 (默认: 0.01)\n");
             printf("  -m <0-1>    调制指数 (默认: 0.8)\n");
+            printf("  -float      同时运行单精度解调并与双精度结果对比\n");
             printf("  -h          显示帮助\n");
             return 0;
         }
@@ -469,6 +350,29 @@ int main(int argc, char *argv[]) {
     printf("  Hilbert变换法 SNR = %.2f dB\n", snr_hilbert);
     printf("  相干解调法 SNR = %.2f dB\n", snr_coherent);
     
+    // 单精度解调，与双精度结果对比
+    if (use_float) {
+        printf("\n--- 步骤6: 单精度 (float) 解调对比 ---\n");
+        float *am_signal_f = (float *)malloc(n * sizeof(float));
+        float *demod_f = (float *)malloc(n * sizeof(float));
+        if (am_signal_f && demod_f) {
+            for (int i = 0; i < n; i++) {
+                am_signal_f[i] = (float)am_signal[i];
+            }
+            printf("与双精度结果的最大偏差:\n");
+            am_demodulate_envelope_f(am_signal_f, demod_f, n, (float)fs);
+            printf("  包络检波法:   %.3e\n", max_deviation_f(demod_f, demod_envelope, n));
+            am_demodulate_envelope_hilbert_f(am_signal_f, demod_f, n, (float)fs);
+            printf("  Hilbert变换法: %.3e\n", max_deviation_f(demod_f, demod_hilbert, n));
+            am_demodulate_coherent_f(am_signal_f, demod_f, n, (float)fc, (float)fs, (float)phase_offset);
+            printf("  相干解调法:   %.3e\n", max_deviation_f(demod_f, demod_coherent, n));
+        } else {
+            fprintf(stderr, "内存分配失败\n");
+        }
+        free(am_signal_f);
+        free(demod_f);
+    }
+    
     // 释放内存
     free(t);
     free(modulating);
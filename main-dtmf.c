@@ -6,11 +6,38 @@
 #include <string.h>
 #include <unistd.h>
 #include <time.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/types.h>
+
+#include "fft.h"
+#include "dtmf_detect.h"
+#include "dtmf_multi.h"
+#include "dtmf_tone.h"
+#include "audio_sink.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
+/**
+ * 单调时钟 (秒)，用于统计解码速度
+ */
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * 进程所有线程累计占用的 CPU 时间 (秒)
+ */
+static double cpu_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
 /**
  * 将double类型音频数据转换为16位PCM格式
  * @param sample 音频样本值 (-1.0 到 1.0)
@@ -25,66 +52,22 @@ int16_t double_to_pcm16(double sample) {
 }
 
 /**
- * 播放音频数据
- * @param x 音频样本数组
- * @param N 样本数量
- * @param fs 采样频率
- * @param device 音频设备 (例如: "hw:0,0" 或 "plughw:1,0", NULL使用默认设备)
- * @return 1表示成功，0表示失败
- */
-int play_audio(double* x, int N, double fs __attribute__((unused)), const char* device) {
-    char cmd[256];
-    
-    // 构建aplay命令
-    if (device != NULL) {
-        // 指定设备
-        snprintf(cmd, sizeof(cmd), "aplay -D %s -f S16_LE -r 8000 -c 1 2>/dev/null", device);
-    } else {
-        // 使用默认设备
-        snprintf(cmd, sizeof(cmd), "aplay -f S16_LE -r 8000 -c 1 2>/dev/null");
-    }
-    
-    // 使用管道将数据发送给aplay命令
-    FILE *pipe = popen(cmd, "w");
-    if (!pipe) {
-        printf("错误: 无法打开音频设备。请确保安装了 alsa-utils (aplay命令)\n");
-        return 0;
-    }
-    
-    // 转换并写入PCM数据
-    for (int n = 0; n < N; n++) {
-        int16_t pcm_sample = double_to_pcm16(x[n]);
-        fwrite(&pcm_sample, sizeof(int16_t), 1, pipe);
-    }
-    
-    pclose(pipe);
-    return 1;
-}
-
-/**
- * 计算离散傅里叶变换 (DFT)
- * @param x 输入信号的实部数组
+ * 计算实数信号的离散傅里叶变换 (DFT)，内部使用 r2c FFT 实现
+ * 实数信号的频谱共轭对称，只输出 N/2+1 个非冗余频点
+ * @param x 输入信号数组
  * @param N 信号长度
- * @param X_real 输出信号频域的实部数组
- * @param X_imag 输出信号频域的虚部数组
+ * @param X_real 输出信号频域的实部数组 (长度 N/2+1)
+ * @param X_imag 输出信号频域的虚部数组 (长度 N/2+1)
  */
 void calculate_dft(double* x, int N, double* X_real, double* X_imag) {
-    for (int k = 0; k < N; k++) {
-        X_real[k] = 0.0;
-        X_imag[k] = 0.0;
-        for (int n = 0; n < N; n++) {
-            double angle = 2.0 * M_PI * k * n / N;
-            X_real[k] += x[n] * cos(angle);
-            X_imag[k] -= x[n] * sin(angle);
-        }
-    }
+    fft_r2c_1d(x, N, X_real, X_imag);
 }
 
 /**
  * 计算频谱 (幅度谱) 和相位谱
  * @param X_real 频域实部
  * @param X_imag 频域虚部
- * @param N 信号长度
+ * @param N 频点数量 (实数信号传入 N/2+1 即可，其余频点由共轭对称得到)
  * @param magnitude 输出幅度谱数组
  * @param phase 输出相位谱数组 (弧度)
  */
@@ -99,54 +82,24 @@ void calculate_spectrum_and_phase(double* X_real, double* X_imag, int N, double*
 }
 
 /**
- * DTMF双音频识别函数
- * @param magnitude 幅度谱数组
+ * DTMF双音频识别函数 (由 FFT 幅度谱判决，实时检测使用 dtmf_detect.h 中的 Goertzel 滤波器组)
+ * @param magnitude 幅度谱数组 (至少包含 N/2+1 个频点)
  * @param N 信号长度
  * @param fs 采样频率
  * @return 识别出的按键字符，如果无法识别返回 '?'
  */
 char detect_dtmf(double* magnitude, int N, double fs) {
-    // DTMF标准频率
-    double low_freqs[] = {697, 770, 852, 941};   // 低频组
-    double high_freqs[] = {1209, 1336, 1477};    // 高频组
-    char dtmf_table[4][3] = {
-        {'1', '2', '3'},
-        {'4', '5', '6'},
-        {'7', '8', '9'},
-        {'*', '0', '#'}
-    };
-    
-    double freq_resolution = fs / N;
-    double threshold = 5.0; // 幅度阈值
-    
-    // 检测低频分量
-    int low_idx = -1;
-    double max_low_mag = 0;
-    for (int i = 0; i < 4; i++) {
-        int k = (int)(low_freqs[i] / freq_resolution + 0.5); // 频率对应的索引
-        if (k < N && magnitude[k] > threshold && magnitude[k] > max_low_mag) {
-            max_low_mag = magnitude[k];
-            low_idx = i;
-        }
-    }
-    
-    // 检测高频分量
-    int high_idx = -1;
-    double max_high_mag = 0;
-    for (int i = 0; i < 3; i++) {
-        int k = (int)(high_freqs[i] / freq_resolution + 0.5); // 频率对应的索引
-        if (k < N && magnitude[k] > threshold && magnitude[k] > max_high_mag) {
-            max_high_mag = magnitude[k];
-            high_idx = i;
-        }
+    dtmf_bank bank;
+    if (dtmf_bank_init(&bank, N, fs, 0) != 0) {
+        return '?';
     }
-    
-    // 如果检测到两个频率分量，返回对应按键
-    if (low_idx >= 0 && high_idx >= 0) {
-        return dtmf_table[low_idx][high_idx];
+
+    // 取出七个音调频点的幅度，超出 N/2 的频点按 0 处理
+    double tones[DTMF_TONES];
+    for (int b = 0; b < DTMF_TONES; b++) {
+        tones[b] = bank.bin[b] >= 0 ? magnitude[bank.bin[b]] : 0.0;
     }
-    
-    return '?'; // 无法识别
+    return dtmf_decide(tones, bank.threshold, NULL, NULL);
 }
 
 /**
@@ -157,29 +110,201 @@ char detect_dtmf(double* magnitude, int N, double fs) {
  * @return 1表示成功，0表示无效按键
  */
 int get_dtmf_frequencies(char key, double* f_low, double* f_high) {
-    // DTMF标准频率
-    double low_freqs[] = {697, 770, 852, 941};   // 低频组
-    double high_freqs[] = {1209, 1336, 1477};    // 高频组
-    char dtmf_table[4][3] = {
-        {'1', '2', '3'},
-        {'4', '5', '6'},
-        {'7', '8', '9'},
-        {'*', '0', '#'}
-    };
-    
-    // 查找按键对应的频率
-    for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < 3; j++) {
-            if (dtmf_table[i][j] == key) {
-                *f_low = low_freqs[i];
-                *f_high = high_freqs[j];
-                return 1; // 成功
+    return dtmf_key_frequencies(key, f_low, f_high);
+}
+
+/**
+ * 打印一个流式解码事件
+ */
+static void print_dtmf_event(const dtmf_event* event) {
+    if (event->released) {
+        printf("[%9.3f s] 按键 '%c' 松开 (时长 %.0f ms)\n", event->time, event->key, event->duration * 1000.0);
+    } else {
+        printf("[%9.3f s] 按键 '%c' 按下\n", event->time, event->key);
+    }
+}
+
+/**
+ * 流式解码 S16_LE 单声道 PCM (文件、管道或标准输入)
+ * 按到达的数据逐帧检测，按键确认后立即输出，不等待读完整个流
+ * @param filename 输入文件，"-" 表示标准输入 (例如 arecord -f S16_LE -r 8000 -c 1 | ./dtmf --decode -)
+ * @param fs 采样频率
+ * @return 0表示成功，-1表示失败
+ */
+int decode_stream(const char* filename, double fs) {
+    int fd = 0;
+    if (strcmp(filename, "-") != 0) {
+        fd = open(filename, O_RDONLY);
+        if (fd < 0) {
+            printf("错误: 无法打开文件 %s\n", filename);
+            return -1;
+        }
+    }
+
+    dtmf_stream stream;
+    if (dtmf_stream_init(&stream, fs) != 0) {
+        printf("错误: 无法初始化 DTMF 解码器\n");
+        if (fd != 0) close(fd);
+        return -1;
+    }
+    printf("流式解码: %s, 采样率 %.0f Hz, 滑动窗口 %d (%.1f ms), 每 %d 个样本判决一次\n",
+           filename, fs, stream.bank.N, stream.bank.N * 1000.0 / fs, stream.hop);
+
+    // read 返回已到达的数据，管道输入时不会为凑满缓冲区而等待
+    enum { PCM_CHUNK = 4096 };
+    unsigned char bytes[2 * PCM_CHUNK + 1];
+    int16_t pcm[PCM_CHUNK];
+    dtmf_event events[64];
+    char keys[256];
+    int nkeys = 0, pending = 0;
+    long long total = 0;
+
+    double t0 = now_seconds();
+    for (;;) {
+        ssize_t got = read(fd, bytes + pending, 2 * PCM_CHUNK - pending);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) break;
+
+        int avail = pending + (int)got;
+        int count = avail / 2;
+        for (int n = 0; n < count; n++) {
+            pcm[n] = (int16_t)(bytes[2 * n] | (bytes[2 * n + 1] << 8));
+        }
+        pending = avail - 2 * count;
+        if (pending) bytes[0] = bytes[avail - 1];
+        total += count;
+
+        int nevents = dtmf_stream_feed(&stream, pcm, count, events, 64);
+        for (int e = 0; e < nevents; e++) {
+            print_dtmf_event(&events[e]);
+            if (!events[e].released && nkeys < (int)sizeof(keys) - 1) keys[nkeys++] = events[e].key;
+        }
+        if (nevents) fflush(stdout);
+    }
+    int nevents = dtmf_stream_flush(&stream, events, 64);
+    for (int e = 0; e < nevents; e++) {
+        print_dtmf_event(&events[e]);
+    }
+    double elapsed = now_seconds() - t0;
+    keys[nkeys] = '\0';
+
+    double audio = total / fs;
+    printf("\n识别结果: %s\n", nkeys ? keys : "(无)");
+    printf("音频时长 %.3f s, 处理耗时 %.3f s", audio, elapsed);
+    if (strcmp(filename, "-") != 0 && elapsed > 0) {
+        printf(", %.0f 倍实时", audio / elapsed);
+    }
+    printf("\n");
+
+    dtmf_stream_free(&stream);
+    if (fd != 0) close(fd);
+    return 0;
+}
+
+/**
+ * 多通道检测的基准测试: 生成 channels 路随机按键信号 (通道交错的 S16)，
+ * 按 20 ms 一包读入多通道检测器，统计每个核能实时处理的通道数，
+ * 并逐通道、逐帧与 FFT 幅度谱 + detect_dtmf 的判决比较
+ * @return 0表示判决全部一致，-1表示失败或不一致
+ */
+int benchmark_channels(int channels, double fs) {
+    int N = (int)(fs * DTMF_STREAM_FRAME_MS / 1000.0 + 0.5);
+    int frames = 40;                            // 约 1 秒
+    int T = frames * N;
+    int packet = (int)(fs * 0.02);              // 20 ms 一包
+    const char* keyset = "0123456789*#";
+
+    int16_t* pcm = (int16_t*)malloc((size_t)channels * T * sizeof(int16_t));
+    char* keys = (char*)malloc((size_t)channels * frames);
+    double* x = (double*)malloc(N * sizeof(double));
+    double* X_real = (double*)malloc((N / 2 + 1) * sizeof(double));
+    double* X_imag = (double*)malloc((N / 2 + 1) * sizeof(double));
+    double* magnitude = (double*)malloc((N / 2 + 1) * sizeof(double));
+    dtmf_multi detector = {0};
+    dtmf_tone_cache tones = {0};
+    if (!pcm || !keys || !x || !X_real || !X_imag || !magnitude ||
+        dtmf_multi_init(&detector, channels, N, fs) != 0 ||
+        dtmf_tone_cache_init(&tones, T, fs, 1.0) != 0) {
+        printf("内存分配失败\n");
+        dtmf_multi_free(&detector);
+        dtmf_tone_cache_free(&tones);
+        free(pcm);
+        free(keys);
+        free(x);
+        free(X_real);
+        free(X_imag);
+        free(magnitude);
+        return -1;
+    }
+
+    // 每个通道每 100 ms 随机换一个按键或静音，幅度和噪声也随机
+    // 按键音与通道无关 (相位从 0 开始连续)，整段只合成一次，各通道按幅度缩放后取用
+    srand(1);
+    for (int c = 0; c < channels; c++) {
+        const double* tone = NULL;
+        double A = 0, noise = (rand() % 100) / 2000.0;
+        int segment = (int)(0.1 * fs);
+        for (int t = 0; t < T; t++) {
+            if (t % segment == 0) {
+                int r = rand() % (int)(strlen(keyset) + 2);
+                A = r < (int)strlen(keyset) ? 0.05 + (rand() % 100) / 500.0 : 0.0;
+                if (A > 0) tone = dtmf_tone_cache_get(&tones, keyset[r]);
             }
+            double v = (A > 0 ? A * tone[t] : 0.0) + noise * (2.0 * rand() / RAND_MAX - 1.0);
+            pcm[(size_t)t * channels + c] = double_to_pcm16(v);
         }
     }
-    
-    return 0; // 无效按键
+
+    // 每核指标按 CPU 时间计算: 数据量少时 dtmf_multi_feed 只用一个线程，不能按线程数平分墙钟时间
+    int nthreads = 1;
+    double t0 = now_seconds();
+    double cpu0 = cpu_seconds();
+    int done_frames = 0;
+    for (int t = 0; t < T; t += packet) {
+        int count = t + packet <= T ? packet : T - t;
+        done_frames += dtmf_multi_feed(&detector, pcm + (size_t)t * channels, count,
+                                       keys + (size_t)done_frames * channels, frames - done_frames);
+        if (detector.threads > nthreads) nthreads = detector.threads;
+    }
+    double elapsed = now_seconds() - t0;
+    double cpu = cpu_seconds() - cpu0;
+
+    // 逐通道与 FFT 检测比较
+    long long mismatches = 0, detected = 0;
+    for (int f = 0; f < done_frames; f++) {
+        for (int c = 0; c < channels; c++) {
+            for (int n = 0; n < N; n++) {
+                x[n] = pcm[(size_t)(f * N + n) * channels + c] * (1.0 / 32768.0);
+            }
+            calculate_dft(x, N, X_real, X_imag);
+            for (int k = 0; k <= N / 2; k++) {
+                magnitude[k] = sqrt(X_real[k] * X_real[k] + X_imag[k] * X_imag[k]);
+            }
+            char key = keys[(size_t)f * channels + c];
+            if (detect_dtmf(magnitude, N, fs) != key) mismatches++;
+            if (key != '?') detected++;
+        }
+    }
+
+    double audio = (double)T / fs;
+    printf("多通道检测: %d 通道, 帧长 %d, %d 线程, 内核 %s\n",
+           channels, N, nthreads, fft_simd_level_name(fft_simd_get_level()));
+    printf("  %.3f s 音频耗时 %.4f s, %.1f M 样本/秒\n", audio, elapsed, (double)channels * T / elapsed / 1e6);
+    printf("  每核实时通道数: %.0f (CPU 时间 %.4f s)\n", channels * audio / cpu, cpu);
+    printf("  与 FFT + detect_dtmf 比较: %lld / %lld 帧不一致 (检出按键 %lld 帧)\n",
+           mismatches, (long long)done_frames * channels, detected);
+
+    dtmf_multi_free(&detector);
+    dtmf_tone_cache_free(&tones);
+    free(pcm);
+    free(keys);
+    free(x);
+    free(X_real);
+    free(X_imag);
+    free(magnitude);
+    return mismatches == 0 ? 0 : -1;
 }
+
 int main(int argc, char *argv[]) {
     double duration = 0.5; // 信号时长 500ms (播放需要更长的时间才能听清)
     double fs = 8000.0; // 采样频率 8kHz (DTMF标准采样率)
@@ -196,27 +321,86 @@ int main(int argc, char *argv[]) {
     
     // DTMF (双音多频) 信号
     // 从命令行参数获取按键序列
-    const char* dtmf_keys = "1";    // 默认按键序列
-    
-    if (argc > 1) {
-        // 使用第一个命令行参数作为DTMF按键序列
-        dtmf_keys = argv[1];
-    } else {
-        printf("用法: %s <DTMF按键序列>\n", argv[0]);
+    const char* dtmf_keys = NULL;
+    const char* decode_file = NULL;     // --decode: 流式解码 PCM 输入
+    const char* output_file = NULL;     // --output: 把按键音写入 PCM 文件 (扩展名 .wav 时为 WAV 文件) 而不播放
+    int bench_channels = 0;             // --channels: 多通道检测基准测试
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--decode") == 0 && i + 1 < argc) {
+            decode_file = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output_file = argv[++i];
+        } else if (strcmp(argv[i], "--channels") == 0 && i + 1 < argc) {
+            bench_channels = atoi(argv[++i]);
+            if (bench_channels < 1) {
+                printf("错误: 无效的通道数 %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            fs = atof(argv[++i]);
+            if (!(fs > 0)) {
+                printf("错误: 无效的采样率 %s\n", argv[i]);
+                return 1;
+            }
+        } else if (!dtmf_keys) {
+            // 使用第一个非选项参数作为DTMF按键序列
+            dtmf_keys = argv[i];
+        }
+    }
+
+    if (decode_file) {
+        return decode_stream(decode_file, fs) == 0 ? 0 : 1;
+    }
+    if (bench_channels) {
+        return benchmark_channels(bench_channels, fs) == 0 ? 0 : 1;
+    }
+    N = (int)(duration * fs);
+
+    if (!dtmf_keys) {
+        dtmf_keys = "1";    // 默认按键序列
+        printf("用法: %s <DTMF按键序列> [--output PCM文件|WAV文件] [--rate 采样率]\n", argv[0]);
+        printf("      %s --decode <PCM文件|-> [--rate 采样率]\n", argv[0]);
+        printf("      %s --channels <通道数> [--rate 采样率]  (多通道检测基准测试)\n", argv[0]);
         printf("有效按键: 0-9, *, #\n");
         printf("示例: %s 123      (播放 1-2-3)\n", argv[0]);
         printf("示例: %s \"*123#\"  (播放 *-1-2-3-#)\n", argv[0]);
+        printf("示例: %s 123 --output keys.raw && %s --decode keys.raw  (生成并解码)\n", argv[0], argv[0]);
+        printf("示例: %s 123 --output keys.wav  (写入 WAV 文件)\n", argv[0]);
         printf("未提供参数，使用默认按键 '%s'\n\n", dtmf_keys);
     }
-    
-    printf("播放DTMF音到设备: %s\n", audio_device ? audio_device : "默认设备");
+
+    // 整个按键序列只打开一次输出，按键音和间隔的静音写入同一条数据流，由输出线程写出
+    audio_sink* sink;
+    if (output_file) {
+        size_t len = strlen(output_file);
+        int wav = len >= 4 && strcmp(output_file + len - 4, ".wav") == 0;
+        sink = audio_sink_open(wav ? AUDIO_SINK_WAV : AUDIO_SINK_RAW, output_file, (int)fs);
+        if (!sink) {
+            return 1;
+        }
+        printf("写入DTMF音到文件: %s (%s, S16_LE, %.0f Hz, 单声道)\n", output_file, wav ? "WAV" : "PCM", fs);
+    } else {
+        sink = audio_sink_open(AUDIO_SINK_PIPE, audio_device, (int)fs);
+        if (!sink) {
+            return 1;
+        }
+        printf("播放DTMF音到设备: %s\n", audio_device ? audio_device : "默认设备");
+    }
     printf("按键序列: %s\n\n", dtmf_keys);
+
+    // 十二个按键音只合成一次 (七个音调由旋转振荡器生成后两两相加)，每个按键直接取用
+    dtmf_tone_cache tones;
+    if (dtmf_tone_cache_init(&tones, N, fs, 1.0) != 0) {
+        printf("内存分配失败\n");
+        audio_sink_close(sink);
+        return 1;
+    }
     
     // 遍历按键序列，依次播放每个按键
     for (int i = 0; dtmf_keys[i] != '\0'; i++) {
         char dtmf_key = dtmf_keys[i];
         double f_low, f_high;   // 低频和高频分量
-        double A = 1.0;         // 幅度
         
         // 根据按键获取对应的DTMF频率
         if (!get_dtmf_frequencies(dtmf_key, &f_low, &f_high)) {
@@ -233,67 +417,37 @@ int main(int argc, char *argv[]) {
          * 941Hz    *       0       #
          */
         
-        // 动态生成DTMF信号采样数据
-        double *x = (double *)malloc(N * sizeof(double));
-        if (!x) {
-            printf("内存分配失败\n");
-            return 1;
-        }
-        
-        // 生成DTMF双音频信号: x[n] = sin(2π*f_low*n/fs) + sin(2π*f_high*n/fs)
-        for (int n = 0; n < N; n++) {
-            x[n] = A * sin(2.0 * M_PI * f_low * n / fs) +
-                   A * sin(2.0 * M_PI * f_high * n / fs);
-        }
+        // DTMF双音频信号: x[n] = sin(2π*f_low*n/fs) + sin(2π*f_high*n/fs)，从缓存中取出
+        const double* x = dtmf_tone_cache_get(&tones, dtmf_key);
 
-        // 分配内存用于存储频域结果
-        double *X_real = (double *)malloc(N * sizeof(double));
-        double *X_imag = (double *)malloc(N * sizeof(double));
-        double *magnitude = (double *)malloc(N * sizeof(double));
-        double *phase = (double *)malloc(N * sizeof(double));
+        // 识别DTMF按键: 只需要七个音调频点的幅度，用 Goertzel 滤波器组代替整帧 FFT
+        dtmf_bank bank;
+        dtmf_bank_init(&bank, N, fs, 0);
+        char detected_key = dtmf_bank_detect(&bank, x);
 
-        if (!X_real || !X_imag || !magnitude || !phase) {
-            printf("内存分配失败\n");
-            free(x);
-            return 1;
-        }
-
-        // 1. 执行 DFT
-        calculate_dft(x, N, X_real, X_imag);
-
-        // 2. 计算幅度和相位
-        calculate_spectrum_and_phase(X_real, X_imag, N, magnitude, phase);
-
-        // 3. 识别DTMF按键
-        char detected_key = detect_dtmf(magnitude, N, fs);
-
-        // 4. 播放DTMF音
-        printf("[%d/%ld] 播放按键 '%c' (%.0f Hz + %.0f Hz)...", 
-               i + 1, strlen(dtmf_keys), dtmf_key, f_low, f_high);
+        // 播放DTMF音 (或写入文件)
+        printf("[%d/%ld] %s按键 '%c' (%.0f Hz + %.0f Hz)...", 
+               i + 1, strlen(dtmf_keys), output_file ? "写入" : "播放", dtmf_key, f_low, f_high);
         fflush(stdout);
         
-        if (play_audio(x, N, fs, audio_device)) {
+        // 按键之后是 100ms 静音，作为样本写入同一条数据流，按键间隔精确到一个样本
+        if (audio_sink_write(sink, x, N) == 0 && audio_sink_silence(sink, (int)(0.1 * fs)) == 0) {
             printf(" 完成 [识别: '%c' %s]\n", detected_key, 
                    (detected_key == dtmf_key) ? "✓" : "✗");
         } else {
             printf(" 失败\n");
         }
-        
-        // 释放当前按键的内存
-        free(x);
-        free(X_real);
-        free(X_imag);
-        free(magnitude);
-        free(phase);
-        
-        // 在按键之间添加短暂停顿（100ms）
-        if (dtmf_keys[i + 1] != '\0') {
-            struct timespec ts = {0, 100000000}; // 100ms = 100,000,000 纳秒
-            nanosleep(&ts, NULL);
-        }
     }
     
-    printf("\n播放完成！\n");
+    dtmf_tone_cache_free(&tones);
+    // 等待输出线程把缓冲区中的数据全部写出 (播放时即播放结束)
+    if (audio_sink_close(sink) != 0) {
+        printf("\n%s失败！\n", output_file ? "写入" : "播放");
+    } else if (output_file) {
+        printf("\n写入完成！\n");
+    } else {
+        printf("\n播放完成！\n");
+    }
     printf("\nDTMF标准频率表：\n");
     printf("        1209Hz  1336Hz  1477Hz\n");
     printf(" 697Hz    1       2       3\n");
@@ -1,55 +1,47 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <time.h>
+
+#include "fft.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
 /**
- * 计算离散傅里叶变换 (DFT)
- * @param x 输入信号的实部数组
+ * 计算实数信号的离散傅里叶变换 (DFT)，内部使用 r2c FFT 实现
+ * 实数信号的频谱共轭对称，只输出 N/2+1 个非冗余频点
+ * 数百万点的长信号自动使用四步法，并按 FFT_THREADS 多线程执行
+ * @param x 输入信号数组
  * @param N 信号长度
- * @param X_real 输出信号频域的实部数组
- * @param X_imag 输出信号频域的虚部数组
+ * @param X_real 输出信号频域的实部数组 (长度 N/2+1)
+ * @param X_imag 输出信号频域的虚部数组 (长度 N/2+1)
+ * @return 0表示成功，-1表示失败
  */
-void calculate_dft(double* x, int N, double* X_real, double* X_imag) {
-    for (int k = 0; k < N; k++) {
-        X_real[k] = 0.0;
-        X_imag[k] = 0.0;
-        for (int n = 0; n < N; n++) {
-            double angle = 2.0 * M_PI * k * n / N;
-            X_real[k] += x[n] * cos(angle);
-            X_imag[k] -= x[n] * sin(angle);
-        }
-    }
+int calculate_dft(double* x, int N, double* X_real, double* X_imag) {
+    return fft_r2c_1d(x, N, X_real, X_imag);
 }
 
 /**
- * 计算离散傅里叶逆变换 (IDFT)
- * @param X_real 输入频域信号的实部数组
- * @param X_imag 输入频域信号的虚部数组
+ * 计算离散傅里叶逆变换 (IDFT)，内部使用 c2r FFT 实现
+ * @param X_real 输入频域信号的实部数组 (长度 N/2+1)
+ * @param X_imag 输入频域信号的虚部数组 (长度 N/2+1)
  * @param N 信号长度
  * @param x 输出时域信号数组
+ * @return 0表示成功，-1表示失败
  */
-void calculate_idft(double* X_real, double* X_imag, int N, double* x) {
-    for (int n = 0; n < N; n++) {
-        x[n] = 0.0;
-        for (int k = 0; k < N; k++) {
-            double angle = 2.0 * M_PI * k * n / N;
-            // IDFT: 注意符号与DFT相反 (+ 代替 -)
-            x[n] += X_real[k] * cos(angle) - X_imag[k] * sin(angle);
-        }
-        // 归一化
-        x[n] /= N;
-    }
+int calculate_idft(double* X_real, double* X_imag, int N, double* x) {
+    return fft_c2r_1d(X_real, X_imag, N, x);
 }
 
 /**
  * 计算频谱 (幅度谱) 和相位谱
  * @param X_real 频域实部
  * @param X_imag 频域虚部
- * @param N 信号长度
+ * @param N 频点数量 (实数信号传入 N/2+1 即可，其余频点由共轭对称得到)
  * @param magnitude 输出幅度谱数组
  * @param phase 输出相位谱数组 (弧度)
  */
@@ -62,7 +54,137 @@ void calculate_spectrum_and_phase(double* X_real, double* X_imag, int N, double*
         phase[k] = atan2(X_imag[k], X_real[k]);
     }
 }
-int main() {
+
+/**
+ * 找出幅度谱中最强的若干个局部峰值 (按幅度从大到小)
+ * @param magnitude 幅度谱 (长度 bins)
+ * @param bins 频点数量
+ * @param peaks 输出峰值所在的频点下标
+ * @param count 需要的峰值个数
+ * @return 实际找到的峰值个数
+ */
+int find_spectral_peaks(const double* magnitude, int bins, int* peaks, int count) {
+    int found = 0;
+    for (int k = 1; k + 1 < bins; k++) {
+        if (magnitude[k] < magnitude[k - 1] || magnitude[k] < magnitude[k + 1]) {
+            continue;
+        }
+        // 插入排序，只保留最强的 count 个
+        int pos = found < count ? found++ : count;
+        while (pos > 0 && magnitude[peaks[pos - 1]] < magnitude[k]) {
+            if (pos < count) peaks[pos] = peaks[pos - 1];
+            pos--;
+        }
+        if (pos < count) peaks[pos] = k;
+    }
+    return found;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * 长信号模式: 模拟一段 seconds 秒、采样率 fs 的采集数据 (与 AM/包络检波程序相同的 100 kHz)
+ * 长度达到数百万点，DFT 内部使用四步法
+ */
+static int run_long_capture(double seconds, double fs) {
+    long long total = (long long)(seconds * fs + 0.5);
+    if (total < 2 || total > 0x7fffffff) {
+        printf("错误: 采样点数量 %lld 超出范围\n", total);
+        return 1;
+    }
+    int N = (int)total;
+    int bins = N / 2 + 1;
+
+    double *x = (double *)malloc((size_t)N * sizeof(double));
+    double *x_restored = (double *)malloc((size_t)N * sizeof(double));
+    double *X_real = (double *)malloc((size_t)bins * sizeof(double));
+    double *X_imag = (double *)malloc((size_t)bins * sizeof(double));
+    double *magnitude = (double *)malloc((size_t)bins * sizeof(double));
+    double *phase = (double *)malloc((size_t)bins * sizeof(double));
+    if (!x || !x_restored || !X_real || !X_imag || !magnitude || !phase) {
+        printf("内存分配失败\n");
+        free(x);
+        free(x_restored);
+        free(X_real);
+        free(X_imag);
+        free(magnitude);
+        free(phase);
+        return 1;
+    }
+
+    // 1 kHz 与 12.5 kHz 两个正弦波，再叠加少量噪声
+    double f1 = 1000.0, f2 = 12500.0;
+    srand(1);
+    for (int n = 0; n < N; n++) {
+        double t = n / fs;
+        x[n] = sin(2.0 * M_PI * f1 * t) + 0.25 * sin(2.0 * M_PI * f2 * t + M_PI / 3.0) +
+               0.01 * ((double)rand() / RAND_MAX - 0.5);
+    }
+
+    printf("长信号模式: %.2f 秒, 采样频率 %.0f Hz, N = %d, 线程数 %d\n", seconds, fs, N, fft_get_threads());
+
+    // 第一次调用包含计划创建，第二次为稳定耗时
+    double t0 = now_seconds();
+    int status = calculate_dft(x, N, X_real, X_imag);
+    double t1 = now_seconds();
+    status |= calculate_dft(x, N, X_real, X_imag);
+    double t2 = now_seconds();
+    status |= calculate_idft(X_real, X_imag, N, x_restored);
+    double t3 = now_seconds();
+    if (status != 0) {
+        printf("DFT 计算失败\n");
+    } else {
+        calculate_spectrum_and_phase(X_real, X_imag, bins, magnitude, phase);
+
+        printf("DFT: 首次 %.2f ms (含计划创建), 再次 %.2f ms; IDFT: %.2f ms (含计划创建)\n",
+               (t1 - t0) * 1e3, (t2 - t1) * 1e3, (t3 - t2) * 1e3);
+        printf("频率分辨率: %.4f Hz\n\n", fs / N);
+
+        int peaks[5];
+        int found = find_spectral_peaks(magnitude, bins, peaks, 5);
+        printf("最强的 %d 个频点:\n", found);
+        printf("频率点 k | 频率 (Hz) | 幅度 (2|X|/N)\n");
+        printf("----------------------------------------\n");
+        for (int i = 0; i < found; i++) {
+            int k = peaks[i];
+            printf("%8d | %10.2f | %12.6f\n", k, k * fs / N, 2.0 * magnitude[k] / N);
+        }
+
+        double max_error = 0.0;
+        for (int n = 0; n < N; n++) {
+            double error = fabs(x[n] - x_restored[n]);
+            if (error > max_error) max_error = error;
+        }
+        printf("\nIDFT 最大还原误差: %.3e\n", max_error);
+    }
+
+    free(x);
+    free(x_restored);
+    free(X_real);
+    free(X_imag);
+    free(magnitude);
+    free(phase);
+    return status != 0;
+}
+
+int main(int argc, char* argv[]) {
+    // ./fft1d <秒数> [采样率]: 长信号模式；不带参数时运行下面的 32 点演示
+    if (argc > 1) {
+        double seconds = atof(argv[1]);
+        double fs = (argc > 2) ? atof(argv[2]) : 100000.0;
+        if (seconds <= 0.0 || fs <= 0.0) {
+            printf("用法: %s [秒数 [采样率 Hz，默认 100000]]\n", argv[0]);
+            return 1;
+        }
+        int result = run_long_capture(seconds, fs);
+        fft_plan_cache_clear();
+        return result;
+    }
+
     int N = 32; // 采样点数量
     double fs = 32.0; // 采样频率 (Hz)
     
@@ -87,11 +209,12 @@ int main() {
                sin(2.0 * M_PI * f2 * n / fs + phase2);
     }
 
-    // 分配内存用于存储频域结果
-    double *X_real = (double *)malloc(N * sizeof(double));
-    double *X_imag = (double *)malloc(N * sizeof(double));
-    double *magnitude = (double *)malloc(N * sizeof(double));
-    double *phase = (double *)malloc(N * sizeof(double));
+    // 分配内存用于存储频域结果 (实数信号只需 N/2+1 个频点)
+    int bins = N / 2 + 1;
+    double *X_real = (double *)malloc(bins * sizeof(double));
+    double *X_imag = (double *)malloc(bins * sizeof(double));
+    double *magnitude = (double *)malloc(bins * sizeof(double));
+    double *phase = (double *)malloc(bins * sizeof(double));
 
     if (!X_real || !X_imag || !magnitude || !phase) {
         printf("内存分配失败\n");
@@ -103,16 +226,16 @@ int main() {
     calculate_dft(x, N, X_real, X_imag);
 
     // 2. 计算幅度和相位
-    calculate_spectrum_and_phase(X_real, X_imag, N, magnitude, phase);
+    calculate_spectrum_and_phase(X_real, X_imag, bins, magnitude, phase);
 
     // 输出频域结果
     printf("信号: %.1f Hz 正弦波 (初始相位: 45度) + %.1f Hz 正弦波 (初始相位: 90度)\n", f1, f2);
     printf("采样频率: %.1f Hz\n", fs);
     printf("信号长度 N = %d\n\n", N);
-    printf("=== DFT 结果 ===\n");
+    printf("=== DFT 结果 (k = 0..N/2，其余频点与之共轭对称) ===\n");
     printf("频率点 k | 频率 (Hz) | 幅度谱 Mag[k] | 相位谱 Phase[k] (度)\n");
     printf("--------------------------------------------------------------------\n");
-    for (int k = 0; k < N; k++) {
+    for (int k = 0; k < bins; k++) {
         double freq = k * fs / N; // 对应的实际频率
         double phase_deg = phase[k] * 180.0 / M_PI; // 将弧度转换为度数
         printf("%8d | %10.2f | %14.4f | %20.2f\n", k, freq, magnitude[k], phase_deg);
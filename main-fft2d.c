@@ -1,124 +1,76 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 #include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "fft.h"
+#include "kspace_io.h"
+#include "image_io.h"
+#include "text_io.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-// BMP 文件头结构
-#pragma pack(push, 1)
-typedef struct {
-    uint16_t type;        // 文件类型，必须是 0x4D42 ('BM')
-    uint32_t size;        // 文件大小（字节）
-    uint16_t reserved1;   // 保留，必须是 0
-    uint16_t reserved2;   // 保留，必须是 0
-    uint32_t offset;      // 从文件头到位图数据的偏移量
-} BMPFileHeader;
-
-// BMP 信息头结构
-typedef struct {
-    uint32_t size;           // 信息头大小
-    int32_t  width;          // 图像宽度
-    int32_t  height;         // 图像高度
-    uint16_t planes;         // 颜色平面数，必须是 1
-    uint16_t bits;           // 每像素位数
-    uint32_t compression;    // 压缩类型
-    uint32_t imagesize;      // 图像大小
-    int32_t  xresolution;    // 水平分辨率
-    int32_t  yresolution;    // 垂直分辨率
-    uint32_t ncolors;        // 颜色数
-    uint32_t importantcolors;// 重要颜色数
-} BMPInfoHeader;
-#pragma pack(pop)
+// 灰度图像的输出格式 (--image 选项)
+static int image_format = IMAGE_BMP24;
 
-/**
- * 将数值归一化到 [0, 255] 范围
- */
-uint8_t normalize_to_byte(double value, double min_val, double max_val) {
-    if (max_val == min_val) return 128;
-    double normalized = (value - min_val) / (max_val - min_val) * 255.0;
-    if (normalized < 0) return 0;
-    if (normalized > 255) return 255;
-    return (uint8_t)normalized;
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
 }
 
 /**
- * 将 2D 数据保存为灰度 BMP 图像
- * @param filename 输出文件名
+ * 保存灰度图像 (按数据自身的范围归一化)
+ * @param name 不含扩展名的文件名，扩展名由输出格式决定
  * @param data 2D 数据数组
  * @param width 图像宽度
  * @param height 图像高度
  */
-int save_bmp_grayscale(const char* filename, double* data, int width, int height) {
-    FILE* file = fopen(filename, "wb");
-    if (!file) {
-        printf("无法创建文件: %s\n", filename);
-        return -1;
-    }
-    
-    // 找出数据的最小值和最大值
-    double min_val = data[0], max_val = data[0];
-    for (int i = 1; i < width * height; i++) {
-        if (data[i] < min_val) min_val = data[i];
-        if (data[i] > max_val) max_val = data[i];
-    }
-    
-    // BMP 要求每行字节数是 4 的倍数
-    int row_size = ((width * 3 + 3) / 4) * 4;
-    int padding = row_size - width * 3;
-    
-    // 填充文件头
-    BMPFileHeader file_header;
-    file_header.type = 0x4D42;  // 'BM'
-    file_header.size = sizeof(BMPFileHeader) + sizeof(BMPInfoHeader) + row_size * height;
-    file_header.reserved1 = 0;
-    file_header.reserved2 = 0;
-    file_header.offset = sizeof(BMPFileHeader) + sizeof(BMPInfoHeader);
-    
-    // 填充信息头
-    BMPInfoHeader info_header;
-    info_header.size = sizeof(BMPInfoHeader);
-    info_header.width = width;
-    info_header.height = height;
-    info_header.planes = 1;
-    info_header.bits = 24;  // 24位真彩色
-    info_header.compression = 0;
-    info_header.imagesize = row_size * height;
-    info_header.xresolution = 2835;  // 72 DPI
-    info_header.yresolution = 2835;
-    info_header.ncolors = 0;
-    info_header.importantcolors = 0;
-    
-    // 写入文件头和信息头
-    fwrite(&file_header, sizeof(BMPFileHeader), 1, file);
-    fwrite(&info_header, sizeof(BMPInfoHeader), 1, file);
-    
-    // 写入像素数据 (BMP 从下到上存储)
-    uint8_t pad[3] = {0, 0, 0};
-    for (int i = height - 1; i >= 0; i--) {
-        for (int j = 0; j < width; j++) {
-            uint8_t pixel = normalize_to_byte(data[i * width + j], min_val, max_val);
-            // BGR 格式
-            fwrite(&pixel, 1, 1, file);  // B
-            fwrite(&pixel, 1, 1, file);  // G
-            fwrite(&pixel, 1, 1, file);  // R
-        }
-        // 写入填充字节
-        if (padding > 0) {
-            fwrite(pad, 1, padding, file);
-        }
-    }
-    
-    fclose(file);
-    printf("已保存图像: %s (尺寸: %dx%d, 范围: [%.3f, %.3f])\n", 
-           filename, width, height, min_val, max_val);
-    return 0;
+int save_image(const char* name, const double* data, int width, int height) {
+    char filename[256];
+    snprintf(filename, sizeof(filename), "%s.%s", name, image_format_ext(image_format));
+    return image_save(filename, data, width, height, image_format);
 }
 
 /**
- * 保存K空间数据到文本文件
+ * 保存中心化的幅度谱图像 (零频在图像中心)
+ * @param scale IMAGE_SPECTRUM_LOG 为 log(1+|X|)，IMAGE_SPECTRUM_LINEAR 为 |X|
+ */
+int save_spectrum_image(const char* name, const double* real, const double* imag, int width, int height,
+                        int scale) {
+    char filename[256];
+    snprintf(filename, sizeof(filename), "%s.%s", name, image_format_ext(image_format));
+    return image_save_spectrum(filename, real, imag, width, height, scale, image_format);
+}
+
+typedef struct {
+    const double *real, *imag;
+    int width;
+} kspace_txt_ctx;
+
+/**
+ * K空间文本的一行: 行号、列号、实部、虚部、幅度、相位
+ */
+void kspace_txt_row(void* arg, size_t row, double* values) {
+    const kspace_txt_ctx *ctx = (const kspace_txt_ctx *)arg;
+    double r = ctx->real[row];
+    double im = ctx->imag[row];
+    values[0] = (double)(row / (size_t)ctx->width);
+    values[1] = (double)(row % (size_t)ctx->width);
+    values[2] = r;
+    values[3] = im;
+    values[4] = sqrt(r * r + im * im);
+    values[5] = atan2(im, r);
+}
+
+/**
+ * 保存K空间数据到文本文件 (每个数据点一行，格式 "%4d %4d %15.8e %15.8e %15.8e %15.8e")
  * @param filename 输出文件名
  * @param real 实部数据数组
  * @param imag 虚部数据数组
@@ -126,6 +78,10 @@ int save_bmp_grayscale(const char* filename, double* data, int width, int height
  * @param height 数据高度
  */
 int save_kspace_txt(const char* filename, double* real, double* imag, int width, int height) {
+    static const text_column columns[6] = {
+        {TEXT_INT, 4, 0}, {TEXT_INT, 4, 0},
+        {TEXT_EXP, 15, 8}, {TEXT_EXP, 15, 8}, {TEXT_EXP, 15, 8}, {TEXT_EXP, 15, 8}
+    };
     FILE* file = fopen(filename, "w");
     if (!file) {
         printf("无法创建文件: %s\n", filename);
@@ -138,26 +94,45 @@ int save_kspace_txt(const char* filename, double* real, double* imag, int width,
     fprintf(file, "# Format: row col real imag magnitude phase(rad)\n");
     fprintf(file, "#\n");
     
-    // 写入数据
-    for (int i = 0; i < height; i++) {
-        for (int j = 0; j < width; j++) {
-            int idx = i * width + j;
-            double r = real[idx];
-            double im = imag[idx];
-            double mag = sqrt(r * r + im * im);
-            double phase = atan2(im, r);
-            fprintf(file, "%4d %4d %15.8e %15.8e %15.8e %15.8e\n", 
-                    i, j, r, im, mag, phase);
-        }
-    }
+    // 写入数据 (按行分块格式化，多线程时各块并行)
+    kspace_txt_ctx ctx = {real, imag, width};
+    int result = text_write_table(file, columns, 6, ' ', (size_t)width * height, kspace_txt_row, &ctx);
     
-    fclose(file);
+    if (fclose(file) != 0 || result != 0) {
+        printf("写入文件失败: %s\n", filename);
+        return -1;
+    }
     printf("已保存K空间数据: %s (尺寸: %dx%d)\n", filename, width, height);
     return 0;
 }
 
+/**
+ * 按指定的存储方式保存K空间数据
+ * @param dtype KSPACE_F64、KSPACE_F32 或 KSPACE_F16 (每行缩放)
+ * @param layout KSPACE_SPLIT 或 KSPACE_INTERLEAVED
+ * @param flags 0 或 KSPACE_HERMITIAN (实数图像的频谱，只保存 width/2+1 列)
+ */
+int save_kspace_binary_as(const char* filename, const double* real, const double* imag, int width, int height,
+                          int dtype, int layout, int flags) {
+    kspace_info info, full;
+    if (kspace_save(filename, real, imag, width, height, dtype, layout, flags) != 0 ||
+        kspace_info_init(&info, width, height, 1, dtype, layout, flags) != 0 ||
+        kspace_info_init(&full, width, height, 1, KSPACE_F64, KSPACE_SPLIT, 0) != 0) {
+        return -1;
+    }
+    printf("已保存K空间二进制数据: %s (尺寸: %dx%d, 大小: %llu 字节)\n", 
+           filename, width, height, (unsigned long long)info.file_size);
+    if (info.file_size != full.file_size) {
+        printf("  存储: %s%s, 为 float64 完整频谱的 %.1f%%\n", kspace_dtype_name(dtype),
+               (flags & KSPACE_HERMITIAN) ? ", 共轭对称半谱" : "",
+               100.0 * (double)info.file_size / (double)full.file_size);
+    }
+    return 0;
+}
+
 /**
  * 保存K空间数据到二进制文件
+ * 使用带版本的容器格式 (见 kspace_io.h): 64 字节文件头，实部、虚部平面 64 字节对齐
  * @param filename 输出文件名
  * @param real 实部数据数组
  * @param imag 虚部数据数组
@@ -165,101 +140,96 @@ int save_kspace_txt(const char* filename, double* real, double* imag, int width,
  * @param height 数据高度
  */
 int save_kspace_binary(const char* filename, double* real, double* imag, int width, int height) {
-    FILE* file = fopen(filename, "wb");
-    if (!file) {
-        printf("无法创建文件: %s\n", filename);
+    return save_kspace_binary_as(filename, real, imag, width, height, KSPACE_F64, KSPACE_SPLIT, 0);
+}
+
+/**
+ * 保存单精度K空间数据到二进制文件
+ * 文件格式与 save_kspace_binary 相同，元素类型为 float32，文件大小减半
+ */
+int save_kspace_binary_f32(const char* filename, float* real, float* imag, int width, int height) {
+    kspace_info info;
+    if (kspace_save_f32(filename, real, imag, width, height, KSPACE_SPLIT) != 0 ||
+        kspace_info_init(&info, width, height, 1, KSPACE_F32, KSPACE_SPLIT, 0) != 0) {
         return -1;
     }
-    
-    // 写入文件头
-    fwrite(&width, sizeof(int), 1, file);
-    fwrite(&height, sizeof(int), 1, file);
-    
-    // 写入实部数据
-    fwrite(real, sizeof(double), width * height, file);
-    
-    // 写入虚部数据
-    fwrite(imag, sizeof(double), width * height, file);
-    
-    fclose(file);
-    printf("已保存K空间二进制数据: %s (尺寸: %dx%d, 大小: %ld 字节)\n", 
-           filename, width, height, 
-           (long)(2 * sizeof(int) + 2 * width * height * sizeof(double)));
+    printf("已保存K空间二进制数据 (float32): %s (尺寸: %dx%d, 大小: %llu 字节)\n", 
+           filename, width, height, (unsigned long long)info.file_size);
     return 0;
 }
 
 /**
- * 从二进制文件加载K空间数据
+ * 从二进制文件加载K空间数据 (新旧格式均可，统一转换为 double)
  * @param filename 输入文件名
- * @param real 实部数据数组(需要预先分配)
- * @param imag 虚部数据数组(需要预先分配)
+ * @param real 输出实部数组 (由本函数分配)
+ * @param imag 输出虚部数组 (由本函数分配)
  * @param width 输出数据宽度
  * @param height 输出数据高度
  */
 int load_kspace_binary(const char* filename, double** real, double** imag, int* width, int* height) {
-    FILE* file = fopen(filename, "rb");
-    if (!file) {
-        printf("无法打开文件: %s\n", filename);
+    kspace_file ks;
+    if (kspace_open(filename, &ks) != 0) {
         return -1;
     }
-    
-    // 读取文件头
-    fread(width, sizeof(int), 1, file);
-    fread(height, sizeof(int), 1, file);
+    if (ks.info.depth > 1) {
+        printf("错误: %s 是 %d 个切片的三维K空间文件，此处只支持二维数据\n", filename, ks.info.depth);
+        kspace_close(&ks);
+        return -1;
+    }
+    *width = ks.info.width;
+    *height = ks.info.height;
     
     // 分配内存
-    *real = (double*)malloc((*width) * (*height) * sizeof(double));
-    *imag = (double*)malloc((*width) * (*height) * sizeof(double));
+    *real = (double*)malloc((size_t)(*width) * (*height) * sizeof(double));
+    *imag = (double*)malloc((size_t)(*width) * (*height) * sizeof(double));
     
     if (!*real || !*imag) {
         printf("内存分配失败\n");
-        fclose(file);
+        free(*real);
+        free(*imag);
+        kspace_close(&ks);
         return -1;
     }
     
-    // 读取实部数据
-    fread(*real, sizeof(double), (*width) * (*height), file);
-    
-    // 读取虚部数据
-    fread(*imag, sizeof(double), (*width) * (*height), file);
-    
-    fclose(file);
+    if (kspace_read_rows(&ks, 0, *height, *real, *imag, KSPACE_F64) != 0) {
+        printf("读取K空间数据失败: %s\n", filename);
+        free(*real);
+        free(*imag);
+        *real = *imag = NULL;
+        kspace_close(&ks);
+        return -1;
+    }
+    kspace_close(&ks);
     printf("已加载K空间数据: %s (尺寸: %dx%d)\n", filename, *width, *height);
     return 0;
 }
 
 /**
- * FFT频谱中心化 (FFTShift)
- * 将零频率分量移到频谱中心
- * @param data 输入/输出数据数组
- * @param width 图像宽度
- * @param height 图像高度
+ * 只读映射刚保存的K空间文件，作为逆变换的输入 (还原结果同时验证了文件内容)
+ * @param dtype 需要的元素类型
+ * @return 0表示可以直接把 real/imag 作为 dtype 的分离平面使用，
+ *         1表示需要先用 kspace_read_rows 转换 (其他类型、交错存放或半谱)，两者都用 kspace_close 释放；
+ *         -1表示不能使用，调用者改用内存中的数据
  */
-void fft_shift(double* data, int width, int height) {
-    double* temp = (double*)malloc(width * height * sizeof(double));
-    if (!temp) return;
-    
-    int half_h = height / 2;
-    int half_w = width / 2;
-    
-    for (int i = 0; i < height; i++) {
-        for (int j = 0; j < width; j++) {
-            int new_i = (i + half_h) % height;
-            int new_j = (j + half_w) % width;
-            temp[new_i * width + new_j] = data[i * width + j];
-        }
+int map_saved_kspace(const char* filename, int dtype, int M, int N, kspace_file* ks) {
+    if (kspace_open(filename, ks) != 0) {
+        return -1;
     }
-    
-    // 复制回原数组
-    for (int i = 0; i < width * height; i++) {
-        data[i] = temp[i];
+    if (ks->info.width != N || ks->info.height != M) {
+        printf("K空间文件 %s 与内存中的数据不符\n", filename);
+        kspace_close(ks);
+        return -1;
     }
-    
-    free(temp);
+    if (!kspace_is_direct(ks, dtype)) {
+        printf("  输入: %s (只读映射，读取时转换为计算精度)\n", filename);
+        return 1;
+    }
+    printf("  输入: %s (只读映射)\n", filename);
+    return 0;
 }
 
 /**
- * 计算一维离散傅里叶变换 (1D DFT)
+ * 计算一维离散傅里叶变换 (1D DFT)，内部使用 FFT 实现
  * @param x_real 输入信号的实部数组
  * @param x_imag 输入信号的虚部数组
  * @param N 信号长度
@@ -267,22 +237,11 @@ void fft_shift(double* data, int width, int height) {
  * @param X_imag 输出信号频域的虚部数组
  */
 void calculate_1d_dft(double* x_real, double* x_imag, int N, double* X_real, double* X_imag) {
-    for (int k = 0; k < N; k++) {
-        X_real[k] = 0.0;
-        X_imag[k] = 0.0;
-        for (int n = 0; n < N; n++) {
-            double angle = 2.0 * M_PI * k * n / N;
-            double cos_val = cos(angle);
-            double sin_val = sin(angle);
-            // 复数乘法: (a + bi) * (cos - i*sin)
-            X_real[k] += x_real[n] * cos_val + x_imag[n] * sin_val;
-            X_imag[k] += x_imag[n] * cos_val - x_real[n] * sin_val;
-        }
-    }
+    fft_1d(x_real, x_imag, N, X_real, X_imag);
 }
 
 /**
- * 计算一维离散傅里叶逆变换 (1D IDFT)
+ * 计算一维离散傅里叶逆变换 (1D IDFT)，内部使用 FFT 实现
  * @param X_real 输入频域信号的实部数组
  * @param X_imag 输入频域信号的虚部数组
  * @param N 信号长度
@@ -290,25 +249,12 @@ void calculate_1d_dft(double* x_real, double* x_imag, int N, double* X_real, dou
  * @param x_imag 输出时域信号的虚部数组
  */
 void calculate_1d_idft(double* X_real, double* X_imag, int N, double* x_real, double* x_imag) {
-    for (int n = 0; n < N; n++) {
-        x_real[n] = 0.0;
-        x_imag[n] = 0.0;
-        for (int k = 0; k < N; k++) {
-            double angle = 2.0 * M_PI * k * n / N;
-            double cos_val = cos(angle);
-            double sin_val = sin(angle);
-            // 复数乘法: (a + bi) * (cos + i*sin)，注意符号与DFT相反
-            x_real[n] += X_real[k] * cos_val - X_imag[k] * sin_val;
-            x_imag[n] += X_imag[k] * cos_val + X_real[k] * sin_val;
-        }
-        // 归一化
-        x_real[n] /= N;
-        x_imag[n] /= N;
-    }
+    ifft_1d(X_real, X_imag, N, x_real, x_imag);
 }
 
 /**
  * 计算二维离散傅里叶变换 (2D DFT)
+ * 行变换之后把矩阵分块转置，列变换也在连续内存上进行 (见 fft_2d)
  * @param x_real 输入信号的实部数组 (M x N)
  * @param x_imag 输入信号的虚部数组 (M x N)
  * @param M 行数
@@ -318,171 +264,338 @@ void calculate_1d_idft(double* X_real, double* X_imag, int N, double* x_real, do
  */
 void calculate_2d_dft(double* x_real, double* x_imag, int M, int N, 
                       double* X_real, double* X_imag) {
-    // 临时存储数组
-    double *temp_real = (double *)malloc(M * N * sizeof(double));
-    double *temp_imag = (double *)malloc(M * N * sizeof(double));
-    double *row_real = (double *)malloc(N * sizeof(double));
-    double *row_imag = (double *)malloc(N * sizeof(double));
-    double *row_out_real = (double *)malloc(N * sizeof(double));
-    double *row_out_imag = (double *)malloc(N * sizeof(double));
-    
-    if (!temp_real || !temp_imag || !row_real || !row_imag || !row_out_real || !row_out_imag) {
-        printf("内存分配失败\n");
-        return;
+    if (fft_2d(x_real, x_imag, M, N, X_real, X_imag) != 0) {
+        printf("2D DFT 失败\n");
     }
-    
-    // 第一步: 对每一行进行1D DFT
+}
+
+/**
+ * 计算二维离散傅里叶逆变换 (2D IDFT)，含 1/(MN) 归一化
+ * @param X_real 输入频域信号的实部数组 (M x N)
+ * @param X_imag 输入频域信号的虚部数组 (M x N)
+ * @param M 行数
+ * @param N 列数
+ * @param x_real 输出时域信号的实部数组 (M x N)
+ * @param x_imag 输出时域信号的虚部数组 (M x N)
+ */
+void calculate_2d_idft(const double* X_real, const double* X_imag, int M, int N, 
+                       double* x_real, double* x_imag) {
+    if (ifft_2d(X_real, X_imag, M, N, x_real, x_imag) != 0) {
+        printf("2D IDFT 失败\n");
+    }
+}
+
+/**
+ * 单精度二维离散傅里叶变换 (2D DFT)
+ * 与 calculate_2d_dft 相同，但数据为 float，内存带宽减半、SIMD 宽度加倍
+ * 相对 double 结果的误差约为 1e-7 量级 (见 README-FFT.md)
+ */
+void calculate_2d_dft_f(float* x_real, float* x_imag, int M, int N,
+                        float* X_real, float* X_imag) {
+    if (fftf_2d(x_real, x_imag, M, N, X_real, X_imag) != 0) {
+        printf("2D DFT (float) 失败\n");
+    }
+}
+
+/**
+ * 单精度二维离散傅里叶逆变换 (2D IDFT)，含 1/(MN) 归一化
+ */
+void calculate_2d_idft_f(const float* X_real, const float* X_imag, int M, int N,
+                         float* x_real, float* x_imag) {
+    if (ifftf_2d(X_real, X_imag, M, N, x_real, x_imag) != 0) {
+        printf("2D IDFT (float) 失败\n");
+    }
+}
+
+/**
+ * 由实数图像的半谱展开完整频谱，并计算幅度谱
+ * 实数输入满足共轭对称 X[i][j] = conj(X[(M-i)%M][(N-j)%N])，
+ * 幅度只在 M x (N/2+1) 的半谱上计算，镜像位置直接复用
+ * @param H_real 半谱实部 (M x (N/2+1))
+ * @param H_imag 半谱虚部 (M x (N/2+1))
+ * @param M 行数
+ * @param N 列数
+ * @param X_real 输出完整频谱实部 (M x N)
+ * @param X_imag 输出完整频谱虚部 (M x N)
+ * @param magnitude 输出幅度谱 (M x N)
+ */
+void expand_hermitian_spectrum(double* H_real, double* H_imag, int M, int N,
+                               double* X_real, double* X_imag, double* magnitude) {
+    int half_cols = N / 2 + 1;
     for (int i = 0; i < M; i++) {
-        // 提取第i行
-        for (int j = 0; j < N; j++) {
-            row_real[j] = x_real[i * N + j];
-            row_imag[j] = x_imag[i * N + j];
-        }
-        
-        // 对该行进行1D DFT
-        calculate_1d_dft(row_real, row_imag, N, row_out_real, row_out_imag);
-        
-        // 存储结果
-        for (int j = 0; j < N; j++) {
-            temp_real[i * N + j] = row_out_real[j];
-            temp_imag[i * N + j] = row_out_imag[j];
+        int mirror_i = (M - i) % M;
+        for (int j = 0; j < half_cols; j++) {
+            double re = H_real[i * half_cols + j];
+            double im = H_imag[i * half_cols + j];
+            double mag = sqrt(re * re + im * im);
+
+            X_real[i * N + j] = re;
+            X_imag[i * N + j] = im;
+            magnitude[i * N + j] = mag;
+
+            // 共轭对称位置 (只填写半谱之外的列)
+            int mirror_j = N - j;
+            if (j > 0 && mirror_j >= half_cols) {
+                X_real[mirror_i * N + mirror_j] = re;
+                X_imag[mirror_i * N + mirror_j] = -im;
+                magnitude[mirror_i * N + mirror_j] = mag;
+            }
         }
     }
-    
-    // 分配列数组
-    double *col_real = (double *)malloc(M * sizeof(double));
-    double *col_imag = (double *)malloc(M * sizeof(double));
-    double *col_out_real = (double *)malloc(M * sizeof(double));
-    double *col_out_imag = (double *)malloc(M * sizeof(double));
-    
-    if (!col_real || !col_imag || !col_out_real || !col_out_imag) {
+}
+
+/**
+ * 生成多层测试数据并保存K空间 (--slices / --volume 模式)
+ * 体模为位于体积中心的椭球 (每层是半径随层变化的椭圆)：多层二维数据逐层做 2D FFT，
+ * 三维数据做 3D FFT 并标记为 KSPACE_VOLUME；保存后读回文件做逆变换，检查还原误差
+ * @param depth 层数
+ * @param volume 1 表示三维K空间，0 表示层间独立的多层二维数据
+ * @return 0表示成功，-1表示失败
+ */
+int save_multislice_kspace(const char* filename, int M, int N, int depth, int volume,
+                           int dtype, int layout, int flags) {
+    size_t count = (size_t)depth * M * N;
+    double *x = (double *)malloc(count * sizeof(double));
+    double *X_real = (double *)malloc(count * sizeof(double));
+    double *X_imag = (double *)malloc(count * sizeof(double));
+    if (!x || !X_real || !X_imag) {
         printf("内存分配失败\n");
-        free(temp_real); free(temp_imag);
-        free(row_real); free(row_imag); free(row_out_real); free(row_out_imag);
-        return;
+        free(x);
+        free(X_real);
+        free(X_imag);
+        return -1;
     }
-    
-    // 第二步: 对每一列进行1D DFT
-    for (int j = 0; j < N; j++) {
-        // 提取第j列
+
+    printf("生成%s测试数据: %d 层 x %d x %d (中心椭球)\n", volume ? "三维" : "多层二维", depth, M, N);
+    for (int s = 0; s < depth; s++) {
+        double dz = (s - depth / 2) / (depth / 3.0 + 0.5);
         for (int i = 0; i < M; i++) {
-            col_real[i] = temp_real[i * N + j];
-            col_imag[i] = temp_imag[i * N + j];
+            double dy = (i - M / 2) / (M / 3.0);
+            for (int j = 0; j < N; j++) {
+                double dx = (j - N / 2) / (N / 3.0);
+                x[((size_t)s * M + i) * N + j] = (dx * dx + dy * dy + dz * dz < 1.0) ? 1.0 : 0.0;
+            }
         }
-        
-        // 对该列进行1D DFT
-        calculate_1d_dft(col_real, col_imag, M, col_out_real, col_out_imag);
-        
-        // 存储结果
-        for (int i = 0; i < M; i++) {
-            X_real[i * N + j] = col_out_real[i];
-            X_imag[i * N + j] = col_out_imag[i];
+    }
+
+    int result = volume ? fft_3d(x, NULL, depth, M, N, X_real, X_imag)
+                        : fft_2d_many(x, NULL, M, N, depth, X_real, X_imag);
+    if (result == 0) {
+        // 输入为实数，频谱共轭对称 (多层数据每层各自对称，三维数据整体对称)，可以只保存半谱
+        result = kspace_save_volume(filename, X_real, X_imag, N, M, depth, dtype, layout,
+                                    flags | (volume ? KSPACE_VOLUME : 0));
+    }
+
+    kspace_file ks;
+    if (result == 0 && kspace_open(filename, &ks) == 0) {
+        printf("已保存K空间二进制数据: %s (尺寸: %dx%dx%d, 大小: %llu 字节)\n", filename, N, M, depth,
+               (unsigned long long)ks.info.file_size);
+        // 读回文件 (必要时转换、展开半谱) 后逆变换，与原始数据比较
+        result = kspace_read_rows(&ks, 0, kspace_total_rows(&ks.info), X_real, X_imag, KSPACE_F64);
+        kspace_close(&ks);
+        if (result == 0) {
+            result = volume ? ifft_3d(X_real, X_imag, depth, M, N, X_real, X_imag)
+                            : ifft_2d_many(X_real, X_imag, M, N, depth, X_real, X_imag);
         }
+        if (result == 0) {
+            double max_error = 0.0;
+            for (size_t i = 0; i < count; i++) {
+                double error = fabs(X_real[i] - x[i]);
+                if (error > max_error) max_error = error;
+            }
+            printf("  读回还原最大误差: %.6e\n", max_error);
+        }
+    } else {
+        result = -1;
     }
-    
-    // 释放临时内存
-    free(temp_real);
-    free(temp_imag);
-    free(row_real);
-    free(row_imag);
-    free(row_out_real);
-    free(row_out_imag);
-    free(col_real);
-    free(col_imag);
-    free(col_out_real);
-    free(col_out_imag);
+
+    free(x);
+    free(X_real);
+    free(X_imag);
+    return result;
 }
 
 /**
- * 计算二维离散傅里叶逆变换 (2D IDFT)
- * @param X_real 输入频域信号的实部数组 (M x N)
- * @param X_imag 输入频域信号的虚部数组 (M x N)
- * @param M 行数
- * @param N 列数
- * @param x_real 输出时域信号的实部数组 (M x N)
- * @param x_imag 输出时域信号的虚部数组 (M x N)
+ * 生成欠采样K空间 (--undersample / --center 模式)
+ * 体模与多层模式的一层相同 (中心椭圆)。保留每 R 行中的一行 (等间隔欠采样)
+ * 和/或 |k| <= L/2 的中心行 (低分辨率中心区)，其余行置 0，采样掩码写入 mask_file。
+ * 保存后读回文件，比较剪枝逆变换 (ifft_2d_pruned) 与完整逆变换的结果和耗时
+ * @param R 等间隔欠采样因子 (0 表示不做)
+ * @param L 中心区的宽度 (0 表示不做)
+ * @return 0表示成功，-1表示失败
  */
-void calculate_2d_idft(double* X_real, double* X_imag, int M, int N, 
-                       double* x_real, double* x_imag) {
-    // 临时存储数组
-    double *temp_real = (double *)malloc(M * N * sizeof(double));
-    double *temp_imag = (double *)malloc(M * N * sizeof(double));
-    double *row_real = (double *)malloc(N * sizeof(double));
-    double *row_imag = (double *)malloc(N * sizeof(double));
-    double *row_out_real = (double *)malloc(N * sizeof(double));
-    double *row_out_imag = (double *)malloc(N * sizeof(double));
-    
-    if (!temp_real || !temp_imag || !row_real || !row_imag || !row_out_real || !row_out_imag) {
+int save_undersampled_kspace(const char* filename, const char* mask_file, int M, int N, int R, int L,
+                             int dtype, int layout, int flags) {
+    size_t count = (size_t)M * N;
+    double *X_real = (double *)malloc(count * sizeof(double));
+    double *X_imag = (double *)malloc(count * sizeof(double));
+    double *full_real = (double *)calloc(count, sizeof(double));
+    double *full_imag = (double *)malloc(count * sizeof(double));
+    double *pruned_real = (double *)malloc(count * sizeof(double));
+    double *pruned_imag = (double *)malloc(count * sizeof(double));
+    unsigned char *mask = (unsigned char *)malloc((size_t)M);
+    if (!X_real || !X_imag || !full_real || !full_imag || !pruned_real || !pruned_imag || !mask) {
         printf("内存分配失败\n");
-        return;
+        free(X_real);
+        free(X_imag);
+        free(full_real);
+        free(full_imag);
+        free(pruned_real);
+        free(pruned_imag);
+        free(mask);
+        return -1;
     }
-    
-    // 第一步: 对每一行进行1D IDFT
+
+    // 体模暂存在 full_real 中
     for (int i = 0; i < M; i++) {
-        // 提取第i行
+        double dy = (i - M / 2) / (M / 3.0);
         for (int j = 0; j < N; j++) {
-            row_real[j] = X_real[i * N + j];
-            row_imag[j] = X_imag[i * N + j];
-        }
-        
-        // 对该行进行1D IDFT
-        calculate_1d_idft(row_real, row_imag, N, row_out_real, row_out_imag);
-        
-        // 存储结果
-        for (int j = 0; j < N; j++) {
-            temp_real[i * N + j] = row_out_real[j];
-            temp_imag[i * N + j] = row_out_imag[j];
+            double dx = (j - N / 2) / (N / 3.0);
+            full_real[(size_t)i * N + j] = (dx * dx + dy * dy < 1.0) ? 1.0 : 0.0;
         }
     }
-    
-    // 分配列数组
-    double *col_real = (double *)malloc(M * sizeof(double));
-    double *col_imag = (double *)malloc(M * sizeof(double));
-    double *col_out_real = (double *)malloc(M * sizeof(double));
-    double *col_out_imag = (double *)malloc(M * sizeof(double));
-    
-    if (!col_real || !col_imag || !col_out_real || !col_out_imag) {
-        printf("内存分配失败\n");
-        free(temp_real); free(temp_imag);
-        free(row_real); free(row_imag); free(row_out_real); free(row_out_imag);
-        return;
+    int result = fft_2d(full_real, NULL, M, N, X_real, X_imag);
+
+    // K空间未中心化，第 i 行的频率为 i 或 i - M。两种采样都关于 k=0 对称 (R 整除 M 时)，
+    // 镜像行同时采样或同时为 0，半谱仍然适用
+    int sampled = 0;
+    for (int i = 0; i < M; i++) {
+        int k = (i <= M / 2) ? i : M - i;
+        mask[i] = (R > 0 && i % R == 0) || (L > 0 && k <= L / 2);
+        if (!mask[i]) {
+            memset(X_real + (size_t)i * N, 0, (size_t)N * sizeof(double));
+            memset(X_imag + (size_t)i * N, 0, (size_t)N * sizeof(double));
+        }
+        sampled += mask[i];
     }
-    
-    // 第二步: 对每一列进行1D IDFT
-    for (int j = 0; j < N; j++) {
-        // 提取第j列
+    printf("生成欠采样K空间: %d x %d (中心椭圆), 采样 %d / %d 行", N, M, sampled, M);
+    if (R > 0) printf(", 每 %d 行一行", R);
+    if (L > 0) printf(", 中心 |k| <= %d", L / 2);
+    printf("\n");
+
+    FILE *file = (result == 0) ? fopen(mask_file, "w") : NULL;
+    if (file) {
+        fprintf(file, "# 采样掩码: 每行一个值，1 = 已采样\n");
         for (int i = 0; i < M; i++) {
-            col_real[i] = temp_real[i * N + j];
-            col_imag[i] = temp_imag[i * N + j];
+            fprintf(file, "%d\n", mask[i]);
         }
-        
-        // 对该列进行1D IDFT
-        calculate_1d_idft(col_real, col_imag, M, col_out_real, col_out_imag);
-        
-        // 存储结果
-        for (int i = 0; i < M; i++) {
-            x_real[i * N + j] = col_out_real[i];
-            x_imag[i * N + j] = col_out_imag[i];
+        result = fclose(file) == 0 ? 0 : -1;
+        printf("已保存采样掩码: %s\n", mask_file);
+    } else {
+        result = -1;
+    }
+    if (result == 0) {
+        result = save_kspace_binary_as(filename, X_real, X_imag, N, M, dtype, layout, flags);
+    }
+
+    kspace_file ks;
+    if (result == 0 && kspace_open(filename, &ks) == 0) {
+        // 读回文件后分别做完整逆变换和剪枝逆变换 (各执行多次取平均)
+        result = kspace_read_rows(&ks, 0, M, X_real, X_imag, KSPACE_F64);
+        kspace_close(&ks);
+        const int repeat = 20;
+        double t0 = now_seconds();
+        for (int r = 0; r < repeat && result == 0; r++) {
+            result = ifft_2d(X_real, X_imag, M, N, full_real, full_imag);
+        }
+        double t1 = now_seconds();
+        for (int r = 0; r < repeat && result == 0; r++) {
+            result = ifft_2d_pruned(X_real, X_imag, M, N, mask, pruned_real, pruned_imag);
+        }
+        double t2 = now_seconds();
+        if (result == 0) {
+            double max_diff = 0.0, max_val = 0.0;
+            for (size_t i = 0; i < count; i++) {
+                double diff = hypot(pruned_real[i] - full_real[i], pruned_imag[i] - full_imag[i]);
+                if (diff > max_diff) max_diff = diff;
+                if (fabs(full_real[i]) > max_val) max_val = fabs(full_real[i]);
+            }
+            printf("补零重建: 完整 2D IDFT %.3f ms, 剪枝 2D IDFT %.3f ms (%.2f 倍)\n",
+                   (t1 - t0) * 1e3 / repeat, (t2 - t1) * 1e3 / repeat, (t1 - t0) / fmax(1e-12, t2 - t1));
+            printf("  两者最大差 / 最大值: %.6e\n", max_diff / fmax(1e-30, max_val));
         }
+    } else {
+        result = -1;
     }
-    
-    // 释放临时内存
-    free(temp_real);
-    free(temp_imag);
-    free(row_real);
-    free(row_imag);
-    free(row_out_real);
-    free(row_out_imag);
-    free(col_real);
-    free(col_imag);
-    free(col_out_real);
-    free(col_out_imag);
+
+    free(X_real);
+    free(X_imag);
+    free(full_real);
+    free(full_imag);
+    free(pruned_real);
+    free(pruned_imag);
+    free(mask);
+    return result;
 }
 
-int main() {
+int main(int argc, char *argv[]) {
     int M = 256;  // 图像行数 (增大以生成更清晰的图像)
     int N = 256;  // 图像列数
     
+    // 解析命令行参数: kspace_data.bin 的存储方式 [--dtype f64|f32|f16] [--half] [--interleaved]
+    // 以及图像格式 [--image bmp|bmp8|pgm]；[--slices D] / [--volume D] 只生成多层 / 三维K空间文件，
+    // [--undersample R] [--center L] 只生成欠采样K空间文件和采样掩码
+    int kspace_dtype = KSPACE_F64;
+    int kspace_layout = KSPACE_SPLIT;
+    int kspace_flags = 0;
+    int depth = 0;      // 多层模式的层数
+    int volume = 0;
+    int undersample = 0;    // 欠采样模式: 每 undersample 行保留一行
+    int center = 0;         // 欠采样模式: 保留 |k| <= center/2 的中心行
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--dtype") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "f64") == 0) {
+                kspace_dtype = KSPACE_F64;
+            } else if (strcmp(argv[i], "f32") == 0) {
+                kspace_dtype = KSPACE_F32;
+            } else if (strcmp(argv[i], "f16") == 0) {
+                kspace_dtype = KSPACE_F16;
+            } else {
+                printf("错误: 无效的元素类型 %s (f64、f32 或 f16)\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--half") == 0) {
+            kspace_flags |= KSPACE_HERMITIAN;
+        } else if (strcmp(argv[i], "--interleaved") == 0) {
+            kspace_layout = KSPACE_INTERLEAVED;
+        } else if ((strcmp(argv[i], "--slices") == 0 || strcmp(argv[i], "--volume") == 0) && i + 1 < argc) {
+            volume = strcmp(argv[i], "--volume") == 0;
+            depth = atoi(argv[++i]);
+            if (depth < 2) {
+                printf("错误: 无效的层数 %s (至少 2 层)\n", argv[i]);
+                return 1;
+            }
+        } else if ((strcmp(argv[i], "--undersample") == 0 || strcmp(argv[i], "--center") == 0) && i + 1 < argc) {
+            int *target = strcmp(argv[i], "--center") == 0 ? &center : &undersample;
+            *target = atoi(argv[++i]);
+            if (*target < 1 || *target > M) {
+                printf("错误: 无效的行数 %s (1 到 %d)\n", argv[i], M);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--image") == 0 && i + 1 < argc) {
+            image_format = image_parse_format(argv[++i]);
+            if (image_format < 0) {
+                printf("错误: 无效的图像格式 %s (bmp、bmp8 或 pgm)\n", argv[i]);
+                return 1;
+            }
+        } else {
+            printf("用法: %s [--dtype f64|f32|f16] [--half] [--interleaved] [--image bmp|bmp8|pgm]\n"
+                   "       [--slices D | --volume D] [--undersample R] [--center L]\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    if (depth > 0) {
+        const char *filename = volume ? "kspace_volume.bin" : "kspace_stack.bin";
+        return save_multislice_kspace(filename, M, N, depth, volume,
+                                      kspace_dtype, kspace_layout, kspace_flags) == 0 ? 0 : 1;
+    }
+    if (undersample > 0 || center > 0) {
+        return save_undersampled_kspace("kspace_undersampled.bin", "kspace_mask.txt", M, N, undersample, center,
+                                        kspace_dtype, kspace_layout, kspace_flags) == 0 ? 0 : 1;
+    }
+    
     printf("2D FFT 示例 - 图像尺寸: %d x %d\n\n", M, N);
     
     // 分配内存用于存储2D信号 (模拟图像)
@@ -494,6 +607,11 @@ int main() {
     
     if (!x_real || !x_imag || !X_real || !X_imag || !magnitude) {
         printf("内存分配失败\n");
+        free(x_real);
+        free(x_imag);
+        free(X_real);
+        free(X_imag);
+        free(magnitude);
         return 1;
     }
     
@@ -569,48 +687,64 @@ int main() {
     }
     printf("\n");
     
-    // 执行2D DFT
+    // 执行2D DFT (输入为实数图像，r2c 只计算 N/2+1 列非冗余频点)
     printf("正在执行 2D DFT...\n");
-    calculate_2d_dft(x_real, x_imag, M, N, X_real, X_imag);
-    
-    // 计算幅度谱
-    for (int i = 0; i < M * N; i++) {
-        magnitude[i] = sqrt(X_real[i] * X_real[i] + X_imag[i] * X_imag[i]);
+    int half_cols = N / 2 + 1;
+    double *H_real = (double *)malloc(M * half_cols * sizeof(double));
+    double *H_imag = (double *)malloc(M * half_cols * sizeof(double));
+    if (!H_real || !H_imag) {
+        printf("内存分配失败\n");
+        free(H_real);
+        free(H_imag);
+        free(x_real);
+        free(x_imag);
+        free(X_real);
+        free(X_imag);
+        free(magnitude);
+        return 1;
     }
+    fft_r2c_2d(x_real, M, N, H_real, H_imag);
     
-    // 保存原始图像为BMP
+    // 由共轭对称性展开完整K空间，同时计算幅度谱
+    expand_hermitian_spectrum(H_real, H_imag, M, N, X_real, X_imag, magnitude);
+    free(H_real);
+    free(H_imag);
+    
+    // 保存原始图像
     printf("\n保存图像文件...\n");
-    save_bmp_grayscale("original_image.bmp", x_real, N, M);
+    save_image("original_image", x_real, N, M);
     
     // 保存K空间数据 (频域数据)
     printf("\n保存K空间数据...\n");
-    save_kspace_binary("kspace_data.bin", X_real, X_imag, N, M);
+    // 输入为实数图像，频谱共轭对称，可以只保存半谱
+    save_kspace_binary_as("kspace_data.bin", X_real, X_imag, N, M, kspace_dtype, kspace_layout, kspace_flags);
     save_kspace_txt("kspace_data.txt", X_real, X_imag, N, M);
     
-    // 对幅度谱进行中心化
-    fft_shift(magnitude, N, M);
-    
-    // 保存幅度谱为BMP (对数尺度以便更好地可视化)
-    double *log_magnitude = (double *)malloc(M * N * sizeof(double));
-    if (log_magnitude) {
-        for (int i = 0; i < M * N; i++) {
-            log_magnitude[i] = log(1.0 + magnitude[i]);  // log(1+x) 避免 log(0)
-        }
-        save_bmp_grayscale("magnitude_spectrum.bmp", log_magnitude, N, M);
-        save_bmp_grayscale("magnitude_spectrum_linear.bmp", magnitude, N, M);
-        free(log_magnitude);
-    }
+    // 保存中心化的幅度谱 (对数尺度以便更好地可视化)，幅度、中心化、对数和量化在写入时一次完成
+    save_spectrum_image("magnitude_spectrum", X_real, X_imag, N, M, IMAGE_SPECTRUM_LOG);
+    save_spectrum_image("magnitude_spectrum_linear", X_real, X_imag, N, M, IMAGE_SPECTRUM_LINEAR);
     
-    // 执行2D逆DFT (IDFT) 还原图像
+    // 执行2D逆DFT (IDFT) 还原图像，直接从映射的 K空间文件变换
     printf("\n正在执行 2D IDFT (逆变换)...\n");
     double *restored_real = (double *)malloc(M * N * sizeof(double));
     double *restored_imag = (double *)malloc(M * N * sizeof(double));
+    kspace_file ks;
+    int mapped = map_saved_kspace("kspace_data.bin", KSPACE_F64, M, N, &ks);
     
     if (restored_real && restored_imag) {
-        calculate_2d_idft(X_real, X_imag, M, N, restored_real, restored_imag);
+        const double *in_real = X_real, *in_imag = X_imag;
+        if (mapped == 0) {
+            in_real = (const double *)ks.real;
+            in_imag = (const double *)ks.imag;
+        } else if (mapped == 1 && kspace_read_rows(&ks, 0, M, restored_real, restored_imag, KSPACE_F64) == 0) {
+            // 转换后的数据直接放在输出数组中原地变换
+            in_real = restored_real;
+            in_imag = restored_imag;
+        }
+        calculate_2d_idft(in_real, in_imag, M, N, restored_real, restored_imag);
         
         // 保存还原的图像 (只保存实部，虚部应该接近0)
-        save_bmp_grayscale("restored_image.bmp", restored_real, N, M);
+        save_image("restored_image", restored_real, N, M);
         
         // 计算还原误差
         double max_error = 0.0;
@@ -639,7 +773,57 @@ int main() {
         free(restored_real);
         free(restored_imag);
     }
-    
+    if (mapped >= 0) {
+        kspace_close(&ks);
+    }
+
+    // 单精度路径: 与 double 结果对比，并保存 float32 K空间文件
+    printf("\n正在执行单精度 (float) 2D DFT/IDFT...\n");
+    float *xf_real = (float *)malloc(M * N * sizeof(float));
+    float *xf_imag = (float *)malloc(M * N * sizeof(float));
+    float *Xf_real = (float *)malloc(M * N * sizeof(float));
+    float *Xf_imag = (float *)malloc(M * N * sizeof(float));
+
+    if (xf_real && xf_imag && Xf_real && Xf_imag) {
+        for (int i = 0; i < M * N; i++) {
+            xf_real[i] = (float)x_real[i];
+            xf_imag[i] = 0.0f;
+        }
+        calculate_2d_dft_f(xf_real, xf_imag, M, N, Xf_real, Xf_imag);
+
+        double max_diff = 0.0, max_mag = 0.0;
+        for (int i = 0; i < M * N; i++) {
+            double diff = hypot(Xf_real[i] - X_real[i], Xf_imag[i] - X_imag[i]);
+            if (diff > max_diff) max_diff = diff;
+            if (magnitude[i] > max_mag) max_mag = magnitude[i];
+        }
+        save_kspace_binary_f32("kspace_data_f32.bin", Xf_real, Xf_imag, N, M);
+
+        kspace_file ksf;
+        int mapped_f = map_saved_kspace("kspace_data_f32.bin", KSPACE_F32, M, N, &ksf);
+        calculate_2d_idft_f(mapped_f == 0 ? (const float *)ksf.real : Xf_real,
+                            mapped_f == 0 ? (const float *)ksf.imag : Xf_imag,
+                            M, N, xf_real, xf_imag);
+        if (mapped_f >= 0) {
+            kspace_close(&ksf);
+        }
+        double max_error = 0.0;
+        for (int i = 0; i < M * N; i++) {
+            double error = fabs(xf_real[i] - x_real[i]);
+            if (error > max_error) max_error = error;
+        }
+
+        printf("单精度结果 (相对 double):\n");
+        printf("  K空间最大误差 / 最大幅度: %.6e\n", max_diff / fmax(1e-30, max_mag));
+        printf("  还原最大误差: %.6e\n", max_error);
+    } else {
+        printf("内存分配失败\n");
+    }
+    free(xf_real);
+    free(xf_imag);
+    free(Xf_real);
+    free(Xf_imag);
+
     // 显示幅度谱
     printf("\n2D 幅度谱 (左上角 8x8 区域):\n");
     for (int i = 0; i < 8; i++) {
@@ -8,8 +8,12 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
+#include "text_io.h"
+#include "oscillator.h"
+
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
@@ -29,12 +33,22 @@ void generate_fm_signal(double *t, double *signal, int n,
                         double fc, double fm, double beta, double fs) {
     double delta_f = beta * fm;  // 最大频率偏移
     
-    for (int i = 0; i < n; i++) {
-        t[i] = i / fs;
-        // FM信号: s(t) = A*cos(2π*fc*t + β*sin(2π*fm*t))
-        // 其中β为调制指数，决定频率偏移量
-        signal[i] = cos(2.0 * M_PI * fc * t[i] + 
-                       beta * sin(2.0 * M_PI * fm * t[i]));
+    // FM信号: s(t) = A*cos(2π*fc*t + β*sin(2π*fm*t))
+    // 其中β为调制指数，决定频率偏移量
+    // 调制项 β*sin(2π*fm*t) 由旋转振荡器分段生成，作为载波数控振荡器的逐样本相位偏移
+    osc_rotator mod_osc;
+    osc_nco carrier_nco;
+    double offset[OSC_RESEED];
+    osc_rotator_init(&mod_osc, fm, fs, 0.0);
+    osc_nco_init(&carrier_nco, fc, fs, 0.0);
+    for (int start = 0; start < n; start += OSC_RESEED) {
+        int count = n - start < OSC_RESEED ? n - start : OSC_RESEED;
+        osc_rotator_render(&mod_osc, NULL, offset, count);
+        for (int k = 0; k < count; k++) {
+            t[start + k] = (start + k) / fs;
+            offset[k] *= beta;
+        }
+        osc_nco_render(&carrier_nco, offset, signal + start, count);
     }
     
     printf("调频信号参数:\n");
@@ -55,10 +69,10 @@ void save_signal_to_file(const char *filename, double *t, double *signal, int n)
         return;
     }
     
+    static const text_column column = {TEXT_FIXED, 0, 6};
+    const double *columns[2] = {t, signal};
     fprintf(fp, "# Time(s)\tSignal\n");
-    for (int i = 0; i < n; i++) {
-        fprintf(fp, "%.6f\t%.6f\n", t[i], signal[i]);
-    }
+    text_write_columns(fp, columns, 2, &column, '\t', (size_t)n);
     
     fclose(fp);
     printf("信号已保存到: %s\n", filename);
@@ -74,10 +88,10 @@ void save_signal_to_csv(const char *filename, double *t, double *signal, int n)
         return;
     }
     
+    static const text_column column = {TEXT_FIXED, 0, 6};
+    const double *columns[2] = {t, signal};
     fprintf(fp, "Time,Signal\n");
-    for (int i = 0; i < n; i++) {
-        fprintf(fp, "%.6f,%.6f\n", t[i], signal[i]);
-    }
+    text_write_columns(fp, columns, 2, &column, ',', (size_t)n);
     
     fclose(fp);
     printf("CSV数据已保存到: %s\n", filename);
@@ -179,109 +193,26 @@ void fm_demodulate_phase_discriminator(double *signal, double *demod_signal,
     free(phase);
 }
 
-/**
- * @brief FM解调 - 使用解析信号方法（最准确）
- * 
- * 通过Hilbert变换构造解析信号，然后计算瞬时频率
- * 这里使用简化的离散希尔伯特变换
- * 
- * @param signal 输入的FM信号
- * @param demod_signal 输出的解调信号（频率偏移）
- * @param n 采样点数  
- * @param fs 采样频率
- * @param fc 载波频率
- */
-void fm_demodulate_analytic(double *signal, double *demod_signal, 
-                            int n, double fs, double fc) {
-    double *hilbert = (double *)malloc(n * sizeof(double));
-    double *phase = (double *)malloc(n * sizeof(double));
-    
-    // 简化的Hilbert变换（90度相移）
-    // 对于余弦信号，Hilbert变换产生正弦信号
-    for (int i = 0; i < n; i++) {
-        hilbert[i] = 0.0;
-        
-        // 使用有限长度的希尔伯特变换核
-        for (int k = -20; k <= 20; k++) {
-            if (k == 0) continue;
-            int idx = i + k;
-            if (idx >= 0 && idx < n) {
-                // Hilbert变换核: h(n) = 2*sin^2(πn/2) / (πn)
-                double h = (2.0 / (M_PI * k)) * sin(M_PI * k / 2.0) * sin(M_PI * k / 2.0);
-                hilbert[i] += signal[idx] * h;
-            }
-        }
-    }
-    
-    // 计算瞬时相位
-    for (int i = 0; i < n; i++) {
-        phase[i] = atan2(hilbert[i], signal[i]);
-    }
-    
-    // 计算瞬时频率（相位的导数）
-    for (int i = 1; i < n; i++) {
-        double dphase = phase[i] - phase[i-1];
-        
-        // 相位解包装（unwrapping）
-        while (dphase > M_PI) dphase -= 2.0 * M_PI;
-        while (dphase < -M_PI) dphase += 2.0 * M_PI;
-        
-        // 瞬时频率 = (1/2π) * dφ/dt
-        double inst_freq = (dphase * fs) / (2.0 * M_PI);
-        
-        // 减去载波频率得到调制信号
-        demod_signal[i] = inst_freq - fc;
-    }
-    
-    demod_signal[0] = demod_signal[1];
-    
-    free(hilbert);
-    free(phase);
-}
+// 解析信号解调、低通滤波和去直流的双精度与单精度 (*_f) 版本由同一份实现生成
+#define FM_REAL         double
+#define FM_ID(x)        x
+#define FM_MATH(fn)     fn
+#define FM_VERBOSE      1
+#include "fm_demod_impl.h"
+#undef FM_REAL
+#undef FM_ID
+#undef FM_MATH
+#undef FM_VERBOSE
 
-/**
- * @brief 简单的低通滤波器（移动平均）
- * 
- * @param input 输入信号
- * @param output 输出信号
- * @param n 信号长度
- * @param window_size 滤波窗口大小
- */
-void lowpass_filter(double *input, double *output, int n, int window_size) {
-    int half_window = window_size / 2;
-    
-    for (int i = 0; i < n; i++) {
-        double sum = 0.0;
-        int count = 0;
-        
-        for (int j = -half_window; j <= half_window; j++) {
-            int idx = i + j;
-            if (idx >= 0 && idx < n) {
-                sum += input[idx];
-                count++;
-            }
-        }
-        
-        output[i] = sum / count;
-    }
-}
-
-/**
- * @brief 去除信号的直流分量
- */
-void remove_dc(double *signal, int n) {
-    double mean = 0.0;
-    for (int i = 0; i < n; i++) {
-        mean += signal[i];
-    }
-    mean /= n;
-    
-    for (int i = 0; i < n; i++) {
-        signal[i] -= mean;
-    }
-    
-    printf("  去除直流分量: %.2f Hz\n", mean);
-}
+#define FM_REAL         float
+#define FM_ID(x)        x##_f
+#define FM_MATH(fn)     fn##f
+#define FM_VERBOSE      0
+#include "fm_demod_impl.h"
+#undef FM_REAL
+#undef FM_ID
+#undef FM_MATH
+#undef FM_VERBOSE
 
 /**
  * @brief 计算解调误差
@@ -348,7 +279,20 @@ void print_signal_stats(double *signal, int n) {
     printf("  采样点数: %d\n", n);
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+    int use_float = 0;         // 同时运行单精度解调并与双精度对比
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-float") == 0) {
+            use_float = 1;
+        } else if (strcmp(argv[i], "-h") == 0) {
+            printf("用法: %s [-float]\n", argv[0]);
+            printf("  -float  同时运行单精度解调并与双精度结果对比\n");
+            return 0;
+        } else {
+            printf("警告: 忽略未知参数 %s\n", argv[i]);
+        }
+    }
+    
     // 信号参数设置
     double fs = 8000.0;        // 采样频率 8kHz
     double duration = 0.1;     // 信号持续时间 100ms
@@ -406,8 +350,11 @@ int main() {
     lowpass_filter(demod_signal, demod_filtered, n, filter_window);
     
     // 生成原始调制信号用于对比
+    osc_rotator mod_osc;
+    osc_rotator_init(&mod_osc, fm, fs, 0.0);
+    osc_rotator_render(&mod_osc, NULL, original_modulating, n);
     for (int i = 0; i < n; i++) {
-        original_modulating[i] = beta * fm * sin(2.0 * M_PI * fm * t[i]);
+        original_modulating[i] *= beta * fm;
     }
     
     // 保存解调信号
@@ -424,6 +371,36 @@ int main() {
     // 计算解调误差
     calculate_demod_error(demod_filtered, n, fm, beta, fs);
     
+    // 单精度解调，与双精度结果对比
+    if (use_float) {
+        printf("\n=== 单精度 (float) 解调对比 ===\n");
+        float *signal_f = (float *)malloc(n * sizeof(float));
+        float *demod_f = (float *)malloc(n * sizeof(float));
+        float *filtered_f = (float *)malloc(n * sizeof(float));
+        if (signal_f && demod_f && filtered_f) {
+            for (int i = 0; i < n; i++) {
+                signal_f[i] = (float)signal[i];
+            }
+            fm_demodulate_analytic_f(signal_f, demod_f, n, (float)fs, (float)fc);
+            remove_dc_f(demod_f, n);
+            lowpass_filter_f(demod_f, filtered_f, n, filter_window);
+            
+            double max_diff = 0.0, max_ref = 0.0;
+            for (int i = 0; i < n; i++) {
+                double diff = fabs((double)filtered_f[i] - demod_filtered[i]);
+                if (diff > max_diff) max_diff = diff;
+                if (fabs(demod_filtered[i]) > max_ref) max_ref = fabs(demod_filtered[i]);
+            }
+            printf("  与双精度结果的最大偏差: %.3e Hz (相对峰值 %.3e)\n",
+                   max_diff, max_ref > 0 ? max_diff / max_ref : 0.0);
+        } else {
+            fprintf(stderr, "内存分配失败!\n");
+        }
+        free(signal_f);
+        free(demod_f);
+        free(filtered_f);
+    }
+    
     printf("\n=== 生成完成! ===\n");
     printf("\n输出文件:\n");
     printf("  fm_signal.txt/csv - 原始FM调制信号\n");
@@ -0,0 +1,366 @@
+/**
+ * @file oscillator.c
+ * @brief 不调用三角函数的正弦信号合成 (见 oscillator.h)
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "oscillator.h"
+#include "fft.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define OSC_TABLE_SIZE (1 << OSC_TABLE_BITS)
+#define OSC_FRAC_BITS (64 - OSC_TABLE_BITS)     // 相位字中用于插值的低位
+
+/* ---------------- 旋转振荡器 ---------------- */
+
+/**
+ * 按精确相位重新设置各通道: 通道 j 对应样本 n + j
+ * 相位先取小数部分再乘 2π，与直接计算 cos(2π f t) 的精度相同
+ */
+static void rotator_reseed(osc_rotator* osc) {
+    for (int j = 0; j < OSC_LANES; j++) {
+        double c = osc->phase + osc->cycles * (double)(osc->n + j);
+        c -= floor(c);
+        osc->z_real[j] = cos(2.0 * M_PI * c);
+        osc->z_imag[j] = sin(2.0 * M_PI * c);
+    }
+}
+
+void osc_rotator_init(osc_rotator* osc, double freq, double fs, double phase) {
+    osc->cycles = freq / fs;
+    osc->phase = phase / (2.0 * M_PI);
+    osc->n = 0;
+
+    double step = osc->cycles * OSC_LANES;
+    step -= floor(step);
+    osc->w_real = cos(2.0 * M_PI * step);
+    osc->w_imag = sin(2.0 * M_PI * step);
+    rotator_reseed(osc);
+    osc->until_reseed = OSC_RESEED;
+}
+
+/**
+ * 旋转内核: 输出并推进 blocks 组 (每组 OSC_LANES 个样本)
+ * 相量在整段中留在寄存器里，只在开始和结束时读写 z_real / z_imag
+ */
+static void rotator_scalar(double* z_real, double* z_imag, double wr, double wi,
+                           double* out_cos, double* out_sin, int blocks) {
+    double zr[OSC_LANES], zi[OSC_LANES];
+    for (int j = 0; j < OSC_LANES; j++) {
+        zr[j] = z_real[j];
+        zi[j] = z_imag[j];
+    }
+    // 通道循环完全展开 (否则 GCC 会把输出的复制换成 memcpy 调用)
+    for (int b = 0; b < blocks; b++) {
+        if (out_cos) {
+#pragma GCC unroll 8
+            for (int j = 0; j < OSC_LANES; j++) out_cos[b * OSC_LANES + j] = zr[j];
+        }
+        if (out_sin) {
+#pragma GCC unroll 8
+            for (int j = 0; j < OSC_LANES; j++) out_sin[b * OSC_LANES + j] = zi[j];
+        }
+#pragma GCC unroll 8
+        for (int j = 0; j < OSC_LANES; j++) {
+            double r = zr[j] * wr - zi[j] * wi;
+            zi[j] = zr[j] * wi + zi[j] * wr;
+            zr[j] = r;
+        }
+    }
+    for (int j = 0; j < OSC_LANES; j++) {
+        z_real[j] = zr[j];
+        z_imag[j] = zi[j];
+    }
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define OSC_SIMD_X86 1
+#include <immintrin.h>
+
+/*
+ * 向量内核: OSC_LANES 个通道分成 OSC_LANES / VW 个向量，运算顺序与标量内核相同 (不使用 FMA)，
+ * 各指令集的输出逐位相同
+ */
+#define OSC_ROTATE_FN(NAME, VT, VW, LOADD, STORED, SET1, ADD, SUB, MUL)                         \
+    static void NAME(double* z_real, double* z_imag, double wr_s, double wi_s,                  \
+                     double* out_cos, double* out_sin, int blocks) {                            \
+        VT zr[OSC_LANES / VW], zi[OSC_LANES / VW];                                              \
+        VT wr = SET1(wr_s), wi = SET1(wi_s);                                                    \
+        for (int v = 0; v < OSC_LANES / VW; v++) {                                              \
+            zr[v] = LOADD(z_real + v * VW);                                                     \
+            zi[v] = LOADD(z_imag + v * VW);                                                     \
+        }                                                                                       \
+        for (int b = 0; b < blocks; b++) {                                                      \
+            if (out_cos) {                                                                      \
+                _Pragma("GCC unroll 4")                                                         \
+                for (int v = 0; v < OSC_LANES / VW; v++) STORED(out_cos + b * OSC_LANES + v * VW, zr[v]); \
+            }                                                                                   \
+            if (out_sin) {                                                                      \
+                _Pragma("GCC unroll 4")                                                         \
+                for (int v = 0; v < OSC_LANES / VW; v++) STORED(out_sin + b * OSC_LANES + v * VW, zi[v]); \
+            }                                                                                   \
+            _Pragma("GCC unroll 4")                                                             \
+            for (int v = 0; v < OSC_LANES / VW; v++) {                                          \
+                VT r = SUB(MUL(zr[v], wr), MUL(zi[v], wi));                                     \
+                zi[v] = ADD(MUL(zr[v], wi), MUL(zi[v], wr));                                    \
+                zr[v] = r;                                                                      \
+            }                                                                                   \
+        }                                                                                       \
+        for (int v = 0; v < OSC_LANES / VW; v++) {                                              \
+            STORED(z_real + v * VW, zr[v]);                                                     \
+            STORED(z_imag + v * VW, zi[v]);                                                     \
+        }                                                                                       \
+    }
+
+#pragma GCC push_options
+#pragma GCC target("sse2")
+OSC_ROTATE_FN(rotator_sse2, __m128d, 2, _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd,
+              _mm_add_pd, _mm_sub_pd, _mm_mul_pd)
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+OSC_ROTATE_FN(rotator_avx2, __m256d, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd,
+              _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd)
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+OSC_ROTATE_FN(rotator_avx512, __m512d, 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd,
+              _mm512_add_pd, _mm512_sub_pd, _mm512_mul_pd)
+#pragma GCC pop_options
+#endif
+
+typedef void (*rotator_kernel)(double* z_real, double* z_imag, double wr, double wi,
+                               double* out_cos, double* out_sin, int blocks);
+
+/**
+ * 按 fft_simd_get_level 选择向量宽度
+ */
+static rotator_kernel rotator_select(void) {
+#ifdef OSC_SIMD_X86
+    switch (fft_simd_get_level()) {
+        case FFT_SIMD_AVX512: return rotator_avx512;
+        case FFT_SIMD_AVX2:   return rotator_avx2;
+        case FFT_SIMD_SSE2:   return rotator_sse2;
+        default: break;
+    }
+#endif
+    return rotator_scalar;
+}
+
+void osc_rotator_render(osc_rotator* osc, double* out_cos, double* out_sin, int count) {
+    rotator_kernel kernel = rotator_select();
+    int i = 0;
+
+    while (i < count) {
+        if (osc->until_reseed <= 0) {
+            rotator_reseed(osc);
+            osc->until_reseed = OSC_RESEED;
+        }
+
+        int blocks = (count - i) / OSC_LANES;
+        if (blocks > osc->until_reseed / OSC_LANES) blocks = osc->until_reseed / OSC_LANES;
+        if (blocks == 0) {
+            // 不足一组: 输出前几个通道，下次从新的位置重新设置相位
+            int rest = count - i;
+            for (int j = 0; j < rest; j++) {
+                if (out_cos) out_cos[i + j] = osc->z_real[j];
+                if (out_sin) out_sin[i + j] = osc->z_imag[j];
+            }
+            osc->n += rest;
+            osc->until_reseed = 0;
+            break;
+        }
+
+        kernel(osc->z_real, osc->z_imag, osc->w_real, osc->w_imag,
+               out_cos ? out_cos + i : NULL, out_sin ? out_sin + i : NULL, blocks);
+        i += blocks * OSC_LANES;
+        osc->n += (long long)blocks * OSC_LANES;
+        osc->until_reseed -= blocks * OSC_LANES;
+    }
+}
+
+/* ---------------- 查表数控振荡器 ---------------- */
+
+static double osc_table[OSC_TABLE_SIZE + 1];   // cos(2πk/表长)，最后一项等于第一项便于插值
+static int osc_table_ready = 0;
+
+/**
+ * 填充余弦表 (只在第一次使用时执行，重复执行写入的值相同)
+ */
+static void osc_table_init(void) {
+    for (int k = 0; k <= OSC_TABLE_SIZE; k++) {
+        osc_table[k] = cos(2.0 * M_PI * k / OSC_TABLE_SIZE);
+    }
+    osc_table_ready = 1;
+}
+
+/**
+ * 周数换算为相位字 (按 2^64 取模)
+ */
+static uint64_t cycles_word(double cycles) {
+    cycles -= floor(cycles);
+    double words = cycles * 18446744073709551616.0;     // 2^64
+    return words >= 18446744073709551616.0 ? 0 : (uint64_t)words;
+}
+
+uint64_t osc_phase_word(double radians) {
+    return cycles_word(radians * (1.0 / (2.0 * M_PI)));
+}
+
+#define OSC_MAGIC_ROUND 6755399441055744.0     // 1.5 × 2^52: 加上后尾数的低位就是四舍五入的整数
+#define OSC_MAGIC_FRAC  4503599627370496.0     // 2^52: 尾数放入 32 位整数后减去它得到该整数
+#define OSC_OFFSET_SCALE (4294967296.0 / (2.0 * M_PI))    // 弧度换算为 2^-32 周
+#define OSC_INTERP_BITS 32                      // 插值只取表下标之后的 32 位
+
+static inline uint64_t double_bits(double x) {
+    uint64_t u;
+    memcpy(&u, &x, sizeof(u));
+    return u;
+}
+
+static inline double bits_double(uint64_t u) {
+    double x;
+    memcpy(&x, &u, sizeof(x));
+    return x;
+}
+
+/**
+ * 逐样本的附加相位换算为相位字: 精度取 2^-32 周 (约 1.5e-9 弧度)，
+ * 只做一次乘加和移位，不调用 floor 也不做浮点到整数的转换 (|radians| < 1e6)
+ */
+static inline uint64_t offset_word(double radians) {
+    return double_bits(radians * OSC_OFFSET_SCALE + OSC_MAGIC_ROUND) << 32;
+}
+
+/**
+ * 查表 + 线性插值 (调用前余弦表必须已经填充)
+ * 插值系数取下标之后的 32 位，同样按尾数拼接换算为 double，只用整数移位和浮点加减，便于向量化
+ */
+static inline double table_lookup(uint64_t phase) {
+    uint64_t k = phase >> OSC_FRAC_BITS;
+    uint64_t f = (phase >> (OSC_FRAC_BITS - OSC_INTERP_BITS)) & 0xffffffffu;
+    double frac = (bits_double(f | double_bits(OSC_MAGIC_FRAC)) - OSC_MAGIC_FRAC) * (1.0 / 4294967296.0);
+    return osc_table[k] + frac * (osc_table[k + 1] - osc_table[k]);
+}
+
+double osc_table_cos(uint64_t phase) {
+    if (!osc_table_ready) osc_table_init();
+    return table_lookup(phase);
+}
+
+void osc_nco_init(osc_nco* nco, double freq, double fs, double phase) {
+    if (!osc_table_ready) osc_table_init();
+    nco->phase = osc_phase_word(phase);
+    nco->step = cycles_word(freq / fs);
+}
+
+/**
+ * 数控振荡器内核: 输出 count 个样本，返回之后的相位
+ */
+static uint64_t nco_scalar(uint64_t phase, uint64_t step, const double* offset, double* out, int count) {
+    if (offset) {
+        for (int i = 0; i < count; i++, phase += step) {
+            out[i] = table_lookup(phase + offset_word(offset[i]));
+        }
+    } else {
+        for (int i = 0; i < count; i++, phase += step) {
+            out[i] = table_lookup(phase);
+        }
+    }
+    return phase;
+}
+
+#ifdef OSC_SIMD_X86
+/*
+ * 向量内核: VW 个相邻样本的相位字放在 64 位整数通道中，两次 gather 取出表中相邻两项，
+ * 运算与 table_lookup / offset_word 逐位相同。SSE2 没有 gather，使用标量内核。
+ * 不足一个向量的样本在同一个函数内按标量处理，理由与 image_io.c 的 min/max 内核相同 (避免尾调用前缺少 vzeroupper)
+ */
+#define OSC_NCO_FN(NAME, VT, VI, VW, LOADD, STORED, LOADI, SET1, SET1I, ADD, SUB, MUL,         \
+                   ADDI, ANDI, ORI, SRLI, SLLI, CASTPD, CASTSI, GATHER)                       \
+    static uint64_t NAME(uint64_t phase, uint64_t step, const double* offset, double* out, int count) { \
+        uint64_t lanes[VW];                                                                     \
+        for (int j = 0; j < VW; j++) lanes[j] = phase + (uint64_t)j * step;                     \
+        VI p = LOADI(lanes);                                                                    \
+        VI vstep = SET1I((long long)(step * VW));                                               \
+        VI one = SET1I(1), mask = SET1I(0xffffffffLL);                                          \
+        VI magic_bits = SET1I((long long)double_bits(OSC_MAGIC_FRAC));                          \
+        VT magic = SET1(OSC_MAGIC_FRAC), round = SET1(OSC_MAGIC_ROUND);                         \
+        VT scale = SET1(OSC_OFFSET_SCALE), unit = SET1(1.0 / 4294967296.0);                     \
+        int i = 0;                                                                              \
+        for (; i + VW <= count; i += VW) {                                                      \
+            VI q = p;                                                                           \
+            if (offset) {                                                                       \
+                VT w = ADD(MUL(LOADD(offset + i), scale), round);                               \
+                q = ADDI(q, SLLI(CASTPD(w), 32));                                               \
+            }                                                                                   \
+            VI k = SRLI(q, OSC_FRAC_BITS);                                                      \
+            VI f = ANDI(SRLI(q, OSC_FRAC_BITS - OSC_INTERP_BITS), mask);                        \
+            VT frac = MUL(SUB(CASTSI(ORI(f, magic_bits)), magic), unit);                        \
+            VT a = GATHER(k), b = GATHER(ADDI(k, one));                                         \
+            STORED(out + i, ADD(a, MUL(frac, SUB(b, a))));                                      \
+            p = ADDI(p, vstep);                                                                 \
+        }                                                                                       \
+        phase += (uint64_t)i * step;                                                            \
+        for (; i < count; i++, phase += step) {                                                 \
+            out[i] = table_lookup(offset ? phase + offset_word(offset[i]) : phase);             \
+        }                                                                                       \
+        return phase;                                                                           \
+    }
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+static inline __m256i nco_load_avx2(const uint64_t* p) {
+    return _mm256_loadu_si256((const __m256i*)p);
+}
+static inline __m256d nco_gather_avx2(__m256i k) {
+    return _mm256_i64gather_pd(osc_table, k, 8);
+}
+OSC_NCO_FN(nco_avx2, __m256d, __m256i, 4, _mm256_loadu_pd, _mm256_storeu_pd, nco_load_avx2,
+           _mm256_set1_pd, _mm256_set1_epi64x, _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd,
+           _mm256_add_epi64, _mm256_and_si256, _mm256_or_si256, _mm256_srli_epi64, _mm256_slli_epi64,
+           _mm256_castpd_si256, _mm256_castsi256_pd, nco_gather_avx2)
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+static inline __m512i nco_load_avx512(const uint64_t* p) {
+    return _mm512_loadu_si512((const void*)p);
+}
+static inline __m512d nco_gather_avx512(__m512i k) {
+    return _mm512_i64gather_pd(k, osc_table, 8);
+}
+OSC_NCO_FN(nco_avx512, __m512d, __m512i, 8, _mm512_loadu_pd, _mm512_storeu_pd, nco_load_avx512,
+           _mm512_set1_pd, _mm512_set1_epi64, _mm512_add_pd, _mm512_sub_pd, _mm512_mul_pd,
+           _mm512_add_epi64, _mm512_and_si512, _mm512_or_si512, _mm512_srli_epi64, _mm512_slli_epi64,
+           _mm512_castpd_si512, _mm512_castsi512_pd, nco_gather_avx512)
+#pragma GCC pop_options
+#endif
+
+typedef uint64_t (*nco_kernel)(uint64_t phase, uint64_t step, const double* offset, double* out, int count);
+
+/**
+ * 按 fft_simd_get_level 选择向量宽度
+ */
+static nco_kernel nco_select(void) {
+#ifdef OSC_SIMD_X86
+    switch (fft_simd_get_level()) {
+        case FFT_SIMD_AVX512: return nco_avx512;
+        case FFT_SIMD_AVX2:   return nco_avx2;
+        default: break;
+    }
+#endif
+    return nco_scalar;
+}
+
+void osc_nco_render(osc_nco* nco, const double* offset, double* out, int count) {
+    nco->phase = nco_select()(nco->phase, nco->step, offset, out, count);
+}
@@ -6,7 +6,7 @@ echo ""
 
 # 编译程序
 echo "步骤1: 编译AM程序..."
-gcc -o am_signal main-am.c -lm
+gcc -o am_signal main-am.c text_io.c fft_thread.c oscillator.c fft_simd.c -lm -pthread
 if [ $? -ne 0 ]; then
     echo "错误: 编译失败"
     exit 1
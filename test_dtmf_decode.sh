@@ -0,0 +1,73 @@
+#!/bin/bash
+# DTMF 流式解码测试 (./dtmf --decode)
+# 1. 生成按键序列的 PCM 文件后解码，文件和管道输入都应还原出原序列
+# 2. 短于 40 ms 的按键音不确认，短于 40 ms 的间隔不拆成两次按键
+
+echo "=========================================="
+echo "  DTMF 流式解码测试"
+echo "=========================================="
+echo
+
+make dtmf > /dev/null || { echo "  ✗ 编译失败"; exit 1; }
+
+workdir=$(mktemp -d)
+trap 'rm -rf "$workdir"' EXIT
+failed=0
+
+# 解码 PCM 文件 (或 - 表示标准输入)，输出识别结果
+decoded_keys() {
+    ./dtmf --decode "$1" | sed -n 's/^识别结果: //p'
+}
+
+# 检查识别结果: 说明 期望值 实际值
+check() {
+    if [ "$3" = "$2" ]; then
+        echo "  ✓ $1: $3"
+    else
+        echo "  ✗ $1: 期望 $2，实际 ${3:-(无输出)}"
+        failed=1
+    fi
+}
+
+# 按键序列往返: dtmf 生成，dtmf --decode 解码
+./dtmf "123*#0" --output "$workdir/keys.raw" > /dev/null
+check "文件输入 123*#0" "123*#0" "$(decoded_keys "$workdir/keys.raw")"
+check "管道输入 123*#0" "123*#0" "$(cat "$workdir/keys.raw" | decoded_keys -)"
+
+if command -v python3 > /dev/null 2>&1; then
+    # 按段生成 8 kHz S16_LE 信号: 每段为 "5:毫秒" (按键 5，两音调各 -8 dBFS) 或 "-:毫秒" (静音)
+    make_pcm() {
+        python3 -c '
+import math, struct, sys
+fs = 8000
+samples = []
+for segment in sys.argv[2:]:
+    key, ms = segment.split(":")
+    for n in range(fs * int(ms) // 1000):
+        v = 0.0
+        if key == "5":
+            v = 0.4 * math.sin(2 * math.pi * 770 * n / fs) + 0.4 * math.sin(2 * math.pi * 1336 * n / fs)
+        samples.append(int(v * 32767))
+open(sys.argv[1], "wb").write(struct.pack("<%dh" % len(samples), *samples))
+' "$@"
+    }
+
+    make_pcm "$workdir/burst30.raw" -:100 5:30 -:100
+    check "30 ms 短音不确认" "(无)" "$(decoded_keys "$workdir/burst30.raw")"
+    make_pcm "$workdir/burst50.raw" -:100 5:50 -:100
+    check "50 ms 按键音确认" "5" "$(decoded_keys "$workdir/burst50.raw")"
+    make_pcm "$workdir/gap50.raw" -:100 5:100 -:50 5:100 -:100
+    check "50 ms 间隔为两次按键" "55" "$(decoded_keys "$workdir/gap50.raw")"
+    make_pcm "$workdir/gap30.raw" -:100 5:100 -:30 5:100 -:100
+    check "30 ms 间隔不拆分按键" "5" "$(decoded_keys "$workdir/gap30.raw")"
+else
+    echo "  - 跳过短音和间隔测试 (需要 python3 生成测试数据)"
+fi
+
+echo
+if [ $failed -eq 0 ]; then
+    echo "测试通过"
+else
+    echo "测试失败"
+fi
+exit $failed
@@ -8,7 +8,7 @@ echo ""
 
 # 编译程序
 echo "【步骤 1】编译程序..."
-gcc -o envelope_detector envelope_detector.c -lm -O2 -Wall
+gcc -o envelope_detector envelope_detector.c text_io.c fft_thread.c oscillator.c fft_simd.c -lm -pthread -O2 -Wall
 
 if [ $? -ne 0 ]; then
     echo "❌ 编译失败！"
@@ -0,0 +1,241 @@
+#!/bin/bash
+# FFT 计划缓存测试
+# 调用者持有 fft_*_get 返回的计划时调大线程数 (fft_set_threads)，缓存为新线程数另建计划，
+# 旧计划在 fft_plan_cache_clear 之前仍然可以执行，结果与新计划一致；
+# 多个线程同时以相同尺寸调用简单接口 (fft_1d、fft_r2c_1d、fft_2d)，结果与单线程调用一致
+# (编译器支持时用 AddressSanitizer 编译，释放后使用会直接报错)
+
+echo "=========================================="
+echo "  FFT 计划缓存测试"
+echo "=========================================="
+echo
+
+workdir=$(mktemp -d)
+trap 'rm -rf "$workdir"' EXIT
+
+cat > "$workdir/plan_cache.c" << 'EOF'
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "fft.h"
+
+static int failed = 0;
+
+static double max_diff(const double* a, const double* b, size_t n) {
+    double max = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double d = fabs(a[i] - b[i]);
+        if (d > max) max = d;
+    }
+    return max;
+}
+
+static void check(const char* name, int ok) {
+    printf("  %s %s\n", ok ? "✓" : "✗", name);
+    if (!ok) failed = 1;
+}
+
+/* 四步法复数计划 (N >= 2^19) */
+static void test_plan(void) {
+    const int n = 1 << 19;
+    double *x = malloc(n * sizeof(double));
+    double *a_real = malloc(n * sizeof(double)), *a_imag = malloc(n * sizeof(double));
+    double *b_real = malloc(n * sizeof(double)), *b_imag = malloc(n * sizeof(double));
+    if (!x || !a_real || !a_imag || !b_real || !b_imag) {
+        check("复数计划: 内存分配", 0);
+        free(x); free(a_real); free(a_imag); free(b_real); free(b_imag);
+        return;
+    }
+    for (int i = 0; i < n; i++) x[i] = sin(0.001 * i) + 0.25 * cos(0.37 * i);
+
+    fft_set_threads(1);
+    fft_plan *held = fft_plan_get(n, FFT_FORWARD);
+    fft_set_threads(4);
+    fft_plan *fresh = fft_plan_get(n, FFT_FORWARD);
+    check("复数计划: 线程数增加后重新获取", held && fresh);
+    if (held && fresh) {
+        int ok = fft_execute(held, x, NULL, a_real, a_imag) == 0 &&
+                 fft_execute(fresh, x, NULL, b_real, b_imag) == 0;
+        check("复数计划: 持有的旧计划仍可执行且与新计划一致",
+              ok && max_diff(a_real, b_real, n) < 1e-6 && max_diff(a_imag, b_imag, n) < 1e-6);
+    }
+    free(x); free(a_real); free(a_imag); free(b_real); free(b_imag);
+}
+
+/* 实数计划 (内部复数计划长度 N/2 >= 2^19，使用四步法) */
+static void test_rplan(void) {
+    const int n = 1 << 20, bins = n / 2 + 1;
+    double *x = malloc(n * sizeof(double));
+    double *a_real = malloc(bins * sizeof(double)), *a_imag = malloc(bins * sizeof(double));
+    double *b_real = malloc(bins * sizeof(double)), *b_imag = malloc(bins * sizeof(double));
+    if (!x || !a_real || !a_imag || !b_real || !b_imag) {
+        check("实数计划: 内存分配", 0);
+        free(x); free(a_real); free(a_imag); free(b_real); free(b_imag);
+        return;
+    }
+    for (int i = 0; i < n; i++) x[i] = sin(0.002 * i) - 0.5 * cos(0.11 * i);
+
+    fft_set_threads(1);
+    fft_rplan *held = fft_rplan_get(n, FFT_FORWARD);
+    fft_set_threads(4);
+    fft_rplan *fresh = fft_rplan_get(n, FFT_FORWARD);
+    check("实数计划: 线程数增加后重新获取", held && fresh);
+    if (held && fresh) {
+        int ok = fft_execute_r2c(held, x, a_real, a_imag) == 0 &&
+                 fft_execute_r2c(fresh, x, b_real, b_imag) == 0;
+        check("实数计划: 持有的旧计划仍可执行且与新计划一致",
+              ok && max_diff(a_real, b_real, bins) < 1e-6 && max_diff(a_imag, b_imag, bins) < 1e-6);
+    }
+    free(x); free(a_real); free(a_imag); free(b_real); free(b_imag);
+}
+
+/* 批量变换计划 (每个线程一份工作区) */
+static void test_plan_many(void) {
+    const int n = 256, howmany = 1024;
+    const size_t total = (size_t)n * howmany;
+    double *x = malloc(total * sizeof(double));
+    double *a_real = malloc(total * sizeof(double)), *a_imag = malloc(total * sizeof(double));
+    double *b_real = malloc(total * sizeof(double)), *b_imag = malloc(total * sizeof(double));
+    if (!x || !a_real || !a_imag || !b_real || !b_imag) {
+        check("批量计划: 内存分配", 0);
+        free(x); free(a_real); free(a_imag); free(b_real); free(b_imag);
+        return;
+    }
+    for (size_t i = 0; i < total; i++) x[i] = cos(0.013 * i) + 0.1 * (double)(i % 7);
+
+    fft_set_threads(1);
+    fft_plan_many *held = fft_plan_many_get(n, howmany, 1, n, FFT_FORWARD);
+    fft_set_threads(4);
+    fft_plan_many *fresh = fft_plan_many_get(n, howmany, 1, n, FFT_FORWARD);
+    check("批量计划: 线程数增加后重新获取", held && fresh);
+    if (held && fresh) {
+        int ok = fft_execute_many(held, x, NULL, a_real, a_imag) == 0 &&
+                 fft_execute_many(fresh, x, NULL, b_real, b_imag) == 0;
+        check("批量计划: 持有的旧计划仍可执行且与新计划一致",
+              ok && max_diff(a_real, b_real, total) < 1e-9 && max_diff(a_imag, b_imag, total) < 1e-9);
+    }
+    free(x); free(a_real); free(a_imag); free(b_real); free(b_imag);
+}
+
+/* 二维计划 (每个线程一份工作区和列条带)，原地变换 */
+static void test_plan2d(void) {
+    const int M = 256, N = 256;
+    const size_t total = (size_t)M * N;
+    double *a_real = malloc(total * sizeof(double)), *a_imag = calloc(total, sizeof(double));
+    double *b_real = malloc(total * sizeof(double)), *b_imag = calloc(total, sizeof(double));
+    if (!a_real || !a_imag || !b_real || !b_imag) {
+        check("二维计划: 内存分配", 0);
+        free(a_real); free(a_imag); free(b_real); free(b_imag);
+        return;
+    }
+    for (size_t i = 0; i < total; i++) a_real[i] = b_real[i] = sin(0.07 * (i % N)) * cos(0.05 * (i / N));
+
+    fft_set_threads(1);
+    fft_plan2d *held = fft_plan2d_get(M, N, FFT_FORWARD);
+    fft_set_threads(4);
+    fft_plan2d *fresh = fft_plan2d_get(M, N, FFT_FORWARD);
+    check("二维计划: 线程数增加后重新获取", held && fresh);
+    if (held && fresh) {
+        int ok = fft_execute_2d(held, a_real, a_imag) == 0 &&
+                 fft_execute_2d(fresh, b_real, b_imag) == 0;
+        check("二维计划: 持有的旧计划仍可执行且与新计划一致",
+              ok && max_diff(a_real, b_real, total) < 1e-9 && max_diff(a_imag, b_imag, total) < 1e-9);
+    }
+    free(a_real); free(a_imag); free(b_real); free(b_imag);
+}
+
+/* 多个线程同时调用简单接口: 缓存计划只借给一个线程，其余线程使用临时计划 */
+#define SIMPLE_THREADS 4
+#define SIMPLE_ROUNDS  200
+#define SIMPLE_N       1024
+#define SIMPLE_M       64
+
+static double simple_x[SIMPLE_M * SIMPLE_N];
+static double ref_1d_real[SIMPLE_N], ref_1d_imag[SIMPLE_N];
+static double ref_r2c_real[SIMPLE_N / 2 + 1], ref_r2c_imag[SIMPLE_N / 2 + 1];
+static double ref_2d_real[SIMPLE_M * SIMPLE_N], ref_2d_imag[SIMPLE_M * SIMPLE_N];
+
+static void* simple_worker(void* arg) {
+    int *ok = (int *)arg;
+    double *re = malloc(SIMPLE_M * SIMPLE_N * sizeof(double));
+    double *im = malloc(SIMPLE_M * SIMPLE_N * sizeof(double));
+    *ok = re && im;
+    for (int round = 0; round < SIMPLE_ROUNDS && *ok; round++) {
+        switch (round % 3) {
+        case 0:
+            *ok = fft_1d(simple_x, NULL, SIMPLE_N, re, im) == 0 &&
+                  max_diff(re, ref_1d_real, SIMPLE_N) == 0 && max_diff(im, ref_1d_imag, SIMPLE_N) == 0;
+            break;
+        case 1:
+            *ok = fft_r2c_1d(simple_x, SIMPLE_N, re, im) == 0 &&
+                  max_diff(re, ref_r2c_real, SIMPLE_N / 2 + 1) == 0 &&
+                  max_diff(im, ref_r2c_imag, SIMPLE_N / 2 + 1) == 0;
+            break;
+        default:
+            *ok = fft_2d(simple_x, NULL, SIMPLE_M, SIMPLE_N, re, im) == 0 &&
+                  max_diff(re, ref_2d_real, SIMPLE_M * SIMPLE_N) == 0 &&
+                  max_diff(im, ref_2d_imag, SIMPLE_M * SIMPLE_N) == 0;
+            break;
+        }
+    }
+    free(re);
+    free(im);
+    return NULL;
+}
+
+static void test_simple_concurrent(void) {
+    for (int i = 0; i < SIMPLE_M * SIMPLE_N; i++) simple_x[i] = sin(0.03 * i) + 0.2 * cos(0.9 * i);
+    fft_set_threads(1);
+    int ok = fft_1d(simple_x, NULL, SIMPLE_N, ref_1d_real, ref_1d_imag) == 0 &&
+             fft_r2c_1d(simple_x, SIMPLE_N, ref_r2c_real, ref_r2c_imag) == 0 &&
+             fft_2d(simple_x, NULL, SIMPLE_M, SIMPLE_N, ref_2d_real, ref_2d_imag) == 0;
+    check("简单接口: 单线程参考结果", ok);
+    if (!ok) return;
+
+    pthread_t threads[SIMPLE_THREADS];
+    int results[SIMPLE_THREADS];
+    int started = 0;
+    for (int t = 0; t < SIMPLE_THREADS; t++) {
+        results[t] = 1;
+        if (pthread_create(&threads[t], NULL, simple_worker, &results[t]) != 0) break;
+        started++;
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+        ok = ok && results[t];
+    }
+    check("简单接口: 多个线程同时调用，结果与单线程一致", ok && started == SIMPLE_THREADS);
+}
+
+int main(void) {
+    test_plan();
+    test_rplan();
+    test_plan_many();
+    test_plan2d();
+    test_simple_concurrent();
+    fft_plan_cache_clear();
+    return failed;
+}
+EOF
+
+sources="fft.c fft_simd.c fft_thread.c"
+sanitize=""
+if echo 'int main(void) { return 0; }' | gcc -fsanitize=address -x c - -o "$workdir/asan_probe" > /dev/null 2>&1 &&
+   "$workdir/asan_probe" > /dev/null 2>&1; then
+    sanitize="-fsanitize=address -fno-omit-frame-pointer"
+fi
+gcc -O1 -g -std=c99 -Wall -Wextra $sanitize -I. "$workdir/plan_cache.c" $sources \
+    -o "$workdir/plan_cache" -lm -pthread || { echo "  ✗ 编译失败"; exit 1; }
+[ -n "$sanitize" ] && echo "  (AddressSanitizer 已启用)"
+
+"$workdir/plan_cache"
+failed=$?
+
+echo
+if [ $failed -eq 0 ]; then
+    echo "测试通过"
+else
+    echo "测试失败"
+fi
+exit $failed
@@ -0,0 +1,66 @@
+#!/bin/bash
+# FFT SIMD 内核一致性测试
+# 分别强制使用 scalar / sse2 / avx2 / avx512 内核运行 fft2d 和 kspace_to_image，
+# 检查输出的图像与标量内核一致
+# (FMA 的舍入与分开的乘加不同，量化到 8 位灰度时个别像素允许相差 1)
+
+echo "=========================================="
+echo "  FFT SIMD 内核一致性测试"
+echo "=========================================="
+echo
+
+make fft2d kspace_to_image > /dev/null || { echo "  ✗ 编译失败"; exit 1; }
+
+# 两个等大文件逐字节比较，输出最大差值
+max_byte_diff() {
+    cmp -l "$1" "$2" | awk '
+        function oct(s,  v, i) { v = 0; for (i = 1; i <= length(s); i++) v = v * 8 + substr(s, i, 1); return v }
+        { d = oct($2) - oct($3); if (d < 0) d = -d; if (d > max) max = d }
+        END { print max + 0 }'
+}
+
+workdir=$(mktemp -d)
+trap 'rm -rf "$workdir"' EXIT
+failed=0
+
+for level in scalar sse2 avx2 avx512; do
+    FFT_SIMD=$level ./fft2d > "$workdir/fft2d_$level.txt" 2> "$workdir/stderr_$level.txt"
+    if grep -q "不支持" "$workdir/stderr_$level.txt"; then
+        echo "  - $level: 当前 CPU 不支持，跳过"
+        continue
+    fi
+    FFT_SIMD=$level ./kspace_to_image kspace_data.bin > /dev/null 2>&1
+    if [ $? -ne 0 ]; then
+        echo "  ✗ $level: kspace_to_image 运行失败"
+        failed=1
+        continue
+    fi
+    mkdir -p "$workdir/$level"
+    cp magnitude_spectrum.bmp restored_image.bmp reconstructed_image.bmp "$workdir/$level/" 2>/dev/null
+
+    if [ "$level" = "scalar" ]; then
+        echo "  ✓ scalar: 参考输出"
+        continue
+    fi
+    same=1
+    for f in magnitude_spectrum.bmp restored_image.bmp reconstructed_image.bmp; do
+        diff=$(max_byte_diff "$workdir/scalar/$f" "$workdir/$level/$f")
+        if [ "$diff" -gt 1 ]; then
+            echo "  ✗ $level: $f 与标量内核相差 $diff 个灰度级"
+            same=0
+        fi
+    done
+    if [ $same -eq 1 ]; then
+        echo "  ✓ $level: 输出与标量内核一致"
+    else
+        failed=1
+    fi
+done
+
+echo
+if [ $failed -eq 0 ]; then
+    echo "测试通过"
+else
+    echo "测试失败"
+fi
+exit $failed
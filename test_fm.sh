@@ -9,7 +9,7 @@ echo
 # 检查程序是否已编译
 if [ ! -f "./fm_signal" ]; then
     echo "正在编译 FM 信号程序..."
-    gcc -o fm_signal main-fm.c -lm -Wall
+    gcc -o fm_signal main-fm.c text_io.c fft_thread.c oscillator.c fft_simd.c -lm -pthread -Wall
     if [ $? -ne 0 ]; then
         echo "编译失败！"
         exit 1
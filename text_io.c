@@ -0,0 +1,310 @@
+/**
+ * @file text_io.c
+ * @brief 数值表格的快速文本输出 (见 text_io.h)
+ *
+ * 正确舍入: printf 按数值的精确二进制值四舍五入 (恰好一半时取偶数)。
+ * a * 10^P 用 Dekker 乘法得到精确的 hi + lo，整数部分 < 2^52 时，
+ * 由 hi 的小数部分和 lo 的符号即可判断精确值相对 .5 的位置，得到与 printf 相同的整数。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+
+#include "text_io.h"
+#include "fft.h"
+#include "fft_thread.h"
+
+#define TEXT_CHUNK_ROWS 8192            // 每个任务格式化的行数
+#define TEXT_PARALLEL_MIN 16384         // 少于这么多行时不启动线程
+#define TEXT_MAX_PRECISION 40           // 超过时 text_format 只保证不越界 (截断为该精度)
+#define TEXT_MAX_WIDTH 64
+
+/** 10^0 .. 10^22 都能用 double 精确表示 */
+static const double text_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const uint64_t text_pow10_int[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL
+};
+
+/**
+ * 精确乘法: a * b = hi + lo
+ * 有硬件 FMA 时 (此时编译器也可能合并乘加) 直接用 fma 求误差项，否则用 Veltkamp 拆分 + Dekker 乘法
+ */
+static void text_two_prod(double a, double b, double* hi, double* lo) {
+    double p = a * b;
+#ifdef __FP_FAST_FMA
+    *hi = p;
+    *lo = fma(a, b, -p);
+#else
+    const double split = 134217729.0;   // 2^27 + 1
+    double ta = split * a, tb = split * b;
+    double ah = ta - (ta - a), al = a - ah;
+    double bh = tb - (tb - b), bl = b - bh;
+    *hi = p;
+    *lo = ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+#endif
+}
+
+/**
+ * 按 printf 的规则把 a * 10^k (a >= 0，0 <= k <= 22) 舍入为整数
+ * @return 0表示成功，-1表示超出精确判断的范围
+ */
+static int text_round_scaled(double a, int k, uint64_t* n) {
+    double hi, lo;
+    text_two_prod(a, text_pow10[k], &hi, &lo);
+    if (!(hi < 4503599627370496.0)) return -1;     // 2^52
+    double fl = floor(hi);
+    double frac = hi - fl;                          // 精确
+    uint64_t v = (uint64_t)fl;
+    // |lo| 不超过 hi 的半个 ulp，只在 frac 恰好为 0.5 时影响结果
+    if (frac > 0.5 || (frac == 0.5 && (lo > 0 || (lo == 0 && (v & 1))))) {
+        v++;
+    }
+    *n = v;
+    return 0;
+}
+
+/**
+ * 写出 n 的十进制数字 (至少 digits 位，不足时补 0)，返回位数
+ */
+static int text_put_uint(char* out, uint64_t n, int digits) {
+    char tmp[24];
+    int len = 0;
+    do {
+        tmp[len++] = (char)('0' + n % 10);
+        n /= 10;
+    } while (n > 0);
+    while (len < digits) tmp[len++] = '0';
+    for (int i = 0; i < len; i++) out[i] = tmp[len - 1 - i];
+    return len;
+}
+
+/**
+ * 左侧补空格到 width 个字符
+ */
+static int text_pad(char* out, int len, int width) {
+    if (len >= width) return len;
+    memmove(out + (width - len), out, (size_t)len);
+    memset(out, ' ', (size_t)(width - len));
+    return width;
+}
+
+static int text_snprintf(char* out, double value, const text_column* column) {
+    char buf[TEXT_MAX_FIELD + 1];
+    int len;
+    switch (column->kind) {
+        case TEXT_EXP:   len = snprintf(buf, sizeof(buf), "%*.*e", column->width, column->precision, value); break;
+        case TEXT_INT:   len = snprintf(buf, sizeof(buf), "%*d", column->width, (int)value); break;
+        default:         len = snprintf(buf, sizeof(buf), "%*.*f", column->width, column->precision, value); break;
+    }
+    if (len < 0) return 0;
+    if (len > TEXT_MAX_FIELD) len = TEXT_MAX_FIELD;
+    memcpy(out, buf, (size_t)len);
+    return len;
+}
+
+/**
+ * %.Pf: 整数部分、小数点、P 位小数
+ */
+static int text_fixed(char* out, double value, int precision) {
+    uint64_t n;
+    if (precision > 16 || !isfinite(value) || text_round_scaled(fabs(value), precision, &n) != 0) {
+        return -1;
+    }
+    int len = 0;
+    if (signbit(value)) out[len++] = '-';
+    len += text_put_uint(out + len, n / text_pow10_int[precision], 1);
+    if (precision > 0) {
+        out[len++] = '.';
+        len += text_put_uint(out + len, n % text_pow10_int[precision], precision);
+    }
+    return len;
+}
+
+/**
+ * %.Pe: 一位整数、P 位小数、e、符号和至少两位的指数
+ */
+static int text_exp(char* out, double value, int precision) {
+    if (precision > 15 || !isfinite(value)) return -1;
+    double a = fabs(value);
+    uint64_t n = 0;
+    int e = 0;
+    if (a != 0) {
+        // log10 的估计可能差一位，按舍入后的位数修正
+        e = (int)floor(log10(a));
+        for (int tries = 0; ; tries++) {
+            int k = precision - e;
+            if (tries > 3 || k < 0 || k > 22 || text_round_scaled(a, k, &n) != 0) return -1;
+            if (n < text_pow10_int[precision]) {
+                e--;
+            } else if (n >= text_pow10_int[precision + 1]) {
+                e++;
+            } else {
+                break;
+            }
+        }
+    }
+    int len = 0;
+    if (signbit(value)) out[len++] = '-';
+    uint64_t lead = n / text_pow10_int[precision];
+    out[len++] = (char)('0' + lead);
+    if (precision > 0) {
+        out[len++] = '.';
+        len += text_put_uint(out + len, n % text_pow10_int[precision], precision);
+    }
+    out[len++] = 'e';
+    out[len++] = e < 0 ? '-' : '+';
+    len += text_put_uint(out + len, (uint64_t)(e < 0 ? -e : e), 2);
+    return len;
+}
+
+int text_format(char* out, double value, const text_column* column) {
+    text_column c = *column;
+    if (c.width > TEXT_MAX_WIDTH) c.width = TEXT_MAX_WIDTH;
+    if (c.width < 0) c.width = 0;
+    if (c.precision > TEXT_MAX_PRECISION) c.precision = TEXT_MAX_PRECISION;
+    if (c.precision < 0) c.precision = 0;
+
+    int len;
+    switch (c.kind) {
+        case TEXT_INT: {
+            if (!(value >= -2147483647.0 && value <= 2147483647.0)) return text_snprintf(out, value, &c);
+            int iv = (int)value;
+            len = 0;
+            if (iv < 0) out[len++] = '-';
+            len += text_put_uint(out + len, (uint64_t)(iv < 0 ? -(long long)iv : iv), 1);
+            return text_pad(out, len, c.width);
+        }
+        case TEXT_EXP:
+            len = text_exp(out, value, c.precision);
+            break;
+        default:
+            len = text_fixed(out, value, c.precision);
+            break;
+    }
+    return len < 0 ? text_snprintf(out, value, &c) : text_pad(out, len, c.width);
+}
+
+/* ---------------- 分块并行输出 ---------------- */
+
+typedef struct {
+    char *data;
+    size_t len, cap;
+    int failed;
+} text_buffer;
+
+typedef struct {
+    const text_column *columns;
+    int ncols;
+    char sep;
+    size_t rows;
+    text_row_fn fn;
+    void *ctx;
+    size_t first_chunk;         // 本轮第一个块的序号
+    int chunks;                 // 本轮的块数 (每块一个缓冲区)
+    int next;
+    text_buffer *buffers;
+} text_task;
+
+/**
+ * 把块 chunk 的各行格式化到 buf
+ */
+static void text_format_chunk(const text_task* task, size_t chunk, text_buffer* buf) {
+    size_t begin = chunk * TEXT_CHUNK_ROWS;
+    size_t end = begin + TEXT_CHUNK_ROWS < task->rows ? begin + TEXT_CHUNK_ROWS : task->rows;
+    size_t row_max = (size_t)task->ncols * (TEXT_MAX_FIELD + 1) + 1;
+    double values[64];
+    buf->len = 0;
+    for (size_t row = begin; row < end; row++) {
+        if (buf->cap - buf->len < row_max) {
+            size_t cap = buf->cap * 2 + row_max;
+            char *data = (char *)realloc(buf->data, cap);
+            if (!data) {
+                buf->failed = 1;
+                return;
+            }
+            buf->data = data;
+            buf->cap = cap;
+        }
+        task->fn(task->ctx, row, values);
+        char *out = buf->data + buf->len;
+        for (int k = 0; k < task->ncols; k++) {
+            if (k > 0) *out++ = task->sep;
+            out += text_format(out, values[k], &task->columns[k]);
+        }
+        *out++ = '\n';
+        buf->len = (size_t)(out - buf->data);
+    }
+}
+
+static void text_worker(fft_team* team, void* arg, int member) {
+    text_task *task = (text_task *)arg;
+    int begin, count;
+    (void)member;
+    while ((count = fft_team_claim(team, &task->next, task->chunks, 1, &begin)) > 0) {
+        text_format_chunk(task, task->first_chunk + (size_t)begin, &task->buffers[begin]);
+    }
+}
+
+int text_write_table(FILE* file, const text_column* columns, int ncols, char sep,
+                     size_t rows, text_row_fn fn, void* ctx) {
+    if (ncols < 1 || ncols > 64) return -1;
+
+    // 每轮格式化 threads 个块 (单线程时为 1 块)，按顺序写出后再开始下一轮
+    int nthreads = rows < TEXT_PARALLEL_MIN ? 1 : fft_get_threads();
+    size_t total = (rows + TEXT_CHUNK_ROWS - 1) / TEXT_CHUNK_ROWS;
+    text_task task;
+    task.columns = columns;
+    task.ncols = ncols;
+    task.sep = sep;
+    task.rows = rows;
+    task.fn = fn;
+    task.ctx = ctx;
+    task.buffers = (text_buffer *)calloc((size_t)nthreads, sizeof(text_buffer));
+    int ok = task.buffers != NULL;
+
+    for (task.first_chunk = 0; ok && task.first_chunk < total; task.first_chunk += (size_t)task.chunks) {
+        task.chunks = total - task.first_chunk < (size_t)nthreads ? (int)(total - task.first_chunk) : nthreads;
+        task.next = 0;
+        fft_team_run(text_worker, &task, task.chunks);
+        for (int k = 0; ok && k < task.chunks; k++) {
+            ok = !task.buffers[k].failed &&
+                 fwrite(task.buffers[k].data, 1, task.buffers[k].len, file) == task.buffers[k].len;
+        }
+    }
+
+    if (task.buffers) {
+        for (int k = 0; k < nthreads; k++) free(task.buffers[k].data);
+        free(task.buffers);
+    }
+    return ok ? 0 : -1;
+}
+
+typedef struct {
+    const double *const *data;
+    int ncols;
+} text_columns_ctx;
+
+static void text_columns_row(void* ctx, size_t row, double* values) {
+    const text_columns_ctx *c = (const text_columns_ctx *)ctx;
+    for (int k = 0; k < c->ncols; k++) {
+        values[k] = c->data[k][row];
+    }
+}
+
+int text_write_columns(FILE* file, const double* const* data, int ncols, const text_column* column,
+                       char sep, size_t rows) {
+    text_column columns[64];
+    if (ncols < 1 || ncols > 64) return -1;
+    for (int k = 0; k < ncols; k++) columns[k] = *column;
+    text_columns_ctx ctx = {data, ncols};
+    return text_write_table(file, columns, ncols, sep, rows, text_columns_row, &ctx);
+}
@@ -0,0 +1,59 @@
+/**
+ * @file text_io.h
+ * @brief 数值表格的快速文本输出 (K空间文本、各程序的 CSV)
+ *
+ * 输出与逐行 fprintf 的结果逐字节相同，但不经过 printf 的格式解析：
+ * - 定点 (%.Nf) 和科学计数 (%W.Ne) 直接由正确舍入的整数生成各位数字，
+ *   无法保证正确舍入的少数数值 (很大的数、非数等) 交给 snprintf
+ * - 每个线程把一段连续的行格式化到自己的缓冲区，按顺序拼接后整块写入
+ */
+
+#ifndef TEXT_IO_H
+#define TEXT_IO_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+/** 列的格式 */
+#define TEXT_FIXED 0            // 与 "%W.Pf" 相同
+#define TEXT_EXP   1            // 与 "%W.Pe" 相同
+#define TEXT_INT   2            // 与 "%Wd" 相同 (数值必须是整数)
+
+/**
+ * 一列的格式: width 为最小宽度 (不足时左侧补空格，0 表示不补)，precision 为小数位数
+ */
+typedef struct {
+    int kind;
+    int width;
+    int precision;
+} text_column;
+
+/**
+ * 计算第 row 行各列的数值 (写入 values[0..ncols-1])
+ * 可能由多个线程同时调用 (各自不同的行)
+ */
+typedef void (*text_row_fn)(void* ctx, size_t row, double* values);
+
+/**
+ * 格式化一个数值，结果与 snprintf 相同
+ * @param out 输出缓冲区，至少 TEXT_MAX_FIELD 字节 (不写入结尾的 '\0')
+ * @return 写入的字符数
+ */
+#define TEXT_MAX_FIELD 384
+int text_format(char* out, double value, const text_column* column);
+
+/**
+ * 写出 rows 行的表格: 每行的各列之间用 sep 分隔，行尾为 '\n'
+ * @return 0表示成功，-1表示失败
+ */
+int text_write_table(FILE* file, const text_column* columns, int ncols, char sep,
+                     size_t rows, text_row_fn fn, void* ctx);
+
+/**
+ * 写出由若干等长数组组成的表格 (第 k 列取 data[k][row])，所有列使用同一个格式
+ * @return 0表示成功，-1表示失败
+ */
+int text_write_columns(FILE* file, const double* const* data, int ncols, const text_column* column,
+                       char sep, size_t rows);
+
+#endif /* TEXT_IO_H */